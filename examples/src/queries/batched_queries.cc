@@ -0,0 +1,33 @@
+#include <memory>
+#include <vector>
+
+#include <wavemap/data_structure/volumetric/hashed_wavelet_octree.h>
+#include <wavemap/utils/query/batched_query_accelerator.h>
+#include <wavemap/utils/thread_pool.h>
+
+#include "wavemap_examples/common.h"
+
+using namespace wavemap;
+int main(int, char**) {
+  // Declare a map pointer for illustration purposes
+  // NOTE: See the other tutorials on how to load maps from files or ROS topics,
+  //       such as the map topic published by the wavemap ROS server.
+  HashedWaveletOctree::Ptr map;
+
+  // Create the batched query accelerator
+  // NOTE: The thread pool is optional. If it is omitted, the batches are
+  //       evaluated on the calling thread.
+  auto thread_pool = std::make_shared<ThreadPool>();
+  BatchedQueryAccelerator batched_query_accelerator(*map, thread_pool);
+
+  // Gather the points you want to query, for example all points along a path
+  std::vector<Point3D> query_points;
+  examples::doSomething(query_points);
+
+  // Query all points at once
+  // NOTE: Batches of cell (Index3D) or node (OctreeIndex) indices can be
+  //       queried in the same way.
+  const std::vector<FloatingPoint> occupancy_log_odds =
+      batched_query_accelerator.getCellValues(query_points);
+  examples::doSomething(occupancy_log_odds);
+}
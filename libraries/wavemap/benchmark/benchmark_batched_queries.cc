@@ -0,0 +1,130 @@
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "wavemap/common.h"
+#include "wavemap/data_structure/volumetric/hashed_wavelet_octree.h"
+#include "wavemap/utils/query/batched_query_accelerator.h"
+#include "wavemap/utils/query/query_accelerator.h"
+#include "wavemap/utils/random_number_generator.h"
+#include "wavemap/utils/thread_pool.h"
+
+namespace wavemap {
+constexpr FloatingPoint kMapHalfWidth = 20.f;
+constexpr size_t kNumQueries = 1u << 20;
+
+// Create a map whose blocks are all allocated and contain random values
+std::unique_ptr<HashedWaveletOctree> CreateRandomMap(
+    RandomNumberGenerator& random_number_generator) {
+  HashedWaveletOctreeConfig config;
+  auto map = std::make_unique<HashedWaveletOctree>(config);
+  const auto max_index = static_cast<IndexElement>(
+      std::ceil(kMapHalfWidth / config.min_cell_width));
+  for (int update_idx = 0; update_idx < 1 << 20; ++update_idx) {
+    Index3D index;
+    for (int dim_idx = 0; dim_idx < 3; ++dim_idx) {
+      index[dim_idx] =
+          random_number_generator.getRandomInteger(-max_index, max_index);
+    }
+    map->addToCellValue(index, random_number_generator.getRandomRealNumber(
+                                   config.min_log_odds, config.max_log_odds));
+  }
+  map->threshold();
+  return map;
+}
+
+// Generate query points that are either spread uniformly over the whole map,
+// or clustered in small balls, like the collision checks of a planner
+std::vector<Point3D> GenerateQueryPoints(
+    RandomNumberGenerator& random_number_generator, bool clustered) {
+  constexpr int kNumPointsPerCluster = 64;
+  constexpr FloatingPoint kClusterRadius = 0.5f;
+  std::vector<Point3D> points(kNumQueries);
+  Point3D cluster_center = Point3D::Zero();
+  for (size_t point_idx = 0u; point_idx < kNumQueries; ++point_idx) {
+    const bool new_cluster = point_idx % kNumPointsPerCluster == 0u;
+    Point3D& point = points[point_idx];
+    for (int dim_idx = 0; dim_idx < 3; ++dim_idx) {
+      if (!clustered || new_cluster) {
+        cluster_center[dim_idx] = random_number_generator.getRandomRealNumber(
+            -kMapHalfWidth, kMapHalfWidth);
+      }
+      point[dim_idx] =
+          clustered ? cluster_center[dim_idx] +
+                          random_number_generator.getRandomRealNumber(
+                              -kClusterRadius, kClusterRadius)
+                    : cluster_center[dim_idx];
+    }
+  }
+  return points;
+}
+
+// Query each point through the map's virtual getCellValue method
+static void QueryVirtual(benchmark::State& state) {
+  RandomNumberGenerator random_number_generator;
+  const auto map = CreateRandomMap(random_number_generator);
+  const VolumetricDataStructureBase& map_base = *map;
+  const auto points =
+      GenerateQueryPoints(random_number_generator, state.range(0));
+  const FloatingPoint cell_width_inv = 1.f / map->getMinCellWidth();
+  for (auto _ : state) {
+    FloatingPoint sum = 0.f;
+    for (const Point3D& point : points) {
+      sum += map_base.getCellValue(
+          convert::pointToNearestIndex(point, cell_width_inv));
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumQueries);
+}
+BENCHMARK(QueryVirtual)->Arg(false)->Arg(true)->Unit(benchmark::kMillisecond);
+
+// Query each point, in the given order, through the single cursor accelerator
+static void QueryAccelerated(benchmark::State& state) {
+  RandomNumberGenerator random_number_generator;
+  const auto map = CreateRandomMap(random_number_generator);
+  const auto points =
+      GenerateQueryPoints(random_number_generator, state.range(0));
+  const FloatingPoint cell_width_inv = 1.f / map->getMinCellWidth();
+  for (auto _ : state) {
+    QueryAccelerator query_accelerator(*map);
+    FloatingPoint sum = 0.f;
+    for (const Point3D& point : points) {
+      sum += query_accelerator.getCellValue(
+          convert::pointToNearestIndex(point, cell_width_inv));
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumQueries);
+}
+BENCHMARK(QueryAccelerated)
+    ->Arg(false)
+    ->Arg(true)
+    ->Unit(benchmark::kMillisecond);
+
+// Query all points as one batch, using the given number of threads
+static void QueryBatched(benchmark::State& state) {
+  RandomNumberGenerator random_number_generator;
+  const auto map = CreateRandomMap(random_number_generator);
+  const auto points =
+      GenerateQueryPoints(random_number_generator, state.range(0));
+  const auto num_threads = static_cast<size_t>(state.range(1));
+  const auto thread_pool =
+      num_threads == 0u ? nullptr : std::make_shared<ThreadPool>(num_threads);
+  BatchedQueryAccelerator batched_query_accelerator(*map, thread_pool);
+  std::vector<FloatingPoint> values(kNumQueries);
+  for (auto _ : state) {
+    batched_query_accelerator.getCellValues(points.data(), points.size(),
+                                            values.data());
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumQueries);
+}
+BENCHMARK(QueryBatched)
+    ->ArgsProduct({{false, true}, {0, 4}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+}  // namespace wavemap
+
+BENCHMARK_MAIN();
@@ -0,0 +1,183 @@
+#include <unordered_map>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "wavemap/common.h"
+#include "wavemap/data_structure/block_hash_map.h"
+#include "wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h"
+#include "wavemap/data_structure/volumetric/hashed_wavelet_octree.h"
+#include "wavemap/indexing/index_hashes.h"
+#include "wavemap/utils/iterate/grid_iterator.h"
+#include "wavemap/utils/random_number_generator.h"
+
+namespace wavemap {
+using Block = HashedWaveletOctreeBlock;
+// Container that was used by the hashed maps before the BlockHashMap
+using UnorderedBlockMap = std::unordered_map<Index3D, Block, IndexHash<3>>;
+using FlatBlockMap = BlockHashMap<Block, 3>;
+
+constexpr IndexElement kTreeHeight = 6;
+constexpr FloatingPoint kMinLogOdds = -2.f;
+constexpr FloatingPoint kMaxLogOdds = 4.f;
+
+// Look up random blocks in a dense local map, of which about half exist
+template <typename BlockMapT>
+static void LookupRandomBlocks(benchmark::State& state) {
+  RandomNumberGenerator random_number_generator;
+  const auto map_half_width = static_cast<IndexElement>(state.range(0));
+
+  BlockMapT block_map;
+  for (const Index3D& block_index : Grid<3>(Index3D::Constant(-map_half_width),
+                                            Index3D::Constant(map_half_width))) {
+    block_map.try_emplace(block_index, kTreeHeight, kMinLogOdds, kMaxLogOdds);
+  }
+
+  constexpr int kNumQueries = 1 << 12;
+  const IndexElement query_half_width = 5 * map_half_width / 4;
+  std::vector<Index3D> query_indices(kNumQueries);
+  for (auto& query_index : query_indices) {
+    for (int dim_idx = 0; dim_idx < 3; ++dim_idx) {
+      query_index[dim_idx] = random_number_generator.getRandomInteger(
+          -query_half_width, query_half_width);
+    }
+  }
+
+  for (auto _ : state) {
+    size_t num_found = 0u;
+    for (const Index3D& query_index : query_indices) {
+      num_found += block_map.count(query_index);
+    }
+    benchmark::DoNotOptimize(num_found);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumQueries);
+}
+BENCHMARK_TEMPLATE(LookupRandomBlocks, UnorderedBlockMap)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(32);
+BENCHMARK_TEMPLATE(LookupRandomBlocks, FlatBlockMap)->Arg(4)->Arg(16)->Arg(32);
+
+// Mimic the block map accesses of the integrators' updateMap, for a sensor that
+// moves forward by one block per iteration. All blocks in the sensor's field of
+// view are checked, allocated if needed and fetched. The blocks that fall out
+// of view are removed, like empty blocks would be by pruning.
+template <typename BlockMapT>
+static void SelectBlocksInFov(benchmark::State& state) {
+  const auto fov_half_width = static_cast<IndexElement>(state.range(0));
+  const Index3D fov_min_offset = Index3D::Constant(-fov_half_width);
+  const Index3D fov_max_offset = Index3D::Constant(fov_half_width);
+
+  BlockMapT block_map;
+  Index3D sensor_block_index = Index3D::Zero();
+  for (auto _ : state) {
+    const Grid<3> fov_blocks(sensor_block_index + fov_min_offset,
+                             sensor_block_index + fov_max_offset);
+    size_t num_allocated_blocks = 0u;
+    for (const Index3D& block_index : fov_blocks) {
+      num_allocated_blocks += block_map.count(block_index);
+    }
+    for (const Index3D& block_index : fov_blocks) {
+      block_map.try_emplace(block_index, kTreeHeight, kMinLogOdds,
+                            kMaxLogOdds);
+    }
+    for (const Index3D& block_index : fov_blocks) {
+      benchmark::DoNotOptimize(&block_map.at(block_index));
+    }
+    benchmark::DoNotOptimize(num_allocated_blocks);
+
+    const IndexElement min_x = sensor_block_index.x() - fov_half_width;
+    for (auto it = block_map.begin(); it != block_map.end();) {
+      if (it->first.x() <= min_x) {
+        it = block_map.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    ++sensor_block_index.x();
+  }
+  const int64_t fov_width = 2 * fov_half_width + 1;
+  state.SetItemsProcessed(state.iterations() * fov_width * fov_width *
+                          fov_width);
+}
+BENCHMARK_TEMPLATE(SelectBlocksInFov, UnorderedBlockMap)->Arg(4)->Arg(8);
+BENCHMARK_TEMPLATE(SelectBlocksInFov, FlatBlockMap)->Arg(4)->Arg(8);
+
+// Iterate over a map of which most blocks were erased again, s.t. most of the
+// table's slots are empty or deleted, like after the sensor moved on
+template <typename BlockMapT>
+static void IterateSparseBlocks(benchmark::State& state) {
+  RandomNumberGenerator random_number_generator;
+  const auto map_half_width = static_cast<IndexElement>(state.range(0));
+
+  BlockMapT block_map;
+  for (const Index3D& block_index : Grid<3>(Index3D::Constant(-map_half_width),
+                                            Index3D::Constant(map_half_width))) {
+    block_map.try_emplace(block_index, kTreeHeight, kMinLogOdds, kMaxLogOdds);
+  }
+  for (auto it = block_map.begin(); it != block_map.end();) {
+    if (random_number_generator.getRandomInteger(0, 7) != 0) {
+      it = block_map.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (auto _ : state) {
+    IndexElement sum = 0;
+    for (const auto& [block_index, block] : block_map) {
+      sum += block_index.x();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * block_map.size());
+}
+BENCHMARK_TEMPLATE(IterateSparseBlocks, UnorderedBlockMap)->Arg(8)->Arg(32);
+BENCHMARK_TEMPLATE(IterateSparseBlocks, FlatBlockMap)->Arg(8)->Arg(32);
+
+// Query random cells of a map whose blocks are all allocated
+template <typename MapT>
+static void GetCellValueRandomAccess(benchmark::State& state) {
+  RandomNumberGenerator random_number_generator;
+  const auto map_half_width = static_cast<IndexElement>(state.range(0));
+
+  typename MapT::Config config;
+  MapT map(config);
+  const Index3D block_size = map.getBlockSize();
+  const Index3D min_index = -map_half_width * block_size;
+  const Index3D max_index = map_half_width * block_size;
+  for (const Index3D& block_index :
+       Grid<3>(Index3D::Constant(-map_half_width),
+               Index3D::Constant(map_half_width - 1))) {
+    const Index3D index = block_index.cwiseProduct(block_size);
+    map.setCellValue(index, random_number_generator.getRandomRealNumber(
+                                kMinLogOdds, kMaxLogOdds));
+  }
+
+  constexpr int kNumQueries = 1 << 12;
+  std::vector<Index3D> query_indices(kNumQueries);
+  for (auto& query_index : query_indices) {
+    for (int dim_idx = 0; dim_idx < 3; ++dim_idx) {
+      query_index[dim_idx] = random_number_generator.getRandomInteger(
+          min_index[dim_idx], max_index[dim_idx]);
+    }
+  }
+
+  for (auto _ : state) {
+    FloatingPoint sum = 0.f;
+    for (const Index3D& query_index : query_indices) {
+      sum += map.getCellValue(query_index);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumQueries);
+}
+BENCHMARK_TEMPLATE(GetCellValueRandomAccess, HashedWaveletOctree)
+    ->Arg(4)
+    ->Arg(16);
+BENCHMARK_TEMPLATE(GetCellValueRandomAccess, HashedChunkedWaveletOctree)
+    ->Arg(4)
+    ->Arg(16);
+}  // namespace wavemap
+
+BENCHMARK_MAIN();
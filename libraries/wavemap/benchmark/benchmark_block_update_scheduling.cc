@@ -0,0 +1,149 @@
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scan_generator.h"
+#include "wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h"
+#include "wavemap/integrator/measurement_model/continuous_beam.h"
+#include "wavemap/integrator/projective/coarse_to_fine/hashed_chunked_wavelet_integrator.h"
+
+namespace wavemap {
+// Hardware cache miss counter for the calling thread and all threads it
+// spawns after the counter was opened
+// NOTE: The counts of spawned threads are only added once they exit. The
+//       thread pool should therefore be created after and destroyed before
+//       the counter is read.
+class CacheMissCounter {
+ public:
+  CacheMissCounter() {
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.size = sizeof(attributes);
+    attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+    attributes.disabled = 1;
+    attributes.inherit = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    file_descriptor_ = static_cast<int>(
+        syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0));
+  }
+  ~CacheMissCounter() {
+    if (isAvailable()) {
+      close(file_descriptor_);
+    }
+  }
+
+  // Hardware counters are commonly unavailable in VMs and containers, or when
+  // restricted through perf_event_paranoid
+  bool isAvailable() const { return 0 <= file_descriptor_; }
+
+  void start() {
+    if (isAvailable()) {
+      ioctl(file_descriptor_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(file_descriptor_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+  std::optional<uint64_t> stop() {
+    if (!isAvailable()) {
+      return std::nullopt;
+    }
+    ioctl(file_descriptor_, PERF_EVENT_IOC_DISABLE, 0);
+    uint64_t count = 0u;
+    if (read(file_descriptor_, &count, sizeof(count)) != sizeof(count)) {
+      return std::nullopt;
+    }
+    return count;
+  }
+
+ private:
+  int file_descriptor_ = -1;
+};
+
+// Integrate a sequence of scans with the hashed chunked wavelet integrator,
+// with or without locality-aware block scheduling, and count the cache misses
+template <typename ProjectorT, bool kLocalityAware>
+void IntegrateScans(benchmark::State& state) {
+  constexpr int kNumScans = 10;
+  const auto projection_model =
+      SensorSetup<ProjectorT>::createProjectionModel();
+  const auto scans = generateScans(
+      *projection_model, SensorSetup<ProjectorT>::getMountingOrientation(),
+      kNumScans);
+
+  ProjectiveIntegratorConfig integrator_config{0.5f, 20.f};
+  integrator_config.locality_aware_block_scheduling = kLocalityAware;
+  const auto posed_range_image =
+      std::make_shared<PosedImage<>>(projection_model->getDimensions());
+  const auto beam_offset_image =
+      std::make_shared<Image<Vector2D>>(projection_model->getDimensions());
+  const auto measurement_model = std::make_shared<ContinuousBeam>(
+      ContinuousBeamConfig{0.0035f, 0.1f, 0.2f, 0.4f}, projection_model,
+      posed_range_image, beam_offset_image);
+  HashedChunkedWaveletOctreeConfig map_config;
+  map_config.min_cell_width = 0.1f;
+
+  CacheMissCounter cache_miss_counter;
+  uint64_t total_cache_misses = 0u;
+  bool cache_misses_available = cache_miss_counter.isAvailable();
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto occupancy_map =
+        std::make_shared<HashedChunkedWaveletOctree>(map_config);
+    cache_miss_counter.start();
+    {
+      HashedChunkedWaveletIntegrator integrator(
+          integrator_config, projection_model, posed_range_image,
+          beam_offset_image, measurement_model, occupancy_map,
+          std::make_shared<ThreadPool>());
+      state.ResumeTiming();
+      for (const auto& scan : scans) {
+        integrator.integratePointcloud(scan);
+      }
+      state.PauseTiming();
+    }
+    if (const auto cache_misses = cache_miss_counter.stop(); cache_misses) {
+      total_cache_misses += cache_misses.value();
+    } else {
+      cache_misses_available = false;
+    }
+    benchmark::DoNotOptimize(occupancy_map->getMemoryUsage());
+    state.ResumeTiming();
+  }
+
+  state.counters["fps"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * kNumScans),
+      benchmark::Counter::kIsRate);
+  if (cache_misses_available) {
+    state.counters["cache_misses_per_scan"] =
+        static_cast<double>(total_cache_misses) /
+        static_cast<double>(state.iterations() * kNumScans);
+  } else {
+    state.SetLabel("cache miss counter unavailable");
+  }
+}
+
+BENCHMARK_TEMPLATE(IntegrateScans, OusterProjector, false)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(IntegrateScans, OusterProjector, true)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(IntegrateScans, PinholeCameraProjector, false)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(IntegrateScans, PinholeCameraProjector, true)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+}  // namespace wavemap
+
+BENCHMARK_MAIN();
@@ -0,0 +1,165 @@
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <stack>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scan_generator.h"
+#include "wavemap/data_structure/volumetric/hashed_wavelet_octree.h"
+#include "wavemap/integrator/measurement_model/continuous_beam.h"
+#include "wavemap/integrator/projective/coarse_to_fine/hashed_wavelet_integrator.h"
+#include "wavemap/utils/compression/detail_coefficient_codec.h"
+
+namespace wavemap {
+// Size of a node in the raw (uncompressed) serialization formats
+constexpr size_t kRawNodeSize =
+    DetailCoefficientModel::kNumDetails * sizeof(float) + sizeof(uint8_t);
+
+struct BlockNodes {
+  std::vector<DetailCoefficientEncoder::Details> details;
+  std::vector<uint8_t> allocated_children_bitsets;
+};
+
+// Build a realistic map by integrating a sequence of synthetic LiDAR scans and
+// collect the nodes of each of its blocks in depth-first order
+const std::vector<BlockNodes>& getMapNodes() {
+  static const std::vector<BlockNodes> map_nodes = []() {
+    constexpr int kNumScans = 10;
+    const auto projection_model =
+        SensorSetup<OusterProjector>::createProjectionModel();
+    const auto scans = generateScans(
+        *projection_model,
+        SensorSetup<OusterProjector>::getMountingOrientation(), kNumScans);
+
+    const auto posed_range_image =
+        std::make_shared<PosedImage<>>(projection_model->getDimensions());
+    const auto beam_offset_image =
+        std::make_shared<Image<Vector2D>>(projection_model->getDimensions());
+    const auto measurement_model = std::make_shared<ContinuousBeam>(
+        ContinuousBeamConfig{0.0035f, 0.1f, 0.2f, 0.4f}, projection_model,
+        posed_range_image, beam_offset_image);
+    HashedWaveletOctreeConfig map_config;
+    map_config.min_cell_width = 0.1f;
+    auto occupancy_map = std::make_shared<HashedWaveletOctree>(map_config);
+    HashedWaveletIntegrator integrator(
+        ProjectiveIntegratorConfig{0.5f, 20.f}, projection_model,
+        posed_range_image, beam_offset_image, measurement_model, occupancy_map,
+        std::make_shared<ThreadPool>());
+    for (const auto& scan : scans) {
+      integrator.integratePointcloud(scan);
+    }
+    occupancy_map->threshold();
+    occupancy_map->prune();
+
+    std::vector<BlockNodes> nodes;
+    for (const auto& [block_index, block] : occupancy_map->getBlocks()) {
+      auto& block_nodes = nodes.emplace_back();
+      std::stack<const HashedWaveletOctreeBlock::NodeType*> stack;
+      stack.emplace(&block.getRootNode());
+      while (!stack.empty()) {
+        const auto* node = stack.top();
+        stack.pop();
+        uint8_t allocated_children_bitset = 0u;
+        for (int relative_child_idx = OctreeIndex::kNumChildren - 1;
+             0 <= relative_child_idx; --relative_child_idx) {
+          if (const auto* child = node->getChild(relative_child_idx); child) {
+            stack.emplace(child);
+            allocated_children_bitset |= 1 << relative_child_idx;
+          }
+        }
+        block_nodes.details.emplace_back(node->data());
+        block_nodes.allocated_children_bitsets.emplace_back(
+            allocated_children_bitset);
+      }
+    }
+    return nodes;
+  }();
+  return map_nodes;
+}
+
+size_t countNodes(const std::vector<BlockNodes>& map_nodes) {
+  size_t num_nodes = 0u;
+  for (const auto& block_nodes : map_nodes) {
+    num_nodes += block_nodes.details.size();
+  }
+  return num_nodes;
+}
+
+std::vector<std::vector<uint8_t>> encodeBlocks(
+    const std::vector<BlockNodes>& map_nodes, FloatingPoint quantization_step) {
+  std::vector<std::vector<uint8_t>> encoded_blocks(map_nodes.size());
+  for (size_t block_idx = 0; block_idx < map_nodes.size(); ++block_idx) {
+    const auto& block_nodes = map_nodes[block_idx];
+    DetailCoefficientEncoder encoder(quantization_step,
+                                     encoded_blocks[block_idx]);
+    for (size_t node_idx = 0; node_idx < block_nodes.details.size();
+         ++node_idx) {
+      encoder.encodeNode(block_nodes.details[node_idx],
+                         block_nodes.allocated_children_bitsets[node_idx]);
+    }
+    encoder.flush();
+  }
+  return encoded_blocks;
+}
+
+void setCounters(benchmark::State& state,
+                 const std::vector<BlockNodes>& map_nodes,
+                 const std::vector<std::vector<uint8_t>>& encoded_blocks) {
+  const size_t num_nodes = countNodes(map_nodes);
+  size_t num_encoded_bytes = 0u;
+  for (const auto& encoded_block : encoded_blocks) {
+    num_encoded_bytes += encoded_block.size();
+  }
+  const auto num_blocks = static_cast<double>(map_nodes.size());
+  state.counters["raw_bytes_per_block"] =
+      static_cast<double>(num_nodes * kRawNodeSize) / num_blocks;
+  state.counters["compressed_bytes_per_block"] =
+      static_cast<double>(num_encoded_bytes) / num_blocks;
+  state.counters["nodes_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * num_nodes),
+      benchmark::Counter::kIsRate);
+}
+
+// The quantization step is passed as its negated base 10 exponent
+FloatingPoint getQuantizationStep(const benchmark::State& state) {
+  return std::pow(10.f, -static_cast<FloatingPoint>(state.range(0)));
+}
+
+void EncodeNodes(benchmark::State& state) {
+  const auto& map_nodes = getMapNodes();
+  const FloatingPoint quantization_step = getQuantizationStep(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(encodeBlocks(map_nodes, quantization_step));
+  }
+  setCounters(state, map_nodes, encodeBlocks(map_nodes, quantization_step));
+}
+
+void DecodeNodes(benchmark::State& state) {
+  const auto& map_nodes = getMapNodes();
+  const FloatingPoint quantization_step = getQuantizationStep(state);
+  const auto encoded_blocks = encodeBlocks(map_nodes, quantization_step);
+  for (auto _ : state) {
+    for (size_t block_idx = 0; block_idx < map_nodes.size(); ++block_idx) {
+      const auto& encoded_block = encoded_blocks[block_idx];
+      DetailCoefficientDecoder decoder(
+          quantization_step, encoded_block.data(),
+          encoded_block.data() + encoded_block.size());
+      DetailCoefficientDecoder::Details details;
+      uint8_t allocated_children_bitset;
+      for (size_t node_idx = 0; node_idx < map_nodes[block_idx].details.size();
+           ++node_idx) {
+        decoder.decodeNode(details, allocated_children_bitset);
+        benchmark::DoNotOptimize(details);
+      }
+    }
+  }
+  setCounters(state, map_nodes, encoded_blocks);
+}
+
+BENCHMARK(EncodeNodes)->DenseRange(2, 5)->Unit(benchmark::kMillisecond);
+BENCHMARK(DecodeNodes)->DenseRange(2, 5)->Unit(benchmark::kMillisecond);
+}  // namespace wavemap
+
+BENCHMARK_MAIN();
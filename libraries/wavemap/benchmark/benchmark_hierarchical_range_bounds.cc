@@ -0,0 +1,93 @@
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include "wavemap/integrator/projection_model/ouster_projector.h"
+#include "wavemap/integrator/projection_model/pinhole_camera_projector.h"
+#include "wavemap/integrator/projective/coarse_to_fine/hierarchical_range_bounds.h"
+#include "wavemap/utils/iterate/grid_iterator.h"
+#include "wavemap/utils/random_number_generator.h"
+
+namespace wavemap {
+// Ouster OS0-128 LiDAR in 2048x10 mode
+std::shared_ptr<ProjectorBase> createOusterProjector() {
+  OusterProjectorConfig projector_config;
+  projector_config.elevation = {-kQuarterPi, kQuarterPi, 128};
+  projector_config.azimuth = {-kPi, kPi, 2048};
+  return std::make_shared<OusterProjector>(projector_config);
+}
+
+// 720p depth camera
+std::shared_ptr<ProjectorBase> createPinholeCameraProjector() {
+  return std::make_shared<PinholeCameraProjector>(
+      PinholeCameraProjectorConfig{640.f, 640.f, 640.f, 360.f, 720, 1280});
+}
+
+// Fill the range image with random ranges, including about 10% of values that
+// are below the min range and should therefore be treated as unobserved
+void fillRandomRangeImage(Image<>& range_image,
+                          RandomNumberGenerator& random_number_generator) {
+  for (const Index2D& index : Grid<2>(
+           Index2D::Zero(), range_image.getDimensions() - Index2D::Ones())) {
+    range_image.at(index) =
+        random_number_generator.getRandomRealNumber(-3.f, 30.f);
+  }
+}
+
+// Build the range bounds from scratch for every range image, as done before
+// the range image intersectors were reused across measurements
+template <std::shared_ptr<ProjectorBase> (*CreateProjector)()>
+void ConstructRangeBounds(benchmark::State& state) {
+  constexpr FloatingPoint kMinRange = 0.f;
+  RandomNumberGenerator random_number_generator;
+  const auto projection_model = CreateProjector();
+  const bool azimuth_wraps_pi = projection_model->sensorAxisIsPeriodic().y();
+  auto range_image =
+      std::make_shared<Image<>>(projection_model->getDimensions());
+  fillRandomRangeImage(*range_image, random_number_generator);
+
+  for (auto _ : state) {
+    HierarchicalRangeBounds range_bounds(range_image, azimuth_wraps_pi,
+                                         kMinRange, projection_model.get());
+    benchmark::ClobberMemory();
+  }
+}
+
+// Update existing range bounds in place, optionally in parallel
+template <std::shared_ptr<ProjectorBase> (*CreateProjector)(), bool kParallel>
+void UpdateRangeBounds(benchmark::State& state) {
+  constexpr FloatingPoint kMinRange = 0.f;
+  RandomNumberGenerator random_number_generator;
+  const auto projection_model = CreateProjector();
+  const bool azimuth_wraps_pi = projection_model->sensorAxisIsPeriodic().y();
+  auto range_image =
+      std::make_shared<Image<>>(projection_model->getDimensions());
+  fillRandomRangeImage(*range_image, random_number_generator);
+  ThreadPool thread_pool;
+
+  HierarchicalRangeBounds range_bounds(range_image, azimuth_wraps_pi,
+                                       kMinRange, projection_model.get());
+  for (auto _ : state) {
+    range_bounds.update(kParallel ? &thread_pool : nullptr);
+    benchmark::ClobberMemory();
+  }
+}
+
+BENCHMARK_TEMPLATE(ConstructRangeBounds, createOusterProjector)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(UpdateRangeBounds, createOusterProjector, false)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(UpdateRangeBounds, createOusterProjector, true)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+BENCHMARK_TEMPLATE(ConstructRangeBounds, createPinholeCameraProjector)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(UpdateRangeBounds, createPinholeCameraProjector, false)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(UpdateRangeBounds, createPinholeCameraProjector, true)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+}  // namespace wavemap
+
+BENCHMARK_MAIN();
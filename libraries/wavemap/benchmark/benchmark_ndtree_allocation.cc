@@ -0,0 +1,172 @@
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "wavemap/common.h"
+#include "wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h"
+#include "wavemap/data_structure/volumetric/hashed_wavelet_octree.h"
+#include "wavemap/integrator/measurement_model/continuous_beam.h"
+#include "wavemap/integrator/projection_model/spherical_projector.h"
+#include "wavemap/integrator/projective/coarse_to_fine/hashed_chunked_wavelet_integrator.h"
+#include "wavemap/integrator/projective/coarse_to_fine/hashed_wavelet_integrator.h"
+#include "wavemap/utils/memory/object_pool.h"
+#include "wavemap/utils/random_number_generator.h"
+
+// Count all heap allocations made by the process, including those made by the
+// integrators' worker threads
+namespace {
+std::atomic<size_t> num_heap_allocations = 0;
+}  // namespace
+
+void* operator new(size_t size) {
+  num_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+void* operator new(size_t size, std::align_val_t alignment) {
+  num_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  const size_t alignment_bytes = static_cast<size_t>(alignment);
+  const size_t aligned_size =
+      (size + alignment_bytes - 1) / alignment_bytes * alignment_bytes;
+  if (void* ptr = std::aligned_alloc(alignment_bytes, aligned_size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+  std::free(ptr);
+}
+
+namespace wavemap {
+using NodeChunkType = HashedChunkedWaveletOctreeBlock::NodeChunkType;
+
+// Allocate and release a batch of chunks, through the system allocator
+static void AllocateChunksUnpooled(benchmark::State& state) {
+  const auto batch_size = static_cast<size_t>(state.range(0));
+  std::vector<std::unique_ptr<NodeChunkType>> chunks(batch_size);
+  const size_t num_heap_allocations_before = num_heap_allocations;
+  for (auto _ : state) {
+    for (auto& chunk : chunks) {
+      chunk = std::make_unique<NodeChunkType>();
+      benchmark::DoNotOptimize(chunk.get());
+    }
+    for (auto& chunk : chunks) {
+      chunk.reset();
+    }
+  }
+  state.counters["heap_allocs"] = benchmark::Counter(
+      static_cast<double>(num_heap_allocations - num_heap_allocations_before),
+      benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(AllocateChunksUnpooled)->Arg(8)->Arg(64)->Arg(512);
+
+// Allocate and release a batch of chunks, through their object pool
+static void AllocateChunksPooled(benchmark::State& state) {
+  const auto batch_size = static_cast<size_t>(state.range(0));
+  std::vector<PooledUniquePtr<NodeChunkType>> chunks(batch_size);
+  const size_t num_heap_allocations_before = num_heap_allocations;
+  for (auto _ : state) {
+    for (auto& chunk : chunks) {
+      chunk = makePooledUnique<NodeChunkType>();
+      benchmark::DoNotOptimize(chunk.get());
+    }
+    for (auto& chunk : chunks) {
+      chunk.reset();
+    }
+  }
+  state.counters["heap_allocs"] = benchmark::Counter(
+      static_cast<double>(num_heap_allocations - num_heap_allocations_before),
+      benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(AllocateChunksPooled)->Arg(8)->Arg(64)->Arg(512);
+
+// Integrate pointclouds from a sensor that drives forward, while continuously
+// pruning the map, s.t. new nodes are allocated and old ones are released
+template <typename MapT, typename IntegratorT>
+static void IntegrateWhileDriving(benchmark::State& state) {
+  RandomNumberGenerator random_number_generator;
+
+  SphericalProjectorConfig projector_config;
+  projector_config.elevation.min_angle = -kPi / 8.f;
+  projector_config.elevation.max_angle = kPi / 8.f;
+  projector_config.elevation.num_cells = 32;
+  projector_config.azimuth.min_angle = -kPi;
+  projector_config.azimuth.max_angle = kPi;
+  projector_config.azimuth.num_cells = 512;
+  const auto projection_model =
+      std::make_shared<SphericalProjector>(projector_config);
+  const auto posed_range_image =
+      std::make_shared<PosedImage<>>(projection_model->getDimensions());
+  const auto beam_offset_image =
+      std::make_shared<Image<Vector2D>>(projection_model->getDimensions());
+  ContinuousBeamConfig measurement_model_config;
+  measurement_model_config.angle_sigma = 0.001f;
+  measurement_model_config.range_sigma = 0.05f;
+  const auto measurement_model = std::make_shared<ContinuousBeam>(
+      measurement_model_config, projection_model, posed_range_image,
+      beam_offset_image);
+
+  typename MapT::Config map_config;
+  map_config.min_cell_width = 0.1f;
+  map_config.only_prune_blocks_if_unused_for = 0.f;
+  const auto occupancy_map = std::make_shared<MapT>(map_config);
+  ProjectiveIntegratorConfig integrator_config;
+  integrator_config.min_range = 0.5f;
+  integrator_config.max_range = 10.f;
+  IntegratorT integrator(integrator_config, projection_model,
+                         posed_range_image, beam_offset_image,
+                         measurement_model, occupancy_map);
+
+  Pointcloud<> pointcloud;
+  pointcloud.resize(projection_model->getNumRows() *
+                    projection_model->getNumColumns());
+  const size_t num_heap_allocations_before = num_heap_allocations;
+  FloatingPoint sensor_position_x = 0.f;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (int point_idx = 0; point_idx < static_cast<int>(pointcloud.size());
+         ++point_idx) {
+      const Index2D image_index{point_idx % projection_model->getNumRows(),
+                                point_idx / projection_model->getNumRows()};
+      const FloatingPoint range =
+          random_number_generator.getRandomRealNumber(1.f, 10.f);
+      pointcloud[point_idx] =
+          range * projection_model->sensorToCartesian(
+                      {projection_model->indexToImage(image_index), 1.f});
+    }
+    Transformation3D T_W_C;
+    T_W_C.getPosition().x() = sensor_position_x;
+    sensor_position_x += 0.5f;
+    state.ResumeTiming();
+
+    integrator.integratePointcloud(PosedPointcloud<>(T_W_C, pointcloud));
+    occupancy_map->prune();
+  }
+  state.counters["heap_allocs"] = benchmark::Counter(
+      static_cast<double>(num_heap_allocations - num_heap_allocations_before),
+      benchmark::Counter::kAvgIterations);
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<int64_t>(pointcloud.size()));
+}
+BENCHMARK_TEMPLATE(IntegrateWhileDriving, HashedWaveletOctree,
+                   HashedWaveletIntegrator)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(IntegrateWhileDriving, HashedChunkedWaveletOctree,
+                   HashedChunkedWaveletIntegrator)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+}  // namespace wavemap
+
+BENCHMARK_MAIN();
@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scan_generator.h"
+#include "wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h"
+#include "wavemap/data_structure/volumetric/hashed_wavelet_octree.h"
+#include "wavemap/integrator/measurement_model/continuous_beam.h"
+#include "wavemap/integrator/projection_model/ouster_projector.h"
+#include "wavemap/integrator/projection_model/pinhole_camera_projector.h"
+#include "wavemap/integrator/projective/coarse_to_fine/hashed_chunked_wavelet_integrator.h"
+#include "wavemap/integrator/projective/coarse_to_fine/hashed_wavelet_integrator.h"
+#include "wavemap/integrator/projective/pipelined_integrator.h"
+
+namespace wavemap {
+// Integrate a sequence of scans generated for the sensor setup of ProjectorT,
+// where IntegratorT is either one of the generic integrators or one of their
+// versions specialized for ProjectorT
+template <typename ProjectorT, typename IntegratorT, typename DataStructureT>
+void IntegrateScans(benchmark::State& state) {
+  constexpr int kNumScans = 10;
+  const auto projection_model =
+      SensorSetup<ProjectorT>::createProjectionModel();
+  const auto scans = generateScans(
+      *projection_model, SensorSetup<ProjectorT>::getMountingOrientation(),
+      kNumScans);
+
+  const ProjectiveIntegratorConfig integrator_config{0.5f, 20.f};
+  const auto posed_range_image =
+      std::make_shared<PosedImage<>>(projection_model->getDimensions());
+  const auto beam_offset_image =
+      std::make_shared<Image<Vector2D>>(projection_model->getDimensions());
+  const auto measurement_model = std::make_shared<ContinuousBeam>(
+      ContinuousBeamConfig{0.0035f, 0.1f, 0.2f, 0.4f}, projection_model,
+      posed_range_image, beam_offset_image);
+  typename DataStructureT::Config map_config;
+  map_config.min_cell_width = 0.1f;
+  const auto thread_pool = std::make_shared<ThreadPool>();
+
+  // Total time spent in each of the block update stages
+  double select_blocks_time = 0.0;
+  double allocate_blocks_time = 0.0;
+  double update_blocks_time = 0.0;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto occupancy_map = std::make_shared<DataStructureT>(map_config);
+    IntegratorT integrator(integrator_config, projection_model,
+                           posed_range_image, beam_offset_image,
+                           measurement_model, occupancy_map, thread_pool);
+    state.ResumeTiming();
+    for (const auto& scan : scans) {
+      integrator.integratePointcloud(scan);
+      const auto& stage_timings = integrator.getLastStageTimings();
+      select_blocks_time += stage_timings.select_blocks;
+      allocate_blocks_time += stage_timings.allocate_blocks;
+      update_blocks_time += stage_timings.update_blocks;
+    }
+    benchmark::DoNotOptimize(occupancy_map->getMemoryUsage());
+  }
+
+  const auto num_scans_integrated =
+      static_cast<double>(state.iterations() * kNumScans);
+  state.counters["fps"] =
+      benchmark::Counter(num_scans_integrated, benchmark::Counter::kIsRate);
+  state.counters["select_ms"] = 1e3 * select_blocks_time / num_scans_integrated;
+  state.counters["allocate_ms"] =
+      1e3 * allocate_blocks_time / num_scans_integrated;
+  state.counters["update_ms"] = 1e3 * update_blocks_time / num_scans_integrated;
+}
+
+// Integrate the same sequence of scans with a PipelinedIntegrator, whose
+// pipeline depth is passed as the benchmark's argument
+template <typename ProjectorT, typename IntegratorT, typename DataStructureT>
+void IntegrateScansPipelined(benchmark::State& state) {
+  constexpr int kNumScans = 10;
+  const int pipeline_depth = static_cast<int>(state.range(0));
+  const auto projection_model =
+      SensorSetup<ProjectorT>::createProjectionModel();
+  const auto scans = generateScans(
+      *projection_model, SensorSetup<ProjectorT>::getMountingOrientation(),
+      kNumScans);
+
+  const ProjectiveIntegratorConfig integrator_config{0.5f, 20.f};
+  typename DataStructureT::Config map_config;
+  map_config.min_cell_width = 0.1f;
+  const auto thread_pool = std::make_shared<ThreadPool>();
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto occupancy_map = std::make_shared<DataStructureT>(map_config);
+    std::vector<ProjectiveIntegrator::Ptr> stages;
+    for (int stage_idx = 0; stage_idx < pipeline_depth; ++stage_idx) {
+      const auto posed_range_image =
+          std::make_shared<PosedImage<>>(projection_model->getDimensions());
+      const auto beam_offset_image =
+          std::make_shared<Image<Vector2D>>(projection_model->getDimensions());
+      const auto measurement_model = std::make_shared<ContinuousBeam>(
+          ContinuousBeamConfig{0.0035f, 0.1f, 0.2f, 0.4f}, projection_model,
+          posed_range_image, beam_offset_image);
+      stages.emplace_back(std::make_shared<IntegratorT>(
+          integrator_config, projection_model, posed_range_image,
+          beam_offset_image, measurement_model, occupancy_map, thread_pool));
+    }
+    PipelinedIntegrator integrator(std::move(stages), thread_pool);
+    state.ResumeTiming();
+    for (const auto& scan : scans) {
+      integrator.integratePointcloud(scan);
+    }
+    integrator.flush();
+    benchmark::DoNotOptimize(occupancy_map->getMemoryUsage());
+  }
+
+  state.counters["fps"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * kNumScans),
+      benchmark::Counter::kIsRate);
+}
+
+// Benchmark each sensor and integrator combination, with the generic (virtual)
+// and the specialized (devirtualized) block update kernels
+BENCHMARK_TEMPLATE(IntegrateScans, OusterProjector, HashedWaveletIntegrator,
+                   HashedWaveletOctree)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(
+    IntegrateScans, OusterProjector,
+    SpecializedHashedWaveletIntegrator<OusterProjector, ContinuousBeam>,
+    HashedWaveletOctree)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(IntegrateScans, OusterProjector,
+                   HashedChunkedWaveletIntegrator, HashedChunkedWaveletOctree)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(
+    IntegrateScans, OusterProjector,
+    SpecializedHashedChunkedWaveletIntegrator<OusterProjector, ContinuousBeam>,
+    HashedChunkedWaveletOctree)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(IntegrateScans, PinholeCameraProjector,
+                   HashedWaveletIntegrator, HashedWaveletOctree)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(
+    IntegrateScans, PinholeCameraProjector,
+    SpecializedHashedWaveletIntegrator<PinholeCameraProjector, ContinuousBeam>,
+    HashedWaveletOctree)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(IntegrateScans, PinholeCameraProjector,
+                   HashedChunkedWaveletIntegrator, HashedChunkedWaveletOctree)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(
+    IntegrateScans, PinholeCameraProjector,
+    SpecializedHashedChunkedWaveletIntegrator<PinholeCameraProjector,
+                                              ContinuousBeam>,
+    HashedChunkedWaveletOctree)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+// Benchmark the throughput of pipelined integration across pipeline depths
+BENCHMARK_TEMPLATE(IntegrateScansPipelined, OusterProjector,
+                   HashedChunkedWaveletIntegrator, HashedChunkedWaveletOctree)
+    ->DenseRange(1, 4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(IntegrateScansPipelined, PinholeCameraProjector,
+                   HashedChunkedWaveletIntegrator, HashedChunkedWaveletOctree)
+    ->DenseRange(1, 4)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+}  // namespace wavemap
+
+BENCHMARK_MAIN();
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "wavemap/utils/thread_pool.h"
+
+namespace wavemap {
+namespace {
+// Reference implementation of the previous, single queue based thread pool
+class SingleQueueThreadPool {
+ public:
+  explicit SingleQueueThreadPool(size_t thread_count) {
+    for (size_t i = 0; i < thread_count; ++i) {
+      workers_.emplace_back([this] { worker_loop(); });
+    }
+  }
+  ~SingleQueueThreadPool() {
+    {
+      auto lock = std::scoped_lock<std::mutex>(tasks_mutex_);
+      terminate_ = true;
+    }
+    worker_condition_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  void wait_all() {
+    auto lock = std::unique_lock<std::mutex>(tasks_mutex_);
+    wait_all_condition_.wait(lock, [this] { return task_count_ == 0; });
+  }
+
+  template <typename Callable>
+  auto add_task(Callable&& callable) {
+    using ReturnType = std::result_of_t<Callable()>;
+    auto task = std::make_shared<std::packaged_task<ReturnType()>>(
+        std::forward<Callable>(callable));
+    {
+      auto lock = std::scoped_lock<std::mutex>(tasks_mutex_);
+      tasks_.emplace([task]() { (*task)(); });
+      task_count_++;
+    }
+    worker_condition_.notify_one();
+    return task->get_future();
+  }
+
+ private:
+  void worker_loop() {
+    while (true) {
+      auto task = std::function<void()>();
+      {
+        auto lock = std::unique_lock<std::mutex>(tasks_mutex_);
+        worker_condition_.wait(
+            lock, [this] { return terminate_ || !tasks_.empty(); });
+        if (terminate_ && tasks_.empty()) {
+          return;
+        }
+        task = std::move(tasks_.front());
+        tasks_.pop();
+      }
+      task();
+      if (--task_count_ == 0) {
+        auto lock = std::unique_lock<std::mutex>(tasks_mutex_);
+        wait_all_condition_.notify_all();
+      }
+    }
+  }
+
+  std::vector<std::thread> workers_;
+  std::queue<std::function<void()>> tasks_;
+  std::atomic<int> task_count_ = 0;
+  std::mutex tasks_mutex_;
+  std::condition_variable worker_condition_;
+  std::condition_variable wait_all_condition_;
+  std::atomic<bool> terminate_ = false;
+};
+
+// Emulates the per-block tasks of the hashed integrators, whose run time is
+// controlled through the number of inner loop iterations
+struct DummyBlockUpdate {
+  std::atomic<size_t>* checksum;
+  size_t num_iterations;
+  size_t block_idx;
+  void operator()() const {
+    size_t value = block_idx;
+    for (size_t iteration = 0; iteration < num_iterations; ++iteration) {
+      value = value * 6364136223846793005u + 1442695040888963407u;
+      benchmark::DoNotOptimize(value);
+    }
+    checksum->fetch_add(value & 1u, std::memory_order_relaxed);
+  }
+};
+}  // namespace
+
+template <typename PoolT>
+static void ScheduleTasks(benchmark::State& state) {
+  const size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+  const size_t num_tasks = state.range(0);
+  const size_t num_iterations = state.range(1);
+  PoolT pool(num_threads);
+  std::atomic<size_t> checksum = 0;
+  for (auto _ : state) {
+    for (size_t task_idx = 0; task_idx < num_tasks; ++task_idx) {
+      const DummyBlockUpdate task{&checksum, num_iterations, task_idx};
+      if constexpr (std::is_same_v<PoolT, ThreadPool>) {
+        pool.add_detached_task(task);
+      } else {
+        pool.add_task(task);
+      }
+    }
+    pool.wait_all();
+  }
+  benchmark::DoNotOptimize(checksum.load());
+  state.SetItemsProcessed(state.iterations() * num_tasks);
+}
+
+template <typename PoolT>
+static void ScheduleTasksWithFutures(benchmark::State& state) {
+  const size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+  const size_t num_tasks = state.range(0);
+  const size_t num_iterations = state.range(1);
+  PoolT pool(num_threads);
+  std::atomic<size_t> checksum = 0;
+  std::vector<std::future<void>> futures(num_tasks);
+  for (auto _ : state) {
+    for (size_t task_idx = 0; task_idx < num_tasks; ++task_idx) {
+      futures[task_idx] =
+          pool.add_task(DummyBlockUpdate{&checksum, num_iterations, task_idx});
+    }
+    for (auto& future : futures) {
+      future.wait();
+    }
+  }
+  benchmark::DoNotOptimize(checksum.load());
+  state.SetItemsProcessed(state.iterations() * num_tasks);
+}
+
+static void TaskSizes(benchmark::internal::Benchmark* benchmark) {
+  // Number of tasks and amount of work per task
+  benchmark->ArgNames({"tasks", "work"});
+  for (const int num_tasks : {64, 1024, 16384}) {
+    for (const int num_iterations : {0, 100, 10000}) {
+      benchmark->Args({num_tasks, num_iterations});
+    }
+  }
+  benchmark->UseRealTime();
+}
+
+BENCHMARK_TEMPLATE(ScheduleTasks, SingleQueueThreadPool)->Apply(TaskSizes);
+BENCHMARK_TEMPLATE(ScheduleTasks, ThreadPool)->Apply(TaskSizes);
+BENCHMARK_TEMPLATE(ScheduleTasksWithFutures, SingleQueueThreadPool)
+    ->Apply(TaskSizes);
+BENCHMARK_TEMPLATE(ScheduleTasksWithFutures, ThreadPool)->Apply(TaskSizes);
+}  // namespace wavemap
+
+BENCHMARK_MAIN();
@@ -0,0 +1,135 @@
+#ifndef WAVEMAP_BENCHMARK_SCAN_GENERATOR_H_
+#define WAVEMAP_BENCHMARK_SCAN_GENERATOR_H_
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "wavemap/common.h"
+#include "wavemap/data_structure/pointcloud.h"
+#include "wavemap/integrator/projection_model/ouster_projector.h"
+#include "wavemap/integrator/projection_model/pinhole_camera_projector.h"
+#include "wavemap/utils/random_number_generator.h"
+
+namespace wavemap {
+// Generate a sequence of scans, as recorded by a sensor that moves through a
+// room with a few pillars while slowly turning around the vertical axis
+// NOTE: The scans are generated by intersecting each beam with the room's
+//       walls, floor, ceiling and pillars, s.t. they contain the same number
+//       of points and cover free space at similar distances as real scans.
+//       The sensor is mounted with orientation q_B_C on the moving body B.
+inline std::vector<PosedPointcloud<>> generateScans(
+    const ProjectorBase& projection_model,
+    const Eigen::Quaternion<FloatingPoint>& q_B_C, int num_scans) {
+  constexpr FloatingPoint kRoomHalfWidth = 12.f;
+  constexpr FloatingPoint kFloorHeight = -1.5f;
+  constexpr FloatingPoint kCeilingHeight = 3.f;
+  constexpr FloatingPoint kPillarRadius = 0.5f;
+  const std::vector<Point2D> pillar_centers{
+      {-6.f, -6.f}, {-6.f, 6.f}, {6.f, -6.f}, {6.f, 6.f}, {0.f, 4.f}};
+
+  RandomNumberGenerator random_number_generator;
+  std::vector<PosedPointcloud<>> scans;
+  for (int scan_idx = 0; scan_idx < num_scans; ++scan_idx) {
+    // Move the sensor along a line, rotating it slowly
+    const FloatingPoint progress = static_cast<FloatingPoint>(scan_idx) /
+                                   static_cast<FloatingPoint>(num_scans);
+    const Eigen::AngleAxis<FloatingPoint> q_W_B{kPi * progress,
+                                                Vector3D::UnitZ()};
+    const Transformation3D T_W_C(
+        Rotation3D{Eigen::Quaternion<FloatingPoint>{q_W_B * q_B_C}},
+        Point3D{-4.f + 8.f * progress, -2.f, 0.f});
+
+    Pointcloud<> pointcloud;
+    pointcloud.resize(projection_model.getNumRows() *
+                      projection_model.getNumColumns());
+    int point_idx = 0;
+    for (int row_idx = 0; row_idx < projection_model.getNumRows(); ++row_idx) {
+      for (int col_idx = 0; col_idx < projection_model.getNumColumns();
+           ++col_idx) {
+        const Vector3D C_direction =
+            projection_model
+                .sensorToCartesian(
+                    {projection_model.indexToImage({row_idx, col_idx}), 1.f})
+                .normalized();
+        const Vector3D W_direction = T_W_C.getRotation().rotate(C_direction);
+        const Point3D& W_origin = T_W_C.getPosition();
+
+        // Intersect the beam with the room's bounding box
+        FloatingPoint range = std::numeric_limits<FloatingPoint>::max();
+        for (int axis = 0; axis < 3; ++axis) {
+          if (std::abs(W_direction[axis]) < kEpsilon) {
+            continue;
+          }
+          const FloatingPoint lower =
+              axis == 2 ? kFloorHeight : -kRoomHalfWidth;
+          const FloatingPoint upper =
+              axis == 2 ? kCeilingHeight : kRoomHalfWidth;
+          const FloatingPoint bound = 0.f < W_direction[axis] ? upper : lower;
+          range = std::min(range,
+                           (bound - W_origin[axis]) / W_direction[axis]);
+        }
+        // Intersect it with the pillars
+        for (const Point2D& pillar_center : pillar_centers) {
+          const Vector2D offset = W_origin.head<2>() - pillar_center;
+          const FloatingPoint a = W_direction.head<2>().squaredNorm();
+          const FloatingPoint b = 2.f * offset.dot(W_direction.head<2>());
+          const FloatingPoint c =
+              offset.squaredNorm() - kPillarRadius * kPillarRadius;
+          const FloatingPoint discriminant = b * b - 4.f * a * c;
+          if (a < kEpsilon || discriminant < 0.f) {
+            continue;
+          }
+          const FloatingPoint t = (-b - std::sqrt(discriminant)) / (2.f * a);
+          if (0.f < t) {
+            range = std::min(range, t);
+          }
+        }
+        // Add a little range noise
+        range += random_number_generator.getRandomRealNumber(-0.02f, 0.02f);
+        pointcloud[point_idx] = range * C_direction;
+        ++point_idx;
+      }
+    }
+    scans.emplace_back(T_W_C, pointcloud);
+  }
+  return scans;
+}
+
+// Sensor setups to benchmark, each providing a projection model and its
+// mounting orientation
+template <typename ProjectorT>
+struct SensorSetup;
+
+// Ouster OS0-64 LiDAR, mounted upright
+template <>
+struct SensorSetup<OusterProjector> {
+  static std::shared_ptr<OusterProjector> createProjectionModel() {
+    OusterProjectorConfig projector_config;
+    projector_config.elevation = {-kQuarterPi / 2.f, kQuarterPi / 2.f, 64};
+    projector_config.azimuth = {-kPi, kPi, 1024};
+    return std::make_shared<OusterProjector>(projector_config);
+  }
+  static Eigen::Quaternion<FloatingPoint> getMountingOrientation() {
+    return Eigen::Quaternion<FloatingPoint>::Identity();
+  }
+};
+
+// VGA depth camera, looking forward
+template <>
+struct SensorSetup<PinholeCameraProjector> {
+  static std::shared_ptr<PinholeCameraProjector> createProjectionModel() {
+    return std::make_shared<PinholeCameraProjector>(
+        PinholeCameraProjectorConfig{320.f, 320.f, 320.f, 240.f, 480, 640});
+  }
+  static Eigen::Quaternion<FloatingPoint> getMountingOrientation() {
+    // The camera's optical axis (z) points along the body's x-axis
+    Eigen::Matrix<FloatingPoint, 3, 3> R_B_C;
+    R_B_C << 0.f, 0.f, 1.f, -1.f, 0.f, 0.f, 0.f, -1.f, 0.f;
+    return Eigen::Quaternion<FloatingPoint>{R_B_C};
+  }
+};
+}  // namespace wavemap
+
+#endif  // WAVEMAP_BENCHMARK_SCAN_GENERATOR_H_
@@ -0,0 +1,222 @@
+#ifndef WAVEMAP_DATA_STRUCTURE_BLOCK_HASH_MAP_H_
+#define WAVEMAP_DATA_STRUCTURE_BLOCK_HASH_MAP_H_
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "wavemap/common.h"
+#include "wavemap/indexing/index_hashes.h"
+#include "wavemap/utils/memory/object_pool.h"
+
+namespace wavemap {
+/**
+ * \brief Flat, open addressing hash map from block indices to blocks.
+ *
+ * The table itself only stores one control byte and one index and pointer per
+ * slot. The control bytes hold 7 bits of each key's hash, s.t. a whole group of
+ * slots can be probed at once using SIMD instructions, and the keys only need
+ * to be compared for the (rare) slots whose hash bits match. The blocks are stored
+ * out of line in an ObjectPool. References to blocks therefore remain valid
+ * until the block is erased, also when the table grows, like for
+ * std::unordered_map.
+ *
+ * The interface mirrors the subset of std::unordered_map that is used by the
+ * hashed data structures. Concurrent calls to const methods are safe.
+ */
+template <typename BlockT, int dim, typename HashT = ScrambledIndexHash<dim>>
+class BlockHashMap {
+ public:
+  using BlockIndex = Index<dim>;
+  using key_type = BlockIndex;
+  using mapped_type = BlockT;
+  using value_type = std::pair<const BlockIndex, BlockT>;
+  using size_type = size_t;
+
+  template <bool is_const>
+  class Iterator;
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  BlockHashMap() = default;
+  ~BlockHashMap() { clear(); }
+
+  BlockHashMap(BlockHashMap&& other) noexcept { swap(other); }
+  BlockHashMap& operator=(BlockHashMap&& other) noexcept;
+
+  // Prevent copying, since the blocks are not necessarily copyable
+  BlockHashMap(const BlockHashMap&) = delete;
+  BlockHashMap& operator=(const BlockHashMap&) = delete;
+
+  bool empty() const { return size_ == 0u; }
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+
+  void clear();
+  void reserve(size_t num_blocks);
+  void swap(BlockHashMap& other) noexcept;
+
+  iterator begin() { return iterator::firstFullSlotFrom(this, 0u); }
+  iterator end() { return iterator(this, capacity_); }
+  const_iterator begin() const { return cbegin(); }
+  const_iterator end() const { return cend(); }
+  const_iterator cbegin() const {
+    return const_iterator::firstFullSlotFrom(this, 0u);
+  }
+  const_iterator cend() const { return const_iterator(this, capacity_); }
+
+  iterator find(const BlockIndex& block_index);
+  const_iterator find(const BlockIndex& block_index) const;
+  size_t count(const BlockIndex& block_index) const {
+    return findSlot(block_index) != kNotFound;
+  }
+  bool contains(const BlockIndex& block_index) const {
+    return findSlot(block_index) != kNotFound;
+  }
+
+  // NOTE: Like for std::unordered_map, requesting a block that does not exist
+  //       throws an std::out_of_range exception.
+  BlockT& at(const BlockIndex& block_index);
+  const BlockT& at(const BlockIndex& block_index) const;
+
+  template <typename... BlockConstructorArgs>
+  std::pair<iterator, bool> try_emplace(const BlockIndex& block_index,
+                                        BlockConstructorArgs&&... args);
+
+  iterator erase(iterator pos);
+  size_t erase(const BlockIndex& block_index);
+
+ private:
+  using ControlByte = int8_t;
+  // Control byte states, full slots store the low 7 bits of their key's hash
+  static constexpr ControlByte kEmpty = -128;
+  static constexpr ControlByte kDeleted = -2;
+
+  static constexpr size_t kGroupSize = 16;
+  static constexpr size_t kMinCapacity = kGroupSize;
+  static constexpr size_t kNotFound = std::numeric_limits<size_t>::max();
+
+  // Bitmasks indicating which slots of a group match a given criterion
+  class GroupMask;
+  static GroupMask matchHash(const ControlByte* group, ControlByte hash_bits);
+  static GroupMask matchEmpty(const ControlByte* group);
+  static GroupMask matchEmptyOrDeleted(const ControlByte* group);
+  static GroupMask matchFull(const ControlByte* group);
+
+  // NOTE: The slots store a copy of their block's index, s.t. lookups can
+  //       compare keys without dereferencing the (out of line) blocks.
+  struct Slot {
+    BlockIndex block_index;
+    value_type* value;
+  };
+  std::unique_ptr<ControlByte[]> control_bytes_;
+  std::unique_ptr<Slot[]> slots_;
+  size_t capacity_ = 0u;
+  size_t size_ = 0u;
+  size_t num_deleted_ = 0u;
+
+  static size_t hash(const BlockIndex& block_index) {
+    return HashT{}(block_index);
+  }
+  static size_t maxLoad(size_t capacity) { return capacity - capacity / 8u; }
+
+  size_t findSlot(const BlockIndex& block_index) const {
+    return findSlot(block_index, hash(block_index));
+  }
+  size_t findSlot(const BlockIndex& block_index, size_t hash_value) const;
+  size_t findInsertionSlot(size_t hash_value) const;
+  // NOTE: Also returns the other full slots of the found slot's group that
+  //       come after it, s.t. iterators only need to load the control bytes
+  //       of the next group once these are exhausted.
+  size_t findFirstFullSlot(size_t slot_idx, GroupMask& next_full_slots) const;
+  void rehash(size_t new_capacity);
+};
+
+template <typename BlockT, int dim, typename HashT>
+template <bool is_const>
+class BlockHashMap<BlockT, dim, HashT>::Iterator {
+ public:
+  using MapPtr =
+      std::conditional_t<is_const, const BlockHashMap*, BlockHashMap*>;
+  using iterator_category = std::forward_iterator_tag;
+  using difference_type = std::ptrdiff_t;
+  using value_type = typename BlockHashMap::value_type;
+  using pointer = std::conditional_t<is_const, const value_type*, value_type*>;
+  using reference =
+      std::conditional_t<is_const, const value_type&, value_type&>;
+
+  Iterator() = default;
+  Iterator(MapPtr map, size_t slot_idx) : map_(map), slot_idx_(slot_idx) {}
+  // Allow implicit conversion from mutable to const iterators
+  template <bool other_is_const,
+            typename = std::enable_if_t<is_const && !other_is_const>>
+  Iterator(const Iterator<other_is_const>& other)  // NOLINT
+      : map_(other.map_),
+        slot_idx_(other.slot_idx_),
+        next_full_slots_(other.next_full_slots_) {}
+
+  reference operator*() const { return *map_->slots_[slot_idx_].value; }
+  pointer operator->() const { return map_->slots_[slot_idx_].value; }
+
+  Iterator& operator++() {
+    if (next_full_slots_.any()) {
+      slot_idx_ = slot_idx_ / kGroupSize * kGroupSize +
+                  next_full_slots_.lowestSetBit();
+      next_full_slots_.clearLowestSetBit();
+    } else {
+      slot_idx_ = map_->findFirstFullSlot(slot_idx_ + 1u, next_full_slots_);
+    }
+    prefetchNextBlock();
+    return *this;
+  }
+  Iterator operator++(int) {
+    Iterator previous = *this;
+    ++*this;
+    return previous;
+  }
+
+  friend bool operator==(const Iterator& lhs, const Iterator& rhs) {
+    return lhs.slot_idx_ == rhs.slot_idx_;
+  }
+  friend bool operator!=(const Iterator& lhs, const Iterator& rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  MapPtr map_ = nullptr;
+  size_t slot_idx_ = 0u;
+  // Full slots that follow slot_idx_ in its group
+  // NOTE: Iterators returned by lookups leave this empty, in which case
+  //       incrementing them scans the rest of the group instead.
+  GroupMask next_full_slots_{0u};
+
+  static Iterator firstFullSlotFrom(MapPtr map, size_t slot_idx) {
+    Iterator it(map, slot_idx);
+    it.slot_idx_ = map->findFirstFullSlot(slot_idx, it.next_full_slots_);
+    it.prefetchNextBlock();
+    return it;
+  }
+
+  // Blocks are stored out of line in the order they were allocated, which is
+  // unrelated to the order of their slots. Fetching the next block while the
+  // current one is processed hides most of the resulting cache misses.
+  void prefetchNextBlock() const {
+    if (next_full_slots_.any()) {
+      const size_t next_slot_idx = slot_idx_ / kGroupSize * kGroupSize +
+                                   next_full_slots_.lowestSetBit();
+      __builtin_prefetch(map_->slots_[next_slot_idx].value);
+    }
+  }
+
+  template <bool>
+  friend class Iterator;
+  friend class BlockHashMap;
+};
+}  // namespace wavemap
+
+#include "wavemap/data_structure/impl/block_hash_map_inl.h"
+
+#endif  // WAVEMAP_DATA_STRUCTURE_BLOCK_HASH_MAP_H_
@@ -73,10 +73,10 @@ NdtreeNodeChunk<DataT, dim, height>::allocateChild(
   CHECK_GE(relative_child_index, 0u);
   CHECK_LT(relative_child_index, kNumChildren);
   if (!hasChildrenArray()) {
-    child_chunks_ = std::make_unique<ChildChunkArray>();
+    child_chunks_ = makePooledUnique<ChildChunkArray>();
   }
   child_chunks_->operator[](relative_child_index) =
-      std::make_unique<NdtreeNodeChunk>();
+      makePooledUnique<NdtreeNodeChunk>();
   return child_chunks_->operator[](relative_child_index).get();
 }
 
@@ -9,6 +9,7 @@
 #include "wavemap/common.h"
 #include "wavemap/indexing/ndtree_index.h"
 #include "wavemap/utils/math/tree_math.h"
+#include "wavemap/utils/memory/object_pool.h"
 
 namespace wavemap {
 template <typename DataT, int dim, int height>
@@ -63,12 +64,15 @@ class NdtreeNodeChunk {
  private:
   using NodeDataArray = std::array<DataT, kNumInnerNodes>;
   using NodeChildBitset = std::bitset<kNumInnerNodes>;
+  // NOTE: The chunks and their children arrays are allocated from slab
+  //       pools, s.t. growing and pruning the tree mostly recycles memory
+  //       instead of going through the system allocator.
   using ChildChunkArray =
-      std::array<std::unique_ptr<NdtreeNodeChunk>, kNumChildren>;
+      std::array<PooledUniquePtr<NdtreeNodeChunk>, kNumChildren>;
 
   NodeDataArray node_data_{};
   NodeChildBitset node_has_at_least_one_child_{};
-  std::unique_ptr<ChildChunkArray> child_chunks_;
+  PooledUniquePtr<ChildChunkArray> child_chunks_;
 };
 }  // namespace wavemap
 
@@ -0,0 +1,330 @@
+#ifndef WAVEMAP_DATA_STRUCTURE_IMPL_BLOCK_HASH_MAP_INL_H_
+#define WAVEMAP_DATA_STRUCTURE_IMPL_BLOCK_HASH_MAP_INL_H_
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "wavemap/utils/bits/bit_operations.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define BLOCK_HASH_MAP_SSE2_AVAILABLE
+#endif
+
+namespace wavemap {
+template <typename BlockT, int dim, typename HashT>
+class BlockHashMap<BlockT, dim, HashT>::GroupMask {
+ public:
+  explicit GroupMask(uint32_t mask) : mask_(mask) {}
+
+  bool any() const { return mask_ != 0u; }
+  size_t lowestSetBit() const { return bit_ops::ctz(mask_); }
+  void clearLowestSetBit() { mask_ &= mask_ - 1u; }
+  void clearBitsBelow(size_t bit_idx) { mask_ &= ~uint32_t{0} << bit_idx; }
+
+ private:
+  uint32_t mask_;
+};
+
+template <typename BlockT, int dim, typename HashT>
+typename BlockHashMap<BlockT, dim, HashT>::GroupMask
+BlockHashMap<BlockT, dim, HashT>::matchHash(const ControlByte* group,
+                                            ControlByte hash_bits) {
+#ifdef BLOCK_HASH_MAP_SSE2_AVAILABLE
+  const __m128i control =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  const __m128i match = _mm_cmpeq_epi8(_mm_set1_epi8(hash_bits), control);
+  return GroupMask(static_cast<uint32_t>(_mm_movemask_epi8(match)));
+#else
+  uint32_t mask = 0u;
+  for (size_t idx = 0; idx < kGroupSize; ++idx) {
+    mask |= static_cast<uint32_t>(group[idx] == hash_bits) << idx;
+  }
+  return GroupMask(mask);
+#endif
+}
+
+template <typename BlockT, int dim, typename HashT>
+typename BlockHashMap<BlockT, dim, HashT>::GroupMask
+BlockHashMap<BlockT, dim, HashT>::matchEmpty(const ControlByte* group) {
+  return matchHash(group, kEmpty);
+}
+
+template <typename BlockT, int dim, typename HashT>
+typename BlockHashMap<BlockT, dim, HashT>::GroupMask
+BlockHashMap<BlockT, dim, HashT>::matchEmptyOrDeleted(
+    const ControlByte* group) {
+  // NOTE: Empty and deleted slots are the only ones with their sign bit set.
+#ifdef BLOCK_HASH_MAP_SSE2_AVAILABLE
+  const __m128i control =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  return GroupMask(static_cast<uint32_t>(_mm_movemask_epi8(control)));
+#else
+  uint32_t mask = 0u;
+  for (size_t idx = 0; idx < kGroupSize; ++idx) {
+    mask |= static_cast<uint32_t>(group[idx] < 0) << idx;
+  }
+  return GroupMask(mask);
+#endif
+}
+
+template <typename BlockT, int dim, typename HashT>
+typename BlockHashMap<BlockT, dim, HashT>::GroupMask
+BlockHashMap<BlockT, dim, HashT>::matchFull(const ControlByte* group) {
+#ifdef BLOCK_HASH_MAP_SSE2_AVAILABLE
+  const __m128i control =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+  return GroupMask(static_cast<uint32_t>(_mm_movemask_epi8(control)) ^
+                   0xFFFFu);
+#else
+  uint32_t mask = 0u;
+  for (size_t idx = 0; idx < kGroupSize; ++idx) {
+    mask |= static_cast<uint32_t>(0 <= group[idx]) << idx;
+  }
+  return GroupMask(mask);
+#endif
+}
+
+template <typename BlockT, int dim, typename HashT>
+BlockHashMap<BlockT, dim, HashT>& BlockHashMap<BlockT, dim, HashT>::operator=(
+    BlockHashMap&& other) noexcept {
+  if (this != &other) {
+    clear();
+    swap(other);
+  }
+  return *this;
+}
+
+template <typename BlockT, int dim, typename HashT>
+void BlockHashMap<BlockT, dim, HashT>::clear() {
+  for (size_t slot_idx = 0; slot_idx < capacity_; ++slot_idx) {
+    if (0 <= control_bytes_[slot_idx]) {
+      ObjectPool<value_type>::destroy(slots_[slot_idx].value);
+    }
+    control_bytes_[slot_idx] = kEmpty;
+  }
+  size_ = 0u;
+  num_deleted_ = 0u;
+}
+
+template <typename BlockT, int dim, typename HashT>
+void BlockHashMap<BlockT, dim, HashT>::reserve(size_t num_blocks) {
+  size_t new_capacity = std::max(capacity_, kMinCapacity);
+  while (maxLoad(new_capacity) < num_blocks) {
+    new_capacity *= 2u;
+  }
+  if (new_capacity != capacity_) {
+    rehash(new_capacity);
+  }
+}
+
+template <typename BlockT, int dim, typename HashT>
+void BlockHashMap<BlockT, dim, HashT>::swap(BlockHashMap& other) noexcept {
+  std::swap(control_bytes_, other.control_bytes_);
+  std::swap(slots_, other.slots_);
+  std::swap(capacity_, other.capacity_);
+  std::swap(size_, other.size_);
+  std::swap(num_deleted_, other.num_deleted_);
+}
+
+template <typename BlockT, int dim, typename HashT>
+typename BlockHashMap<BlockT, dim, HashT>::iterator
+BlockHashMap<BlockT, dim, HashT>::find(const BlockIndex& block_index) {
+  const size_t slot_idx = findSlot(block_index);
+  return slot_idx == kNotFound ? end() : iterator(this, slot_idx);
+}
+
+template <typename BlockT, int dim, typename HashT>
+typename BlockHashMap<BlockT, dim, HashT>::const_iterator
+BlockHashMap<BlockT, dim, HashT>::find(const BlockIndex& block_index) const {
+  const size_t slot_idx = findSlot(block_index);
+  return slot_idx == kNotFound ? cend() : const_iterator(this, slot_idx);
+}
+
+template <typename BlockT, int dim, typename HashT>
+BlockT& BlockHashMap<BlockT, dim, HashT>::at(const BlockIndex& block_index) {
+  const size_t slot_idx = findSlot(block_index);
+  if (slot_idx == kNotFound) {
+    throw std::out_of_range("Requested block does not exist.");
+  }
+  return slots_[slot_idx].value->second;
+}
+
+template <typename BlockT, int dim, typename HashT>
+const BlockT& BlockHashMap<BlockT, dim, HashT>::at(
+    const BlockIndex& block_index) const {
+  const size_t slot_idx = findSlot(block_index);
+  if (slot_idx == kNotFound) {
+    throw std::out_of_range("Requested block does not exist.");
+  }
+  return slots_[slot_idx].value->second;
+}
+
+template <typename BlockT, int dim, typename HashT>
+template <typename... BlockConstructorArgs>
+std::pair<typename BlockHashMap<BlockT, dim, HashT>::iterator, bool>
+BlockHashMap<BlockT, dim, HashT>::try_emplace(const BlockIndex& block_index,
+                                              BlockConstructorArgs&&... args) {
+  const size_t hash_value = hash(block_index);
+  if (const size_t slot_idx = findSlot(block_index, hash_value);
+      slot_idx != kNotFound) {
+    return {iterator(this, slot_idx), false};
+  }
+
+  // Grow the table if needed, or purge its tombstones if the live blocks alone
+  // leave enough headroom
+  // NOTE: Maps that slide along with the sensor erase and insert blocks at the
+  //       same rate. Only growing the table once the live blocks reach most
+  //       of the max load keeps such maps from doubling their capacity, and
+  //       thus the cost of iterating over them, because of tombstones.
+  if (maxLoad(capacity_) < size_ + num_deleted_ + 1u) {
+    const bool fits_after_purge =
+        capacity_ != 0u && size_ + 1u <= capacity_ / 32u * 25u;
+    rehash(fits_after_purge ? capacity_
+                            : std::max(kMinCapacity, 2u * capacity_));
+  }
+
+  const size_t slot_idx = findInsertionSlot(hash_value);
+  if (control_bytes_[slot_idx] == kDeleted) {
+    --num_deleted_;
+  }
+  slots_[slot_idx] = {
+      block_index,
+      ObjectPool<value_type>::create(
+          std::piecewise_construct, std::forward_as_tuple(block_index),
+          std::forward_as_tuple(std::forward<BlockConstructorArgs>(args)...))};
+  control_bytes_[slot_idx] = static_cast<ControlByte>(hash_value & 0x7Fu);
+  ++size_;
+  return {iterator(this, slot_idx), true};
+}
+
+template <typename BlockT, int dim, typename HashT>
+typename BlockHashMap<BlockT, dim, HashT>::iterator
+BlockHashMap<BlockT, dim, HashT>::erase(iterator pos) {
+  const size_t slot_idx = pos.slot_idx_;
+  DCHECK_LT(slot_idx, capacity_);
+  DCHECK_LE(0, control_bytes_[slot_idx]);
+  ObjectPool<value_type>::destroy(slots_[slot_idx].value);
+  slots_[slot_idx].value = nullptr;
+  // NOTE: Lookups stop at the first group that contains an empty slot. If the
+  //       slot's group is already in that state, it can directly be marked as
+  //       empty. Otherwise it is marked as deleted, s.t. the probe sequences of
+  //       other keys that continue past this group remain intact.
+  const ControlByte* group =
+      &control_bytes_[slot_idx / kGroupSize * kGroupSize];
+  --size_;
+  if (matchEmpty(group).any()) {
+    control_bytes_[slot_idx] = kEmpty;
+  } else {
+    control_bytes_[slot_idx] = kDeleted;
+    ++num_deleted_;
+  }
+  // NOTE: Erasing a slot does not affect the other slots of its group, so the
+  //       iterator's cached full slots remain valid.
+  return ++pos;
+}
+
+template <typename BlockT, int dim, typename HashT>
+size_t BlockHashMap<BlockT, dim, HashT>::erase(const BlockIndex& block_index) {
+  if (auto it = find(block_index); it != end()) {
+    erase(it);
+    return 1u;
+  }
+  return 0u;
+}
+
+template <typename BlockT, int dim, typename HashT>
+size_t BlockHashMap<BlockT, dim, HashT>::findSlot(
+    const BlockIndex& block_index, size_t hash_value) const {
+  if (size_ == 0u) {
+    return kNotFound;
+  }
+  const auto hash_bits = static_cast<ControlByte>(hash_value & 0x7Fu);
+  const size_t group_idx_mask = capacity_ / kGroupSize - 1u;
+  // Probe the groups following a triangular sequence, which visits all groups
+  // since their number is a power of two
+  size_t group_idx = (hash_value >> 7) & group_idx_mask;
+  for (size_t probe_idx = 1; probe_idx <= capacity_ / kGroupSize;
+       ++probe_idx) {
+    const ControlByte* group = &control_bytes_[group_idx * kGroupSize];
+    for (GroupMask match = matchHash(group, hash_bits); match.any();
+         match.clearLowestSetBit()) {
+      const size_t slot_idx = group_idx * kGroupSize + match.lowestSetBit();
+      if (slots_[slot_idx].block_index == block_index) {
+        return slot_idx;
+      }
+    }
+    if (matchEmpty(group).any()) {
+      return kNotFound;
+    }
+    group_idx = (group_idx + probe_idx) & group_idx_mask;
+  }
+  return kNotFound;
+}
+
+template <typename BlockT, int dim, typename HashT>
+size_t BlockHashMap<BlockT, dim, HashT>::findInsertionSlot(
+    size_t hash_value) const {
+  const size_t group_idx_mask = capacity_ / kGroupSize - 1u;
+  size_t group_idx = (hash_value >> 7) & group_idx_mask;
+  for (size_t probe_idx = 1;; ++probe_idx) {
+    const ControlByte* group = &control_bytes_[group_idx * kGroupSize];
+    if (const GroupMask free_slots = matchEmptyOrDeleted(group);
+        free_slots.any()) {
+      return group_idx * kGroupSize + free_slots.lowestSetBit();
+    }
+    group_idx = (group_idx + probe_idx) & group_idx_mask;
+  }
+}
+
+template <typename BlockT, int dim, typename HashT>
+size_t BlockHashMap<BlockT, dim, HashT>::findFirstFullSlot(
+    size_t slot_idx, GroupMask& next_full_slots) const {
+  // Skip over the slots one group at a time
+  while (slot_idx < capacity_) {
+    const size_t group_start_idx = slot_idx / kGroupSize * kGroupSize;
+    GroupMask full_slots = matchFull(&control_bytes_[group_start_idx]);
+    full_slots.clearBitsBelow(slot_idx - group_start_idx);
+    if (full_slots.any()) {
+      const size_t full_slot_idx = group_start_idx + full_slots.lowestSetBit();
+      full_slots.clearLowestSetBit();
+      next_full_slots = full_slots;
+      return full_slot_idx;
+    }
+    slot_idx = group_start_idx + kGroupSize;
+  }
+  next_full_slots = GroupMask(0u);
+  return capacity_;
+}
+
+template <typename BlockT, int dim, typename HashT>
+void BlockHashMap<BlockT, dim, HashT>::rehash(size_t new_capacity) {
+  DCHECK_EQ(bit_ops::popcount(new_capacity), 1u);
+  DCHECK_LT(size_, maxLoad(new_capacity));
+
+  auto old_control_bytes = std::move(control_bytes_);
+  auto old_slots = std::move(slots_);
+  const size_t old_capacity = capacity_;
+
+  control_bytes_ = std::make_unique<ControlByte[]>(new_capacity);
+  std::fill_n(control_bytes_.get(), new_capacity, kEmpty);
+  slots_ = std::make_unique<Slot[]>(new_capacity);
+  capacity_ = new_capacity;
+  num_deleted_ = 0u;
+
+  // Move the pointers to the existing blocks into the new table
+  // NOTE: The blocks themselves are not moved.
+  for (size_t slot_idx = 0; slot_idx < old_capacity; ++slot_idx) {
+    if (0 <= old_control_bytes[slot_idx]) {
+      const size_t hash_value = hash(old_slots[slot_idx].block_index);
+      const size_t new_slot_idx = findInsertionSlot(hash_value);
+      control_bytes_[new_slot_idx] = old_control_bytes[slot_idx];
+      slots_[new_slot_idx] = old_slots[slot_idx];
+    }
+  }
+}
+}  // namespace wavemap
+
+#endif  // WAVEMAP_DATA_STRUCTURE_IMPL_BLOCK_HASH_MAP_INL_H_
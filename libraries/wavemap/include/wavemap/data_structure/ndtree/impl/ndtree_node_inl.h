@@ -51,10 +51,10 @@ NdtreeNode<DataT, dim>* NdtreeNode<DataT, dim>::allocateChild(
   CHECK_GE(child_index, 0u);
   CHECK_LT(child_index, kNumChildren);
   if (!hasChildrenArray()) {
-    children_ = std::make_unique<ChildrenArray>();
+    children_ = makePooledUnique<ChildrenArray>();
   }
-  children_->operator[](child_index) =
-      std::make_unique<NdtreeNode>(std::forward<NodeConstructorArgs>(args)...);
+  children_->operator[](child_index) = makePooledUnique<NdtreeNode>(
+      std::forward<NodeConstructorArgs>(args)...);
   return children_->operator[](child_index).get();
 }
 
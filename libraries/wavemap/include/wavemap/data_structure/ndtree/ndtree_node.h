@@ -6,6 +6,7 @@
 
 #include "wavemap/common.h"
 #include "wavemap/indexing/ndtree_index.h"
+#include "wavemap/utils/memory/object_pool.h"
 
 namespace wavemap {
 template <typename DataT, int dim>
@@ -45,10 +46,13 @@ class NdtreeNode {
   size_t getMemoryUsage() const;
 
  private:
-  using ChildrenArray = std::array<std::unique_ptr<NdtreeNode>, kNumChildren>;
+  // NOTE: The nodes and their children arrays are allocated from slab pools,
+  //       s.t. growing and pruning the tree mostly recycles memory instead of
+  //       going through the system allocator.
+  using ChildrenArray = std::array<PooledUniquePtr<NdtreeNode>, kNumChildren>;
 
   DataT data_{};
-  std::unique_ptr<ChildrenArray> children_;
+  PooledUniquePtr<ChildrenArray> children_;
 };
 }  // namespace wavemap
 
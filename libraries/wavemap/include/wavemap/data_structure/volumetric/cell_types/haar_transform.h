@@ -42,6 +42,16 @@ typename HaarCoefficients<ValueT, dim>::Scale BackwardSingleChild(
     const typename HaarCoefficients<ValueT, dim>::Parent& parent,
     NdtreeIndexRelativeChild child_idx);
 
+template <typename ValueT, int dim>
+typename HaarCoefficients<ValueT, dim>::Scale BackwardSingleChild(
+    typename HaarCoefficients<ValueT, dim>::Scale parent_scale,
+    const typename HaarCoefficients<ValueT, dim>::Details& parent_details,
+    NdtreeIndexRelativeChild child_idx);
+
+// NOTE: The backwardSingleChild overload that takes the parent's scale and
+//       details separately should be preferred when the details are read
+//       directly from an ndtree node. It avoids copying them into a temporary
+//       Parent, which would stall the vectorized loads that read them back.
 // NOTE: The parallel and lifted transform implementations trade off data
 //       parallelism (i.e. short instruction dependency chains) and efficiency
 //       (i.e. less required operations in total). Benchmarks show the lifting
@@ -74,6 +84,14 @@ struct HaarTransform {
       NdtreeIndexRelativeChild child_idx) {
     return BackwardSingleChild<ValueT, kDim>(parent, child_idx);
   }
+
+  static typename HaarCoefficients<ValueT, kDim>::Scale backwardSingleChild(
+      typename HaarCoefficients<ValueT, kDim>::Scale parent_scale,
+      const typename HaarCoefficients<ValueT, kDim>::Details& parent_details,
+      NdtreeIndexRelativeChild child_idx) {
+    return BackwardSingleChild<ValueT, kDim>(parent_scale, parent_details,
+                                             child_idx);
+  }
 };
 
 template <typename ValueT>
@@ -103,6 +121,14 @@ struct HaarTransform<ValueT, 1> {
       NdtreeIndexRelativeChild child_idx) {
     return BackwardSingleChild<ValueT, kDim>(parent, child_idx);
   }
+
+  static typename HaarCoefficients<ValueT, kDim>::Scale backwardSingleChild(
+      typename HaarCoefficients<ValueT, kDim>::Scale parent_scale,
+      const typename HaarCoefficients<ValueT, kDim>::Details& parent_details,
+      NdtreeIndexRelativeChild child_idx) {
+    return BackwardSingleChild<ValueT, kDim>(parent_scale, parent_details,
+                                             child_idx);
+  }
 };
 
 template <typename ValueT>
@@ -132,6 +158,14 @@ struct HaarTransform<ValueT, 2> {
       NdtreeIndexRelativeChild child_idx) {
     return BackwardSingleChild<ValueT, kDim>(parent, child_idx);
   }
+
+  static typename HaarCoefficients<ValueT, kDim>::Scale backwardSingleChild(
+      typename HaarCoefficients<ValueT, kDim>::Scale parent_scale,
+      const typename HaarCoefficients<ValueT, kDim>::Details& parent_details,
+      NdtreeIndexRelativeChild child_idx) {
+    return BackwardSingleChild<ValueT, kDim>(parent_scale, parent_details,
+                                             child_idx);
+  }
 };
 }  // namespace wavemap
 
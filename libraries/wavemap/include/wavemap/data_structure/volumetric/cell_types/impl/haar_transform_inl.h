@@ -1,9 +1,16 @@
 #ifndef WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_CELL_TYPES_IMPL_HAAR_TRANSFORM_INL_H_
 #define WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_CELL_TYPES_IMPL_HAAR_TRANSFORM_INL_H_
 
+#include <type_traits>
+
 #include "wavemap/utils/bits/bit_operations.h"
 #include "wavemap/utils/math/int_math.h"
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#define HAAR_TRANSFORM_SSE_AVAILABLE
+#endif
+
 namespace wavemap {
 template <typename ValueT, int dim>
 typename HaarCoefficients<ValueT, dim>::Parent ForwardLifted(
@@ -143,22 +150,98 @@ typename HaarCoefficients<ValueT, dim>::CoefficientsArray BackwardParallel(
   return child_scales;
 }
 
+namespace detail {
+// Table with the weights with which each detail coefficient of a parent
+// contributes to the scale coefficient of each of its children
+template <typename ValueT, int dim>
+constexpr auto ComputeBackwardSingleChildWeights() {
+  using Coefficients = HaarCoefficients<ValueT, dim>;
+  std::array<std::array<ValueT, Coefficients::kNumDetailCoefficients>,
+             Coefficients::kNumCoefficients>
+      weights{};
+  // NOTE: The unsigned bit operations are used directly, since the templated
+  //       wrappers are not constexpr.
+  for (uint32_t child_idx = 0; child_idx < Coefficients::kNumCoefficients;
+       ++child_idx) {
+    for (uint32_t parent_idx = 1; parent_idx < Coefficients::kNumCoefficients;
+         ++parent_idx) {
+      const ValueT weight =
+          static_cast<ValueT>(1) /
+          static_cast<ValueT>(int_math::exp2(
+              static_cast<int>(bit_ops::detail::popcount(parent_idx))));
+      weights[child_idx][parent_idx - 1] =
+          bit_ops::detail::parity(~child_idx & parent_idx) ? -weight : weight;
+    }
+  }
+  return weights;
+}
+
+template <typename ValueT, int dim>
+inline constexpr auto kBackwardSingleChildWeights =
+    ComputeBackwardSingleChildWeights<ValueT, dim>();
+
+#ifdef HAAR_TRANSFORM_SSE_AVAILABLE
+// The 7 detail coefficients of a 3D float parent are loaded as two overlapping
+// 4-wide vectors, covering details [0, 3] and [3, 6]. The weights are padded
+// accordingly, with a zero weight s.t. detail 3 is only counted once.
+struct alignas(16) BackwardSingleChildWeightsSse {
+  std::array<float, 4> lower;
+  std::array<float, 4> upper;
+};
+
+constexpr auto ComputeBackwardSingleChildWeightsSse() {
+  constexpr auto kWeights = kBackwardSingleChildWeights<float, 3>;
+  std::array<BackwardSingleChildWeightsSse, 8> weights{};
+  for (int child_idx = 0; child_idx < 8; ++child_idx) {
+    for (int idx = 0; idx < 4; ++idx) {
+      weights[child_idx].lower[idx] = kWeights[child_idx][idx];
+      weights[child_idx].upper[idx] =
+          idx == 0 ? 0.f : kWeights[child_idx][idx + 3];
+    }
+  }
+  return weights;
+}
+
+inline constexpr auto kBackwardSingleChildWeightsSse =
+    ComputeBackwardSingleChildWeightsSse();
+#endif
+}  // namespace detail
+
 template <typename ValueT, int dim>
 typename HaarCoefficients<ValueT, dim>::Scale BackwardSingleChild(
     const typename HaarCoefficients<ValueT, dim>::Parent& parent,
     NdtreeIndexRelativeChild child_idx) {
-  ValueT scale = parent.scale;
+  return BackwardSingleChild<ValueT, dim>(parent.scale, parent.details,
+                                          child_idx);
+}
 
-  for (NdtreeIndexElement parent_idx = 1;
-       parent_idx < HaarCoefficients<ValueT, dim>::kNumCoefficients;
-       ++parent_idx) {
-    const ValueT contribution =
-        parent.details[parent_idx - 1] /
-        static_cast<ValueT>(int_math::exp2(bit_ops::popcount(parent_idx)));
-    scale +=
-        bit_ops::parity(~child_idx & parent_idx) ? -contribution : contribution;
+template <typename ValueT, int dim>
+typename HaarCoefficients<ValueT, dim>::Scale BackwardSingleChild(
+    typename HaarCoefficients<ValueT, dim>::Scale parent_scale,
+    const typename HaarCoefficients<ValueT, dim>::Details& parent_details,
+    NdtreeIndexRelativeChild child_idx) {
+#ifdef HAAR_TRANSFORM_SSE_AVAILABLE
+  if constexpr (std::is_same_v<ValueT, float> && dim == 3) {
+    const auto& weights = detail::kBackwardSingleChildWeightsSse[child_idx];
+    const __m128 lower_details = _mm_loadu_ps(&parent_details[0]);
+    const __m128 upper_details = _mm_loadu_ps(&parent_details[3]);
+    __m128 sum =
+        _mm_add_ps(_mm_mul_ps(lower_details, _mm_load_ps(&weights.lower[0])),
+                   _mm_mul_ps(upper_details, _mm_load_ps(&weights.upper[0])));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0b01));
+    return parent_scale + _mm_cvtss_f32(sum);
+  }
+#endif
+
+  const auto& weights =
+      detail::kBackwardSingleChildWeights<ValueT, dim>[child_idx];
+  ValueT scale = parent_scale;
+  for (NdtreeIndexElement detail_idx = 0;
+       detail_idx < HaarCoefficients<ValueT, dim>::kNumDetailCoefficients;
+       ++detail_idx) {
+    scale += weights[detail_idx] * parent_details[detail_idx];
   }
-
   return scale;
 }
 }  // namespace wavemap
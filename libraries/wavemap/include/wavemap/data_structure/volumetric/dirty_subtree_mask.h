@@ -0,0 +1,61 @@
+#ifndef WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_DIRTY_SUBTREE_MASK_H_
+#define WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_DIRTY_SUBTREE_MASK_H_
+
+#include <bitset>
+
+#include "wavemap/common.h"
+#include "wavemap/indexing/index_conversions.h"
+#include "wavemap/indexing/ndtree_index.h"
+#include "wavemap/utils/math/int_math.h"
+
+namespace wavemap {
+/**
+ * Flags indicating which subtrees of a hashed wavelet octree block changed
+ * since the flags were last cleared, such that only these parts of the block
+ * need to be republished. The tracked subtrees are rooted kSubtreeDepth
+ * levels below the block's root node and indexed in Morton order. Blocks
+ * whose trees are not deeper than kSubtreeDepth are tracked as a whole.
+ */
+class DirtySubtreeMask {
+ public:
+  // NOTE: This matches the chunk height of hashed chunked wavelet octrees,
+  //       s.t. each subtree below their root chunk is stored in one chunk.
+  static constexpr IndexElement kSubtreeDepth = 3;
+  static constexpr LinearIndex kNumSubtrees =
+      int_math::exp2(OctreeIndex::kDim * kSubtreeDepth);
+
+  // NOTE: New blocks are fully dirty, as they have never been published.
+  explicit DirtySubtreeMask(IndexElement tree_height)
+      : tree_height_(tree_height) {
+    markAllDirty();
+  }
+
+  bool tracksSubtrees() const { return kSubtreeDepth < tree_height_; }
+  IndexElement getSubtreeHeight() const {
+    return tracksSubtrees() ? tree_height_ - kSubtreeDepth : tree_height_;
+  }
+
+  // Flag the subtrees that overlap the node with the given index
+  // NOTE: The index can either be expressed w.r.t. the block or globally.
+  void markDirty(const OctreeIndex& node_index);
+  void markAllDirty() { bitset_.set(); }
+  void clear() { bitset_.reset(); }
+
+  bool isDirty(LinearIndex subtree_idx) const { return bitset_[subtree_idx]; }
+  bool any() const { return bitset_.any(); }
+  bool all() const { return bitset_.all(); }
+  size_t count() const { return bitset_.count(); }
+
+  // Index of a subtree's root node, given the index of the block
+  OctreeIndex getSubtreeIndex(const Index3D& block_index,
+                              LinearIndex subtree_idx) const;
+
+ private:
+  IndexElement tree_height_;
+  std::bitset<kNumSubtrees> bitset_;
+};
+}  // namespace wavemap
+
+#include "wavemap/data_structure/volumetric/impl/dirty_subtree_mask_inl.h"
+
+#endif  // WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_DIRTY_SUBTREE_MASK_H_
@@ -0,0 +1,32 @@
+#ifndef WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_HASHED_BLOCK_MAINTENANCE_H_
+#define WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_HASHED_BLOCK_MAINTENANCE_H_
+
+#include "wavemap/common.h"
+#include "wavemap/utils/thread_pool.h"
+
+namespace wavemap::hashed_block_maintenance {
+// Parallel maintenance passes shared by the hashed wavelet octrees, which
+// process the blocks with the thread pool and then remove the blocks that
+// became empty serially, as this modifies the block map itself
+// NOTE: The block map must not be modified concurrently. The passes only wait
+//       for their own tasks, s.t. the pool can be shared with other users.
+template <typename BlockMapT>
+void threshold(BlockMapT& blocks, ThreadPool& thread_pool);
+template <typename BlockMapT>
+void prune(BlockMapT& blocks, ThreadPool& thread_pool);
+template <typename BlockMapT>
+void pruneIfUnusedFor(BlockMapT& blocks, FloatingPoint min_time_unused,
+                      ThreadPool& thread_pool);
+
+// Apply block_fn to all blocks for which select_fn returns true in parallel
+template <typename BlockMapT, typename SelectFn, typename BlockFn>
+void forEachSelectedBlock(BlockMapT& blocks, ThreadPool& thread_pool,
+                          SelectFn select_fn, BlockFn block_fn);
+// Remove all empty blocks from the block map
+template <typename BlockMapT>
+void eraseEmptyBlocks(BlockMapT& blocks);
+}  // namespace wavemap::hashed_block_maintenance
+
+#include "wavemap/data_structure/volumetric/impl/hashed_block_maintenance_inl.h"
+
+#endif  // WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_HASHED_BLOCK_MAINTENANCE_H_
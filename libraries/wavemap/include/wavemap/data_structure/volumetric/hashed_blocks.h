@@ -3,12 +3,12 @@
 
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 #include "wavemap/common.h"
 #include "wavemap/config/config_base.h"
+#include "wavemap/data_structure/block_hash_map.h"
 #include "wavemap/data_structure/volumetric/volumetric_data_structure_base.h"
-#include "wavemap/indexing/index_hashes.h"
 #include "wavemap/utils/math/int_math.h"
 
 namespace wavemap {
@@ -37,11 +37,22 @@ class HashedBlocks : public VolumetricDataStructureBase {
   Index3D getMinIndex() const override;
   Index3D getMaxIndex() const override;
   IndexElement getTreeHeight() const override { return 0; }
+  Index3D getBlockSize() const { return Index3D::Constant(kCellsPerSide); }
 
   FloatingPoint getCellValue(const Index3D& index) const override;
   void setCellValue(const Index3D& index, FloatingPoint new_value) override;
   void addToCellValue(const Index3D& index, FloatingPoint update) override;
 
+  bool hasBlock(const Index3D& block_index) const {
+    return blocks_.contains(block_index);
+  }
+  // Allocate all the given blocks that do not yet exist in one go, growing the
+  // block hash map at most once
+  // NOTE: Once a cell's block is allocated, its value can be read and updated
+  //       without modifying the block hash map. Different blocks can therefore
+  //       safely be updated from different threads.
+  void allocateBlocks(const std::vector<Index3D>& block_indices);
+
   void forEachLeaf(
       typename VolumetricDataStructureBase::IndexedLeafVisitorFunction
           visitor_fn) const override;
@@ -57,7 +68,7 @@ class HashedBlocks : public VolumetricDataStructureBase {
   using BlockIndex = Index3D;
   using CellIndex = Index3D;
 
-  std::unordered_map<BlockIndex, Block, IndexHash<3>> blocks_;
+  BlockHashMap<Block, kDim> blocks_;
 
   FloatingPoint* accessCellData(const Index3D& index,
                                 bool auto_allocate = false);
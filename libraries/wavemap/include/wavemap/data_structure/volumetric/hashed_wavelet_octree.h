@@ -2,14 +2,17 @@
 #define WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_HASHED_WAVELET_OCTREE_H_
 
 #include <memory>
-#include <unordered_map>
+#include <shared_mutex>
+#include <vector>
 
 #include "wavemap/common.h"
 #include "wavemap/config/config_base.h"
+#include "wavemap/data_structure/block_hash_map.h"
 #include "wavemap/data_structure/volumetric/hashed_wavelet_octree_block.h"
+#include "wavemap/data_structure/volumetric/node_update.h"
 #include "wavemap/data_structure/volumetric/volumetric_data_structure_base.h"
-#include "wavemap/indexing/index_hashes.h"
 #include "wavemap/utils/math/int_math.h"
+#include "wavemap/utils/thread_pool.h"
 
 namespace wavemap {
 /**
@@ -64,6 +67,7 @@ class HashedWaveletOctree : public VolumetricDataStructureBase {
 
   using Block = HashedWaveletOctreeBlock;
   using BlockIndex = Block::BlockIndex;
+  using BlockMap = BlockHashMap<Block, kDim>;
   using CellIndex = OctreeIndex;
 
   explicit HashedWaveletOctree(const HashedWaveletOctreeConfig& config)
@@ -74,6 +78,11 @@ class HashedWaveletOctree : public VolumetricDataStructureBase {
   void threshold() override;
   void prune() override;
   void pruneSmart() override;
+  // Variants of the above that process the blocks in parallel. The results
+  // are identical to those of the serial versions.
+  void threshold(ThreadPool& thread_pool);
+  void prune(ThreadPool& thread_pool);
+  void pruneSmart(ThreadPool& thread_pool);
   void clear() override { blocks_.clear(); }
 
   size_t getMemoryUsage() const override;
@@ -90,13 +99,38 @@ class HashedWaveletOctree : public VolumetricDataStructureBase {
   FloatingPoint getCellValue(const OctreeIndex& index) const;
   void setCellValue(const Index3D& index, FloatingPoint new_value) override;
   void addToCellValue(const Index3D& index, FloatingPoint update) override;
+  // Add a list of updates, given in map coordinates and in any order, by
+  // grouping them per block and applying each block's updates in one pass
+  void addToCellValues(const NodeUpdateList& updates);
 
   bool hasBlock(const Index3D& block_index) const;
   Block& getOrAllocateBlock(const Index3D& block_index);
+  // Allocate all the given blocks that do not yet exist in one go, growing the
+  // block hash map at most once
+  // NOTE: This method locks the blocks mutex exclusively by itself, s.t. it
+  //       can safely be called while other threads access the map. It must
+  //       therefore not be called by threads that hold the blocks mutex.
+  void allocateBlocks(const std::vector<Index3D>& block_indices);
+  // Make sure that all the given blocks are allocated, for callers that hold a
+  // shared lock on the blocks mutex. The method returns with the lock held.
+  // NOTE: Since the shared lock can not be upgraded atomically, it is released
+  //       while the missing blocks are allocated. We therefore check that all
+  //       blocks still exist once it is reacquired, and retry if any of them
+  //       were removed in the meantime (e.g. by background pruning).
+  void allocateBlocks(const std::vector<Index3D>& block_indices,
+                      std::shared_lock<std::shared_mutex>& blocks_lock);
   Block& getBlock(const Index3D& block_index);
   const Block& getBlock(const Index3D& block_index) const;
-  auto& getBlocks() { return blocks_; }
-  const auto& getBlocks() const { return blocks_; }
+  BlockMap& getBlocks() { return blocks_; }
+  const BlockMap& getBlocks() const { return blocks_; }
+
+  // Mutex guarding the block hash map's structure, for concurrent access
+  // NOTE: Blocks may only be allocated or removed while this mutex is locked
+  //       exclusively. Threads that look up blocks should lock it for reading
+  //       (shared), and additionally lock the individual blocks they modify.
+  //       It must not be held while waiting on thread pool tasks, since
+  //       waiting workers run other queued tasks that might lock it again.
+  std::shared_mutex& getBlocksMutex() const { return blocks_mutex_; }
 
   void forEachLeaf(
       typename VolumetricDataStructureBase::IndexedLeafVisitorFunction
@@ -108,7 +142,8 @@ class HashedWaveletOctree : public VolumetricDataStructureBase {
   const IndexElement cells_per_block_side_ =
       int_math::exp2(config_.tree_height);
 
-  std::unordered_map<BlockIndex, Block, IndexHash<kDim>> blocks_;
+  BlockMap blocks_;
+  mutable std::shared_mutex blocks_mutex_;
 
   BlockIndex computeBlockIndexFromIndex(const Index3D& index) const {
     return int_math::div_exp2_floor(index, config_.tree_height);
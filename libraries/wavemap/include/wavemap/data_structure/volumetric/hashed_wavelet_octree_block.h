@@ -1,10 +1,15 @@
 #ifndef WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_HASHED_WAVELET_OCTREE_BLOCK_H_
 #define WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_HASHED_WAVELET_OCTREE_BLOCK_H_
 
+#include <mutex>
+#include <vector>
+
 #include "wavemap/common.h"
 #include "wavemap/data_structure/ndtree/ndtree.h"
 #include "wavemap/data_structure/volumetric/cell_types/haar_coefficients.h"
 #include "wavemap/data_structure/volumetric/cell_types/haar_transform.h"
+#include "wavemap/data_structure/volumetric/dirty_subtree_mask.h"
+#include "wavemap/data_structure/volumetric/node_update.h"
 #include "wavemap/data_structure/volumetric/volumetric_data_structure_base.h"
 #include "wavemap/utils/time/time.h"
 
@@ -26,6 +31,7 @@ class HashedWaveletOctreeBlock {
 
   bool empty() const;
   size_t size() const { return ndtree_.size(); }
+  IndexElement getTreeHeight() const { return tree_height_; }
   void threshold();
   void prune();
   void clear();
@@ -33,6 +39,12 @@ class HashedWaveletOctreeBlock {
   FloatingPoint getCellValue(const OctreeIndex& index) const;
   void setCellValue(const OctreeIndex& index, FloatingPoint new_value);
   void addToCellValue(const OctreeIndex& index, FloatingPoint update);
+  // Add a list of updates to the block in a single pass over the touched
+  // subtree, instead of traversing the tree once per update
+  // NOTE: The updates' indices must be expressed w.r.t. the block, as for
+  //       addToCellValue, and be sorted in bulk update order (see
+  //       sortNodeUpdates). Multiple updates to the same node are summed.
+  void addToCellValues(const NodeUpdateList& sorted_updates);
 
   void forEachLeaf(
       const BlockIndex& block_index,
@@ -57,6 +69,12 @@ class HashedWaveletOctreeBlock {
   Timestamp getLastUpdatedStamp() const { return last_updated_stamp_; }
   FloatingPoint getTimeSinceLastUpdated() const;
 
+  // Which of the block's subtrees changed since the flags were last cleared
+  // NOTE: Code that edits the block's nodes directly, instead of through its
+  //       methods, should flag the subtrees it changes itself.
+  DirtySubtreeMask& getDirtySubtrees() { return dirty_subtrees_; }
+  const DirtySubtreeMask& getDirtySubtrees() const { return dirty_subtrees_; }
+
   template <TraversalOrder traversal_order>
   auto getNodeIterator() {
     return ndtree_.getIterator<traversal_order>();
@@ -68,6 +86,11 @@ class HashedWaveletOctreeBlock {
 
   size_t getMemoryUsage() const { return ndtree_.getMemoryUsage(); }
 
+  // Mutex that should be held while accessing the block from multiple threads
+  // NOTE: The block's methods do not lock it themselves, such that single
+  //       threaded users do not pay for the synchronization.
+  std::mutex& getMutex() const { return mutex_; }
+
  private:
   const IndexElement tree_height_;
   const FloatingPoint min_log_odds_;
@@ -79,9 +102,16 @@ class HashedWaveletOctreeBlock {
   bool needs_thresholding_ = false;
   bool needs_pruning_ = false;
   Timestamp last_updated_stamp_ = Time::now();
+  DirtySubtreeMask dirty_subtrees_{tree_height_};
+
+  mutable std::mutex mutex_;
 
   Coefficients::Scale recursiveThreshold(NodeType& node,
                                          Coefficients::Scale scale_coefficient);
+  Coefficients::Scale recursiveAddToCellValues(
+      NodeType& node, IndexElement node_height, const NodeUpdateList& updates,
+      const std::vector<MortonIndex>& morton_codes, size_t first_update_idx,
+      size_t last_update_idx);
   void recursivePrune(NodeType& node);
 };
 }  // namespace wavemap
@@ -0,0 +1,43 @@
+#ifndef WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_IMPL_DIRTY_SUBTREE_MASK_INL_H_
+#define WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_IMPL_DIRTY_SUBTREE_MASK_INL_H_
+
+namespace wavemap {
+inline void DirtySubtreeMask::markDirty(const OctreeIndex& node_index) {
+  if (!tracksSubtrees() || tree_height_ <= node_index.height) {
+    markAllDirty();
+    return;
+  }
+
+  // Nodes that are coarser than the subtrees overlap a contiguous range of them
+  const IndexElement subtree_height = getSubtreeHeight();
+  const LinearIndex first_subtree_idx =
+      OctreeIndex::computeLevelTraversalDistance(
+          convert::nodeIndexToMorton(node_index), tree_height_,
+          subtree_height);
+  if (node_index.height <= subtree_height) {
+    bitset_.set(first_subtree_idx);
+    return;
+  }
+  const LinearIndex num_subtrees = int_math::exp2(
+      OctreeIndex::kDim * (node_index.height - subtree_height));
+  for (LinearIndex subtree_idx = first_subtree_idx;
+       subtree_idx < first_subtree_idx + num_subtrees; ++subtree_idx) {
+    bitset_.set(subtree_idx);
+  }
+}
+
+inline OctreeIndex DirtySubtreeMask::getSubtreeIndex(
+    const Index3D& block_index, LinearIndex subtree_idx) const {
+  OctreeIndex subtree_index{tree_height_, block_index};
+  for (IndexElement depth = tree_height_ - getSubtreeHeight() - 1; 0 <= depth;
+       --depth) {
+    const auto relative_child_idx = static_cast<NdtreeIndexRelativeChild>(
+        (subtree_idx >> (OctreeIndex::kDim * depth)) &
+        (OctreeIndex::kNumChildren - 1));
+    subtree_index = subtree_index.computeChildIndex(relative_child_idx);
+  }
+  return subtree_index;
+}
+}  // namespace wavemap
+
+#endif  // WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_IMPL_DIRTY_SUBTREE_MASK_INL_H_
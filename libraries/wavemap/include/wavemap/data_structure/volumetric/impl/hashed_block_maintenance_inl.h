@@ -0,0 +1,68 @@
+#ifndef WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_IMPL_HASHED_BLOCK_MAINTENANCE_INL_H_
+#define WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_IMPL_HASHED_BLOCK_MAINTENANCE_INL_H_
+
+#include <vector>
+
+namespace wavemap::hashed_block_maintenance {
+template <typename BlockMapT>
+void threshold(BlockMapT& blocks, ThreadPool& thread_pool) {
+  using BlockT = typename BlockMapT::mapped_type;
+  forEachSelectedBlock(
+      blocks, thread_pool,
+      [](const BlockT& block) { return block.getNeedsThresholding(); },
+      [](BlockT& block) { block.threshold(); });
+}
+
+template <typename BlockMapT>
+void prune(BlockMapT& blocks, ThreadPool& thread_pool) {
+  using BlockT = typename BlockMapT::mapped_type;
+  forEachSelectedBlock(
+      blocks, thread_pool,
+      [](const BlockT& block) {
+        return block.getNeedsThresholding() || block.getNeedsPruning();
+      },
+      [](BlockT& block) { block.prune(); });
+  eraseEmptyBlocks(blocks);
+}
+
+template <typename BlockMapT>
+void pruneIfUnusedFor(BlockMapT& blocks, FloatingPoint min_time_unused,
+                      ThreadPool& thread_pool) {
+  using BlockT = typename BlockMapT::mapped_type;
+  forEachSelectedBlock(
+      blocks, thread_pool,
+      [min_time_unused](const BlockT& block) {
+        return min_time_unused < block.getTimeSinceLastUpdated();
+      },
+      [](BlockT& block) { block.prune(); });
+  eraseEmptyBlocks(blocks);
+}
+
+template <typename BlockMapT, typename SelectFn, typename BlockFn>
+void forEachSelectedBlock(BlockMapT& blocks, ThreadPool& thread_pool,
+                          SelectFn select_fn, BlockFn block_fn) {
+  ThreadPool::TaskGroup tasks;
+  for (auto& [block_index, block] : blocks) {
+    if (select_fn(block)) {
+      thread_pool.add_detached_task(
+          tasks, [&block_fn, block_ptr = &block]() { block_fn(*block_ptr); });
+    }
+  }
+  thread_pool.wait_for(tasks);
+}
+
+template <typename BlockMapT>
+void eraseEmptyBlocks(BlockMapT& blocks) {
+  std::vector<typename BlockMapT::key_type> blocks_to_remove;
+  for (const auto& [block_index, block] : blocks) {
+    if (block.empty()) {
+      blocks_to_remove.emplace_back(block_index);
+    }
+  }
+  for (const auto& index : blocks_to_remove) {
+    blocks.erase(index);
+  }
+}
+}  // namespace wavemap::hashed_block_maintenance
+
+#endif  // WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_IMPL_HASHED_BLOCK_MAINTENANCE_INL_H_
@@ -40,13 +40,21 @@ inline void HashedBlocks::addToCellValue(const Index3D& index,
   }
 }
 
+inline void HashedBlocks::allocateBlocks(
+    const std::vector<Index3D>& block_indices) {
+  blocks_.reserve(blocks_.size() + block_indices.size());
+  for (const Index3D& block_index : block_indices) {
+    blocks_.try_emplace(block_index);
+  }
+}
+
 inline FloatingPoint* HashedBlocks::accessCellData(const Index3D& index,
                                                    bool auto_allocate) {
   BlockIndex block_index = computeBlockIndexFromIndex(index);
   auto it = blocks_.find(block_index);
   if (it == blocks_.end()) {
     if (auto_allocate) {
-      it = blocks_.emplace(block_index, Block{}).first;
+      it = blocks_.try_emplace(block_index).first;
     } else {
       return nullptr;
     }
@@ -36,7 +36,7 @@ inline FloatingPoint HashedChunkedWaveletOctreeBlock::getCellValue(
       const NdtreeIndexRelativeChild relative_child_index =
           OctreeIndex::computeRelativeChildIndex(morton_code, parent_height);
       value = Transform::backwardSingleChild(
-          {value, current_chunk->nodeData(relative_node_index)},
+          value, current_chunk->nodeData(relative_node_index),
           relative_child_index);
       // If we've reached the requested resolution or there are no remaining
       // higher resolution details, return
@@ -61,11 +61,10 @@ inline bool HashedChunkedWaveletOctree::hasBlock(
 
 inline HashedChunkedWaveletOctree::Block&
 HashedChunkedWaveletOctree::getOrAllocateBlock(const Index3D& block_index) {
-  if (!hasBlock(block_index)) {
-    blocks_.try_emplace(block_index, config_.tree_height, config_.min_log_odds,
-                        config_.max_log_odds);
-  }
-  return blocks_.at(block_index);
+  return blocks_
+      .try_emplace(block_index, config_.tree_height, config_.min_log_odds,
+                   config_.max_log_odds)
+      .first->second;
 }
 
 inline HashedChunkedWaveletOctree::Block& HashedChunkedWaveletOctree::getBlock(
@@ -26,7 +26,7 @@ inline FloatingPoint HashedWaveletOctreeBlock::getCellValue(
        --parent_height) {
     const NdtreeIndexRelativeChild child_index =
         OctreeIndex::computeRelativeChildIndex(morton_code, parent_height);
-    value = Transform::backwardSingleChild({value, node->data()}, child_index);
+    value = Transform::backwardSingleChild(value, node->data(), child_index);
     if (!node->hasChild(child_index)) {
       break;
     }
@@ -57,7 +57,7 @@ inline FloatingPoint WaveletOctree::getCellValue(
        internal_index.height < parent_height; --parent_height) {
     const NdtreeIndexRelativeChild child_index =
         OctreeIndex::computeRelativeChildIndex(morton_code, parent_height);
-    value = Transform::backwardSingleChild({value, node->data()}, child_index);
+    value = Transform::backwardSingleChild(value, node->data(), child_index);
     if (!node->hasChild(child_index)) {
       break;
     }
@@ -87,7 +87,7 @@ inline void WaveletOctree::setCellValue(const OctreeIndex& index,
         OctreeIndex::computeRelativeChildIndex(morton_code, parent_height);
     NodeType* current_parent = node_ptrs.back();
     current_value = Transform::backwardSingleChild(
-        {current_value, current_parent->data()}, child_index);
+        current_value, current_parent->data(), child_index);
     if (!current_parent->hasChild(child_index)) {
       current_parent->allocateChild(child_index);
     }
@@ -0,0 +1,46 @@
+#ifndef WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_NODE_UPDATE_H_
+#define WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_NODE_UPDATE_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "wavemap/common.h"
+#include "wavemap/indexing/index_conversions.h"
+#include "wavemap/indexing/ndtree_index.h"
+
+namespace wavemap {
+/**
+ * Additive update to the value of an octree node, as used by the bulk update
+ * methods of the hashed wavelet octrees and their blocks.
+ */
+struct NodeUpdate {
+  OctreeIndex index;
+  FloatingPoint update;
+};
+using NodeUpdateList = std::vector<NodeUpdate>;
+
+// Order in which the bulk update methods expect node updates: by the Morton
+// codes of their indices and, for nodes that share the same min corner, from
+// coarse to fine
+inline bool isInBulkUpdateOrder(const NodeUpdate& lhs, const NodeUpdate& rhs) {
+  const MortonIndex lhs_morton = convert::nodeIndexToMorton(lhs.index);
+  const MortonIndex rhs_morton = convert::nodeIndexToMorton(rhs.index);
+  if (lhs_morton != rhs_morton) {
+    return lhs_morton < rhs_morton;
+  }
+  return rhs.index.height < lhs.index.height;
+}
+
+// Sort the given node updates into bulk update order
+// NOTE: The sort is stable, s.t. multiple updates to the same node are summed
+//       in the order in which they were generated.
+// NOTE: Morton codes only preserve the spatial ordering of nodes with
+//       non-negative positions. The updates should therefore be expressed in
+//       block-local coordinates before sorting them.
+inline void sortNodeUpdates(NodeUpdateList& node_updates) {
+  std::stable_sort(node_updates.begin(), node_updates.end(),
+                   isInBulkUpdateOrder);
+}
+}  // namespace wavemap
+
+#endif  // WAVEMAP_DATA_STRUCTURE_VOLUMETRIC_NODE_UPDATE_H_
@@ -20,6 +20,32 @@ struct IndexHash {
 using Index2DHash = IndexHash<2>;
 using Index3DHash = IndexHash<3>;
 
+// Hash that packs the index's coordinates into a 64 bit key and then scrambles
+// it with a single 64x64->128 bit multiplication, folding the high and low
+// halves of the product together. Unlike for IndexHash, the hashes of
+// neighboring indices are uncorrelated in all their bits, which is required by
+// open addressing hash tables that derive the slot and tag bits from it.
+// NOTE: Each coordinate keeps its lowest 64 / dim bits, so the key is unique
+//       for all indices that are representable by the map's Morton codes.
+template <int dim>
+struct ScrambledIndexHash {
+  static constexpr int kBitsPerCoordinate = 64 / dim;
+  static constexpr uint64_t kCoordinateMask =
+      (uint64_t{1} << kBitsPerCoordinate) - 1u;
+
+  size_t operator()(const Index<dim>& index) const {
+    uint64_t key = 0u;
+    for (int dim_idx = 0; dim_idx < dim; ++dim_idx) {
+      key = (key << kBitsPerCoordinate) |
+            (static_cast<uint64_t>(index[dim_idx]) & kCoordinateMask);
+    }
+    const __uint128_t product =
+        static_cast<__uint128_t>(key) * 0x9e3779b97f4a7c15ull;
+    return static_cast<uint64_t>(product) ^
+           static_cast<uint64_t>(product >> 64);
+  }
+};
+
 template <int dim>
 struct NdtreeIndexHash {
   static constexpr auto coefficients =
@@ -37,6 +37,11 @@ class IntegratorBase {
 
   virtual void integratePointcloud(const PosedPointcloud<>& pointcloud) = 0;
 
+  //! Whether the integrator only modifies the map while holding the map's
+  //! block locks, s.t. other threads can safely maintain the map concurrently
+  //! (e.g. threshold or prune it) through the same locks.
+  virtual bool locksMapBlocks() const { return false; }
+
  protected:
   static bool isPointcloudValid(const PosedPointcloud<>& pointcloud);
   static bool isMeasurementValid(const Point3D& C_end_point);
@@ -24,6 +24,23 @@ struct ApproximateGaussianDistribution {
       return 1.f;
     }
   }
+
+  // Branchless version of cumulative(t), which evaluates all cases and selects
+  // the applicable one s.t. loops that call it can be vectorized
+  static FloatingPoint cumulativeBranchless(FloatingPoint t) {
+    const FloatingPoint t_plus_three = t + 3.f;
+    const FloatingPoint three_min_t = 3.f - t;
+    const FloatingPoint lower_tail =
+        (1.f / 48.f) * t_plus_three * t_plus_three * t_plus_three;
+    const FloatingPoint center =
+        (1.f / 2.f) + (1.f / 24.f) * t * t_plus_three * three_min_t;
+    const FloatingPoint upper_tail =
+        1.f - (1.f / 48.f) * three_min_t * three_min_t * three_min_t;
+    FloatingPoint result = t <= 3.f ? upper_tail : 1.f;
+    result = t < 1.f ? center : result;
+    result = t <= -1.f ? lower_tail : result;
+    return t < -3.f ? 0.f : result;
+  }
 };
 }  // namespace wavemap
 
@@ -3,12 +3,14 @@
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <utility>
 
 #include "wavemap/common.h"
 #include "wavemap/config/config_base.h"
 #include "wavemap/indexing/index_conversions.h"
 #include "wavemap/integrator/measurement_model/measurement_model_base.h"
+#include "wavemap/integrator/measurement_model/tabulated_beam_kernel.h"
 #include "wavemap/integrator/projective/update_type.h"
 #include "wavemap/utils/print/eigen.h"
 
@@ -17,7 +19,7 @@ namespace wavemap {
  * Config struct for the continuous beam measurement model.
  */
 struct ContinuousBeamConfig
-    : ConfigBase<ContinuousBeamConfig, 5, BeamSelectorType> {
+    : ConfigBase<ContinuousBeamConfig, 6, BeamSelectorType> {
   //! Uncertainty along the angle axis.
   Radians<FloatingPoint> angle_sigma = 0.f;
   //! Uncertainty along the range axis.
@@ -35,6 +37,15 @@ struct ContinuousBeamConfig
   //! update.
   BeamSelectorType beam_selector_type = BeamSelectorType::kAllNeighbors;
 
+  //! Maximum error, in log-odds, that may be introduced to speed up the
+  //! computation of each beam's update. If set to zero, the updates are
+  //! computed with the reference kernel. Otherwise, updates that are computed
+  //! one by one are interpolated from lookup tables whose resolution is chosen
+  //! to respect this bound, trading accuracy for throughput on computationally
+  //! constrained platforms. Batched updates always use the vectorized
+  //! reference kernel, which is faster than the lookup tables.
+  FloatingPoint max_kernel_error = 0.f;
+
   static MemberMap memberMap;
 
   // Constructors
@@ -50,7 +61,7 @@ struct ContinuousBeamConfig
   bool isValid(bool verbose) const override;
 };
 
-class ContinuousBeam : public MeasurementModelBase {
+class ContinuousBeam final : public MeasurementModelBase {
  public:
   explicit ContinuousBeam(const ContinuousBeamConfig& config,
                           ProjectorBase::ConstPtr projection_model,
@@ -65,6 +76,7 @@ class ContinuousBeam : public MeasurementModelBase {
   }
 
   const ContinuousBeamConfig& getConfig() const { return config_; }
+  bool usesTabulatedKernel() const { return tabulated_kernel_.has_value(); }
   FloatingPoint getPaddingAngle() const override { return angle_threshold_; }
   FloatingPoint getPaddingSurfaceFront() const override {
     return range_threshold_front;
@@ -75,10 +87,27 @@ class ContinuousBeam : public MeasurementModelBase {
 
   FloatingPoint computeWorstCaseApproximationError(
       UpdateType update_type, FloatingPoint cell_to_sensor_distance,
-      FloatingPoint cell_bounding_radius) const override;
+      FloatingPoint cell_bounding_radius) const final;
+
+  FloatingPoint computeUpdate(
+      const SensorCoordinates& sensor_coordinates) const final {
+    return computeUpdate<ProjectorBase>(sensor_coordinates);
+  }
+  void computeUpdateBatch(
+      const ProjectorBase::SensorCoordinatesBatch& sensor_coordinates,
+      UpdateBatch& updates) const final {
+    computeUpdateBatch<ProjectorBase>(sensor_coordinates, updates);
+  }
 
+  // Versions of computeUpdate(Batch) that call the methods of the projection
+  // model as ProjectorT, s.t. they can be inlined if ProjectorT is final
+  template <typename ProjectorT>
   FloatingPoint computeUpdate(
-      const SensorCoordinates& sensor_coordinates) const override;
+      const SensorCoordinates& sensor_coordinates) const;
+  template <typename ProjectorT>
+  void computeUpdateBatch(
+      const ProjectorBase::SensorCoordinatesBatch& sensor_coordinates,
+      UpdateBatch& updates) const;
 
  private:
   const ContinuousBeamConfig config_;
@@ -96,15 +125,28 @@ class ContinuousBeam : public MeasurementModelBase {
   //       the assumed 'ground truth' surface thickness is 3 sigma, and the
   //       angular/range uncertainty extends the non-zero regions with another 3
   //       sigma.
+  const FloatingPoint angle_sigma_squared_inv_ =
+      1.f / (config_.angle_sigma * config_.angle_sigma);
+  const FloatingPoint range_sigma_inv_ = 1.f / config_.range_sigma;
+
+  // Approximation of computeBeamUpdate(...), used if max_kernel_error is set
+  const std::optional<TabulatedBeamKernel> tabulated_kernel_ =
+      0.f < config_.max_kernel_error
+          ? std::optional<TabulatedBeamKernel>(
+                std::in_place, config_.scaling_free, config_.scaling_occupied,
+                config_.max_kernel_error)
+          : std::nullopt;
 
   // Compute the measurement update for a neighborhood in the range image
+  template <typename ProjectorT>
   FloatingPoint computeBeamUpdateNearestNeighbor(
       const Image<>& range_image, const Image<Vector2D>& beam_offset_image,
-      const ProjectorBase& projection_model,
+      const ProjectorT& projection_model,
       const SensorCoordinates& sensor_coordinates) const;
+  template <typename ProjectorT>
   FloatingPoint computeBeamUpdateAllNeighbors(
       const Image<>& range_image, const Image<Vector2D>& beam_offset_image,
-      const ProjectorBase& projection_model,
+      const ProjectorT& projection_model,
       const SensorCoordinates& sensor_coordinates) const;
 
   // Compute the measurement update for a single beam
@@ -112,6 +154,12 @@ class ContinuousBeam : public MeasurementModelBase {
       FloatingPoint cell_to_sensor_distance,
       FloatingPoint cell_to_beam_image_error_norm_squared,
       FloatingPoint measured_distance) const;
+  // Compute the measurement updates for many beams at once
+  using BeamBatch = Eigen::Array<FloatingPoint, 4, ProjectorBase::kBatchSize>;
+  BeamBatch computeBeamUpdateBatch(
+      const BeamBatch& cell_to_sensor_distances,
+      const BeamBatch& cell_to_beam_image_error_norms_squared,
+      const BeamBatch& measured_distances) const;
 };
 }  // namespace wavemap
 
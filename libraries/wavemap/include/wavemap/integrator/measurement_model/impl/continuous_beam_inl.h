@@ -30,25 +30,89 @@ inline FloatingPoint ContinuousBeam::computeWorstCaseApproximationError(
   return std::max(worst_angular_error, worst_dz_error);
 }
 
+template <typename ProjectorT>
 inline FloatingPoint ContinuousBeam::computeUpdate(
     const SensorCoordinates& sensor_coordinates) const {
+  DCHECK(dynamic_cast<const ProjectorT*>(projection_model_.get()) != nullptr);
+  const auto& projection_model =
+      static_cast<const ProjectorT&>(*projection_model_);
   switch (config_.beam_selector_type.toTypeId()) {
     case BeamSelectorType::kNearestNeighbor:
       return computeBeamUpdateNearestNeighbor(
-          *range_image_, *beam_offset_image_, *projection_model_,
+          *range_image_, *beam_offset_image_, projection_model,
           sensor_coordinates);
     case BeamSelectorType::kAllNeighbors:
       return computeBeamUpdateAllNeighbors(*range_image_, *beam_offset_image_,
-                                           *projection_model_,
+                                           projection_model,
                                            sensor_coordinates);
     default:
       return 0.f;
   }
 }
 
+template <typename ProjectorT>
+inline void ContinuousBeam::computeUpdateBatch(
+    const ProjectorBase::SensorCoordinatesBatch& sensor_coordinates,
+    UpdateBatch& updates) const {
+  if (config_.beam_selector_type != BeamSelectorType::kAllNeighbors) {
+    for (int point_idx = 0; point_idx < ProjectorBase::kBatchSize;
+         ++point_idx) {
+      updates[point_idx] = computeUpdate<ProjectorT>(
+          {sensor_coordinates.image.col(point_idx),
+           sensor_coordinates.depth[point_idx]});
+    }
+    return;
+  }
+
+  DCHECK(dynamic_cast<const ProjectorT*>(projection_model_.get()) != nullptr);
+  const auto& projection_model =
+      static_cast<const ProjectorT&>(*projection_model_);
+
+  // Gather the measured distances and image errors of each point's four
+  // neighboring beams, as in computeBeamUpdateAllNeighbors
+  BeamBatch measured_distances = BeamBatch::Zero();
+  BeamBatch cell_to_beam_image_error_norms_sq;
+  constexpr bool row_major = Image<>::Data::IsRowMajor;
+  const int stride = static_cast<int>(range_image_->getData().outerStride());
+  for (int point_idx = 0; point_idx < ProjectorBase::kBatchSize; ++point_idx) {
+    const ImageCoordinates image_coordinates =
+        sensor_coordinates.image.col(point_idx);
+    auto [image_indices, cell_to_beam_offsets] =
+        projection_model.imageToNearestIndicesAndOffsets(image_coordinates);
+    for (int neighbor_idx = 0; neighbor_idx < 4; ++neighbor_idx) {
+      const auto& image_index = image_indices.col(neighbor_idx);
+      if (range_image_->isIndexWithinBounds(image_index)) {
+        const int linear_index =
+            row_major ? stride * image_index[0] + image_index[1]  // NOLINT
+                      : stride * image_index[1] + image_index[0];
+        measured_distances(neighbor_idx, point_idx) =
+            range_image_->getData().coeff(linear_index);
+        cell_to_beam_offsets.col(neighbor_idx) -=
+            beam_offset_image_->getData().coeffRef(linear_index);
+      }
+    }
+    const auto error_norms_sq =
+        projection_model.imageOffsetsToErrorSquaredNorms(image_coordinates,
+                                                         cell_to_beam_offsets);
+    cell_to_beam_image_error_norms_sq.col(point_idx) =
+        Eigen::Map<const Eigen::Array<FloatingPoint, 4, 1>>(
+            error_norms_sq.data());
+  }
+
+  // Evaluate the beam model for all neighbors of all points at once
+  const BeamBatch cell_to_sensor_distances =
+      sensor_coordinates.depth.replicate<4, 1>();
+  updates = computeBeamUpdateBatch(cell_to_sensor_distances,
+                                   cell_to_beam_image_error_norms_sq,
+                                   measured_distances)
+                .colwise()
+                .sum();
+}
+
+template <typename ProjectorT>
 inline FloatingPoint ContinuousBeam::computeBeamUpdateNearestNeighbor(
     const Image<>& range_image, const Image<Vector2D>& beam_offset_image,
-    const ProjectorBase& projection_model,
+    const ProjectorT& projection_model,
     const SensorCoordinates& sensor_coordinates) const {
   // Get the measured distance and cell to beam offset
   const auto [image_index, cell_offset] =
@@ -72,9 +136,10 @@ inline FloatingPoint ContinuousBeam::computeBeamUpdateNearestNeighbor(
                            measured_distance);
 }
 
+template <typename ProjectorT>
 inline FloatingPoint ContinuousBeam::computeBeamUpdateAllNeighbors(
     const Image<>& range_image, const Image<Vector2D>& beam_offset_image,
-    const ProjectorBase& projection_model,
+    const ProjectorT& projection_model,
     const SensorCoordinates& sensor_coordinates) const {
   // Get the measured distances and cell to beam offsets
   std::array<FloatingPoint, 4> measured_distances{};
@@ -124,6 +189,12 @@ inline FloatingPoint ContinuousBeam::computeBeamUpdate(
     return 0.f;
   }
 
+  if (tabulated_kernel_) {
+    return tabulated_kernel_->computeBeamUpdate(
+        cell_to_beam_image_error_norm_squared * angle_sigma_squared_inv_,
+        (cell_to_sensor_distance - measured_distance) * range_sigma_inv_);
+  }
+
   const FloatingPoint g =
       std::sqrt(cell_to_beam_image_error_norm_squared) / config_.angle_sigma;
   // NOTE: As derived in our paper, angle_contrib = C(g + 3.f) - C(g - 3.f)
@@ -155,6 +226,79 @@ inline FloatingPoint ContinuousBeam::computeBeamUpdate(
   DCHECK(!std::isnan(log_odds) && std::isfinite(log_odds));
   return log_odds;
 }
+
+inline ContinuousBeam::BeamBatch ContinuousBeam::computeBeamUpdateBatch(
+    const BeamBatch& cell_to_sensor_distances,
+    const BeamBatch& cell_to_beam_image_error_norms_squared,
+    const BeamBatch& measured_distances) const {
+  // NOTE: This follows the same steps as computeBeamUpdate, but evaluates all
+  //       branches and then selects the applicable results s.t. the loop can
+  //       be vectorized. Beams in unknown space get a probability of 0.5,
+  //       which corresponds to a log odds update of 0. The square roots and
+  //       logarithms are evaluated with Eigen's packet math. Since this
+  //       outperforms gathering values from lookup tables, the tabulated
+  //       kernel is only used for updates that are computed one by one.
+  // NOTE: The batch is processed in segments of 8 beams, which Eigen evaluates
+  //       with AVX packets. Evaluating the whole batch at once would use
+  //       AVX-512 packets on hosts that support them, whose intrinsics trigger
+  //       spurious -Wuninitialized warnings with GCC 12.
+  constexpr int kSegmentSize = 8;
+  using BeamSegment = Eigen::Array<FloatingPoint, kSegmentSize, 1>;
+  static_assert(BeamBatch::SizeAtCompileTime % kSegmentSize == 0);
+  BeamBatch log_odds;
+  for (int segment_start = 0; segment_start < BeamBatch::SizeAtCompileTime;
+       segment_start += kSegmentSize) {
+    const BeamSegment gs =
+        BeamSegment::Map(cell_to_beam_image_error_norms_squared.data() +
+                         segment_start)
+            .sqrt() /
+        config_.angle_sigma;
+    BeamSegment odds;
+    for (int segment_idx = 0; segment_idx < kSegmentSize; ++segment_idx) {
+      const int beam_idx = segment_start + segment_idx;
+      const FloatingPoint cell_to_sensor_distance =
+          cell_to_sensor_distances(beam_idx);
+      const FloatingPoint cell_to_beam_image_error_norm_squared =
+          cell_to_beam_image_error_norms_squared(beam_idx);
+      const FloatingPoint measured_distance = measured_distances(beam_idx);
+
+      const bool fully_in_unknown_space =
+          (angle_threshold_squared < cell_to_beam_image_error_norm_squared) |
+          (measured_distance + range_threshold_back_ < cell_to_sensor_distance);
+
+      const FloatingPoint angle_contrib =
+          1.f - ApproximateGaussianDistribution::cumulativeBranchless(
+                    gs(segment_idx) - 3.f);
+
+      const bool fully_in_free_space =
+          cell_to_sensor_distance < measured_distance - range_threshold_front;
+      constexpr FloatingPoint kFreeSpaceRangeContrib = -0.5f;
+      const FloatingPoint f =
+          (cell_to_sensor_distance - measured_distance) / config_.range_sigma;
+      const FloatingPoint surface_range_contrib =
+          ApproximateGaussianDistribution::cumulativeBranchless(f) -
+          0.5f *
+              ApproximateGaussianDistribution::cumulativeBranchless(f - 3.f) -
+          0.5f;
+      const FloatingPoint range_contrib =
+          fully_in_free_space ? kFreeSpaceRangeContrib : surface_range_contrib;
+
+      // NOTE: Since the angle_contrib is non-negative, contribs can only be
+      //       positive outside of free space. Checking its sign alone therefore
+      //       selects the same scaling as in computeBeamUpdate.
+      const FloatingPoint contribs = range_contrib * angle_contrib;
+      const FloatingPoint scaling =
+          contribs < 0.f ? config_.scaling_free : config_.scaling_occupied;
+      const FloatingPoint scaled_contribs = scaling * contribs;
+
+      const FloatingPoint p =
+          fully_in_unknown_space ? 0.5f : scaled_contribs + 0.5f;
+      odds(segment_idx) = p / (1.f - p);
+    }
+    BeamSegment::Map(log_odds.data() + segment_start) = odds.log();
+  }
+  return log_odds;
+}
 }  // namespace wavemap
 
 #endif  // WAVEMAP_INTEGRATOR_MEASUREMENT_MODEL_IMPL_CONTINUOUS_BEAM_INL_H_
@@ -44,6 +44,39 @@ class MeasurementModelBase {
 
   virtual FloatingPoint computeUpdate(
       const SensorCoordinates& sensor_coordinates) const = 0;
+
+  // Batched version of computeUpdate, evaluating the update for each point in
+  // the batch
+  // NOTE: The default implementation evaluates the updates one by one. Derived
+  //       classes can override it with a vectorized version.
+  using UpdateBatch = Eigen::Array<FloatingPoint, 1, ProjectorBase::kBatchSize>;
+  virtual void computeUpdateBatch(
+      const ProjectorBase::SensorCoordinatesBatch& sensor_coordinates,
+      UpdateBatch& updates) const {
+    for (int point_idx = 0; point_idx < ProjectorBase::kBatchSize;
+         ++point_idx) {
+      updates[point_idx] =
+          computeUpdate({sensor_coordinates.image.col(point_idx),
+                         sensor_coordinates.depth[point_idx]});
+    }
+  }
+
+  // Versions of computeUpdate(Batch) for callers that know the type of the
+  // projection model the measurement model was created with
+  // NOTE: These forward to the virtual methods by default. Measurement models
+  //       that query the projection model can hide them with versions that call
+  //       the ProjectorT's methods directly, s.t. they can be inlined.
+  template <typename ProjectorT>
+  FloatingPoint computeUpdate(
+      const SensorCoordinates& sensor_coordinates) const {
+    return computeUpdate(sensor_coordinates);
+  }
+  template <typename ProjectorT>
+  void computeUpdateBatch(
+      const ProjectorBase::SensorCoordinatesBatch& sensor_coordinates,
+      UpdateBatch& updates) const {
+    computeUpdateBatch(sensor_coordinates, updates);
+  }
 };
 }  // namespace wavemap
 
@@ -0,0 +1,51 @@
+#ifndef WAVEMAP_INTEGRATOR_MEASUREMENT_MODEL_TABULATED_BEAM_KERNEL_H_
+#define WAVEMAP_INTEGRATOR_MEASUREMENT_MODEL_TABULATED_BEAM_KERNEL_H_
+
+#include "wavemap/common.h"
+#include "wavemap/utils/math/lookup_table.h"
+
+namespace wavemap {
+/**
+ * Approximation of the ContinuousBeam model's per-beam update, which replaces
+ * the square root, approximate Gaussian CDFs and logarithm evaluated by the
+ * reference kernel with lookups in small, linearly interpolated tables. The
+ * tables' resolutions are chosen s.t. the error of the resulting log-odds
+ * updates w.r.t. the reference kernel stays below the requested bound.
+ */
+class TabulatedBeamKernel {
+ public:
+  TabulatedBeamKernel(FloatingPoint scaling_free,
+                      FloatingPoint scaling_occupied, FloatingPoint max_error);
+
+  // Compute the log-odds update for a beam, given the squared angular error
+  // normalized by the angle sigma squared and the range error normalized by
+  // the range sigma
+  // NOTE: Both inputs are clamped to the model's support, s.t. cells that are
+  //       fully in free or unknown space are handled without branching.
+  FloatingPoint computeBeamUpdate(FloatingPoint normalized_angle_error_squared,
+                                  FloatingPoint normalized_range_error) const {
+    const FloatingPoint contribs =
+        range_contrib_table_(normalized_range_error) *
+        angle_contrib_table_(normalized_angle_error_squared);
+    return contribs < 0.f ? free_log_odds_table_(contribs)
+                          : occupied_log_odds_table_(contribs);
+  }
+
+  // Upper bound on the error of computeBeamUpdate(...), based on the
+  // interpolation errors measured while building the tables
+  FloatingPoint getWorstCaseError() const { return worst_case_error_; }
+
+ private:
+  // Tables of the model's angle and range contributions, and of the log-odds
+  // update as a function of their product, for cells in front of and behind
+  // the surface respectively
+  const LookupTable angle_contrib_table_;
+  const LookupTable range_contrib_table_;
+  const LookupTable free_log_odds_table_;
+  const LookupTable occupied_log_odds_table_;
+
+  FloatingPoint worst_case_error_ = 0.f;
+};
+}  // namespace wavemap
+
+#endif  // WAVEMAP_INTEGRATOR_MEASUREMENT_MODEL_TABULATED_BEAM_KERNEL_H_
@@ -20,6 +20,30 @@ inline SensorCoordinates OusterProjector::cartesianToSensor(
   return {{elevation_angle, azimuth_angle}, range};
 }
 
+inline void OusterProjector::cartesianToSensorBatch(
+    const CartesianBatch& C_points,
+    SensorCoordinatesBatch& sensor_coordinates) const {
+  // Project the beams' endpoints into their 2D planes B, as in
+  // cartesianToSensor, for all points in the batch at once
+  // NOTE: The square roots are evaluated with Eigen's packet math and the
+  //       remaining loop is branchless, s.t. all steps are vectorized.
+  const auto C_x = C_points.row(0).array();
+  const auto C_y = C_points.row(1).array();
+  const auto C_z = C_points.row(2).array();
+  const Eigen::Array<FloatingPoint, 1, kBatchSize> B_x =
+      (C_x.square() + C_y.square()).sqrt() -
+      config_.lidar_origin_to_beam_origin;
+  const Eigen::Array<FloatingPoint, 1, kBatchSize> B_y =
+      C_z - config_.lidar_origin_to_sensor_origin_z_offset;
+  for (int point_idx = 0; point_idx < kBatchSize; ++point_idx) {
+    sensor_coordinates.image(0, point_idx) =
+        approximate::atan2()(B_y[point_idx], B_x[point_idx]);
+    sensor_coordinates.image(1, point_idx) =
+        approximate::atan2()(C_y[point_idx], C_x[point_idx]);
+  }
+  sensor_coordinates.depth = (B_x.square() + B_y.square()).sqrt();
+}
+
 inline Point3D OusterProjector::sensorToCartesian(
     const SensorCoordinates& coordinates) const {
   const FloatingPoint elevation_angle = coordinates.image[0];
@@ -4,6 +4,16 @@
 #include <utility>
 
 namespace wavemap {
+inline void ProjectorBase::cartesianToSensorBatch(
+    const CartesianBatch& C_points,
+    SensorCoordinatesBatch& sensor_coordinates) const {
+  for (int point_idx = 0; point_idx < kBatchSize; ++point_idx) {
+    const auto [image, depth] = cartesianToSensor(C_points.col(point_idx));
+    sensor_coordinates.image.col(point_idx) = image;
+    sensor_coordinates.depth[point_idx] = depth;
+  }
+}
+
 inline Index2D ProjectorBase::imageToNearestIndex(
     const ImageCoordinates& image_coordinates) const {
   return imageToIndexReal(image_coordinates)
@@ -13,6 +13,26 @@ inline SensorCoordinates SphericalProjector::cartesianToSensor(
   return {std::move(image_coordinates), range};
 }
 
+inline void SphericalProjector::cartesianToSensorBatch(
+    const CartesianBatch& C_points,
+    SensorCoordinatesBatch& sensor_coordinates) const {
+  // NOTE: The square roots are evaluated with Eigen's packet math and the
+  //       remaining loop is branchless, s.t. all steps are vectorized.
+  const auto C_x = C_points.row(0).array();
+  const auto C_y = C_points.row(1).array();
+  const auto C_z = C_points.row(2).array();
+  const Eigen::Array<FloatingPoint, 1, kBatchSize> C_xy_norm =
+      (C_x.square() + C_y.square()).sqrt();
+  for (int point_idx = 0; point_idx < kBatchSize; ++point_idx) {
+    sensor_coordinates.image(0, point_idx) =
+        approximate::atan2()(C_z[point_idx], C_xy_norm[point_idx]);
+    sensor_coordinates.image(1, point_idx) =
+        approximate::atan2()(C_y[point_idx], C_x[point_idx]);
+  }
+  sensor_coordinates.depth =
+      (C_x.square() + C_y.square() + C_z.square()).sqrt();
+}
+
 inline Point3D SphericalProjector::sensorToCartesian(
     const SensorCoordinates& coordinates) const {
   const FloatingPoint elevation_angle = coordinates.image[0];
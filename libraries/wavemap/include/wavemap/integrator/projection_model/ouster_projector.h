@@ -44,7 +44,7 @@ struct OusterProjectorConfig
   bool isValid(bool verbose) const override;
 };
 
-class OusterProjector : public ProjectorBase {
+class OusterProjector final : public ProjectorBase {
  public:
   using Config = OusterProjectorConfig;
 
@@ -58,6 +58,9 @@ class OusterProjector : public ProjectorBase {
 
   // Coordinate transforms between Cartesian and sensor space
   SensorCoordinates cartesianToSensor(const Point3D& C_point) const final;
+  void cartesianToSensorBatch(
+      const CartesianBatch& C_points,
+      SensorCoordinatesBatch& sensor_coordinates) const final;
   Point3D sensorToCartesian(const SensorCoordinates& coordinates) const final;
   FloatingPoint imageOffsetToErrorSquaredNorm(
       const ImageCoordinates& linearization_point,
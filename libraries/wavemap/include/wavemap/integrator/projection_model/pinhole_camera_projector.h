@@ -41,7 +41,7 @@ struct PinholeCameraProjectorConfig
   bool isValid(bool verbose) const override;
 };
 
-class PinholeCameraProjector : public ProjectorBase {
+class PinholeCameraProjector final : public ProjectorBase {
  public:
   using Config = PinholeCameraProjectorConfig;
 
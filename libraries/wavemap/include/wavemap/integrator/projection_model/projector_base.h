@@ -54,6 +54,21 @@ class ProjectorBase {
 
   // Coordinate transforms between Cartesian and sensor space
   virtual SensorCoordinates cartesianToSensor(const Point3D& C_point) const = 0;
+  // Batched version of cartesianToSensor, converting each column of C_points
+  // NOTE: The batches are stored row-major, s.t. each coordinate can be
+  //       processed for all points at once using SIMD instructions. The default
+  //       implementation converts the points one by one, derived classes can
+  //       override it with a vectorized version.
+  static constexpr int kBatchSize = 8;
+  using CartesianBatch =
+      Eigen::Matrix<FloatingPoint, 3, kBatchSize, Eigen::RowMajor>;
+  struct SensorCoordinatesBatch {
+    Eigen::Array<FloatingPoint, 2, kBatchSize, Eigen::RowMajor> image;
+    Eigen::Array<FloatingPoint, 1, kBatchSize> depth;
+  };
+  virtual void cartesianToSensorBatch(
+      const CartesianBatch& C_points,
+      SensorCoordinatesBatch& sensor_coordinates) const;
   virtual Point3D sensorToCartesian(
       const SensorCoordinates& coordinates) const = 0;
   Point3D sensorToCartesian(const ImageCoordinates& image_coordinates,
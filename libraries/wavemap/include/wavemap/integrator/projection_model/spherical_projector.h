@@ -30,7 +30,7 @@ struct SphericalProjectorConfig
   bool isValid(bool verbose) const override;
 };
 
-class SphericalProjector : public ProjectorBase {
+class SphericalProjector final : public ProjectorBase {
  public:
   using Config = SphericalProjectorConfig;
 
@@ -44,6 +44,9 @@ class SphericalProjector : public ProjectorBase {
 
   // Coordinate transforms between Cartesian and sensor space
   SensorCoordinates cartesianToSensor(const Point3D& C_point) const final;
+  void cartesianToSensorBatch(
+      const CartesianBatch& C_points,
+      SensorCoordinatesBatch& sensor_coordinates) const final;
   Point3D sensorToCartesian(const SensorCoordinates& coordinates) const final;
   FloatingPoint imageOffsetToErrorSquaredNorm(
       const ImageCoordinates& linearization_point,
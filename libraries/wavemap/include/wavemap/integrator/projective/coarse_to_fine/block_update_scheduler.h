@@ -0,0 +1,97 @@
+#ifndef WAVEMAP_INTEGRATOR_PROJECTIVE_COARSE_TO_FINE_BLOCK_UPDATE_SCHEDULER_H_
+#define WAVEMAP_INTEGRATOR_PROJECTIVE_COARSE_TO_FINE_BLOCK_UPDATE_SCHEDULER_H_
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "wavemap/common.h"
+#include "wavemap/data_structure/aabb.h"
+#include "wavemap/indexing/ndtree_index.h"
+#include "wavemap/integrator/projection_model/projector_base.h"
+
+namespace wavemap {
+/**
+ * Groups the blocks that are updated by a measurement into tasks of nearby
+ * blocks, s.t. the blocks that are updated by the same worker read mostly the
+ * same parts of the range and beam offset images.
+ *
+ * The blocks are first sorted along a Morton (Z-order) curve, which places
+ * spatially close blocks next to each other. The sorted list is then split
+ * greedily into tasks whose estimated working set, i.e. the image region the
+ * task's blocks project onto and the blocks themselves, fits in a worker's L2
+ * cache. The tasks are also kept small enough to balance the load over all
+ * workers.
+ */
+class BlockUpdateScheduler {
+ public:
+  // Half-open range [first, last) of blocks in the sorted block list
+  using Task = std::pair<size_t, size_t>;
+
+  // Rough estimate of the memory touched when updating one block
+  static constexpr size_t kDefaultBlockWorkingSetSize = 16 * 1024;
+  // Minimum number of tasks per worker, to keep the workers balanced
+  static constexpr size_t kMinNumTasksPerWorker = 4;
+
+  // NOTE: If locality_aware is false, schedule() keeps the blocks in their
+  //       original order and creates one task per block.
+  BlockUpdateScheduler(
+      bool locality_aware, ProjectorBase::ConstPtr projection_model,
+      FloatingPoint min_cell_width, IndexElement tree_height,
+      size_t num_workers,
+      size_t block_working_set_size = kDefaultBlockWorkingSetSize)
+      : locality_aware_(locality_aware),
+        projection_model_(std::move(projection_model)),
+        min_cell_width_(min_cell_width),
+        tree_height_(tree_height),
+        num_workers_(std::max(num_workers, size_t{1})),
+        block_working_set_size_(block_working_set_size) {}
+
+  // Reorder the blocks in place and split them into tasks, for a measurement
+  // taken from the sensor pose given by R_C_W and t_W_C
+  // NOTE: The blocks can be given as block indices (Index3D) or as the
+  //       indices of the blocks' root nodes (OctreeIndex).
+  template <typename BlockIndexT>
+  std::vector<Task> schedule(std::vector<BlockIndexT>& blocks,
+                             const Transformation3D::RotationMatrix& R_C_W,
+                             const Point3D& t_W_C) const;
+
+  bool isLocalityAware() const { return locality_aware_; }
+  size_t getMaxTaskWorkingSetSize() const { return max_task_working_set_size_; }
+
+  // Size of the current CPU's L2 cache in bytes, or a conservative default if
+  // it can not be determined
+  static size_t getL2CacheSize();
+
+ private:
+  const bool locality_aware_;
+  const ProjectorBase::ConstPtr projection_model_;
+  const FloatingPoint min_cell_width_;
+  const IndexElement tree_height_;
+  const size_t num_workers_;
+  const size_t block_working_set_size_;
+  const size_t max_task_working_set_size_ = getL2CacheSize();
+
+  // Range and beam offset image bytes read per pixel
+  static constexpr size_t kBytesPerPixel =
+      sizeof(FloatingPoint) + sizeof(Vector2D);
+
+  static const Index3D& getBlockPosition(const Index3D& block_index) {
+    return block_index;
+  }
+  static const Index3D& getBlockPosition(const OctreeIndex& block_node_index) {
+    return block_node_index.position;
+  }
+
+  // Image-space footprint of a block, as an inclusive range of image indices
+  AABB<Index2D> getImageFootprint(
+      const Index3D& block_index,
+      const Transformation3D::RotationMatrix& R_C_W,
+      const Point3D& t_W_C) const;
+};
+}  // namespace wavemap
+
+#include "wavemap/integrator/projective/coarse_to_fine/impl/block_update_scheduler_inl.h"
+
+#endif  // WAVEMAP_INTEGRATOR_PROJECTIVE_COARSE_TO_FINE_BLOCK_UPDATE_SCHEDULER_H_
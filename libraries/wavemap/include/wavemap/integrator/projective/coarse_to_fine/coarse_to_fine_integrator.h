@@ -32,6 +32,7 @@ class CoarseToFineIntegrator : public ProjectiveIntegrator {
   static constexpr auto kUnitCubeHalfDiagonal =
       constants<FloatingPoint>::kSqrt3 / 2.f;
 
+  void prepareMapUpdate() override;
   void updateMap() override;
 };
 }  // namespace wavemap
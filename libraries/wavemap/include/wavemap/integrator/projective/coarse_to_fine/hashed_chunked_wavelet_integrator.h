@@ -7,6 +7,7 @@
 
 #include "wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h"
 #include "wavemap/data_structure/volumetric/volumetric_data_structure_base.h"
+#include "wavemap/integrator/projective/coarse_to_fine/block_update_scheduler.h"
 #include "wavemap/integrator/projective/coarse_to_fine/range_image_intersector.h"
 #include "wavemap/integrator/projective/projective_integrator.h"
 #include "wavemap/utils/thread_pool.h"
@@ -29,6 +30,8 @@ class HashedChunkedWaveletIntegrator : public ProjectiveIntegrator {
         thread_pool_(thread_pool ? std::move(thread_pool)
                                  : std::make_shared<ThreadPool>()) {}
 
+  bool locksMapBlocks() const override { return true; }
+
  private:
   using BlockList = std::vector<HashedChunkedWaveletOctree::BlockIndex>;
 
@@ -50,25 +53,78 @@ class HashedChunkedWaveletIntegrator : public ProjectiveIntegrator {
   const IndexElement tree_height_ = occupancy_map_->getTreeHeight();
   const IndexElement chunk_height_ = occupancy_map_->getChunkHeight();
 
+  // Groups the blocks into tasks of nearby blocks, to improve cache locality
+  const BlockUpdateScheduler block_update_scheduler_{
+      config_.locality_aware_block_scheduling, projection_model_,
+      min_cell_width_, tree_height_, thread_pool_->size()};
+
   std::pair<OctreeIndex, OctreeIndex> getFovMinMaxIndices(
       const Point3D& sensor_origin) const;
+  // Select the blocks that need updating, testing the FOV in parallel
+  BlockList selectBlocksToUpdate() const;
   void recursiveTester(const OctreeIndex& node_index,
-                       BlockList& update_job_list);
+                       BlockList& update_job_list) const;
 
+  void prepareMapUpdate() override;
   void updateMap() override;
-  void updateBlock(HashedChunkedWaveletOctree::Block& block,
-                   const HashedChunkedWaveletOctree::BlockIndex& block_index);
 
+ protected:
+  // Update a block through the generic (virtual) projection and measurement
+  // model interfaces, derived classes can override it to use specialized ones
+  virtual void updateBlock(
+      HashedChunkedWaveletOctree::Block& block,
+      const HashedChunkedWaveletOctree::BlockIndex& block_index);
+  // Block update kernel that calls the models' methods as ProjectorT and
+  // MeasurementModelT, s.t. they can be inlined if these types are final
+  template <typename ProjectorT, typename MeasurementModelT>
+  void updateBlockImpl(
+      HashedChunkedWaveletOctree::Block& block,
+      const HashedChunkedWaveletOctree::BlockIndex& block_index);
+
+ private:
+  template <typename ProjectorT, typename MeasurementModelT>
   void updateNodeRecursive(
       HashedChunkedWaveletOctreeBlock::NodeChunkType& parent_chunk,
       const OctreeIndex& parent_node_index, LinearIndex parent_in_chunk_index,
       FloatingPoint& parent_value,
       HashedChunkedWaveletOctreeBlock::NodeChunkType::BitRef parent_has_child,
-      bool& block_needs_thresholding);
+      bool& block_needs_thresholding, DirtySubtreeMask& dirty_subtrees);
+  template <typename ProjectorT, typename MeasurementModelT>
   void updateLeavesBatch(
       const OctreeIndex& parent_index, FloatingPoint& parent_value,
       HashedChunkedWaveletOctreeBlock::NodeChunkType::DataType& parent_details);
 };
+
+/**
+ * Version of the HashedChunkedWaveletIntegrator whose block update kernels are
+ * specialized at compile time for the given projection and measurement model
+ * types. This removes the virtual calls from the innermost integration loops.
+ * NOTE: Specializations are only compiled for the combinations that the
+ *       IntegratorFactory creates, i.e. the ContinuousBeam measurement model
+ *       combined with the Ouster, pinhole camera or spherical projector.
+ */
+template <typename ProjectorT, typename MeasurementModelT>
+class SpecializedHashedChunkedWaveletIntegrator final
+    : public HashedChunkedWaveletIntegrator {
+ public:
+  SpecializedHashedChunkedWaveletIntegrator(
+      const ProjectiveIntegratorConfig& config,
+      std::shared_ptr<const ProjectorT> projection_model,
+      PosedImage<>::Ptr posed_range_image,
+      Image<Vector2D>::Ptr beam_offset_image,
+      std::shared_ptr<const MeasurementModelT> measurement_model,
+      HashedChunkedWaveletOctree::Ptr occupancy_map,
+      std::shared_ptr<ThreadPool> thread_pool = nullptr)
+      : HashedChunkedWaveletIntegrator(
+            config, std::move(projection_model), std::move(posed_range_image),
+            std::move(beam_offset_image), std::move(measurement_model),
+            std::move(occupancy_map), std::move(thread_pool)) {}
+
+ private:
+  void updateBlock(
+      HashedChunkedWaveletOctree::Block& block,
+      const HashedChunkedWaveletOctree::BlockIndex& block_index) override;
+};
 }  // namespace wavemap
 
 #include "wavemap/integrator/projective/coarse_to_fine/impl/hashed_chunked_wavelet_integrator_inl.h"
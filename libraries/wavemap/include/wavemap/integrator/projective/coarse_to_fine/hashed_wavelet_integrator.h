@@ -7,6 +7,7 @@
 
 #include "wavemap/data_structure/volumetric/hashed_wavelet_octree.h"
 #include "wavemap/data_structure/volumetric/volumetric_data_structure_base.h"
+#include "wavemap/integrator/projective/coarse_to_fine/block_update_scheduler.h"
 #include "wavemap/integrator/projective/coarse_to_fine/range_image_intersector.h"
 #include "wavemap/integrator/projective/projective_integrator.h"
 #include "wavemap/utils/thread_pool.h"
@@ -28,6 +29,8 @@ class HashedWaveletIntegrator : public ProjectiveIntegrator {
         thread_pool_(thread_pool ? std::move(thread_pool)
                                  : std::make_shared<ThreadPool>()) {}
 
+  bool locksMapBlocks() const override { return true; }
+
  private:
   const HashedWaveletOctree::Ptr occupancy_map_;
   const FloatingPoint min_cell_width_ = occupancy_map_->getMinCellWidth();
@@ -39,6 +42,11 @@ class HashedWaveletIntegrator : public ProjectiveIntegrator {
   const FloatingPoint max_log_odds_ = occupancy_map_->getMaxLogOdds();
   const IndexElement tree_height_ = occupancy_map_->getTreeHeight();
 
+  // Groups the blocks into tasks of nearby blocks, to improve cache locality
+  const BlockUpdateScheduler block_update_scheduler_{
+      config_.locality_aware_block_scheduling, projection_model_,
+      min_cell_width_, tree_height_, thread_pool_->size()};
+
   std::shared_ptr<RangeImageIntersector> range_image_intersector_;
   static constexpr auto kUnitCubeHalfDiagonal =
       constants<FloatingPoint>::kSqrt3 / 2.f;
@@ -47,12 +55,60 @@ class HashedWaveletIntegrator : public ProjectiveIntegrator {
       const Point3D& sensor_origin) const;
 
   using BlockList = std::vector<OctreeIndex>;
+  // Select the blocks that need updating, testing the FOV in parallel
+  BlockList selectBlocksToUpdate() const;
   void recursiveTester(const OctreeIndex& node_index,
-                       BlockList& update_job_list);
+                       BlockList& update_job_list) const;
 
+  void prepareMapUpdate() override;
   void updateMap() override;
+
+ protected:
+  // Update a block through the generic (virtual) projection and measurement
+  // model interfaces, derived classes can override it to use specialized ones
+  virtual void updateBlock(HashedWaveletOctree::Block& block,
+                           const OctreeIndex& block_index);
+  // Block update kernel that calls the models' methods as ProjectorT and
+  // MeasurementModelT, s.t. they can be inlined if these types are final
+  template <typename ProjectorT, typename MeasurementModelT>
+  void updateBlockImpl(HashedWaveletOctree::Block& block,
+                       const OctreeIndex& block_index);
+
+ private:
+  template <typename ProjectorT, typename MeasurementModelT>
+  void updateLeavesBatch(
+      const OctreeIndex& parent_index,
+      HashedWaveletOctreeBlock::Coefficients::CoefficientsArray& child_values);
+};
+
+/**
+ * Version of the HashedWaveletIntegrator whose block update kernels are
+ * specialized at compile time for the given projection and measurement model
+ * types. This removes the virtual calls from the innermost integration loops.
+ * NOTE: Specializations are only compiled for the combinations that the
+ *       IntegratorFactory creates, i.e. the ContinuousBeam measurement model
+ *       combined with the Ouster, pinhole camera or spherical projector.
+ */
+template <typename ProjectorT, typename MeasurementModelT>
+class SpecializedHashedWaveletIntegrator final
+    : public HashedWaveletIntegrator {
+ public:
+  SpecializedHashedWaveletIntegrator(
+      const ProjectiveIntegratorConfig& config,
+      std::shared_ptr<const ProjectorT> projection_model,
+      PosedImage<>::Ptr posed_range_image,
+      Image<Vector2D>::Ptr beam_offset_image,
+      std::shared_ptr<const MeasurementModelT> measurement_model,
+      HashedWaveletOctree::Ptr occupancy_map,
+      std::shared_ptr<ThreadPool> thread_pool = nullptr)
+      : HashedWaveletIntegrator(
+            config, std::move(projection_model), std::move(posed_range_image),
+            std::move(beam_offset_image), std::move(measurement_model),
+            std::move(occupancy_map), std::move(thread_pool)) {}
+
+ private:
   void updateBlock(HashedWaveletOctree::Block& block,
-                   const OctreeIndex& block_index);
+                   const OctreeIndex& block_index) override;
 };
 }  // namespace wavemap
 
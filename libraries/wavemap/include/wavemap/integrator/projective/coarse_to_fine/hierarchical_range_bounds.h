@@ -10,8 +10,10 @@
 #include <vector>
 
 #include "wavemap/data_structure/image.h"
+#include "wavemap/indexing/ndtree_index.h"
 #include "wavemap/integrator/projection_model/projector_base.h"
 #include "wavemap/integrator/projective/update_type.h"
+#include "wavemap/utils/thread_pool.h"
 
 namespace wavemap {
 class HierarchicalRangeBounds {
@@ -30,10 +32,17 @@ class HierarchicalRangeBounds {
         << "For scale: " << image_to_pyramid_scale_factor_;
     CHECK((image_to_pyramid_scale_factor_.array() <= 2).all())
         << "For scale: " << image_to_pyramid_scale_factor_;
+    update();
     DCHECK_EQ(lower_bound_levels_.size(), max_height_);
     DCHECK_EQ(upper_bound_levels_.size(), max_height_);
   }
 
+  // Recompute the bounds after the range image's content changed
+  // NOTE: The pyramid levels are only reallocated if the range image's
+  //       dimensions changed. If a thread pool is provided, the lower bound,
+  //       upper bound and unobserved mask pyramids are computed in parallel.
+  void update(ThreadPool* thread_pool = nullptr);
+
   NdtreeIndexElement getMaxHeight() const { return max_height_; }
   FloatingPoint getMinRange() const { return min_range_; }
   static FloatingPoint getUnknownValueLowerBound() {
@@ -96,26 +105,19 @@ class HierarchicalRangeBounds {
   static Index2D computeImageToPyramidScaleFactor(
       const ProjectorBase* projector = nullptr);
 
-  const std::vector<Image<>> lower_bound_levels_ = computeReducedPyramid(
-      range_image_->transform(
-          [=](auto val) { return valueOrInit(val, kUnknownValueLowerBound); }),
-      [](auto a, auto b) { return std::min(a, b); }, kUnknownValueLowerBound);
-  const std::vector<Image<>> upper_bound_levels_ = computeReducedPyramid(
-      range_image_->transform(
-          [=](auto val) { return valueOrInit(val, kUnknownValueUpperBound); }),
-      [](auto a, auto b) { return std::max(a, b); }, kUnknownValueUpperBound);
-  const std::vector<Image<bool>> unobserved_mask_levels_ =
-      computeReducedPyramid(
-          range_image_->transform([=](auto val) { return isUnobserved(val); }),
-          [](auto a, auto b) { return a || b; }, true);
-
-  const NdtreeIndexElement max_height_ =
-      static_cast<NdtreeIndexElement>(lower_bound_levels_.size());
-
-  template <typename T = FloatingPoint, typename BinaryFunctor>
-  std::vector<Image<T>> computeReducedPyramid(const Image<T>& range_image,
-                                              BinaryFunctor reduction_functor,
-                                              T init);
+  // Pyramids of the range bounds, where level i is downsampled by 2^(i+1)
+  // NOTE: These buffers are reused by update() whenever possible.
+  Index2D range_image_dims_ = Index2D::Constant(-1);
+  std::vector<Image<>> lower_bound_levels_;
+  std::vector<Image<>> upper_bound_levels_;
+  std::vector<Image<bool>> unobserved_mask_levels_;
+  NdtreeIndexElement max_height_ = 0;
+
+  void allocateLevels(const Index2D& range_image_dims);
+  template <typename T, typename ReductionT, typename LeafTransformT>
+  void computeReducedPyramid(std::vector<Image<T>>& pyramid,
+                             ReductionT reduction,
+                             LeafTransformT leaf_transform, T init) const;
 
   bool isUnobserved(FloatingPoint value) const { return value < min_range_; }
   FloatingPoint valueOrInit(FloatingPoint value, FloatingPoint init) const {
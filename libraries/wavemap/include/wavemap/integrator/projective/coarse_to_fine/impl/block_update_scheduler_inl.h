@@ -0,0 +1,89 @@
+#ifndef WAVEMAP_INTEGRATOR_PROJECTIVE_COARSE_TO_FINE_IMPL_BLOCK_UPDATE_SCHEDULER_INL_H_
+#define WAVEMAP_INTEGRATOR_PROJECTIVE_COARSE_TO_FINE_IMPL_BLOCK_UPDATE_SCHEDULER_INL_H_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "wavemap/utils/bits/morton_encoding.h"
+#include "wavemap/utils/math/int_math.h"
+
+namespace wavemap {
+template <typename BlockIndexT>
+std::vector<BlockUpdateScheduler::Task> BlockUpdateScheduler::schedule(
+    std::vector<BlockIndexT>& blocks,
+    const Transformation3D::RotationMatrix& R_C_W,
+    const Point3D& t_W_C) const {
+  std::vector<Task> tasks;
+  if (blocks.empty()) {
+    return tasks;
+  }
+
+  // Without locality awareness, update each block in its own task
+  if (!locality_aware_) {
+    tasks.reserve(blocks.size());
+    for (size_t block_idx = 0; block_idx < blocks.size(); ++block_idx) {
+      tasks.emplace_back(block_idx, block_idx + 1);
+    }
+    return tasks;
+  }
+
+  // Sort the blocks along a Morton curve
+  // NOTE: The indices are offset s.t. they are all positive, as the Morton
+  //       codes of negative indices would not preserve locality around zero.
+  Index3D min_block_position = getBlockPosition(blocks.front());
+  for (const BlockIndexT& block_index : blocks) {
+    min_block_position =
+        min_block_position.cwiseMin(getBlockPosition(block_index));
+  }
+  std::vector<std::pair<MortonIndex, BlockIndexT>> sorted_blocks;
+  sorted_blocks.reserve(blocks.size());
+  for (const BlockIndexT& block_index : blocks) {
+    sorted_blocks.emplace_back(
+        morton::encode<3>(
+            Index3D{getBlockPosition(block_index) - min_block_position}),
+        block_index);
+  }
+  std::sort(sorted_blocks.begin(), sorted_blocks.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs.first < rhs.first;
+            });
+  for (size_t block_idx = 0; block_idx < blocks.size(); ++block_idx) {
+    blocks[block_idx] = sorted_blocks[block_idx].second;
+  }
+
+  // Greedily grow each task until its working set would exceed the L2 cache
+  // size or it contains more than its share of the blocks
+  const size_t max_blocks_per_task = int_math::div_round_up(
+      blocks.size(), kMinNumTasksPerWorker * num_workers_);
+  size_t task_start_idx = 0;
+  AABB<Index2D> task_footprint;
+  for (size_t block_idx = 0; block_idx < blocks.size(); ++block_idx) {
+    const AABB<Index2D> block_footprint =
+        getImageFootprint(getBlockPosition(blocks[block_idx]), R_C_W, t_W_C);
+    AABB<Index2D> grown_footprint = task_footprint;
+    grown_footprint.includePoint(block_footprint.min);
+    grown_footprint.includePoint(block_footprint.max);
+    const Index2D grown_footprint_dims =
+        grown_footprint.max - grown_footprint.min + Index2D::Ones();
+    const size_t num_blocks = block_idx - task_start_idx + 1;
+    const size_t working_set_size =
+        grown_footprint_dims.prod() * kBytesPerPixel +
+        num_blocks * block_working_set_size_;
+    if (task_start_idx < block_idx &&
+        (max_task_working_set_size_ < working_set_size ||
+         max_blocks_per_task < num_blocks)) {
+      tasks.emplace_back(task_start_idx, block_idx);
+      task_start_idx = block_idx;
+      task_footprint = block_footprint;
+    } else {
+      task_footprint = grown_footprint;
+    }
+  }
+  tasks.emplace_back(task_start_idx, blocks.size());
+
+  return tasks;
+}
+}  // namespace wavemap
+
+#endif  // WAVEMAP_INTEGRATOR_PROJECTIVE_COARSE_TO_FINE_IMPL_BLOCK_UPDATE_SCHEDULER_INL_H_
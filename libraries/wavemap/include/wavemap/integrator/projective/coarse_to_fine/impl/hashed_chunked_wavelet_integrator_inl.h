@@ -1,12 +1,13 @@
 #ifndef WAVEMAP_INTEGRATOR_PROJECTIVE_COARSE_TO_FINE_IMPL_HASHED_CHUNKED_WAVELET_INTEGRATOR_INL_H_
 #define WAVEMAP_INTEGRATOR_PROJECTIVE_COARSE_TO_FINE_IMPL_HASHED_CHUNKED_WAVELET_INTEGRATOR_INL_H_
 
+#include <mutex>
 #include <utility>
 
 namespace wavemap {
 inline void HashedChunkedWaveletIntegrator::recursiveTester(  // NOLINT
     const OctreeIndex& node_index,
-    HashedChunkedWaveletIntegrator::BlockList& update_job_list) {
+    HashedChunkedWaveletIntegrator::BlockList& update_job_list) const {
   const AABB<Point3D> block_aabb =
       convert::nodeIndexToAABB(node_index, min_cell_width_);
   const UpdateType update_type = range_image_intersector_->determineUpdateType(
@@ -24,7 +25,11 @@ inline void HashedChunkedWaveletIntegrator::recursiveTester(  // NOLINT
     }
     if (occupancy_map_->hasBlock(node_index.position)) {
       const auto& block = occupancy_map_->getBlock(node_index.position);
-      if (min_log_odds_shrunk_ <= block.getRootScale()) {
+      const FloatingPoint root_scale = [&block]() {
+        auto block_lock = std::scoped_lock(block.getMutex());
+        return block.getRootScale();
+      }();
+      if (min_log_odds_shrunk_ <= root_scale) {
         // Add the block to the job list
         update_job_list.emplace_back(node_index.position);
       }
@@ -37,6 +42,7 @@ inline void HashedChunkedWaveletIntegrator::recursiveTester(  // NOLINT
   }
 }
 
+template <typename ProjectorT, typename MeasurementModelT>
 inline void HashedChunkedWaveletIntegrator::updateLeavesBatch(
     const OctreeIndex& parent_index, FloatingPoint& parent_value,
     HaarCoefficients<FloatingPoint, 3>::Details& parent_details) {
@@ -45,7 +51,8 @@ inline void HashedChunkedWaveletIntegrator::updateLeavesBatch(
       {parent_value, parent_details});
 
   // Get child center points in world frame W
-  Eigen::Matrix<FloatingPoint, 3, OctreeIndex::kNumChildren> child_centers;
+  static_assert(OctreeIndex::kNumChildren == ProjectorBase::kBatchSize);
+  ProjectorBase::CartesianBatch child_centers;
   for (int child_idx = 0; child_idx < OctreeIndex::kNumChildren; ++child_idx) {
     const auto child_index = parent_index.computeChildIndex(child_idx);
     child_centers.col(child_idx) =
@@ -54,15 +61,15 @@ inline void HashedChunkedWaveletIntegrator::updateLeavesBatch(
 
   // Transform into sensor frame C
   const auto& T_C_W = posed_range_image_->getPoseInverse();
-  for (int child_idx = 0; child_idx < OctreeIndex::kNumChildren; ++child_idx) {
-    child_centers.col(child_idx) = T_C_W * child_centers.col(child_idx);
-  }
+  child_centers = T_C_W.getRotationMatrix() * child_centers;
+  child_centers.colwise() += T_C_W.getPosition();
 
   // Compute updated values
+  const auto samples =
+      computeUpdateBatch<ProjectorT, MeasurementModelT>(child_centers);
   for (int child_idx = 0; child_idx < OctreeIndex::kNumChildren; ++child_idx) {
-    const FloatingPoint sample = computeUpdate(child_centers.col(child_idx));
     FloatingPoint& child_value = child_values[child_idx];
-    child_value = sample + child_value;
+    child_value = samples[child_idx] + child_value;
   }
 
   // Threshold
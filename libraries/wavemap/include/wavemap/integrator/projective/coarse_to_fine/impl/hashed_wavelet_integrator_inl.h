@@ -1,12 +1,14 @@
 #ifndef WAVEMAP_INTEGRATOR_PROJECTIVE_COARSE_TO_FINE_IMPL_HASHED_WAVELET_INTEGRATOR_INL_H_
 #define WAVEMAP_INTEGRATOR_PROJECTIVE_COARSE_TO_FINE_IMPL_HASHED_WAVELET_INTEGRATOR_INL_H_
 
+#include <algorithm>
+#include <mutex>
 #include <utility>
 
 namespace wavemap {
 inline void HashedWaveletIntegrator::recursiveTester(  // NOLINT
     const OctreeIndex& node_index,
-    HashedWaveletIntegrator::BlockList& update_job_list) {
+    HashedWaveletIntegrator::BlockList& update_job_list) const {
   const AABB<Point3D> block_aabb =
       convert::nodeIndexToAABB(node_index, min_cell_width_);
   const UpdateType update_type = range_image_intersector_->determineUpdateType(
@@ -24,7 +26,11 @@ inline void HashedWaveletIntegrator::recursiveTester(  // NOLINT
     }
     if (occupancy_map_->hasBlock(node_index.position)) {
       const auto& block = occupancy_map_->getBlock(node_index.position);
-      if (min_log_odds_ + kNoiseThreshold / 10.f <= block.getRootScale()) {
+      const FloatingPoint root_scale = [&block]() {
+        auto block_lock = std::scoped_lock(block.getMutex());
+        return block.getRootScale();
+      }();
+      if (min_log_odds_ + kNoiseThreshold / 10.f <= root_scale) {
         // Add the block to the job list
         update_job_list.emplace_back(node_index);
       }
@@ -36,6 +42,35 @@ inline void HashedWaveletIntegrator::recursiveTester(  // NOLINT
     recursiveTester(child_index, update_job_list);
   }
 }
+
+template <typename ProjectorT, typename MeasurementModelT>
+inline void HashedWaveletIntegrator::updateLeavesBatch(
+    const OctreeIndex& parent_index,
+    HashedWaveletOctreeBlock::Coefficients::CoefficientsArray& child_values) {
+  // Get child center points in world frame W
+  static_assert(OctreeIndex::kNumChildren == ProjectorBase::kBatchSize);
+  ProjectorBase::CartesianBatch child_centers;
+  for (int child_idx = 0; child_idx < OctreeIndex::kNumChildren; ++child_idx) {
+    const auto child_index = parent_index.computeChildIndex(child_idx);
+    child_centers.col(child_idx) =
+        convert::nodeIndexToCenterPoint(child_index, min_cell_width_);
+  }
+
+  // Transform into sensor frame C
+  const auto& T_C_W = posed_range_image_->getPoseInverse();
+  child_centers = T_C_W.getRotationMatrix() * child_centers;
+  child_centers.colwise() += T_C_W.getPosition();
+
+  // Compute and threshold the updated values
+  const auto samples =
+      computeUpdateBatch<ProjectorT, MeasurementModelT>(child_centers);
+  for (int child_idx = 0; child_idx < OctreeIndex::kNumChildren; ++child_idx) {
+    FloatingPoint& child_value = child_values[child_idx];
+    child_value = std::clamp(samples[child_idx] + child_value,
+                             min_log_odds_ - kNoiseThreshold,
+                             max_log_odds_ + kNoiseThreshold);
+  }
+}
 }  // namespace wavemap
 
 #endif  // WAVEMAP_INTEGRATOR_PROJECTIVE_COARSE_TO_FINE_IMPL_HASHED_WAVELET_INTEGRATOR_INL_H_
@@ -4,8 +4,8 @@
 #include <algorithm>
 #include <vector>
 
-#include "wavemap/utils/bits/bit_operations.h"
 #include "wavemap/utils/iterate/grid_iterator.h"
+#include "wavemap/utils/math/int_math.h"
 
 namespace wavemap {
 inline Bounds<FloatingPoint> HierarchicalRangeBounds::getBounds(
@@ -289,94 +289,6 @@ inline Index2D HierarchicalRangeBounds::computeImageToPyramidScaleFactor(
     return Index2D::Ones();
   }
 }
-
-template <typename T, typename BinaryFunctor>
-std::vector<Image<T>> HierarchicalRangeBounds::computeReducedPyramid(
-    const Image<T>& range_image, BinaryFunctor reduction_functor, T init) {
-  CHECK(!azimuth_wraps_pi_ || bit_ops::popcount(range_image.getNumColumns()))
-      << "For LiDAR range images that wrap around horizontally (FoV of "
-         "360deg), only column numbers that are exact powers of 2 are "
-         "currently supported.";
-
-  const Index2D range_image_dims = range_image.getDimensions();
-  const Index2D range_image_dims_scaled =
-      image_to_pyramid_scale_factor_.cwiseProduct(range_image_dims);
-  const int max_num_halvings =
-      int_math::log2_ceil(range_image_dims_scaled.maxCoeff());
-
-  std::vector<Image<T>> pyramid;
-  pyramid.reserve(max_num_halvings);
-  for (int level_idx = 0; level_idx < max_num_halvings; ++level_idx) {
-    // Initialize the current level
-    const Index2D level_dims =
-        int_math::div_exp2_ceil(range_image_dims_scaled, level_idx + 1);
-    Image<T>& current_level =
-        pyramid.emplace_back(level_dims.x(), level_dims.y(), init);
-
-    // Reduce from the previous level or from the range image (for level 0)
-    const Image<T>& previous_level =
-        level_idx == 0 ? range_image : pyramid[level_idx - 1];
-    const Index2D previous_level_dims = previous_level.getDimensions();
-
-    for (const Index2D& idx :
-         Grid<2>(Index2D::Zero(), level_dims - Index2D::Ones())) {
-      Index2D min_child_idx = 2 * idx;
-      Index2D max_child_idx = min_child_idx + Index2D::Ones();
-      if (level_idx == 0) {
-        min_child_idx =
-            min_child_idx.cwiseQuotient(image_to_pyramid_scale_factor_);
-        max_child_idx =
-            max_child_idx.cwiseQuotient(image_to_pyramid_scale_factor_);
-      }
-
-      // Reduce the values in the 2x2 block of the previous level from
-      // min_child_idx to max_child_idx while avoiding out-of-bounds access if
-      // we're on the border. Where out-of-bounds access would occur, we
-      // virtually pad the previous level with initial value 'init'.
-      if ((min_child_idx.array() < previous_level_dims.array()).all()) {
-        const T r00 = previous_level.at({min_child_idx.x(), min_child_idx.y()});
-        if (max_child_idx.x() < previous_level_dims.x()) {
-          const T r10 =
-              previous_level.at({max_child_idx.x(), min_child_idx.y()});
-          const T first_col_reduced = reduction_functor(r00, r10);
-          if (max_child_idx.y() < previous_level_dims.y()) {
-            const T r01 =
-                previous_level.at({min_child_idx.x(), max_child_idx.y()});
-            const T r11 =
-                previous_level.at({max_child_idx.x(), max_child_idx.y()});
-            const T second_col_reduced = reduction_functor(r01, r11);
-            current_level.at(idx) =
-                reduction_functor(first_col_reduced, second_col_reduced);
-          } else if (azimuth_wraps_pi_ &&
-                     max_child_idx.y() <= previous_level_dims.y()) {
-            const T r01 = previous_level.at({min_child_idx.x(), 0});
-            const T r11 = previous_level.at({max_child_idx.x(), 0});
-            const T second_col_reduced = reduction_functor(r01, r11);
-            current_level.at(idx) =
-                reduction_functor(first_col_reduced, second_col_reduced);
-          } else {
-            current_level.at(idx) = reduction_functor(first_col_reduced, init);
-          }
-        } else if (max_child_idx.y() < previous_level_dims.y()) {
-          const T r01 =
-              previous_level.at({min_child_idx.x(), max_child_idx.y()});
-          const T first_row_reduced = reduction_functor(r00, r01);
-          current_level.at(idx) = reduction_functor(first_row_reduced, init);
-        } else if (azimuth_wraps_pi_ &&
-                   max_child_idx.y() <= previous_level_dims.y()) {
-          const T r01 = previous_level.at({min_child_idx.x(), 0});
-          const T first_row_reduced = reduction_functor(r00, r01);
-          current_level.at(idx) = reduction_functor(first_row_reduced, init);
-        } else {
-          current_level.at(idx) = reduction_functor(r00, init);
-        }
-      } else {
-        current_level.at(idx) = init;
-      }
-    }
-  }
-  return pyramid;
-}
 }  // namespace wavemap
 
 #endif  // WAVEMAP_INTEGRATOR_PROJECTIVE_COARSE_TO_FINE_IMPL_HIERARCHICAL_RANGE_BOUNDS_INL_H_
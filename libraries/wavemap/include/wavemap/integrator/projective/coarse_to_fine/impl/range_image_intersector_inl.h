@@ -8,6 +8,7 @@
 #include "wavemap/integrator/measurement_model/continuous_beam.h"
 
 namespace wavemap {
+template <typename ProjectorT>
 inline UpdateType RangeImageIntersector::determineUpdateType(
     const AABB<Point3D>& W_cell_aabb,
     const Transformation3D::RotationMatrix& R_C_W, const Point3D& t_W_C) const {
@@ -15,10 +16,16 @@ inline UpdateType RangeImageIntersector::determineUpdateType(
     return UpdateType::kPossiblyOccupied;
   }
 
+  DCHECK(dynamic_cast<const ProjectorT*>(projection_model_.get()) != nullptr);
+  const auto& projection_model =
+      static_cast<const ProjectorT&>(*projection_model_);
+
   // Get the min and max angles for any point in the cell projected into the
   // range image
-  auto [min_sensor_coordinates, max_sensor_coordinates] =
-      projection_model_->cartesianToSensorAABB(W_cell_aabb, R_C_W, t_W_C);
+  const AABB<Vector3D> sensor_coordinates_aabb =
+      projection_model.cartesianToSensorAABB(W_cell_aabb, R_C_W, t_W_C);
+  const Vector3D& min_sensor_coordinates = sensor_coordinates_aabb.min;
+  const Vector3D& max_sensor_coordinates = sensor_coordinates_aabb.max;
   if (max_range_ < min_sensor_coordinates.z() ||
       max_sensor_coordinates.z() < min_range_) {
     return UpdateType::kFullyUnobserved;
@@ -26,9 +33,9 @@ inline UpdateType RangeImageIntersector::determineUpdateType(
 
   // Pad the min and max angles with the measurement model's angle threshold to
   // account for the beam's non-zero width (angular uncertainty)
-  const Index2D min_image_index = projection_model_->imageToFloorIndex(
+  const Index2D min_image_index = projection_model.imageToFloorIndex(
       min_sensor_coordinates.head<2>() - Vector2D::Constant(angle_threshold_));
-  const Index2D max_image_index = projection_model_->imageToCeilIndex(
+  const Index2D max_image_index = projection_model.imageToCeilIndex(
       max_sensor_coordinates.head<2>() + Vector2D::Constant(angle_threshold_));
 
   // If the angle wraps around, we can't always use the hierarchical range image
@@ -37,10 +44,10 @@ inline UpdateType RangeImageIntersector::determineUpdateType(
   if (x_range_wraps_around || (!y_axis_wraps_around_ && y_range_wraps_around)) {
     const bool x_range_fully_outside_fov =
         max_image_index.x() < 0 &&
-        projection_model_->getNumRows() < min_image_index.x();
+        projection_model.getNumRows() < min_image_index.x();
     const bool y_range_fully_outside_fov =
         max_image_index.y() < 0 &&
-        projection_model_->getNumColumns() < min_image_index.y();
+        projection_model.getNumColumns() < min_image_index.y();
     if ((!x_range_wraps_around || x_range_fully_outside_fov) &&
         (y_axis_wraps_around_ || !y_range_wraps_around ||
          y_range_fully_outside_fov)) {
@@ -55,7 +62,7 @@ inline UpdateType RangeImageIntersector::determineUpdateType(
 
   // Check if the cell is outside the FoV
   if ((max_image_index.array() < 0).any() ||
-      (projection_model_->getDimensions().array() <= min_image_index.array())
+      (projection_model.getDimensions().array() <= min_image_index.array())
           .any()) {
     return UpdateType::kFullyUnobserved;
   }
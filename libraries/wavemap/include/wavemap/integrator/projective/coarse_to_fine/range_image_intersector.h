@@ -12,6 +12,7 @@
 #include "wavemap/integrator/projection_model/projector_base.h"
 #include "wavemap/integrator/projective/coarse_to_fine/hierarchical_range_bounds.h"
 #include "wavemap/integrator/projective/update_type.h"
+#include "wavemap/utils/thread_pool.h"
 
 namespace wavemap {
 class RangeImageIntersector {
@@ -30,13 +31,23 @@ class RangeImageIntersector {
         range_threshold_in_front_(measurement_model.getPaddingSurfaceFront()),
         range_threshold_behind_(measurement_model.getPaddingSurfaceBack()) {}
 
+  // Update the intersector after the range image's content changed
+  // NOTE: This reuses the hierarchical range bounds' buffers, making it
+  //       cheaper than constructing a new intersector for every measurement.
+  void update(ThreadPool* thread_pool = nullptr) {
+    hierarchical_range_image_.update(thread_pool);
+  }
+
+  // NOTE: If the projection model's type is known, it can be passed as
+  //       ProjectorT s.t. its methods can be inlined.
+  template <typename ProjectorT = ProjectorBase>
   UpdateType determineUpdateType(const AABB<Point3D>& W_cell_aabb,
                                  const Transformation3D::RotationMatrix& R_C_W,
                                  const Point3D& t_W_C) const;
 
  private:
   const bool y_axis_wraps_around_;
-  const HierarchicalRangeBounds hierarchical_range_image_;
+  HierarchicalRangeBounds hierarchical_range_image_;
 
   const ProjectorBase::ConstPtr projection_model_;
 
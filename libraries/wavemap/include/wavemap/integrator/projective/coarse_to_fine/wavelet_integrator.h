@@ -37,6 +37,7 @@ class WaveletIntegrator : public ProjectiveIntegrator {
       WaveletOctree::NodeType& parent_node,
       OctreeIndex ::RelativeChild relative_child_index);
 
+  void prepareMapUpdate() override;
   void updateMap() override;
 };
 }  // namespace wavemap
@@ -2,10 +2,11 @@
 #define WAVEMAP_INTEGRATOR_PROJECTIVE_IMPL_PROJECTIVE_INTEGRATOR_INL_H_
 
 namespace wavemap {
+template <typename ProjectorT, typename MeasurementModelT>
 inline FloatingPoint ProjectiveIntegrator::computeUpdate(
     const Point3D& C_cell_center) const {
   const auto sensor_coordinates =
-      projection_model_->cartesianToSensor(C_cell_center);
+      getProjectionModelAs<ProjectorT>().cartesianToSensor(C_cell_center);
 
   // Check if we're outside the min/max range
   // NOTE: For spherical (e.g. LiDAR) projection models, sensor_coordinates.z()
@@ -16,7 +17,44 @@ inline FloatingPoint ProjectiveIntegrator::computeUpdate(
     return 0.f;
   }
 
-  return measurement_model_->computeUpdate(sensor_coordinates);
+  return getMeasurementModelAs<MeasurementModelT>()
+      .template computeUpdate<ProjectorT>(sensor_coordinates);
+}
+
+template <typename ProjectorT, typename MeasurementModelT>
+inline MeasurementModelBase::UpdateBatch
+ProjectiveIntegrator::computeUpdateBatch(
+    const ProjectorBase::CartesianBatch& C_cell_centers) const {
+  ProjectorBase::SensorCoordinatesBatch sensor_coordinates;
+  getProjectionModelAs<ProjectorT>().cartesianToSensorBatch(C_cell_centers,
+                                                            sensor_coordinates);
+
+  MeasurementModelBase::UpdateBatch updates;
+  getMeasurementModelAs<MeasurementModelT>()
+      .template computeUpdateBatch<ProjectorT>(sensor_coordinates, updates);
+
+  // Discard the updates of cells outside the min/max range
+  for (int point_idx = 0; point_idx < ProjectorBase::kBatchSize; ++point_idx) {
+    const FloatingPoint depth = sensor_coordinates.depth[point_idx];
+    const bool outside_range =
+        depth < config_.min_range || config_.max_range < depth;
+    updates[point_idx] = outside_range ? 0.f : updates[point_idx];
+  }
+  return updates;
+}
+
+template <typename ProjectorT>
+inline const ProjectorT& ProjectiveIntegrator::getProjectionModelAs() const {
+  DCHECK(dynamic_cast<const ProjectorT*>(projection_model_.get()) != nullptr);
+  return static_cast<const ProjectorT&>(*projection_model_);
+}
+
+template <typename MeasurementModelT>
+inline const MeasurementModelT& ProjectiveIntegrator::getMeasurementModelAs()
+    const {
+  DCHECK(dynamic_cast<const MeasurementModelT*>(measurement_model_.get()) !=
+         nullptr);
+  return static_cast<const MeasurementModelT&>(*measurement_model_);
 }
 }  // namespace wavemap
 
@@ -0,0 +1,95 @@
+#ifndef WAVEMAP_INTEGRATOR_PROJECTIVE_PIPELINED_INTEGRATOR_H_
+#define WAVEMAP_INTEGRATOR_PROJECTIVE_PIPELINED_INTEGRATOR_H_
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "wavemap/data_structure/image.h"
+#include "wavemap/integrator/integrator_base.h"
+#include "wavemap/integrator/projective/projective_integrator.h"
+#include "wavemap/utils/thread_pool.h"
+
+namespace wavemap {
+/**
+ * Integrator that overlaps the integration of consecutive measurements by
+ * cycling through multiple projective integrators (stages), which all update
+ * the same map. While the map update of measurement N is running, measurement
+ * N+1 is already imported into the next stage's range image and its range
+ * image intersector (incl. its HierarchicalRangeBounds) is built.
+ *
+ * The map updates themselves are committed strictly in the order in which the
+ * measurements were received. Each block therefore sees the same sequence of
+ * updates as with sequential integration, s.t. the resulting map is identical.
+ * Both the preparation and the commits run as tasks on the thread pool, which
+ * never block on each other. A measurement's commit is only scheduled once it
+ * has been prepared and its predecessor's commit has finished. Commits may
+ * run nested within other tasks that wait on the thread pool, so the stages
+ * must not hold any map locks while waiting (see getBlocksMutex()).
+ * Since the map is updated asynchronously, other threads should only access it
+ * through the map's own locking (as provided by the hashed maps) or after
+ * calling flush().
+ */
+class PipelinedIntegrator : public IntegratorBase {
+ public:
+  using Ptr = std::shared_ptr<PipelinedIntegrator>;
+
+  PipelinedIntegrator(std::vector<ProjectiveIntegrator::Ptr> stages,
+                      std::shared_ptr<ThreadPool> thread_pool);
+  ~PipelinedIntegrator() override { flush(); }
+
+  // Methods to enqueue new pointclouds / depth images for integration
+  // NOTE: These only block if all stages are still busy with previous
+  //       measurements.
+  void integratePointcloud(const PosedPointcloud<>& pointcloud) override;
+  void integrateRangeImage(const PosedImage<>& range_image);
+
+  // Wait until all enqueued measurements have been integrated
+  void flush();
+
+  bool locksMapBlocks() const override;
+
+  size_t getPipelineDepth() const { return stages_.size(); }
+  const std::vector<ProjectiveIntegrator::Ptr>& getStages() const {
+    return stages_;
+  }
+
+ private:
+  const std::vector<ProjectiveIntegrator::Ptr> stages_;
+  const std::shared_ptr<ThreadPool> thread_pool_;
+  size_t next_stage_idx_ = 0;
+
+  // Completion of the last measurement each stage was used for
+  std::vector<std::shared_future<void>> stage_done_;
+  // Completion of the most recently enqueued measurement
+  std::shared_future<void> last_measurement_done_;
+
+  // Measurements that were enqueued but whose commit was not yet scheduled,
+  // in the order in which they were received
+  // NOTE: The stages are owned by stages_, whose destruction waits for all
+  //       pending measurements through flush(). The tasks therefore refer to
+  //       them through a plain pointer, which also ensures that the last
+  //       reference to a stage (and its thread pool) is never released by one
+  //       of the pool's own workers.
+  struct PendingMeasurement {
+    ProjectiveIntegrator* stage;
+    std::optional<bool> is_valid;  // Set once the measurement is prepared
+    std::promise<void> done;
+  };
+  std::mutex mutex_;
+  std::deque<std::shared_ptr<PendingMeasurement>> pending_measurements_;
+  bool is_committing_ = false;
+
+  template <typename PrepareFn>
+  void enqueue(PrepareFn prepare);
+  // Schedule the commit of the oldest pending measurement, if it is prepared
+  // and no other commit is running
+  // NOTE: Must be called while holding mutex_.
+  void scheduleNextCommit();
+};
+}  // namespace wavemap
+
+#endif  // WAVEMAP_INTEGRATOR_PROJECTIVE_PIPELINED_INTEGRATOR_H_
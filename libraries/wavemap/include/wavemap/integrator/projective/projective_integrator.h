@@ -15,7 +15,7 @@ namespace wavemap {
 /**
  * Config struct for projective integrators.
  */
-struct ProjectiveIntegratorConfig : ConfigBase<ProjectiveIntegratorConfig, 4> {
+struct ProjectiveIntegratorConfig : ConfigBase<ProjectiveIntegratorConfig, 6> {
   //! Minimum range measurements should have to be considered.
   //! Measurements below this threshold are ignored.
   Meters<FloatingPoint> min_range = 0.5f;
@@ -35,6 +35,16 @@ struct ProjectiveIntegratorConfig : ConfigBase<ProjectiveIntegratorConfig, 4> {
   //! please refer to: https://www.roboticsproceedings.org/rss19/p065.pdf.
   FloatingPoint termination_update_error = 0.1f;
 
+  //! Number of measurements that can be in flight at once. When set above 1,
+  //! the IntegratorFactory wraps the integrator into a PipelinedIntegrator,
+  //! which imports and preprocesses the next measurements while the map update
+  //! of the current measurement is still running. Defaults to 1 (disabled).
+  int pipeline_depth = 1;
+  //! Whether to group the blocks that are updated by each measurement into
+  //! tasks of nearby blocks, s.t. each worker reads mostly the same parts of
+  //! the range image. Only used by the hashed integrators. Defaults to true.
+  bool locality_aware_block_scheduling = true;
+
   static MemberMap memberMap;
 
   // Constructors
@@ -49,6 +59,19 @@ class ProjectiveIntegrator : public IntegratorBase {
  public:
   using Ptr = std::shared_ptr<ProjectiveIntegrator>;
 
+  // Wall time spent in each stage of the last integrated measurement, in
+  // seconds
+  // NOTE: The block selection, allocation and update times are only measured
+  //       by the hashed integrators and remain zero for the other types.
+  struct StageTimings {
+    double import_measurement = 0.0;
+    double prepare_map_update = 0.0;
+    double update_map = 0.0;
+    double select_blocks = 0.0;
+    double allocate_blocks = 0.0;
+    double update_blocks = 0.0;
+  };
+
   explicit ProjectiveIntegrator(
       const ProjectiveIntegratorConfig& config,
       ProjectorBase::ConstPtr projection_model,
@@ -66,6 +89,18 @@ class ProjectiveIntegrator : public IntegratorBase {
       const PosedPointcloud<Point<3>>& pointcloud) override;
   void integrateRangeImage(const PosedImage<>& range_image);
 
+  // Methods to integrate a measurement in two stages. The preparation stage
+  // imports the measurement and precomputes everything its map update needs,
+  // touching only the integrator's own state. The commit stage then applies
+  // the update to the map.
+  // NOTE: This allows the next measurement to be prepared by another
+  //       integrator while the current one is being committed, see
+  //       PipelinedIntegrator. The prepare methods return false if the
+  //       measurement is invalid, in which case it should not be committed.
+  bool preparePointcloud(const PosedPointcloud<Point<3>>& pointcloud);
+  bool prepareRangeImage(const PosedImage<>& range_image);
+  void commitPreparedMeasurement();
+
   // Accessors for debugging and visualization
   // NOTE: These accessors are for introspection only, not for modifying the
   //       internal state. They therefore only expose const references or
@@ -82,6 +117,9 @@ class ProjectiveIntegrator : public IntegratorBase {
   Image<Vector2D>::ConstPtr getBeamOffsetImage() const {
     return beam_offset_image_;
   }
+  const StageTimings& getLastStageTimings() const {
+    return last_stage_timings_;
+  }
 
  protected:
   const ProjectiveIntegratorConfig config_;
@@ -92,12 +130,41 @@ class ProjectiveIntegrator : public IntegratorBase {
 
   const MeasurementModelBase::ConstPtr measurement_model_;
 
+  StageTimings last_stage_timings_;
+
   virtual void importPointcloud(const PosedPointcloud<>& pointcloud);
   virtual void importRangeImage(const PosedImage<>& range_image_input);
 
+  virtual void prepareMapUpdate() {}
   virtual void updateMap() = 0;
 
+  FloatingPoint computeUpdate(const Point3D& C_cell_center) const {
+    return computeUpdate<ProjectorBase, MeasurementModelBase>(C_cell_center);
+  }
+  // Batched version of computeUpdate, evaluating the updates for the cells
+  // whose centers are stored in the columns of C_cell_centers all at once
+  MeasurementModelBase::UpdateBatch computeUpdateBatch(
+      const ProjectorBase::CartesianBatch& C_cell_centers) const {
+    return computeUpdateBatch<ProjectorBase, MeasurementModelBase>(
+        C_cell_centers);
+  }
+
+  // Versions of computeUpdate(Batch) that are specialized for known projection
+  // and measurement model types, s.t. the compiler can inline their methods
+  // instead of calling them through their vtables
+  // NOTE: The types must match the (derived) types of the models the
+  //       integrator was constructed with.
+  template <typename ProjectorT, typename MeasurementModelT>
   FloatingPoint computeUpdate(const Point3D& C_cell_center) const;
+  template <typename ProjectorT, typename MeasurementModelT>
+  MeasurementModelBase::UpdateBatch computeUpdateBatch(
+      const ProjectorBase::CartesianBatch& C_cell_centers) const;
+
+  // Get the models downcast to the types used by the specialized methods
+  template <typename ProjectorT>
+  const ProjectorT& getProjectionModelAs() const;
+  template <typename MeasurementModelT>
+  const MeasurementModelT& getMeasurementModelAs() const;
 };
 }  // namespace wavemap
 
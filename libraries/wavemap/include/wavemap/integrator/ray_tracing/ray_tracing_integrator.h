@@ -1,12 +1,18 @@
 #ifndef WAVEMAP_INTEGRATOR_RAY_TRACING_RAY_TRACING_INTEGRATOR_H_
 #define WAVEMAP_INTEGRATOR_RAY_TRACING_RAY_TRACING_INTEGRATOR_H_
 
+#include <memory>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "wavemap/data_structure/volumetric/hashed_blocks.h"
 #include "wavemap/data_structure/volumetric/volumetric_data_structure_base.h"
+#include "wavemap/indexing/index_hashes.h"
 #include "wavemap/integrator/integrator_base.h"
 #include "wavemap/integrator/measurement_model/constant_ray.h"
 #include "wavemap/utils/iterate/ray_iterator.h"
+#include "wavemap/utils/thread_pool.h"
 
 namespace wavemap {
 /**
@@ -26,20 +32,68 @@ struct RayTracingIntegratorConfig : ConfigBase<RayTracingIntegratorConfig, 2> {
   bool isValid(bool verbose) const override;
 };
 
+/**
+ * Integrator that updates the map by tracing each ray of a pointcloud through
+ * the map's cells.
+ *
+ * If a thread pool is provided and the map is a HashedBlocks,
+ * HashedWaveletOctree or HashedChunkedWaveletOctree, the rays are traced in
+ * parallel. Each batch of rays then accumulates its updates in a buffer keyed
+ * by block, after which the updates of each block are applied by a single
+ * task. For HashedBlocks, every cell receives its updates in the same order as
+ * with serial integration, s.t. the resulting maps are identical. For the
+ * hashed wavelet octrees, each block's updates are applied in a single pass
+ * with addToCellValues, s.t. the maps match up to floating point rounding.
+ */
 class RayTracingIntegrator : public IntegratorBase {
  public:
   RayTracingIntegrator(const RayTracingIntegratorConfig& config,
-                       VolumetricDataStructureBase::Ptr occupancy_map)
+                       VolumetricDataStructureBase::Ptr occupancy_map,
+                       std::shared_ptr<ThreadPool> thread_pool = nullptr)
       : config_(config.checkValid()),
-        occupancy_map_(std::move(CHECK_NOTNULL(occupancy_map))) {}
+        occupancy_map_(std::move(CHECK_NOTNULL(occupancy_map))),
+        thread_pool_(std::move(thread_pool)) {}
 
   void integratePointcloud(const PosedPointcloud<>& pointcloud) override;
 
+  bool locksMapBlocks() const override;
+
  private:
   using MeasurementModelType = ConstantRay;
 
   const RayTracingIntegratorConfig config_;
   const VolumetricDataStructureBase::Ptr occupancy_map_;
+  const std::shared_ptr<ThreadPool> thread_pool_;
+
+  // Updates generated by a batch of rays, grouped by block and stored in the
+  // order in which they were generated
+  struct CellUpdate {
+    Index3D index;
+    FloatingPoint update;
+  };
+  using BlockUpdates =
+      std::unordered_map<Index3D, std::vector<CellUpdate>, IndexHash<3>>;
+  std::vector<BlockUpdates> batch_updates_;
+
+  void integratePointcloudSerial(const PosedPointcloud<>& pointcloud);
+  template <typename MapT>
+  void integratePointcloudParallel(const PosedPointcloud<>& pointcloud,
+                                   MapT& occupancy_map);
+
+  void traceRays(const Pointcloud<>& W_points, const Point3D& W_start_point,
+                 size_t first_point_idx, size_t last_point_idx,
+                 IndexElement block_height, BlockUpdates& block_updates) const;
+  template <typename MapT>
+  void applyUpdates(MapT& occupancy_map,
+                    const std::vector<Index3D>& blocks_to_update);
+  void applyUpdates(HashedBlocks& occupancy_map,
+                    const std::vector<Index3D>& blocks_to_update);
+
+  // Call the visitor on all updates of the given block, in the order in which
+  // they were generated
+  template <typename VisitorFn>
+  void forEachUpdateInBlock(const Index3D& block_index,
+                            VisitorFn visitor_fn) const;
 };
 }  // namespace wavemap
 
@@ -33,6 +33,14 @@ inline constexpr uint64_t clz(uint64_t bitstring) {
   return __builtin_clzll(bitstring);
 }
 
+inline constexpr uint32_t ctz(uint32_t bitstring) {
+  return __builtin_ctz(bitstring);
+}
+
+inline constexpr uint64_t ctz(uint64_t bitstring) {
+  return __builtin_ctzll(bitstring);
+}
+
 #ifdef BIT_EXPAND_AVAILABLE
 inline uint32_t expand(uint32_t source, uint32_t selector) {
   return _pdep_u32(source, selector);
@@ -141,6 +149,12 @@ constexpr T clz(T bitstring) {
   return detail::clz(bit_cast_unsigned(bitstring));
 }
 
+template <typename T>
+constexpr T ctz(T bitstring) {
+  DCHECK(bitstring != static_cast<T>(0));
+  return detail::ctz(bit_cast_unsigned(bitstring));
+}
+
 template <typename T>
 constexpr T repeat_block(int block_width, T block_contents) {
   constexpr int type_width = 8 * sizeof(T);
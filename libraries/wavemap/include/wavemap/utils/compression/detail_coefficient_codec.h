@@ -0,0 +1,90 @@
+#ifndef WAVEMAP_UTILS_COMPRESSION_DETAIL_COEFFICIENT_CODEC_H_
+#define WAVEMAP_UTILS_COMPRESSION_DETAIL_COEFFICIENT_CODEC_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "wavemap/common.h"
+#include "wavemap/data_structure/volumetric/cell_types/haar_coefficients.h"
+#include "wavemap/utils/compression/range_coder.h"
+
+namespace wavemap {
+// Adaptive probability models shared by the encoder and decoder
+struct DetailCoefficientModel {
+  using Details = HaarCoefficients<FloatingPoint, 3>::Details;
+  static constexpr int kNumDetails =
+      HaarCoefficients<FloatingPoint, 3>::kNumDetailCoefficients;
+  static constexpr int kNumValueLengthBits = 5;
+
+  // Which children of the node are allocated
+  std::array<BitProbability, 256> allocated_children_bitset;
+  // Which detail coefficients are non-zero, depending on whether the node has
+  // children
+  std::array<std::array<BitProbability, 128>, 2> nonzero_mask;
+  // Number of significant bits of each non-zero coefficient's value
+  std::array<std::array<BitProbability, 1 << kNumValueLengthBits>, kNumDetails>
+      value_length;
+
+  DetailCoefficientModel() {
+    allocated_children_bitset.fill(kInitialBitProbability);
+    for (auto& probabilities : nonzero_mask) {
+      probabilities.fill(kInitialBitProbability);
+    }
+    for (auto& probabilities : value_length) {
+      probabilities.fill(kInitialBitProbability);
+    }
+  }
+};
+
+/**
+ * Compressed encoding of the nodes of a wavelet octree, i.e. their detail
+ * coefficients and bitset of allocated children. The coefficients are
+ * quantized to multiples of quantization_step, which bounds the error of each
+ * coefficient to half a step. Each node is then written as its children
+ * bitset, a bitmask of its non-zero coefficients and the values of these
+ * coefficients, which are all entropy coded with adaptive models. Since most
+ * coefficients are (near) zero after thresholding, this typically takes a
+ * fraction of the 29 bytes used by the raw format.
+ */
+class DetailCoefficientEncoder {
+ public:
+  using Details = DetailCoefficientModel::Details;
+
+  DetailCoefficientEncoder(FloatingPoint quantization_step,
+                           std::vector<uint8_t>& output);
+
+  void encodeNode(const Details& details, uint8_t allocated_children_bitset);
+
+  // Must be called after encoding the last node
+  void flush() { range_encoder_.flush(); }
+
+ private:
+  const FloatingPoint quantization_step_inv_;
+  RangeEncoder range_encoder_;
+  DetailCoefficientModel model_;
+};
+
+/**
+ * Decoder for nodes encoded with the DetailCoefficientEncoder. The nodes are
+ * returned in the order in which they were encoded, and the decoder must be
+ * constructed with the same quantization step.
+ */
+class DetailCoefficientDecoder {
+ public:
+  using Details = DetailCoefficientModel::Details;
+
+  DetailCoefficientDecoder(FloatingPoint quantization_step,
+                           const uint8_t* data_begin, const uint8_t* data_end);
+
+  // Returns false if the data ended before the node could be decoded
+  bool decodeNode(Details& details, uint8_t& allocated_children_bitset);
+
+ private:
+  const FloatingPoint quantization_step_;
+  RangeDecoder range_decoder_;
+  DetailCoefficientModel model_;
+};
+}  // namespace wavemap
+
+#endif  // WAVEMAP_UTILS_COMPRESSION_DETAIL_COEFFICIENT_CODEC_H_
@@ -0,0 +1,188 @@
+#ifndef WAVEMAP_UTILS_COMPRESSION_RANGE_CODER_H_
+#define WAVEMAP_UTILS_COMPRESSION_RANGE_CODER_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace wavemap {
+// Probability that an adaptively modeled bit is zero, in units of 1 / 2^11
+// NOTE: Models should be initialized with kInitialBitProbability, which
+//       corresponds to p = 0.5.
+using BitProbability = uint16_t;
+inline constexpr int kBitProbabilityNumBits = 11;
+inline constexpr uint32_t kBitProbabilityOne = 1u << kBitProbabilityNumBits;
+inline constexpr BitProbability kInitialBitProbability =
+    kBitProbabilityOne / 2u;
+
+/**
+ * Binary adaptive range encoder, following the design of the range coder used
+ * in LZMA. Each bit is either coded with an adaptive probability model, which
+ * is updated after every bit s.t. frequent values cost only a fraction of a
+ * bit, or directly with a fixed probability of 0.5.
+ */
+class RangeEncoder {
+ public:
+  explicit RangeEncoder(std::vector<uint8_t>& output) : output_(output) {}
+
+  void encodeBit(BitProbability& probability, bool bit) {
+    const uint32_t bound = (range_ >> kBitProbabilityNumBits) * probability;
+    if (!bit) {
+      range_ = bound;
+      probability += (kBitProbabilityOne - probability) >> kAdaptationShift;
+    } else {
+      low_ += bound;
+      range_ -= bound;
+      probability -= probability >> kAdaptationShift;
+    }
+    normalize();
+  }
+
+  // Encode the num_bits least significant bits of value, most significant first
+  // NOTE: The probability models should be stored in an array of size
+  //       2^num_bits, which is traversed as a binary tree.
+  void encodeBitTree(BitProbability* probabilities, int num_bits,
+                     uint32_t value) {
+    uint32_t model_idx = 1u;
+    for (int bit_idx = num_bits - 1; 0 <= bit_idx; --bit_idx) {
+      const bool bit = (value >> bit_idx) & 1u;
+      encodeBit(probabilities[model_idx], bit);
+      model_idx = (model_idx << 1) | bit;
+    }
+  }
+
+  // Encode the num_bits least significant bits of value without modeling
+  void encodeDirectBits(uint32_t value, int num_bits) {
+    for (int bit_idx = num_bits - 1; 0 <= bit_idx; --bit_idx) {
+      range_ >>= 1;
+      if ((value >> bit_idx) & 1u) {
+        low_ += range_;
+      }
+      normalize();
+    }
+  }
+
+  // Write out the remaining state, s.t. the decoder can decode all bits
+  void flush() {
+    for (int byte_idx = 0; byte_idx < 5; ++byte_idx) {
+      shiftLow();
+    }
+  }
+
+ private:
+  static constexpr int kAdaptationShift = 5;
+  static constexpr uint32_t kTopValue = 1u << 24;
+
+  std::vector<uint8_t>& output_;
+  uint64_t low_ = 0u;
+  uint32_t range_ = 0xFFFFFFFFu;
+  uint8_t cache_ = 0u;
+  uint64_t cache_size_ = 1u;
+
+  void normalize() {
+    while (range_ < kTopValue) {
+      range_ <<= 8;
+      shiftLow();
+    }
+  }
+
+  // Output the top byte of low, while propagating carries into the bytes that
+  // were held back because they could still be affected by one
+  void shiftLow() {
+    if (static_cast<uint32_t>(low_) < 0xFF000000u || (low_ >> 32) != 0u) {
+      const auto carry = static_cast<uint8_t>(low_ >> 32);
+      uint8_t byte = cache_;
+      do {
+        output_.emplace_back(static_cast<uint8_t>(byte + carry));
+        byte = 0xFFu;
+      } while (--cache_size_ != 0u);
+      cache_ = static_cast<uint8_t>(low_ >> 24);
+    }
+    ++cache_size_;
+    low_ = (low_ & 0x00FFFFFFu) << 8;
+  }
+};
+
+/**
+ * Decoder for the bits encoded by the RangeEncoder. The probability models
+ * should be initialized and used in the same order as when encoding.
+ */
+class RangeDecoder {
+ public:
+  RangeDecoder(const uint8_t* data_begin, const uint8_t* data_end)
+      : position_(data_begin), end_(data_end) {
+    for (int byte_idx = 0; byte_idx < 5; ++byte_idx) {
+      code_ = (code_ << 8) | nextByte();
+    }
+  }
+
+  bool decodeBit(BitProbability& probability) {
+    const uint32_t bound = (range_ >> kBitProbabilityNumBits) * probability;
+    bool bit;
+    if (code_ < bound) {
+      range_ = bound;
+      probability += (kBitProbabilityOne - probability) >> kAdaptationShift;
+      bit = false;
+    } else {
+      code_ -= bound;
+      range_ -= bound;
+      probability -= probability >> kAdaptationShift;
+      bit = true;
+    }
+    normalize();
+    return bit;
+  }
+
+  uint32_t decodeBitTree(BitProbability* probabilities, int num_bits) {
+    uint32_t model_idx = 1u;
+    for (int bit_idx = 0; bit_idx < num_bits; ++bit_idx) {
+      model_idx = (model_idx << 1) | decodeBit(probabilities[model_idx]);
+    }
+    return model_idx - (1u << num_bits);
+  }
+
+  uint32_t decodeDirectBits(int num_bits) {
+    uint32_t value = 0u;
+    for (int bit_idx = 0; bit_idx < num_bits; ++bit_idx) {
+      range_ >>= 1;
+      const bool bit = range_ <= code_;
+      if (bit) {
+        code_ -= range_;
+      }
+      value = (value << 1) | bit;
+      normalize();
+    }
+    return value;
+  }
+
+  // Whether the decoder tried to read past the end of the data, which means
+  // that the data was truncated or corrupted
+  bool overran() const { return overran_; }
+
+ private:
+  static constexpr int kAdaptationShift = 5;
+  static constexpr uint32_t kTopValue = 1u << 24;
+
+  const uint8_t* position_;
+  const uint8_t* const end_;
+  uint32_t code_ = 0u;
+  uint32_t range_ = 0xFFFFFFFFu;
+  bool overran_ = false;
+
+  uint8_t nextByte() {
+    if (position_ == end_) {
+      overran_ = true;
+      return 0u;
+    }
+    return *position_++;
+  }
+
+  void normalize() {
+    while (range_ < kTopValue) {
+      range_ <<= 8;
+      code_ = (code_ << 8) | nextByte();
+    }
+  }
+};
+}  // namespace wavemap
+
+#endif  // WAVEMAP_UTILS_COMPRESSION_RANGE_CODER_H_
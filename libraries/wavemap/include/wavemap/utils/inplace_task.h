@@ -0,0 +1,134 @@
+#ifndef WAVEMAP_UTILS_INPLACE_TASK_H_
+#define WAVEMAP_UTILS_INPLACE_TASK_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace wavemap {
+/**
+ * \brief Move-only, type-erased void() callable with small buffer storage.
+ *
+ * Unlike std::function, callables that fit in the inline buffer and are
+ * nothrow move constructible are stored without any heap allocation. Larger
+ * callables transparently fall back to a heap allocated copy. Being move-only,
+ * it can also hold callables that own move-only resources such as
+ * std::packaged_task.
+ */
+class InplaceTask {
+ public:
+  static constexpr size_t kInlineStorageSize = 48;
+  static constexpr size_t kInlineStorageAlignment = alignof(std::max_align_t);
+
+  InplaceTask() = default;
+  ~InplaceTask() { reset(); }
+
+  template <typename Callable,
+            typename = std::enable_if_t<
+                !std::is_same_v<std::decay_t<Callable>, InplaceTask>>>
+  InplaceTask(Callable&& callable);  // NOLINT
+
+  InplaceTask(InplaceTask&& other) noexcept { moveFrom(other); }
+  InplaceTask& operator=(InplaceTask&& other) noexcept;
+
+  // Prevent copying
+  InplaceTask(const InplaceTask&) = delete;
+  InplaceTask& operator=(const InplaceTask&) = delete;
+
+  explicit operator bool() const { return operations_ != nullptr; }
+  void operator()() { operations_->invoke(&storage_); }
+
+  void reset();
+
+  template <typename Callable>
+  static constexpr bool isStoredInline() {
+    return sizeof(Callable) <= kInlineStorageSize &&
+           alignof(Callable) <= kInlineStorageAlignment &&
+           std::is_nothrow_move_constructible_v<Callable>;
+  }
+
+ private:
+  using Storage =
+      std::aligned_storage_t<kInlineStorageSize, kInlineStorageAlignment>;
+
+  struct Operations {
+    void (*invoke)(Storage* storage);
+    void (*move)(Storage* from, Storage* to) noexcept;
+    void (*destroy)(Storage* storage) noexcept;
+  };
+  template <typename Callable>
+  struct InlineOperations;
+  template <typename Callable>
+  struct HeapOperations;
+
+  Storage storage_;
+  const Operations* operations_ = nullptr;
+
+  void moveFrom(InplaceTask& other) noexcept;
+};
+
+template <typename Callable>
+struct InplaceTask::InlineOperations {
+  static Callable* get(Storage* storage) {
+    return std::launder(reinterpret_cast<Callable*>(storage));
+  }
+  static void invoke(Storage* storage) { (*get(storage))(); }
+  static void move(Storage* from, Storage* to) noexcept {
+    new (to) Callable(std::move(*get(from)));
+    get(from)->~Callable();
+  }
+  static void destroy(Storage* storage) noexcept { get(storage)->~Callable(); }
+  static constexpr Operations kOperations{&invoke, &move, &destroy};
+};
+
+template <typename Callable>
+struct InplaceTask::HeapOperations {
+  static Callable*& get(Storage* storage) {
+    return *std::launder(reinterpret_cast<Callable**>(storage));
+  }
+  static void invoke(Storage* storage) { (*get(storage))(); }
+  static void move(Storage* from, Storage* to) noexcept {
+    new (to) Callable*(get(from));
+  }
+  static void destroy(Storage* storage) noexcept { delete get(storage); }
+  static constexpr Operations kOperations{&invoke, &move, &destroy};
+};
+
+template <typename Callable, typename>
+InplaceTask::InplaceTask(Callable&& callable) {
+  using CallableT = std::decay_t<Callable>;
+  if constexpr (isStoredInline<CallableT>()) {
+    new (&storage_) CallableT(std::forward<Callable>(callable));
+    operations_ = &InlineOperations<CallableT>::kOperations;
+  } else {
+    new (&storage_) CallableT*(new CallableT(std::forward<Callable>(callable)));
+    operations_ = &HeapOperations<CallableT>::kOperations;
+  }
+}
+
+inline InplaceTask& InplaceTask::operator=(InplaceTask&& other) noexcept {
+  if (this != &other) {
+    reset();
+    moveFrom(other);
+  }
+  return *this;
+}
+
+inline void InplaceTask::reset() {
+  if (operations_) {
+    operations_->destroy(&storage_);
+    operations_ = nullptr;
+  }
+}
+
+inline void InplaceTask::moveFrom(InplaceTask& other) noexcept {
+  if (other.operations_) {
+    other.operations_->move(&other.storage_, &storage_);
+    operations_ = std::exchange(other.operations_, nullptr);
+  }
+}
+}  // namespace wavemap
+
+#endif  // WAVEMAP_UTILS_INPLACE_TASK_H_
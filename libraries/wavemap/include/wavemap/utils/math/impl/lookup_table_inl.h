@@ -0,0 +1,53 @@
+#ifndef WAVEMAP_UTILS_MATH_IMPL_LOOKUP_TABLE_INL_H_
+#define WAVEMAP_UTILS_MATH_IMPL_LOOKUP_TABLE_INL_H_
+
+#include <algorithm>
+#include <cmath>
+
+namespace wavemap {
+template <typename FunctionT>
+LookupTable::LookupTable(FunctionT function, FloatingPoint min_input,
+                         FloatingPoint max_input, FloatingPoint max_error)
+    : min_input_(min_input), max_input_(max_input) {
+  CHECK_LT(min_input_, max_input_);
+  CHECK_GT(max_error, 0.f);
+
+  // Refine the table until the interpolation error is within the bound
+  for (int num_intervals = kMinNumIntervals; num_intervals <= kMaxNumIntervals;
+       num_intervals *= 2) {
+    num_intervals_ = num_intervals;
+    const FloatingPoint step =
+        (max_input_ - min_input_) / static_cast<FloatingPoint>(num_intervals);
+    step_inv_ = 1.f / step;
+    values_.resize(num_intervals + 1);
+    for (int sample_idx = 0; sample_idx <= num_intervals; ++sample_idx) {
+      values_[sample_idx] =
+          function(min_input_ + static_cast<FloatingPoint>(sample_idx) * step);
+    }
+
+    // Measure the interpolation error in between the samples
+    max_error_ = 0.f;
+    constexpr int kNumErrorSamples = kNumErrorSamplesPerInterval;
+    for (int interval_idx = 0; interval_idx < num_intervals; ++interval_idx) {
+      for (int sample_idx = 1; sample_idx < kNumErrorSamples; ++sample_idx) {
+        const FloatingPoint input =
+            min_input_ +
+            (static_cast<FloatingPoint>(interval_idx) +
+             static_cast<FloatingPoint>(sample_idx) / kNumErrorSamples) *
+                step;
+        max_error_ =
+            std::max(max_error_, std::abs((*this)(input) - function(input)));
+      }
+    }
+    if (max_error_ <= max_error) {
+      return;
+    }
+  }
+
+  LOG(WARNING) << "Could not approximate function within error bound "
+               << max_error << " using " << num_intervals_
+               << " intervals. Achieved error is " << max_error_ << ".";
+}
+}  // namespace wavemap
+
+#endif  // WAVEMAP_UTILS_MATH_IMPL_LOOKUP_TABLE_INL_H_
@@ -0,0 +1,63 @@
+#ifndef WAVEMAP_UTILS_MATH_LOOKUP_TABLE_H_
+#define WAVEMAP_UTILS_MATH_LOOKUP_TABLE_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "wavemap/common.h"
+
+namespace wavemap {
+/**
+ * Piecewise linear approximation of a scalar function on a closed interval,
+ * stored as samples on a uniform grid. Inputs outside the interval are clamped
+ * to its bounds. The number of samples is chosen as the smallest power of two
+ * for which the interpolation error, measured by densely evaluating the
+ * function, stays below the requested bound.
+ */
+class LookupTable {
+ public:
+  static constexpr int kMinNumIntervals = 4;
+  static constexpr int kMaxNumIntervals = 1 << 16;
+  static constexpr int kNumErrorSamplesPerInterval = 16;
+
+  template <typename FunctionT>
+  LookupTable(FunctionT function, FloatingPoint min_input,
+              FloatingPoint max_input, FloatingPoint max_error);
+
+  FloatingPoint operator()(FloatingPoint input) const {
+    const FloatingPoint position =
+        (std::clamp(input, min_input_, max_input_) - min_input_) * step_inv_;
+    const int interval_idx =
+        std::min(static_cast<int>(position), num_intervals_ - 1);
+    const FloatingPoint t = position - static_cast<FloatingPoint>(interval_idx);
+    const FloatingPoint lower_value = values_[interval_idx];
+    return lower_value + t * (values_[interval_idx + 1] - lower_value);
+  }
+
+  FloatingPoint getMinInput() const { return min_input_; }
+  FloatingPoint getMaxInput() const { return max_input_; }
+  int getNumIntervals() const { return num_intervals_; }
+  // Largest interpolation error that was measured while building the table
+  FloatingPoint getMaxError() const { return max_error_; }
+  // Smallest and largest value stored in the table, which also bound the
+  // values it can return
+  FloatingPoint getMinValue() const {
+    return *std::min_element(values_.begin(), values_.end());
+  }
+  FloatingPoint getMaxValue() const {
+    return *std::max_element(values_.begin(), values_.end());
+  }
+
+ private:
+  const FloatingPoint min_input_;
+  const FloatingPoint max_input_;
+  int num_intervals_ = 0;
+  FloatingPoint step_inv_ = 0.f;
+  FloatingPoint max_error_ = 0.f;
+  std::vector<FloatingPoint> values_;
+};
+}  // namespace wavemap
+
+#include "wavemap/utils/math/impl/lookup_table_inl.h"
+
+#endif  // WAVEMAP_UTILS_MATH_LOOKUP_TABLE_H_
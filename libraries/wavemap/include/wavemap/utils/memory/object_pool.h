@@ -0,0 +1,279 @@
+#ifndef WAVEMAP_UTILS_MEMORY_OBJECT_POOL_H_
+#define WAVEMAP_UTILS_MEMORY_OBJECT_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace wavemap {
+/**
+ * \brief Slab allocator for objects of type T with thread-local free lists.
+ *
+ * Objects are carved out of large, contiguous slabs instead of being allocated
+ * individually on the heap. Released objects are recycled through a free list.
+ * To avoid contention between threads, each thread keeps its own free list and
+ * only exchanges objects with the shared pool in batches, e.g. when its list
+ * runs empty or grows too long. Objects can therefore be allocated on one
+ * thread and released on another.
+ *
+ * \note The pool is shared by all objects of type T. Once many of its objects
+ *       are free, slabs whose objects were all returned to the shared pool are
+ *       released to the system. Memory is therefore returned when maps shrink
+ *       or are destroyed, while the free objects of partially used slabs keep
+ *       being recycled.
+ */
+template <typename T>
+class ObjectPool {
+ public:
+  static constexpr size_t kTargetSlabSize = 64 * 1024;  // In bytes
+
+  template <typename... Args>
+  static T* create(Args&&... args);
+  static void destroy(T* object) noexcept;
+
+  // Number of slabs, and thus system allocations, the pool made so far
+  static size_t getNumSlabs() {
+    return getSharedPool().num_slabs.load(std::memory_order_relaxed);
+  }
+  static constexpr size_t getNumObjectsPerSlab() { return kNumSlotsPerSlab; }
+
+ private:
+  union Slot {
+    Slot* next_free;
+    alignas(T) std::byte storage[sizeof(T)];
+  };
+
+  static constexpr size_t kNumSlotsPerSlab =
+      std::max(size_t{8}, kTargetSlabSize / sizeof(Slot));
+  // Number of slots that are moved between the threads and the shared pool
+  static constexpr size_t kBatchSize = std::max(size_t{4}, kNumSlotsPerSlab);
+  // Minimum number of free slots in the shared pool before it releases slabs
+  static constexpr size_t kMinNumFreeSlotsToRelease = 4 * kNumSlotsPerSlab;
+
+  struct SharedPool {
+    std::mutex mutex;
+    Slot* free_list = nullptr;
+    size_t num_free_slots = 0;
+    // NOTE: The threshold grows with the number of free slots that could not
+    //       be released, s.t. the cost of releasing slabs remains amortized.
+    size_t release_threshold = kMinNumFreeSlotsToRelease;
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    std::atomic<size_t> num_slabs = 0;
+  };
+  // NOTE: The shared pool is intentionally leaked, s.t. objects that are
+  //       released during static destruction can still be returned to it.
+  static SharedPool& getSharedPool() {
+    static auto* shared_pool = new SharedPool();
+    return *shared_pool;
+  }
+
+  // NOTE: The free list is trivially destructible, s.t. it remains accessible
+  //       at any point in the thread's lifetime. Its slots are returned to the
+  //       shared pool by a separate flusher once the thread exits.
+  struct ThreadCache {
+    Slot* free_list = nullptr;
+    size_t size = 0;
+    bool has_flusher = false;
+  };
+  struct ThreadCacheFlusher {
+    ~ThreadCacheFlusher();
+  };
+  static inline thread_local ThreadCache thread_cache_;
+
+  static void registerFlusher(ThreadCache& cache);
+  static void refill(ThreadCache& cache);
+  static void drain(ThreadCache& cache, size_t num_slots);
+  static void releaseEmptySlabs(SharedPool& shared_pool);
+};
+
+/**
+ * \brief Deleter that returns objects to their ObjectPool, for use with
+ *        std::unique_ptr.
+ */
+template <typename T>
+struct ObjectPoolDeleter {
+  void operator()(T* object) const noexcept { ObjectPool<T>::destroy(object); }
+};
+
+template <typename T>
+using PooledUniquePtr = std::unique_ptr<T, ObjectPoolDeleter<T>>;
+
+template <typename T, typename... Args>
+PooledUniquePtr<T> makePooledUnique(Args&&... args) {
+  return PooledUniquePtr<T>(
+      ObjectPool<T>::create(std::forward<Args>(args)...));
+}
+
+template <typename T>
+template <typename... Args>
+T* ObjectPool<T>::create(Args&&... args) {
+  ThreadCache& cache = thread_cache_;
+  if (!cache.free_list) {
+    refill(cache);
+  }
+  Slot* slot = cache.free_list;
+  cache.free_list = slot->next_free;
+  --cache.size;
+  // NOTE: If the constructor throws, the slot is simply lost to the pool.
+  return new (slot->storage) T(std::forward<Args>(args)...);
+}
+
+template <typename T>
+void ObjectPool<T>::destroy(T* object) noexcept {
+  if (!object) {
+    return;
+  }
+  object->~T();
+  ThreadCache& cache = thread_cache_;
+  if (!cache.has_flusher) {
+    registerFlusher(cache);
+  }
+  auto* slot = reinterpret_cast<Slot*>(object);
+  slot->next_free = cache.free_list;
+  cache.free_list = slot;
+  ++cache.size;
+  if (2 * kBatchSize < cache.size) {
+    drain(cache, kBatchSize);
+  }
+}
+
+template <typename T>
+ObjectPool<T>::ThreadCacheFlusher::~ThreadCacheFlusher() {
+  ThreadCache& cache = thread_cache_;
+  // NOTE: Objects that are released later on during the thread's exit remain
+  //       in its free list, since the flusher can not be registered again.
+  drain(cache, cache.size);
+}
+
+template <typename T>
+void ObjectPool<T>::registerFlusher(ThreadCache& cache) {
+  // NOTE: Thread-local objects with non-trivial destructors are constructed on
+  //       first use, which also schedules their destruction at thread exit.
+  static thread_local ThreadCacheFlusher flusher;
+  (void)flusher;
+  cache.has_flusher = true;
+}
+
+template <typename T>
+void ObjectPool<T>::refill(ThreadCache& cache) {
+  if (!cache.has_flusher) {
+    registerFlusher(cache);
+  }
+
+  SharedPool& shared_pool = getSharedPool();
+  auto lock = std::scoped_lock(shared_pool.mutex);
+
+  // Take a batch of recycled slots from the shared pool, if available
+  if (shared_pool.free_list) {
+    while (shared_pool.free_list && cache.size < kBatchSize) {
+      Slot* slot = shared_pool.free_list;
+      shared_pool.free_list = slot->next_free;
+      --shared_pool.num_free_slots;
+      slot->next_free = cache.free_list;
+      cache.free_list = slot;
+      ++cache.size;
+    }
+    return;
+  }
+
+  // Otherwise, allocate a new slab
+  // NOTE: The slab's slots are pushed in reverse order, s.t. they are handed
+  //       out in the order in which they are laid out in memory.
+  Slot* slab = shared_pool.slabs.emplace_back(new Slot[kNumSlotsPerSlab]).get();
+  shared_pool.num_slabs.fetch_add(1, std::memory_order_relaxed);
+  for (size_t slot_idx = kNumSlotsPerSlab; 0 < slot_idx; --slot_idx) {
+    Slot* slot = &slab[slot_idx - 1];
+    slot->next_free = cache.free_list;
+    cache.free_list = slot;
+    ++cache.size;
+  }
+}
+
+template <typename T>
+void ObjectPool<T>::drain(ThreadCache& cache, size_t num_slots) {
+  if (num_slots == 0) {
+    return;
+  }
+
+  // Detach the first 'num_slots' slots from the thread's free list
+  Slot* first = cache.free_list;
+  Slot* last = first;
+  for (size_t slot_idx = 1; slot_idx < num_slots; ++slot_idx) {
+    last = last->next_free;
+  }
+  cache.free_list = last->next_free;
+  cache.size -= num_slots;
+
+  // Splice them into the shared pool's free list
+  SharedPool& shared_pool = getSharedPool();
+  auto lock = std::scoped_lock(shared_pool.mutex);
+  last->next_free = shared_pool.free_list;
+  shared_pool.free_list = first;
+  shared_pool.num_free_slots += num_slots;
+
+  // Return memory to the system once enough of it is unused
+  if (shared_pool.release_threshold <= shared_pool.num_free_slots) {
+    releaseEmptySlabs(shared_pool);
+  }
+}
+
+template <typename T>
+void ObjectPool<T>::releaseEmptySlabs(SharedPool& shared_pool) {
+  // Sort the slabs by address, s.t. the slab of each slot can be looked up
+  auto& slabs = shared_pool.slabs;
+  std::sort(slabs.begin(), slabs.end(), [](const auto& lhs, const auto& rhs) {
+    return std::less<const Slot*>{}(lhs.get(), rhs.get());
+  });
+  auto find_slab_idx = [&slabs](const Slot* slot) {
+    const auto slab_it =
+        std::upper_bound(slabs.begin(), slabs.end(), slot,
+                         [](const Slot* value, const auto& slab) {
+                           return std::less<const Slot*>{}(value, slab.get());
+                         });
+    return static_cast<size_t>(std::distance(slabs.begin(), slab_it)) - 1u;
+  };
+
+  // Count the free slots of each slab
+  std::vector<size_t> num_free_slots_per_slab(slabs.size(), 0u);
+  for (Slot* slot = shared_pool.free_list; slot; slot = slot->next_free) {
+    ++num_free_slots_per_slab[find_slab_idx(slot)];
+  }
+
+  // Remove the slots of the slabs that are entirely free from the free list
+  Slot* free_list = nullptr;
+  size_t num_free_slots = 0u;
+  for (Slot* slot = shared_pool.free_list; slot;) {
+    Slot* next_slot = slot->next_free;
+    if (num_free_slots_per_slab[find_slab_idx(slot)] != kNumSlotsPerSlab) {
+      slot->next_free = free_list;
+      free_list = slot;
+      ++num_free_slots;
+    }
+    slot = next_slot;
+  }
+  shared_pool.free_list = free_list;
+  shared_pool.num_free_slots = num_free_slots;
+  shared_pool.release_threshold =
+      std::max(kMinNumFreeSlotsToRelease, 2u * num_free_slots);
+
+  // And release the slabs themselves
+  size_t num_kept_slabs = 0u;
+  for (size_t slab_idx = 0u; slab_idx < slabs.size(); ++slab_idx) {
+    if (num_free_slots_per_slab[slab_idx] != kNumSlotsPerSlab) {
+      std::swap(slabs[num_kept_slabs], slabs[slab_idx]);
+      ++num_kept_slabs;
+    }
+  }
+  slabs.resize(num_kept_slabs);
+  shared_pool.num_slabs.store(num_kept_slabs, std::memory_order_relaxed);
+}
+}  // namespace wavemap
+
+#endif  // WAVEMAP_UTILS_MEMORY_OBJECT_POOL_H_
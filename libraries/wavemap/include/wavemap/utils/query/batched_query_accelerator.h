@@ -0,0 +1,72 @@
+#ifndef WAVEMAP_UTILS_QUERY_BATCHED_QUERY_ACCELERATOR_H_
+#define WAVEMAP_UTILS_QUERY_BATCHED_QUERY_ACCELERATOR_H_
+
+#include <memory>
+#include <vector>
+
+#include "wavemap/common.h"
+#include "wavemap/data_structure/volumetric/hashed_wavelet_octree.h"
+#include "wavemap/indexing/ndtree_index.h"
+#include "wavemap/utils/thread_pool.h"
+
+namespace wavemap {
+/**
+ * \brief Evaluates large batches of queries on a HashedWaveletOctree.
+ *
+ * The queries are first sorted in Morton order. Queries that fall into the
+ * same block and subtree are therefore evaluated one after the other, s.t. each
+ * query can reuse the block lookup and the part of the tree descent it has in
+ * common with its predecessor. The work is split into chunks, which are spread
+ * over the thread pool if one is provided and processed on the calling thread
+ * otherwise. The values are returned in the original order of the queries.
+ *
+ * \note The map must not be modified while a batch is being evaluated.
+ */
+class BatchedQueryAccelerator {
+ public:
+  static constexpr int kDim = 3;
+
+  explicit BatchedQueryAccelerator(
+      const HashedWaveletOctree& map,
+      std::shared_ptr<ThreadPool> thread_pool = nullptr)
+      : map_(map), thread_pool_(std::move(thread_pool)) {}
+
+  // Get the values of the cells that contain the given points, the given cells
+  // or the given nodes at any resolution
+  // NOTE: The values are written to the output array, which must be able to
+  //       hold num_queries values.
+  void getCellValues(const Point3D* points, size_t num_queries,
+                     FloatingPoint* values) const;
+  void getCellValues(const Index3D* indices, size_t num_queries,
+                     FloatingPoint* values) const;
+  void getCellValues(const OctreeIndex* node_indices, size_t num_queries,
+                     FloatingPoint* values) const;
+
+  template <typename QueryT>
+  std::vector<FloatingPoint> getCellValues(
+      const std::vector<QueryT>& queries) const {
+    std::vector<FloatingPoint> values(queries.size());
+    getCellValues(queries.data(), queries.size(), values.data());
+    return values;
+  }
+
+  // Number of queries that are processed together as one task
+  static constexpr size_t kChunkSize = 1u << 14;
+
+ private:
+  const HashedWaveletOctree& map_;
+  const std::shared_ptr<ThreadPool> thread_pool_;
+
+  template <typename QueryT, typename ToNodeIndexFn>
+  void getCellValuesImpl(const QueryT* queries, size_t num_queries,
+                         FloatingPoint* values,
+                         ToNodeIndexFn to_node_index) const;
+
+  // Call chunk_fn(chunk_start, chunk_end) for consecutive chunks of queries,
+  // in parallel if a thread pool is available
+  template <typename ChunkFn>
+  void forEachChunk(size_t num_queries, ChunkFn chunk_fn) const;
+};
+}  // namespace wavemap
+
+#endif  // WAVEMAP_UTILS_QUERY_BATCHED_QUERY_ACCELERATOR_H_
@@ -0,0 +1,166 @@
+#ifndef WAVEMAP_UTILS_QUERY_IMPL_QUERY_ACCELERATOR_INL_H_
+#define WAVEMAP_UTILS_QUERY_IMPL_QUERY_ACCELERATOR_INL_H_
+
+namespace wavemap {
+inline FloatingPoint QueryAccelerator<HashedWaveletOctree>::getCellValue(
+    const OctreeIndex& index) {
+  // Remember previous query indices and compute new ones
+  const BlockIndex previous_block_index = block_index_;
+  const MortonIndex previous_morton_code = morton_code_;
+  const IndexElement previous_height = height_;
+  block_index_ = computeBlockIndexFromIndex(index);
+  morton_code_ = convert::nodeIndexToMorton(index);
+
+  // Check whether we're in the same block as last time
+  if (block_index_ == previous_block_index) {
+    // Compute the last ancestor the current and previous query had in common
+    auto last_common_ancestor = OctreeIndex::computeLastCommonAncestorHeight(
+        morton_code_, index.height, previous_morton_code, previous_height);
+    height_ = last_common_ancestor;
+    DCHECK_LE(height_, tree_height_);
+  } else {
+    // Test if the queried block exists
+    if (const auto it = block_map_.find(block_index_); it != block_map_.end()) {
+      // If yes, load it
+      const auto& current_block = it->second;
+      node_stack_[tree_height_] = &current_block.getRootNode();
+      value_stack_[tree_height_] = current_block.getRootScale();
+      height_ = tree_height_;
+    } else {
+      // Otherwise return ignore this query and return 'unknown'
+      block_index_ = previous_block_index;
+      morton_code_ = previous_morton_code;
+      return 0.f;
+    }
+  }
+
+  // If the requested value was already decompressed in the last query, return
+  if (height_ == index.height) {
+    return value_stack_[height_];
+  }
+
+  // Load the node at height_ if it was not yet loaded last time
+  if (previous_height != tree_height_ && height_ == previous_height) {
+    const NodeType* parent_node = node_stack_[height_ + 1];
+    const NdtreeIndexRelativeChild child_index =
+        OctreeIndex::computeRelativeChildIndex(morton_code_, height_ + 1);
+    if (!parent_node->hasChild(child_index)) {
+      return value_stack_[height_];
+    }
+    node_stack_[height_] = parent_node->getChild(child_index);
+  }
+
+  // Walk down the tree from height_ to index.height
+  while (true) {
+    const NodeType* parent_node = node_stack_[height_];
+    const FloatingPoint parent_value = value_stack_[height_];
+    const NdtreeIndexRelativeChild child_idx =
+        OctreeIndex::computeRelativeChildIndex(morton_code_, height_);
+    --height_;
+    value_stack_[height_] = Transform::backwardSingleChild(
+        parent_value, parent_node->data(), child_idx);
+    if (height_ == index.height || !parent_node->hasChild(child_idx)) {
+      break;
+    }
+    node_stack_[height_] = parent_node->getChild(child_idx);
+  }
+
+  return value_stack_[height_];
+}
+
+inline FloatingPoint
+QueryAccelerator<HashedChunkedWaveletOctree>::getCellValue(
+    const OctreeIndex& index) {
+  // Remember previous query indices and compute new ones
+  const BlockIndex previous_block_index = block_index_;
+  const MortonIndex previous_morton_code = morton_code_;
+  const IndexElement previous_height = height_;
+  block_index_ = computeBlockIndexFromIndex(index);
+  morton_code_ = convert::nodeIndexToMorton(index);
+
+  // Check whether we're in the same block as last time
+  if (block_index_ == previous_block_index) {
+    // Compute the last ancestor the current and previous query had in common
+    auto last_common_ancestor = OctreeIndex::computeLastCommonAncestorHeight(
+        morton_code_, index.height, previous_morton_code, previous_height);
+    height_ = last_common_ancestor;
+    DCHECK_LE(height_, tree_height_);
+  } else {
+    // Test if the queried block exists
+    if (const auto it = block_map_.find(block_index_); it != block_map_.end()) {
+      // If yes, load it
+      const auto& current_block = it->second;
+      chunk_stack_[tree_height_] = &current_block.getRootChunk();
+      value_stack_[tree_height_] = current_block.getRootScale();
+      height_ = tree_height_;
+    } else {
+      // Otherwise return ignore this query and return 'unknown'
+      block_index_ = previous_block_index;
+      morton_code_ = previous_morton_code;
+      return 0.f;
+    }
+  }
+
+  // If the requested value was already decompressed in the last query, return
+  if (height_ == index.height) {
+    return value_stack_[height_];
+  }
+
+  // If the last query stopped at height_, check whether the node at height_
+  // has any details and load its chunk if it was not yet loaded last time
+  if (previous_height != tree_height_ && height_ == previous_height) {
+    const IndexElement parent_height = height_ + 1;
+    const IndexElement chunk_top_height = computeChunkTopHeight(parent_height);
+    const NodeChunkType* parent_chunk = chunk_stack_[chunk_top_height];
+    const LinearIndex relative_parent_index =
+        OctreeIndex::computeTreeTraversalDistance(
+            morton_code_, chunk_top_height, parent_height);
+    if (!parent_chunk->nodeHasAtLeastOneChild(relative_parent_index)) {
+      return value_stack_[height_];
+    }
+    if (height_ == chunk_top_height - kChunkHeight) {
+      const LinearIndex linear_child_index =
+          OctreeIndex::computeLevelTraversalDistance(
+              morton_code_, chunk_top_height, height_);
+      if (!parent_chunk->hasChild(linear_child_index)) {
+        return value_stack_[height_];
+      }
+      chunk_stack_[height_] = parent_chunk->getChild(linear_child_index);
+    }
+  }
+
+  // Walk down the tree from height_ to index.height
+  IndexElement chunk_top_height = computeChunkTopHeight(height_);
+  while (true) {
+    const NodeChunkType* chunk = chunk_stack_[chunk_top_height];
+    const FloatingPoint parent_value = value_stack_[height_];
+    const LinearIndex relative_node_index =
+        OctreeIndex::computeTreeTraversalDistance(morton_code_,
+                                                  chunk_top_height, height_);
+    const NdtreeIndexRelativeChild child_idx =
+        OctreeIndex::computeRelativeChildIndex(morton_code_, height_);
+    --height_;
+    value_stack_[height_] = Transform::backwardSingleChild(
+        parent_value, chunk->nodeData(relative_node_index), child_idx);
+    if (height_ == index.height ||
+        !chunk->nodeHasAtLeastOneChild(relative_node_index)) {
+      break;
+    }
+    // Descend to the next chunk once we've walked past the current chunk
+    if (height_ == chunk_top_height - kChunkHeight) {
+      const LinearIndex linear_child_index =
+          OctreeIndex::computeLevelTraversalDistance(
+              morton_code_, chunk_top_height, height_);
+      if (!chunk->hasChild(linear_child_index)) {
+        break;
+      }
+      chunk_top_height = height_;
+      chunk_stack_[chunk_top_height] = chunk->getChild(linear_child_index);
+    }
+  }
+
+  return value_stack_[height_];
+}
+}  // namespace wavemap
+
+#endif  // WAVEMAP_UTILS_QUERY_IMPL_QUERY_ACCELERATOR_INL_H_
@@ -3,24 +3,66 @@
 
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <utility>
 #include <vector>
 
-#include <glog/logging.h>
+#include "wavemap/utils/inplace_task.h"
 
 namespace wavemap {
 /**
- * \brief Implements a thread pool with a fixed number of threads.
+ * \brief Implements a work-stealing thread pool with a fixed number of threads.
+ *
+ * Each worker owns a task deque. Tasks submitted from within a worker are
+ * pushed onto and popped from the back of its own deque, which keeps
+ * recursively spawned work cache-local. Tasks submitted from other threads
+ * are distributed over the workers' deques in a round-robin fashion. Idle
+ * workers steal tasks from the front of the other workers' deques.
  */
 class ThreadPool {
  public:
+  /**
+   * \brief Tracks the completion of a group of detached tasks.
+   *
+   * \details Detached tasks that are added to a group can be awaited with
+   *          wait_for, which only waits for the tasks in the group. The group
+   *          must outlive its tasks, i.e. it must be waited on before it is
+   *          destroyed.
+   */
+  class TaskGroup {
+   public:
+    TaskGroup() = default;
+    ~TaskGroup();
+
+    // Prevent copying etc. of this class, as its tasks refer to it
+    TaskGroup(TaskGroup const& other) = delete;
+    TaskGroup& operator=(TaskGroup const& other) = delete;
+
+    /**
+     * \brief Returns whether all the group's tasks completed.
+     */
+    bool is_done() const { return pending_task_count_ == 0; }
+
+   private:
+    friend class ThreadPool;
+
+    //! Count of the group's tasks that were added but not yet completed
+    std::atomic<int> pending_task_count_{0};
+    //! Synchronizes task completions with the threads waiting for them
+    std::mutex mutex_;
+    //! Waiting thread notification condition variable
+    std::condition_variable condition_;
+
+    void task_done();
+  };
+
   /**
    * \brief Creates a new thread pool with the a number of workers.
    *
@@ -38,11 +80,46 @@ class ThreadPool {
    */
   ~ThreadPool();
 
+  /**
+   * \brief Returns the number of worker threads.
+   */
+  size_t size() const { return workers_.size(); }
+
+  /**
+   * \brief Returns whether the calling thread is one of this pool's workers.
+   */
+  bool is_worker_thread() const;
+
   /**
    * \brief Waits for all work to be complete.
+   *
+   * \note This includes unrelated tasks that other users submitted to the same
+   *       pool. It must not be called from within a task, as it would wait for
+   *       itself. Prefer waiting on specific tasks with wait_for.
    */
   void wait_all();
 
+  /**
+   * \brief Waits for the task, or the tasks, behind the given future(s).
+   *
+   * \details Unlike wait_all, this does not wait for unrelated tasks. When
+   *          called from one of the pool's workers, the worker runs queued
+   *          tasks while it waits instead of blocking, s.t. tasks can wait on
+   *          the tasks they spawned without deadlocking the pool.
+   * \param futures the future(s) returned by add_task
+   */
+  template <typename FutureT>
+  void wait_for(const FutureT& future);
+  template <typename FutureT>
+  void wait_for(const std::vector<FutureT>& futures);
+
+  /**
+   * \brief Waits for all the tasks of the given group, like wait_for(future).
+   *
+   * \param task_group the group the tasks were added to by add_detached_task
+   */
+  void wait_for(TaskGroup& task_group);
+
   /**
    * \brief Adds a callable task to the task queue.
    *
@@ -54,28 +131,93 @@ class ThreadPool {
   std::future<std::result_of_t<Callable(Args...)>> add_task(Callable&& callable,
                                                             Args&&... args);
 
+  /**
+   * \brief Adds a fire-and-forget task to the task queue.
+   *
+   * \details Unlike add_task, no future or shared state is created. Callables
+   *          that fit in InplaceTask's inline buffer are therefore scheduled
+   *          without any heap allocations. To wait for the task, add it to a
+   *          TaskGroup with the overload below. Otherwise, callers that need
+   *          to know when the task completed must signal it themselves.
+   * \param callable the executable task, taking no arguments
+   */
+  template <typename Callable>
+  void add_detached_task(Callable&& callable) {
+    enqueue(InplaceTask(std::forward<Callable>(callable)));
+  }
+
+  /**
+   * \brief Adds a fire-and-forget task whose completion is tracked by a group.
+   *
+   * \param task_group the group to add the task to, which must outlive it
+   * \param callable the executable task, taking no arguments
+   */
+  template <typename Callable>
+  void add_detached_task(TaskGroup& task_group, Callable&& callable);
+
  private:
+  struct alignas(64) WorkerQueue {
+    std::mutex mutex;
+    std::deque<InplaceTask> tasks;
+  };
+
+  /**
+   * \brief Pushes a task onto the calling worker's deque, or onto one of the
+   *        workers' deques if the caller is not a worker of this pool.
+   */
+  void enqueue(InplaceTask&& task);
+
+  /**
+   * \brief Pops a task from the back of the worker's own deque or, if it is
+   *        empty, steals one from the front of another worker's deque.
+   */
+  bool try_pop(size_t worker_idx, InplaceTask& task);
+
+  /**
+   * \brief Runs a task that was popped by a worker and updates the counters.
+   */
+  void run_task(InplaceTask& task);
+
+  /**
+   * \brief Lets the calling worker run one queued task, if there is one.
+   *
+   * \return whether a task was run
+   */
+  bool run_pending_task();
+
   /**
    * \brief Loop executed by each of the workers.
    */
-  void worker_loop();
+  void worker_loop(size_t worker_idx);
 
  private:
   //! Worker threads of the pool
   std::vector<std::thread> workers_;
-  //! Queue of tasks to execute
-  std::queue<std::function<void()>> tasks_;
+  //! Task deques, one per worker
+  std::unique_ptr<WorkerQueue[]> queues_;
+  //! Index of the deque that the next external submission will be pushed to
+  std::atomic<size_t> next_queue_idx_;
+
+  //! Count of tasks that were queued but not yet picked up by a worker
+  std::atomic<int> queued_task_count_;
   //! Count of tasks yet to be completed
   std::atomic<int> task_count_;
+  //! Number of workers that are currently sleeping
+  std::atomic<int> sleeping_worker_count_;
 
-  //! Task queue synchronization mutex
-  std::mutex tasks_mutex_;
+  //! Worker thread sleep synchronization mutex
+  std::mutex worker_mutex_;
   //! Worker thread notification condition variable
   std::condition_variable worker_condition_;
+  //! Waiting thread synchronization mutex
+  std::mutex wait_all_mutex_;
   //! Waiting thread notification condition variable
   std::condition_variable wait_all_condition_;
   //! Flag indicating the termination of all workers
   std::atomic<bool> terminate_;
+
+  //! Time a worker waiting in wait_for sleeps if there is nothing to run
+  static constexpr auto kWaitForPollingInterval = std::chrono::microseconds(50);
 };
 
 template <typename Callable, typename... Args>
@@ -83,20 +225,45 @@ std::future<std::result_of_t<Callable(Args...)>> ThreadPool::add_task(
     Callable&& callable, Args&&... args) {
   using ReturnType = std::result_of_t<Callable(Args...)>;
 
-  auto task = std::make_shared<std::packaged_task<ReturnType()>>(
+  std::packaged_task<ReturnType()> task(
       std::bind(std::forward<Callable>(callable), std::forward<Args>(args)...));
+  auto future = task.get_future();
+  enqueue(InplaceTask(std::move(task)));
 
-  {
-    auto lock = std::scoped_lock<std::mutex>(tasks_mutex_);
-    if (terminate_) {
-      LOG(FATAL) << "Adding tasks to an already stopped pool.";
+  return future;
+}
+
+template <typename Callable>
+void ThreadPool::add_detached_task(TaskGroup& task_group, Callable&& callable) {
+  ++task_group.pending_task_count_;
+  enqueue(InplaceTask(
+      [&task_group, callable = std::forward<Callable>(callable)]() mutable {
+        callable();
+        task_group.task_done();
+      }));
+}
+
+template <typename FutureT>
+void ThreadPool::wait_for(const FutureT& future) {
+  if (!is_worker_thread()) {
+    future.wait();
+    return;
+  }
+  // Help out instead of blocking, since the awaited task might still be
+  // queued behind the task that is waiting for it
+  while (future.wait_for(std::chrono::seconds(0)) !=
+         std::future_status::ready) {
+    if (!run_pending_task()) {
+      future.wait_for(kWaitForPollingInterval);
     }
-    tasks_.emplace([task]() { (*task)(); });
-    task_count_++;
   }
-  worker_condition_.notify_one();
+}
 
-  return task->get_future();
+template <typename FutureT>
+void ThreadPool::wait_for(const std::vector<FutureT>& futures) {
+  for (const auto& future : futures) {
+    wait_for(future);
+  }
 }
 }  // namespace wavemap
 
@@ -1,5 +1,9 @@
 #include "wavemap/data_structure/volumetric/hashed_blocks.h"
 
+#include <unordered_set>
+
+#include "wavemap/indexing/index_hashes.h"
+
 namespace wavemap {
 void HashedBlocks::prune() {
   const Index3D min_local_cell_index = Index3D::Zero();
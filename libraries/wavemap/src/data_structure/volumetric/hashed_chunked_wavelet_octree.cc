@@ -1,9 +1,14 @@
 #include "wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h"
 
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <tracy/Tracy.hpp>
 
+#include "wavemap/data_structure/volumetric/hashed_block_maintenance.h"
+#include "wavemap/indexing/index_hashes.h"
+
 namespace wavemap {
 DECLARE_CONFIG_MEMBERS(HashedChunkedWaveletOctreeConfig,
                       (min_cell_width)
@@ -61,6 +66,22 @@ void HashedChunkedWaveletOctree::pruneSmart() {
   }
 }
 
+void HashedChunkedWaveletOctree::threshold(ThreadPool& thread_pool) {
+  ZoneScoped;
+  hashed_block_maintenance::threshold(blocks_, thread_pool);
+}
+
+void HashedChunkedWaveletOctree::prune(ThreadPool& thread_pool) {
+  ZoneScoped;
+  hashed_block_maintenance::prune(blocks_, thread_pool);
+}
+
+void HashedChunkedWaveletOctree::pruneSmart(ThreadPool& thread_pool) {
+  ZoneScoped;
+  hashed_block_maintenance::pruneIfUnusedFor(
+      blocks_, config_.only_prune_blocks_if_unused_for, thread_pool);
+}
+
 size_t HashedChunkedWaveletOctree::getMemoryUsage() const {
   ZoneScoped;
   // TODO(victorr): Also include the memory usage of the unordered map itself
@@ -96,4 +117,58 @@ Index3D HashedChunkedWaveletOctree::getMaxIndex() const {
   }
   return cells_per_block_side_ * (max_block_index + Index3D::Ones());
 }
+
+void HashedChunkedWaveletOctree::addToCellValues(
+    const NodeUpdateList& updates) {
+  ZoneScoped;
+  // Group the updates by block, expressing their indices w.r.t. the block
+  std::unordered_map<BlockIndex, NodeUpdateList, IndexHash<kDim>>
+      block_updates;
+  for (const NodeUpdate& node_update : updates) {
+    const BlockIndex block_index =
+        computeBlockIndexFromIndex(node_update.index);
+    block_updates[block_index].emplace_back(NodeUpdate{
+        computeCellIndexFromBlockIndexAndIndex(block_index, node_update.index),
+        node_update.update});
+  }
+
+  // Apply them block by block
+  for (auto& [block_index, node_updates] : block_updates) {
+    sortNodeUpdates(node_updates);
+    getOrAllocateBlock(block_index).addToCellValues(node_updates);
+  }
+}
+
+void HashedChunkedWaveletOctree::allocateBlocks(
+    const std::vector<Index3D>& block_indices) {
+  ZoneScoped;
+  auto blocks_lock = std::unique_lock(blocks_mutex_);
+  blocks_.reserve(blocks_.size() + block_indices.size());
+  for (const Index3D& block_index : block_indices) {
+    getOrAllocateBlock(block_index);
+  }
+}
+
+void HashedChunkedWaveletOctree::allocateBlocks(
+    const std::vector<Index3D>& block_indices,
+    std::shared_lock<std::shared_mutex>& blocks_lock) {
+  ZoneScoped;
+  DCHECK_EQ(blocks_lock.mutex(), &blocks_mutex_);
+  DCHECK(blocks_lock.owns_lock());
+  auto find_missing_blocks = [this, &block_indices]() {
+    std::vector<Index3D> missing_blocks;
+    for (const Index3D& block_index : block_indices) {
+      if (!hasBlock(block_index)) {
+        missing_blocks.emplace_back(block_index);
+      }
+    }
+    return missing_blocks;
+  };
+  for (auto missing_blocks = find_missing_blocks(); !missing_blocks.empty();
+       missing_blocks = find_missing_blocks()) {
+    blocks_lock.unlock();
+    allocateBlocks(missing_blocks);
+    blocks_lock.lock();
+  }
+}
 }  // namespace wavemap
@@ -1,5 +1,7 @@
 #include "wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree_block.h"
 
+#include <algorithm>
+
 #include <tracy/Tracy.hpp>
 
 namespace wavemap {
@@ -27,6 +29,7 @@ void HashedChunkedWaveletOctreeBlock::setCellValue(const OctreeIndex& index,
   setNeedsPruning();
   setNeedsThresholding();
   setLastUpdatedStamp();
+  dirty_subtrees_.markDirty(index);
 
   // Descend the tree chunk by chunk while decompressing, and caching chunk ptrs
   const MortonIndex morton_code = convert::nodeIndexToMorton(index);
@@ -48,7 +51,7 @@ void HashedChunkedWaveletOctreeBlock::setCellValue(const OctreeIndex& index,
       const NdtreeIndexRelativeChild relative_child_index =
           OctreeIndex::computeRelativeChildIndex(morton_code, parent_height);
       current_value = Transform::backwardSingleChild(
-          {current_value, current_chunk->nodeData(relative_node_index)},
+          current_value, current_chunk->nodeData(relative_node_index),
           relative_child_index);
       // If we've reached the requested resolution, stop descending
       if (parent_height == index.height + 1) {
@@ -99,6 +102,7 @@ void HashedChunkedWaveletOctreeBlock::addToCellValue(const OctreeIndex& index,
   setNeedsPruning();
   setNeedsThresholding();
   setLastUpdatedStamp();
+  dirty_subtrees_.markDirty(index);
 
   const MortonIndex morton_code = convert::nodeIndexToMorton(index);
   std::array<NodeChunkType*, kMaxChunkStackDepth> chunk_ptrs{};
@@ -143,6 +147,32 @@ void HashedChunkedWaveletOctreeBlock::addToCellValue(const OctreeIndex& index,
   root_scale_coefficient_ += coefficients.scale;
 }
 
+void HashedChunkedWaveletOctreeBlock::addToCellValues(
+    const NodeUpdateList& sorted_updates) {
+  ZoneScoped;
+  if (sorted_updates.empty()) {
+    return;
+  }
+  DCHECK(std::is_sorted(sorted_updates.begin(), sorted_updates.end(),
+                        isInBulkUpdateOrder));
+
+  setNeedsPruning();
+  setNeedsThresholding();
+  setLastUpdatedStamp();
+  for (const auto& node_update : sorted_updates) {
+    dirty_subtrees_.markDirty(node_update.index);
+  }
+
+  std::vector<MortonIndex> morton_codes(sorted_updates.size());
+  std::transform(sorted_updates.begin(), sorted_updates.end(),
+                 morton_codes.begin(), [](const NodeUpdate& node_update) {
+                   return convert::nodeIndexToMorton(node_update.index);
+                 });
+  root_scale_coefficient_ += recursiveAddToCellValues(
+      chunked_ndtree_.getRootChunk(), tree_height_, tree_height_,
+      sorted_updates, morton_codes, 0u, sorted_updates.size());
+}
+
 void HashedChunkedWaveletOctreeBlock::forEachLeaf(
     const BlockIndex& block_index,
     VolumetricDataStructureBase::IndexedLeafVisitorFunction visitor_fn) const {
@@ -315,4 +345,75 @@ void HashedChunkedWaveletOctreeBlock::recursivePrune(  // NOLINT
     chunk.deleteChildrenArray();
   }
 }
+
+HashedChunkedWaveletOctreeBlock::Coefficients::Scale
+HashedChunkedWaveletOctreeBlock::recursiveAddToCellValues(  // NOLINT
+    NodeChunkType& chunk, IndexElement chunk_top_height,
+    IndexElement node_height, const NodeUpdateList& updates,
+    const std::vector<MortonIndex>& morton_codes, size_t first_update_idx,
+    size_t last_update_idx) {
+  // Updates to the node itself come first. Since they change all of its
+  // children equally, they only affect its scale coefficient.
+  Coefficients::Scale scale_update{};
+  size_t update_idx = first_update_idx;
+  for (; update_idx < last_update_idx &&
+         updates[update_idx].index.height == node_height;
+       ++update_idx) {
+    scale_update += updates[update_idx].update;
+  }
+  if (update_idx == last_update_idx) {
+    return scale_update;
+  }
+
+  // Compute the scale updates of the children, whose updates are contiguous
+  Coefficients::CoefficientsArray child_scale_updates{};
+  const IndexElement child_height = node_height - 1;
+  const bool children_start_new_chunk =
+      (tree_height_ - child_height) % kChunkHeight == 0;
+  while (update_idx < last_update_idx) {
+    const MortonIndex child_morton = morton_codes[update_idx];
+    const NdtreeIndexRelativeChild child_idx =
+        OctreeIndex::computeRelativeChildIndex(child_morton, node_height);
+    size_t child_last_update_idx = update_idx + 1;
+    while (child_last_update_idx < last_update_idx &&
+           OctreeIndex::computeRelativeChildIndex(
+               morton_codes[child_last_update_idx], node_height) == child_idx) {
+      ++child_last_update_idx;
+    }
+    // If the child is only updated as a whole, there is no need to descend
+    if (updates[child_last_update_idx - 1].index.height == child_height) {
+      for (; update_idx < child_last_update_idx; ++update_idx) {
+        child_scale_updates[child_idx] += updates[update_idx].update;
+      }
+      continue;
+    }
+    if (children_start_new_chunk) {
+      const LinearIndex linear_child_index =
+          OctreeIndex::computeLevelTraversalDistance(
+              child_morton, chunk_top_height, child_height);
+      NodeChunkType* child_chunk =
+          chunk.hasChild(linear_child_index)
+              ? chunk.getChild(linear_child_index)
+              : chunk.allocateChild(linear_child_index);
+      child_scale_updates[child_idx] = recursiveAddToCellValues(
+          *child_chunk, child_height, child_height, updates, morton_codes,
+          update_idx, child_last_update_idx);
+    } else {
+      child_scale_updates[child_idx] = recursiveAddToCellValues(
+          chunk, chunk_top_height, child_height, updates, morton_codes,
+          update_idx, child_last_update_idx);
+    }
+    update_idx = child_last_update_idx;
+  }
+
+  const auto [children_scale_update, detail_updates] =
+      Transform::forward(child_scale_updates);
+  const LinearIndex relative_node_index =
+      OctreeIndex::computeTreeTraversalDistance(
+          morton_codes[first_update_idx], chunk_top_height, node_height);
+  chunk.nodeData(relative_node_index) += detail_updates;
+  chunk.nodeHasAtLeastOneChild(relative_node_index) = true;
+
+  return scale_update + children_scale_update;
+}
 }  // namespace wavemap
@@ -1,5 +1,7 @@
 #include "wavemap/data_structure/volumetric/hashed_wavelet_octree_block.h"
 
+#include <algorithm>
+
 #include <tracy/Tracy.hpp>
 
 namespace wavemap {
@@ -26,6 +28,7 @@ void HashedWaveletOctreeBlock::clear() {
   root_scale_coefficient_ = Coefficients::Scale{};
   ndtree_.clear();
   last_updated_stamp_ = Time::now();
+  dirty_subtrees_.markAllDirty();
 }
 
 void HashedWaveletOctreeBlock::setCellValue(const OctreeIndex& index,
@@ -33,6 +36,7 @@ void HashedWaveletOctreeBlock::setCellValue(const OctreeIndex& index,
   setNeedsPruning();
   setNeedsThresholding();
   setLastUpdatedStamp();
+  dirty_subtrees_.markDirty(index);
   const MortonIndex morton_code = convert::nodeIndexToMorton(index);
   std::vector<NodeType*> node_ptrs;
   const int height_difference = tree_height_ - index.height;
@@ -45,7 +49,7 @@ void HashedWaveletOctreeBlock::setCellValue(const OctreeIndex& index,
         OctreeIndex::computeRelativeChildIndex(morton_code, parent_height);
     NodeType* current_parent = node_ptrs.back();
     current_value = Transform::backwardSingleChild(
-        {current_value, current_parent->data()}, child_index);
+        current_value, current_parent->data(), child_index);
     if (!current_parent->hasChild(child_index)) {
       current_parent->allocateChild(child_index);
     }
@@ -73,6 +77,7 @@ void HashedWaveletOctreeBlock::addToCellValue(const OctreeIndex& index,
   setNeedsPruning();
   setNeedsThresholding();
   setLastUpdatedStamp();
+  dirty_subtrees_.markDirty(index);
   const MortonIndex morton_code = convert::nodeIndexToMorton(index);
 
   std::vector<NodeType*> node_ptrs;
@@ -105,6 +110,32 @@ void HashedWaveletOctreeBlock::addToCellValue(const OctreeIndex& index,
   root_scale_coefficient_ += coefficients.scale;
 }
 
+void HashedWaveletOctreeBlock::addToCellValues(
+    const NodeUpdateList& sorted_updates) {
+  ZoneScoped;
+  if (sorted_updates.empty()) {
+    return;
+  }
+  DCHECK(std::is_sorted(sorted_updates.begin(), sorted_updates.end(),
+                        isInBulkUpdateOrder));
+
+  setNeedsPruning();
+  setNeedsThresholding();
+  setLastUpdatedStamp();
+  for (const auto& node_update : sorted_updates) {
+    dirty_subtrees_.markDirty(node_update.index);
+  }
+
+  std::vector<MortonIndex> morton_codes(sorted_updates.size());
+  std::transform(sorted_updates.begin(), sorted_updates.end(),
+                 morton_codes.begin(), [](const NodeUpdate& node_update) {
+                   return convert::nodeIndexToMorton(node_update.index);
+                 });
+  root_scale_coefficient_ += recursiveAddToCellValues(
+      ndtree_.getRootNode(), tree_height_, sorted_updates, morton_codes, 0u,
+      sorted_updates.size());
+}
+
 void HashedWaveletOctreeBlock::forEachLeaf(
     const BlockIndex& block_index,
     VolumetricDataStructureBase::IndexedLeafVisitorFunction visitor_fn,
@@ -173,6 +204,60 @@ HashedWaveletOctreeBlock::recursiveThreshold(  // NOLINT
   return scale_update;
 }
 
+HashedWaveletOctreeBlock::Coefficients::Scale
+HashedWaveletOctreeBlock::recursiveAddToCellValues(  // NOLINT
+    HashedWaveletOctreeBlock::NodeType& node, IndexElement node_height,
+    const NodeUpdateList& updates, const std::vector<MortonIndex>& morton_codes,
+    size_t first_update_idx, size_t last_update_idx) {
+  // Updates to the node itself come first. Since they change all of its
+  // children equally, they only affect its scale coefficient.
+  Coefficients::Scale scale_update{};
+  size_t update_idx = first_update_idx;
+  for (; update_idx < last_update_idx &&
+         updates[update_idx].index.height == node_height;
+       ++update_idx) {
+    scale_update += updates[update_idx].update;
+  }
+  if (update_idx == last_update_idx) {
+    return scale_update;
+  }
+
+  // Compute the scale updates of the children, whose updates are contiguous
+  Coefficients::CoefficientsArray child_scale_updates{};
+  const IndexElement child_height = node_height - 1;
+  while (update_idx < last_update_idx) {
+    const NdtreeIndexRelativeChild child_idx =
+        OctreeIndex::computeRelativeChildIndex(morton_codes[update_idx],
+                                               node_height);
+    size_t child_last_update_idx = update_idx + 1;
+    while (child_last_update_idx < last_update_idx &&
+           OctreeIndex::computeRelativeChildIndex(
+               morton_codes[child_last_update_idx], node_height) == child_idx) {
+      ++child_last_update_idx;
+    }
+    // If the child is only updated as a whole, there is no need to descend
+    if (updates[child_last_update_idx - 1].index.height == child_height) {
+      for (; update_idx < child_last_update_idx; ++update_idx) {
+        child_scale_updates[child_idx] += updates[update_idx].update;
+      }
+    } else {
+      NodeType* child_node = node.hasChild(child_idx)
+                                 ? node.getChild(child_idx)
+                                 : node.allocateChild(child_idx);
+      child_scale_updates[child_idx] = recursiveAddToCellValues(
+          *child_node, child_height, updates, morton_codes, update_idx,
+          child_last_update_idx);
+      update_idx = child_last_update_idx;
+    }
+  }
+
+  const auto [children_scale_update, detail_updates] =
+      Transform::forward(child_scale_updates);
+  node.data() += detail_updates;
+
+  return scale_update + children_scale_update;
+}
+
 void HashedWaveletOctreeBlock::recursivePrune(  // NOLINT
     HashedWaveletOctreeBlock::NodeType& node) {
   bool has_at_least_one_child = false;
@@ -1,62 +1,81 @@
 #include "wavemap/integrator/integrator_factory.h"
 
 #include "wavemap/integrator/integrator_base.h"
+#include "wavemap/integrator/measurement_model/continuous_beam.h"
 #include "wavemap/integrator/measurement_model/measurement_model_factory.h"
+#include "wavemap/integrator/projection_model/ouster_projector.h"
+#include "wavemap/integrator/projection_model/pinhole_camera_projector.h"
 #include "wavemap/integrator/projection_model/projector_factory.h"
+#include "wavemap/integrator/projection_model/spherical_projector.h"
 #include "wavemap/integrator/projective/coarse_to_fine/coarse_to_fine_integrator.h"
 #include "wavemap/integrator/projective/coarse_to_fine/hashed_chunked_wavelet_integrator.h"
 #include "wavemap/integrator/projective/coarse_to_fine/hashed_wavelet_integrator.h"
 #include "wavemap/integrator/projective/coarse_to_fine/wavelet_integrator.h"
 #include "wavemap/integrator/projective/fixed_resolution/fixed_resolution_integrator.h"
+#include "wavemap/integrator/projective/pipelined_integrator.h"
 #include "wavemap/integrator/ray_tracing/ray_tracing_integrator.h"
 
 namespace wavemap {
-IntegratorBase::Ptr IntegratorFactory::create(
-    const param::Value& params, VolumetricDataStructureBase::Ptr occupancy_map,
-    std::shared_ptr<ThreadPool> thread_pool,
-    std::optional<IntegratorType> default_integrator_type) {
-  if (const auto type = IntegratorType::from(params, "integration_method");
-      type) {
-    return create(type.value(), params, std::move(occupancy_map),
-                  std::move(thread_pool));
-  }
-
-  if (default_integrator_type.has_value()) {
-    LOG(WARNING) << "Default type \"" << default_integrator_type.value().toStr()
-                 << "\" will be created instead.";
-    return create(default_integrator_type.value(), params,
-                  std::move(occupancy_map), std::move(thread_pool));
-  }
-
-  LOG(ERROR) << "No default was set. Returning nullptr.";
-  return nullptr;
-}
-
-IntegratorBase::Ptr IntegratorFactory::create(
-    IntegratorType integrator_type, const param::Value& params,
-    VolumetricDataStructureBase::Ptr occupancy_map,
+namespace {
+// Create a hashed integrator whose block update kernels are specialized for the
+// types of the given projection and measurement models, if they match one of
+// the combinations that specializations are compiled for, and fall back to the
+// generic (virtual) implementation otherwise
+template <template <typename, typename> typename SpecializedIntegratorT,
+          typename GenericIntegratorT, typename MapT>
+IntegratorBase::Ptr createSpecializedIfAvailable(
+    const ProjectiveIntegratorConfig& config,
+    ProjectorBase::ConstPtr projection_model,
+    PosedImage<>::Ptr posed_range_image,
+    Image<Vector2D>::Ptr beam_offset_image,
+    MeasurementModelBase::ConstPtr measurement_model, MapT occupancy_map,
     std::shared_ptr<ThreadPool> thread_pool) {
-  // If we're using a ray tracing based integrator, we can build it directly
-  if (integrator_type == IntegratorType::kRayTracingIntegrator) {
-    if (const auto config =
-            RayTracingIntegratorConfig::from(params, "integration_method");
-        config) {
-      return std::make_shared<RayTracingIntegrator>(config.value(),
-                                                    std::move(occupancy_map));
-    } else {
-      LOG(ERROR) << "Ray tracing integrator config could not be loaded.";
-      return nullptr;
+  if (auto continuous_beam =
+          std::dynamic_pointer_cast<const ContinuousBeam>(measurement_model);
+      continuous_beam) {
+    if (auto ouster_projector =
+            std::dynamic_pointer_cast<const OusterProjector>(projection_model);
+        ouster_projector) {
+      return std::make_shared<
+          SpecializedIntegratorT<OusterProjector, ContinuousBeam>>(
+          config, std::move(ouster_projector), std::move(posed_range_image),
+          std::move(beam_offset_image), std::move(continuous_beam),
+          std::move(occupancy_map), std::move(thread_pool));
+    }
+    if (auto pinhole_projector =
+            std::dynamic_pointer_cast<const PinholeCameraProjector>(
+                projection_model);
+        pinhole_projector) {
+      return std::make_shared<
+          SpecializedIntegratorT<PinholeCameraProjector, ContinuousBeam>>(
+          config, std::move(pinhole_projector), std::move(posed_range_image),
+          std::move(beam_offset_image), std::move(continuous_beam),
+          std::move(occupancy_map), std::move(thread_pool));
+    }
+    if (auto spherical_projector =
+            std::dynamic_pointer_cast<const SphericalProjector>(
+                projection_model);
+        spherical_projector) {
+      return std::make_shared<
+          SpecializedIntegratorT<SphericalProjector, ContinuousBeam>>(
+          config, std::move(spherical_projector), std::move(posed_range_image),
+          std::move(beam_offset_image), std::move(continuous_beam),
+          std::move(occupancy_map), std::move(thread_pool));
     }
   }
 
-  // Load the projective integrator config
-  const auto integrator_config =
-      ProjectiveIntegratorConfig::from(params, "integration_method");
-  if (!integrator_config.has_value()) {
-    LOG(ERROR) << "Integrator config could not be loaded.";
-    return nullptr;
-  }
+  return std::make_shared<GenericIntegratorT>(
+      config, std::move(projection_model), std::move(posed_range_image),
+      std::move(beam_offset_image), std::move(measurement_model),
+      std::move(occupancy_map), std::move(thread_pool));
+}
 
+// Create a single projective integrator, including its own projection model,
+// range and beam-offset images and measurement model
+IntegratorBase::Ptr createProjectiveIntegrator(
+    IntegratorType integrator_type, const ProjectiveIntegratorConfig& config,
+    const param::Value& params, VolumetricDataStructureBase::Ptr occupancy_map,
+    std::shared_ptr<ThreadPool> thread_pool) {
   // Create the projection model
   std::shared_ptr<ProjectorBase> projection_model =
       ProjectorFactory::create(params);
@@ -85,16 +104,16 @@ IntegratorBase::Ptr IntegratorFactory::create(
   switch (integrator_type.toTypeId()) {
     case IntegratorType::kFixedResolutionIntegrator: {
       return std::make_shared<FixedResolutionIntegrator>(
-          integrator_config.value(), projection_model, posed_range_image,
-          beam_offset_image, measurement_model, std::move(occupancy_map));
+          config, projection_model, posed_range_image, beam_offset_image,
+          measurement_model, std::move(occupancy_map));
     }
     case IntegratorType::kCoarseToFineIntegrator: {
       auto octree_map =
           std::dynamic_pointer_cast<VolumetricOctree>(occupancy_map);
       if (octree_map) {
         return std::make_shared<CoarseToFineIntegrator>(
-            integrator_config.value(), projection_model, posed_range_image,
-            beam_offset_image, measurement_model, std::move(octree_map));
+            config, projection_model, posed_range_image, beam_offset_image,
+            measurement_model, std::move(octree_map));
       } else {
         LOG(ERROR) << "Integrator of type " << integrator_type.toStr()
                    << " only supports data structures of type "
@@ -109,8 +128,8 @@ IntegratorBase::Ptr IntegratorFactory::create(
           std::dynamic_pointer_cast<WaveletOctree>(occupancy_map);
       if (wavelet_map) {
         return std::make_shared<WaveletIntegrator>(
-            integrator_config.value(), projection_model, posed_range_image,
-            beam_offset_image, measurement_model, std::move(wavelet_map));
+            config, projection_model, posed_range_image, beam_offset_image,
+            measurement_model, std::move(wavelet_map));
       } else {
         LOG(ERROR) << "Integrator of type " << integrator_type.toStr()
                    << " only supports data structures of type "
@@ -124,9 +143,10 @@ IntegratorBase::Ptr IntegratorFactory::create(
       auto hashed_wavelet_map =
           std::dynamic_pointer_cast<HashedWaveletOctree>(occupancy_map);
       if (hashed_wavelet_map) {
-        return std::make_shared<HashedWaveletIntegrator>(
-            integrator_config.value(), projection_model, posed_range_image,
-            beam_offset_image, measurement_model, std::move(hashed_wavelet_map),
+        return createSpecializedIfAvailable<SpecializedHashedWaveletIntegrator,
+                                            HashedWaveletIntegrator>(
+            config, projection_model, posed_range_image, beam_offset_image,
+            measurement_model, std::move(hashed_wavelet_map),
             std::move(thread_pool));
       } else {
         LOG(ERROR) << "Integrator of type " << integrator_type.toStr()
@@ -141,10 +161,12 @@ IntegratorBase::Ptr IntegratorFactory::create(
       auto hashed_chunked_wavelet_map =
           std::dynamic_pointer_cast<HashedChunkedWaveletOctree>(occupancy_map);
       if (hashed_chunked_wavelet_map) {
-        return std::make_shared<HashedChunkedWaveletIntegrator>(
-            integrator_config.value(), projection_model, posed_range_image,
-            beam_offset_image, measurement_model,
-            std::move(hashed_chunked_wavelet_map), std::move(thread_pool));
+        return createSpecializedIfAvailable<
+            SpecializedHashedChunkedWaveletIntegrator,
+            HashedChunkedWaveletIntegrator>(
+            config, projection_model, posed_range_image, beam_offset_image,
+            measurement_model, std::move(hashed_chunked_wavelet_map),
+            std::move(thread_pool));
       } else {
         LOG(ERROR)
             << "Integrator of type " << integrator_type.toStr()
@@ -162,4 +184,93 @@ IntegratorBase::Ptr IntegratorFactory::create(
   }
   return nullptr;
 }
+}  // namespace
+
+IntegratorBase::Ptr IntegratorFactory::create(
+    const param::Value& params, VolumetricDataStructureBase::Ptr occupancy_map,
+    std::shared_ptr<ThreadPool> thread_pool,
+    std::optional<IntegratorType> default_integrator_type) {
+  if (const auto type = IntegratorType::from(params, "integration_method");
+      type) {
+    return create(type.value(), params, std::move(occupancy_map),
+                  std::move(thread_pool));
+  }
+
+  if (default_integrator_type.has_value()) {
+    LOG(WARNING) << "Default type \"" << default_integrator_type.value().toStr()
+                 << "\" will be created instead.";
+    return create(default_integrator_type.value(), params,
+                  std::move(occupancy_map), std::move(thread_pool));
+  }
+
+  LOG(ERROR) << "No default was set. Returning nullptr.";
+  return nullptr;
+}
+
+IntegratorBase::Ptr IntegratorFactory::create(
+    IntegratorType integrator_type, const param::Value& params,
+    VolumetricDataStructureBase::Ptr occupancy_map,
+    std::shared_ptr<ThreadPool> thread_pool) {
+  // If we're using a ray tracing based integrator, we can build it directly
+  if (integrator_type == IntegratorType::kRayTracingIntegrator) {
+    if (const auto config =
+            RayTracingIntegratorConfig::from(params, "integration_method");
+        config) {
+      return std::make_shared<RayTracingIntegrator>(
+          config.value(), std::move(occupancy_map), std::move(thread_pool));
+    } else {
+      LOG(ERROR) << "Ray tracing integrator config could not be loaded.";
+      return nullptr;
+    }
+  }
+
+  // Load the projective integrator config
+  const auto integrator_config =
+      ProjectiveIntegratorConfig::from(params, "integration_method");
+  if (!integrator_config.has_value()) {
+    LOG(ERROR) << "Integrator config could not be loaded.";
+    return nullptr;
+  }
+
+  // Create the projective integrator directly if pipelining is disabled
+  const int pipeline_depth = integrator_config->pipeline_depth;
+  if (pipeline_depth <= 1) {
+    return createProjectiveIntegrator(
+        integrator_type, integrator_config.value(), params,
+        std::move(occupancy_map), std::move(thread_pool));
+  }
+  if (integrator_type != IntegratorType::kHashedWaveletIntegrator &&
+      integrator_type != IntegratorType::kHashedChunkedWaveletIntegrator) {
+    LOG(WARNING) << "Pipelined integration is only supported for integrators "
+                    "of type "
+                 << IntegratorType::typeIdToStr(
+                        IntegratorType::kHashedWaveletIntegrator)
+                 << " and "
+                 << IntegratorType::typeIdToStr(
+                        IntegratorType::kHashedChunkedWaveletIntegrator)
+                 << ". Creating a regular integrator instead.";
+    return createProjectiveIntegrator(
+        integrator_type, integrator_config.value(), params,
+        std::move(occupancy_map), std::move(thread_pool));
+  }
+
+  // Otherwise, create one integrator per pipeline stage and chain them
+  // NOTE: All stages update the same map and share the same thread pool, but
+  //       each stage has its own range image, intersector and models s.t. it
+  //       can be prepared while the other stages are updating the map.
+  std::vector<ProjectiveIntegrator::Ptr> stages;
+  for (int stage_idx = 0; stage_idx < pipeline_depth; ++stage_idx) {
+    auto stage = std::dynamic_pointer_cast<ProjectiveIntegrator>(
+        createProjectiveIntegrator(integrator_type, integrator_config.value(),
+                                   params, occupancy_map, thread_pool));
+    if (!stage) {
+      LOG(ERROR) << "Could not create pipeline stage " << stage_idx
+                 << ". Returning nullptr.";
+      return nullptr;
+    }
+    stages.emplace_back(std::move(stage));
+  }
+  return std::make_shared<PipelinedIntegrator>(std::move(stages),
+                                               std::move(thread_pool));
+}
 }  // namespace wavemap
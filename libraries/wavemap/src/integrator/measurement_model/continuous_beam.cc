@@ -6,7 +6,8 @@ DECLARE_CONFIG_MEMBERS(ContinuousBeamConfig,
                       (range_sigma)
                       (scaling_free)
                       (scaling_occupied)
-                      (beam_selector_type));
+                      (beam_selector_type)
+                      (max_kernel_error));
 
 bool ContinuousBeamConfig::isValid(bool verbose) const {
   bool is_valid = true;
@@ -17,6 +18,14 @@ bool ContinuousBeamConfig::isValid(bool verbose) const {
   is_valid &= IS_PARAM_GT(scaling_free, 0.f, verbose);
   is_valid &= IS_PARAM_GT(scaling_occupied, 0.f, verbose);
 
+  is_valid &= IS_PARAM_GE(max_kernel_error, 0.f, verbose);
+  if (0.f < max_kernel_error) {
+    // NOTE: The lookup tables cover the full range of the model's
+    //       contributions, whose log-odds are only finite for scalings below 1.
+    is_valid &= IS_PARAM_LT(scaling_free, 1.f, verbose);
+    is_valid &= IS_PARAM_LT(scaling_occupied, 1.f, verbose);
+  }
+
   return is_valid;
 }
 }  // namespace wavemap
@@ -0,0 +1,84 @@
+#include "wavemap/integrator/measurement_model/tabulated_beam_kernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "wavemap/integrator/measurement_model/approximate_gaussian_distribution.h"
+
+namespace wavemap {
+namespace {
+// Bounds of the product of the angle and range contributions
+// NOTE: The angle contribution lies in [0, 1] and the range contribution in
+//       [-0.5, 0.5], since the CDFs it is composed of lie in [0, 1].
+constexpr FloatingPoint kMinContribs = -0.5f;
+constexpr FloatingPoint kMaxContribs = 0.5f;
+
+FloatingPoint computeLogOdds(FloatingPoint scaled_contribs) {
+  const FloatingPoint p = scaled_contribs + 0.5f;
+  return std::log(p / (1.f - p));
+}
+
+// Largest derivative of the log-odds update w.r.t. the contributions
+FloatingPoint computeMaxLogOddsSlope(FloatingPoint scaling_free,
+                                     FloatingPoint scaling_occupied) {
+  const FloatingPoint p_min = 0.5f + scaling_free * kMinContribs;
+  const FloatingPoint p_max = 0.5f + scaling_occupied * kMaxContribs;
+  return std::max(scaling_free / (p_min * (1.f - p_min)),
+                  scaling_occupied / (p_max * (1.f - p_max)));
+}
+
+// Error bound for the contribution tables, s.t. their combined error
+// contributes at most half of the max_error to the log-odds update
+FloatingPoint computeMaxContribError(FloatingPoint scaling_free,
+                                     FloatingPoint scaling_occupied,
+                                     FloatingPoint max_error) {
+  // NOTE: Since |angle_contrib| <= 1 and |range_contrib| <= 0.5, errors in the
+  //       range and angle contributions are amplified by at most 1 and 0.5 when
+  //       taking their product.
+  return 0.5f * max_error /
+         (1.5f * computeMaxLogOddsSlope(scaling_free, scaling_occupied));
+}
+}  // namespace
+
+TabulatedBeamKernel::TabulatedBeamKernel(FloatingPoint scaling_free,
+                                         FloatingPoint scaling_occupied,
+                                         FloatingPoint max_error)
+    : angle_contrib_table_(
+          [](FloatingPoint normalized_angle_error_squared) {
+            // NOTE: As in ContinuousBeam::computeBeamUpdate. Tabulating the
+            //       contribution as a function of the squared error avoids
+            //       evaluating a square root per beam.
+            const FloatingPoint g = std::sqrt(normalized_angle_error_squared);
+            return 1.f - ApproximateGaussianDistribution::cumulative(g - 3.f);
+          },
+          0.f, 36.f,
+          computeMaxContribError(scaling_free, scaling_occupied, max_error)),
+      range_contrib_table_(
+          [](FloatingPoint f) {
+            return ApproximateGaussianDistribution::cumulative(f) -
+                   0.5f * ApproximateGaussianDistribution::cumulative(f - 3.f) -
+                   0.5f;
+          },
+          -3.f, 6.f,
+          computeMaxContribError(scaling_free, scaling_occupied, max_error)),
+      free_log_odds_table_(
+          [scaling_free](FloatingPoint contribs) {
+            return computeLogOdds(scaling_free * contribs);
+          },
+          kMinContribs, 0.f, 0.5f * max_error),
+      occupied_log_odds_table_(
+          [scaling_occupied](FloatingPoint contribs) {
+            return computeLogOdds(scaling_occupied * contribs);
+          },
+          0.f, kMaxContribs, 0.5f * max_error) {
+  const FloatingPoint max_contribs_error =
+      range_contrib_table_.getMaxError() +
+      0.5f * angle_contrib_table_.getMaxError() +
+      range_contrib_table_.getMaxError() * angle_contrib_table_.getMaxError();
+  worst_case_error_ =
+      computeMaxLogOddsSlope(scaling_free, scaling_occupied) *
+          max_contribs_error +
+      std::max(free_log_odds_table_.getMaxError(),
+               occupied_log_odds_table_.getMaxError());
+}
+}  // namespace wavemap
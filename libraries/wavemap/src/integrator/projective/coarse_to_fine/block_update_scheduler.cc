@@ -0,0 +1,45 @@
+#include "wavemap/integrator/projective/coarse_to_fine/block_update_scheduler.h"
+
+#include <unistd.h>
+
+#include "wavemap/indexing/index_conversions.h"
+
+namespace wavemap {
+size_t BlockUpdateScheduler::getL2CacheSize() {
+  constexpr size_t kDefaultL2CacheSize = 256 * 1024;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+  if (const auto l2_cache_size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+      0 < l2_cache_size) {
+    return static_cast<size_t>(l2_cache_size);
+  }
+#endif
+  return kDefaultL2CacheSize;
+}
+
+AABB<Index2D> BlockUpdateScheduler::getImageFootprint(
+    const Index3D& block_index, const Transformation3D::RotationMatrix& R_C_W,
+    const Point3D& t_W_C) const {
+  const AABB<Point3D> block_aabb = convert::nodeIndexToAABB(
+      OctreeIndex{tree_height_, block_index}, min_cell_width_);
+  const AABB<Vector3D> sensor_aabb =
+      projection_model_->cartesianToSensorAABB(block_aabb, R_C_W, t_W_C);
+  const Index2D max_image_index =
+      projection_model_->getDimensions() - Index2D::Ones();
+  AABB<Index2D> footprint{
+      projection_model_->imageToFloorIndex(sensor_aabb.min.head<2>())
+          .cwiseMax(Index2D::Zero())
+          .cwiseMin(max_image_index),
+      projection_model_->imageToCeilIndex(sensor_aabb.max.head<2>())
+          .cwiseMax(Index2D::Zero())
+          .cwiseMin(max_image_index)};
+  // Blocks that straddle the wrap-around point of a periodic sensor axis
+  // conservatively cover the whole axis
+  for (int axis = 0; axis < 2; ++axis) {
+    if (footprint.max[axis] < footprint.min[axis]) {
+      footprint.min[axis] = 0;
+      footprint.max[axis] = max_image_index[axis];
+    }
+  }
+  return footprint;
+}
+}  // namespace wavemap
@@ -5,12 +5,18 @@
 #include "wavemap/indexing/ndtree_index.h"
 
 namespace wavemap {
-void CoarseToFineIntegrator::updateMap() {
-  // Update the range image intersector
-  range_image_intersector_ = std::make_shared<RangeImageIntersector>(
-      posed_range_image_, projection_model_, *measurement_model_,
-      config_.min_range, config_.max_range);
+void CoarseToFineIntegrator::prepareMapUpdate() {
+  // Update the range image intersector, reusing it if it already exists
+  if (range_image_intersector_) {
+    range_image_intersector_->update();
+  } else {
+    range_image_intersector_ = std::make_shared<RangeImageIntersector>(
+        posed_range_image_, projection_model_, *measurement_model_,
+        config_.min_range, config_.max_range);
+  }
+}
 
+void CoarseToFineIntegrator::updateMap() {
   // Recursively update all relevant cells
   std::stack<OctreeIndex> stack;
   for (const OctreeIndex& node_index : occupancy_map_->getFirstChildIndices()) {
@@ -1,46 +1,138 @@
 #include "wavemap/integrator/projective/coarse_to_fine/hashed_chunked_wavelet_integrator.h"
 
-#include <stack>
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
 
 #include <tracy/Tracy.hpp>
 
+#include "wavemap/integrator/measurement_model/continuous_beam.h"
+#include "wavemap/integrator/projection_model/ouster_projector.h"
+#include "wavemap/integrator/projection_model/pinhole_camera_projector.h"
+#include "wavemap/integrator/projection_model/spherical_projector.h"
+#include "wavemap/utils/time/stopwatch.h"
+
 namespace wavemap {
-void HashedChunkedWaveletIntegrator::updateMap() {
+void HashedChunkedWaveletIntegrator::prepareMapUpdate() {
   ZoneScoped;
-  // Update the range image intersector
-  {
-    ZoneScopedN("updateRangeImageIntersector");
+  // Update the range image intersector, reusing it if it already exists
+  if (range_image_intersector_) {
+    range_image_intersector_->update(thread_pool_.get());
+  } else {
     range_image_intersector_ = std::make_shared<RangeImageIntersector>(
         posed_range_image_, projection_model_, *measurement_model_,
         config_.min_range, config_.max_range);
   }
+}
+
+void HashedChunkedWaveletIntegrator::updateMap() {
+  ZoneScoped;
+  Stopwatch stage_timer;
+
+  // NOTE: The blocks mutex is only locked within each stage's tasks, such that
+  //       blocks can not be removed concurrently (e.g. by background pruning)
+  //       while they are accessed. It must not be held while waiting on the
+  //       thread pool, as waiting workers run other queued tasks that might
+  //       lock it again (e.g. the commits of other pipelined integrators).
 
   // Find all the indices of blocks that need updating
-  BlockList blocks_to_update;
-  {
-    ZoneScopedN("selectBlocksToUpdate");
-    const auto [fov_min_idx, fov_max_idx] =
-        getFovMinMaxIndices(posed_range_image_->getOrigin());
-    for (const auto& block_index :
-         Grid(fov_min_idx.position, fov_max_idx.position)) {
-      recursiveTester(OctreeIndex{fov_min_idx.height, block_index},
-                      blocks_to_update);
+  stage_timer.start();
+  BlockList blocks_to_update = selectBlocksToUpdate();
+  stage_timer.stop();
+  last_stage_timings_.select_blocks = stage_timer.getLastEpisodeDuration();
+
+  // Make sure the to-be-updated blocks are allocated
+  stage_timer.start();
+  occupancy_map_->allocateBlocks(blocks_to_update);
+  stage_timer.stop();
+  last_stage_timings_.allocate_blocks = stage_timer.getLastEpisodeDuration();
+
+  // Update it with the threadpool, in tasks of nearby blocks
+  stage_timer.start();
+  const auto tasks = block_update_scheduler_.schedule(
+      blocks_to_update, posed_range_image_->getRotationMatrixInverse(),
+      posed_range_image_->getOrigin());
+  ThreadPool::TaskGroup update_tasks;
+  for (const auto& [first_block_idx, last_block_idx] : tasks) {
+    thread_pool_->add_detached_task(
+        update_tasks,
+        [this, &blocks_to_update, first_block_idx = first_block_idx,
+         last_block_idx = last_block_idx]() {
+          // Reallocate the task's blocks if they were removed since the
+          // allocation stage, and keep them from being removed while updating
+          auto blocks_lock =
+              std::shared_lock(occupancy_map_->getBlocksMutex());
+          occupancy_map_->allocateBlocks(
+              {blocks_to_update.begin() + first_block_idx,
+               blocks_to_update.begin() + last_block_idx},
+              blocks_lock);
+          for (size_t block_idx = first_block_idx; block_idx < last_block_idx;
+               ++block_idx) {
+            const auto& block_index = blocks_to_update[block_idx];
+            auto& block = occupancy_map_->getBlock(block_index);
+            auto block_lock = std::scoped_lock(block.getMutex());
+            updateBlock(block, block_index);
+          }
+        });
+  }
+  thread_pool_->wait_for(update_tasks);
+  stage_timer.stop();
+  last_stage_timings_.update_blocks = stage_timer.getLastEpisodeDuration();
+}
+
+HashedChunkedWaveletIntegrator::BlockList
+HashedChunkedWaveletIntegrator::selectBlocksToUpdate() const {
+  ZoneScoped;
+  // Split the FOV into subtrees that can be tested in parallel
+  // NOTE: The FOV's top-level nodes are tested directly, s.t. no tasks are
+  //       spawned for the subtrees of nodes that are fully unobserved.
+  const auto [fov_min_idx, fov_max_idx] =
+      getFovMinMaxIndices(posed_range_image_->getOrigin());
+  DCHECK_GT(fov_min_idx.height, tree_height_);
+  std::vector<OctreeIndex> subtrees;
+  for (const auto& top_node_position :
+       Grid(fov_min_idx.position, fov_max_idx.position)) {
+    const OctreeIndex top_node_index{fov_min_idx.height, top_node_position};
+    const AABB<Point3D> top_node_aabb =
+        convert::nodeIndexToAABB(top_node_index, min_cell_width_);
+    const UpdateType update_type =
+        range_image_intersector_->determineUpdateType(
+            top_node_aabb, posed_range_image_->getRotationMatrixInverse(),
+            posed_range_image_->getOrigin());
+    if (update_type == UpdateType::kFullyUnobserved) {
+      continue;
+    }
+    for (const auto& child_index : top_node_index.computeChildIndices()) {
+      subtrees.emplace_back(child_index);
     }
   }
 
-  // Make sure the to-be-updated blocks are allocated
-  for (const auto& block_index : blocks_to_update) {
-    occupancy_map_->getOrAllocateBlock(block_index);
+  // Test the subtrees with the thread pool
+  // NOTE: Each subtree writes to its own list. These are then concatenated in
+  //       the same order as when testing the whole FOV on a single thread.
+  std::vector<BlockList> subtree_blocks(subtrees.size());
+  ThreadPool::TaskGroup subtree_tasks;
+  for (size_t subtree_idx = 0; subtree_idx < subtrees.size(); ++subtree_idx) {
+    thread_pool_->add_detached_task(
+        subtree_tasks, [this, &subtrees, &subtree_blocks, subtree_idx]() {
+          auto blocks_lock =
+              std::shared_lock(occupancy_map_->getBlocksMutex());
+          recursiveTester(subtrees[subtree_idx], subtree_blocks[subtree_idx]);
+        });
   }
+  thread_pool_->wait_for(subtree_tasks);
 
-  // Update it with the threadpool
-  for (const auto& block_index : blocks_to_update) {
-    thread_pool_->add_task([this, block_index]() {
-      auto& block = occupancy_map_->getBlock(block_index);
-      updateBlock(block, block_index);
-    });
+  size_t num_blocks_to_update = 0u;
+  for (const auto& blocks : subtree_blocks) {
+    num_blocks_to_update += blocks.size();
+  }
+  BlockList blocks_to_update;
+  blocks_to_update.reserve(num_blocks_to_update);
+  for (const auto& blocks : subtree_blocks) {
+    blocks_to_update.insert(blocks_to_update.end(), blocks.begin(),
+                            blocks.end());
   }
-  thread_pool_->wait_all();
+  return blocks_to_update;
 }
 
 std::pair<OctreeIndex, OctreeIndex>
@@ -68,24 +160,34 @@ void HashedChunkedWaveletIntegrator::updateBlock(
     HashedChunkedWaveletOctree::Block& block,
     const HashedChunkedWaveletOctree::BlockIndex& block_index) {
   ZoneScoped;
+  updateBlockImpl<ProjectorBase, MeasurementModelBase>(block, block_index);
+}
+
+template <typename ProjectorT, typename MeasurementModelT>
+void HashedChunkedWaveletIntegrator::updateBlockImpl(
+    HashedChunkedWaveletOctree::Block& block,
+    const HashedChunkedWaveletOctree::BlockIndex& block_index) {
   block.setNeedsPruning();
   block.setLastUpdatedStamp();
 
   bool block_needs_thresholding = block.getNeedsThresholding();
   const OctreeIndex root_node_index{tree_height_, block_index};
-  updateNodeRecursive(block.getRootChunk(), root_node_index, 0u,
-                      block.getRootScale(),
-                      block.getRootChunk().nodeHasAtLeastOneChild(0u),
-                      block_needs_thresholding);
+  updateNodeRecursive<ProjectorT, MeasurementModelT>(
+      block.getRootChunk(), root_node_index, 0u, block.getRootScale(),
+      block.getRootChunk().nodeHasAtLeastOneChild(0u),
+      block_needs_thresholding, block.getDirtySubtrees());
   block.setNeedsThresholding(block_needs_thresholding);
 }
 
+template <typename ProjectorT, typename MeasurementModelT>
 void HashedChunkedWaveletIntegrator::updateNodeRecursive(  // NOLINT
     HashedChunkedWaveletOctreeBlock::NodeChunkType& parent_chunk,
     const OctreeIndex& parent_node_index, LinearIndex parent_in_chunk_index,
     FloatingPoint& parent_value,
     HashedChunkedWaveletOctreeBlock::NodeChunkType::BitRef parent_has_child,
-    bool& block_needs_thresholding) {
+    bool& block_needs_thresholding, DirtySubtreeMask& dirty_subtrees) {
+  const auto& projection_model = getProjectionModelAs<ProjectorT>();
+  const auto& measurement_model = getMeasurementModelAs<MeasurementModelT>();
   auto& parent_details = parent_chunk.nodeData(parent_in_chunk_index);
   auto child_values = HashedChunkedWaveletOctreeBlock::Transform::backward(
       {parent_value, parent_details});
@@ -102,7 +204,7 @@ void HashedChunkedWaveletIntegrator::updateNodeRecursive(  // NOLINT
     const AABB<Point3D> W_child_aabb =
         convert::nodeIndexToAABB(child_index, min_cell_width_);
     const UpdateType update_type =
-        range_image_intersector_->determineUpdateType(
+        range_image_intersector_->determineUpdateType<ProjectorT>(
             W_child_aabb, posed_range_image_->getRotationMatrixInverse(),
             posed_range_image_->getOrigin());
 
@@ -127,15 +229,17 @@ void HashedChunkedWaveletIntegrator::updateNodeRecursive(  // NOLINT
     const Point3D C_child_center =
         posed_range_image_->getPoseInverse() * W_child_center;
     const FloatingPoint d_C_child =
-        projection_model_->cartesianToSensorZ(C_child_center);
+        projection_model.cartesianToSensorZ(C_child_center);
     const FloatingPoint bounding_sphere_radius =
         kUnitCubeHalfDiagonal * child_width;
-    if (measurement_model_->computeWorstCaseApproximationError(
+    if (measurement_model.computeWorstCaseApproximationError(
             update_type, d_C_child, bounding_sphere_radius) <
         config_.termination_update_error) {
-      const FloatingPoint sample = computeUpdate(C_child_center);
+      const FloatingPoint sample =
+          computeUpdate<ProjectorT, MeasurementModelT>(C_child_center);
       child_value += sample;
       block_needs_thresholding = true;
+      dirty_subtrees.markDirty(child_index);
       continue;
     }
 
@@ -169,13 +273,16 @@ void HashedChunkedWaveletIntegrator::updateNodeRecursive(  // NOLINT
 
     // If we're at the leaf level, directly compute the update
     if (child_height == config_.termination_height + 1) {
-      updateLeavesBatch(child_index, child_value, child_details);
+      updateLeavesBatch<ProjectorT, MeasurementModelT>(child_index, child_value,
+                                                       child_details);
+      dirty_subtrees.markDirty(child_index);
     } else {
       // Otherwise, recurse
       DCHECK_GE(child_height, 0);
-      updateNodeRecursive(*chunk_containing_child, child_index,
-                          child_node_in_chunk_index, child_value,
-                          child_has_children, block_needs_thresholding);
+      updateNodeRecursive<ProjectorT, MeasurementModelT>(
+          *chunk_containing_child, child_index, child_node_in_chunk_index,
+          child_value, child_has_children, block_needs_thresholding,
+          dirty_subtrees);
     }
 
     if (child_has_children || data::is_nonzero(child_details)) {
@@ -188,4 +295,20 @@ void HashedChunkedWaveletIntegrator::updateNodeRecursive(  // NOLINT
   parent_details = new_details;
   parent_value = new_value;
 }
+
+template <typename ProjectorT, typename MeasurementModelT>
+void SpecializedHashedChunkedWaveletIntegrator<ProjectorT, MeasurementModelT>::
+    updateBlock(HashedChunkedWaveletOctree::Block& block,
+                const HashedChunkedWaveletOctree::BlockIndex& block_index) {
+  ZoneScoped;
+  updateBlockImpl<ProjectorT, MeasurementModelT>(block, block_index);
+}
+
+// Compile the specializations that the IntegratorFactory creates
+template class SpecializedHashedChunkedWaveletIntegrator<OusterProjector,
+                                                         ContinuousBeam>;
+template class SpecializedHashedChunkedWaveletIntegrator<PinholeCameraProjector,
+                                                         ContinuousBeam>;
+template class SpecializedHashedChunkedWaveletIntegrator<SphericalProjector,
+                                                         ContinuousBeam>;
 }  // namespace wavemap
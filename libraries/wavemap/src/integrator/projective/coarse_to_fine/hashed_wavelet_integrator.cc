@@ -1,46 +1,144 @@
 #include "wavemap/integrator/projective/coarse_to_fine/hashed_wavelet_integrator.h"
 
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
 #include <stack>
 
 #include <tracy/Tracy.hpp>
 
+#include "wavemap/integrator/measurement_model/continuous_beam.h"
+#include "wavemap/integrator/projection_model/ouster_projector.h"
+#include "wavemap/integrator/projection_model/pinhole_camera_projector.h"
+#include "wavemap/integrator/projection_model/spherical_projector.h"
+#include "wavemap/utils/time/stopwatch.h"
+
 namespace wavemap {
-void HashedWaveletIntegrator::updateMap() {
+void HashedWaveletIntegrator::prepareMapUpdate() {
   ZoneScoped;
-  // Update the range image intersector
-  {
-    ZoneScopedN("updateRangeImageIntersector");
+  // Update the range image intersector, reusing it if it already exists
+  if (range_image_intersector_) {
+    range_image_intersector_->update(thread_pool_.get());
+  } else {
     range_image_intersector_ = std::make_shared<RangeImageIntersector>(
         posed_range_image_, projection_model_, *measurement_model_,
         config_.min_range, config_.max_range);
   }
+}
+
+void HashedWaveletIntegrator::updateMap() {
+  ZoneScoped;
+  Stopwatch stage_timer;
+
+  // NOTE: The blocks mutex is only locked within each stage's tasks, such that
+  //       blocks can not be removed concurrently (e.g. by background pruning)
+  //       while they are accessed. It must not be held while waiting on the
+  //       thread pool, as waiting workers run other queued tasks that might
+  //       lock it again (e.g. the commits of other pipelined integrators).
 
   // Find all the indices of blocks that need updating
-  BlockList blocks_to_update;
-  {
-    ZoneScopedN("selectBlocksToUpdate");
-    const auto [fov_min_idx, fov_max_idx] =
-        getFovMinMaxIndices(posed_range_image_->getOrigin());
-    for (const auto& block_index :
-         Grid(fov_min_idx.position, fov_max_idx.position)) {
-      recursiveTester(OctreeIndex{fov_min_idx.height, block_index},
-                      blocks_to_update);
-    }
-  }
+  stage_timer.start();
+  BlockList blocks_to_update = selectBlocksToUpdate();
+  stage_timer.stop();
+  last_stage_timings_.select_blocks = stage_timer.getLastEpisodeDuration();
 
   // Make sure the to-be-updated blocks are allocated
+  stage_timer.start();
+  std::vector<Index3D> block_indices;
+  block_indices.reserve(blocks_to_update.size());
   for (const auto& block_index : blocks_to_update) {
-    occupancy_map_->getOrAllocateBlock(block_index.position);
+    block_indices.emplace_back(block_index.position);
   }
+  occupancy_map_->allocateBlocks(block_indices);
+  stage_timer.stop();
+  last_stage_timings_.allocate_blocks = stage_timer.getLastEpisodeDuration();
 
-  // Update it with the threadpool
-  for (const auto& block_index : blocks_to_update) {
-    thread_pool_->add_task([this, block_index]() {
-      auto& block = occupancy_map_->getBlock(block_index.position);
-      updateBlock(block, block_index);
-    });
+  // Update it with the threadpool, in tasks of nearby blocks
+  stage_timer.start();
+  const auto tasks = block_update_scheduler_.schedule(
+      blocks_to_update, posed_range_image_->getRotationMatrixInverse(),
+      posed_range_image_->getOrigin());
+  ThreadPool::TaskGroup update_tasks;
+  for (const auto& [first_block_idx, last_block_idx] : tasks) {
+    thread_pool_->add_detached_task(
+        update_tasks,
+        [this, &blocks_to_update, &block_indices,
+         first_block_idx = first_block_idx, last_block_idx = last_block_idx]() {
+          // Reallocate the task's blocks if they were removed since the
+          // allocation stage, and keep them from being removed while updating
+          auto blocks_lock =
+              std::shared_lock(occupancy_map_->getBlocksMutex());
+          occupancy_map_->allocateBlocks(
+              {block_indices.begin() + first_block_idx,
+               block_indices.begin() + last_block_idx},
+              blocks_lock);
+          for (size_t block_idx = first_block_idx; block_idx < last_block_idx;
+               ++block_idx) {
+            const auto& block_index = blocks_to_update[block_idx];
+            auto& block = occupancy_map_->getBlock(block_index.position);
+            auto block_lock = std::scoped_lock(block.getMutex());
+            updateBlock(block, block_index);
+          }
+        });
+  }
+  thread_pool_->wait_for(update_tasks);
+  stage_timer.stop();
+  last_stage_timings_.update_blocks = stage_timer.getLastEpisodeDuration();
+}
+
+HashedWaveletIntegrator::BlockList
+HashedWaveletIntegrator::selectBlocksToUpdate() const {
+  ZoneScoped;
+  // Split the FOV into subtrees that can be tested in parallel
+  // NOTE: The FOV's top-level nodes are tested directly, s.t. no tasks are
+  //       spawned for the subtrees of nodes that are fully unobserved.
+  const auto [fov_min_idx, fov_max_idx] =
+      getFovMinMaxIndices(posed_range_image_->getOrigin());
+  DCHECK_GT(fov_min_idx.height, tree_height_);
+  std::vector<OctreeIndex> subtrees;
+  for (const auto& top_node_position :
+       Grid(fov_min_idx.position, fov_max_idx.position)) {
+    const OctreeIndex top_node_index{fov_min_idx.height, top_node_position};
+    const AABB<Point3D> top_node_aabb =
+        convert::nodeIndexToAABB(top_node_index, min_cell_width_);
+    const UpdateType update_type =
+        range_image_intersector_->determineUpdateType(
+            top_node_aabb, posed_range_image_->getRotationMatrixInverse(),
+            posed_range_image_->getOrigin());
+    if (update_type == UpdateType::kFullyUnobserved) {
+      continue;
+    }
+    for (const auto& child_index : top_node_index.computeChildIndices()) {
+      subtrees.emplace_back(child_index);
+    }
+  }
+
+  // Test the subtrees with the thread pool
+  // NOTE: Each subtree writes to its own list. These are then concatenated in
+  //       the same order as when testing the whole FOV on a single thread.
+  std::vector<BlockList> subtree_blocks(subtrees.size());
+  ThreadPool::TaskGroup subtree_tasks;
+  for (size_t subtree_idx = 0; subtree_idx < subtrees.size(); ++subtree_idx) {
+    thread_pool_->add_detached_task(
+        subtree_tasks, [this, &subtrees, &subtree_blocks, subtree_idx]() {
+          auto blocks_lock =
+              std::shared_lock(occupancy_map_->getBlocksMutex());
+          recursiveTester(subtrees[subtree_idx], subtree_blocks[subtree_idx]);
+        });
+  }
+  thread_pool_->wait_for(subtree_tasks);
+
+  size_t num_blocks_to_update = 0u;
+  for (const auto& blocks : subtree_blocks) {
+    num_blocks_to_update += blocks.size();
+  }
+  BlockList blocks_to_update;
+  blocks_to_update.reserve(num_blocks_to_update);
+  for (const auto& blocks : subtree_blocks) {
+    blocks_to_update.insert(blocks_to_update.end(), blocks.begin(),
+                            blocks.end());
   }
-  thread_pool_->wait_all();
+  return blocks_to_update;
 }
 
 std::pair<OctreeIndex, OctreeIndex>
@@ -68,6 +166,14 @@ HashedWaveletIntegrator::getFovMinMaxIndices(
 void HashedWaveletIntegrator::updateBlock(HashedWaveletOctree::Block& block,
                                           const OctreeIndex& block_index) {
   ZoneScoped;
+  updateBlockImpl<ProjectorBase, MeasurementModelBase>(block, block_index);
+}
+
+template <typename ProjectorT, typename MeasurementModelT>
+void HashedWaveletIntegrator::updateBlockImpl(HashedWaveletOctree::Block& block,
+                                              const OctreeIndex& block_index) {
+  const auto& projection_model = getProjectionModelAs<ProjectorT>();
+  const auto& measurement_model = getMeasurementModelAs<MeasurementModelT>();
   HashedWaveletOctreeBlock::NodeType& root_node = block.getRootNode();
   HashedWaveletOctreeBlock::Coefficients::Scale& root_node_scale =
       block.getRootScale();
@@ -105,6 +211,17 @@ void HashedWaveletIntegrator::updateBlock(HashedWaveletOctree::Block& block,
       }
     }
 
+    // If the stack element's children are leaves, update them all at once
+    if (stack.top().next_child_idx == 0 &&
+        stack.top().parent_node_index.height ==
+            config_.termination_height + 1) {
+      updateLeavesBatch<ProjectorT, MeasurementModelT>(
+          stack.top().parent_node_index, stack.top().child_scale_coefficients);
+      block.getDirtySubtrees().markDirty(stack.top().parent_node_index);
+      stack.top().next_child_idx = OctreeIndex::kNumChildren;
+      continue;
+    }
+
     // Evaluate stack element's active child
     const NdtreeIndexRelativeChild current_child_idx =
         stack.top().next_child_idx;
@@ -117,27 +234,14 @@ void HashedWaveletIntegrator::updateBlock(HashedWaveletOctree::Block& block,
         stack.top().child_scale_coefficients[current_child_idx];
     const OctreeIndex node_index =
         stack.top().parent_node_index.computeChildIndex(current_child_idx);
-    DCHECK_GE(node_index.height, 0);
-
-    // If we're at the leaf level, directly update the node
-    if (node_index.height == config_.termination_height) {
-      const Point3D W_node_center =
-          convert::nodeIndexToCenterPoint(node_index, min_cell_width_);
-      const Point3D C_node_center =
-          posed_range_image_->getPoseInverse() * W_node_center;
-      const FloatingPoint sample = computeUpdate(C_node_center);
-      node_value =
-          std::clamp(sample + node_value, min_log_odds_ - kNoiseThreshold,
-                     max_log_odds_ + kNoiseThreshold);
-      continue;
-    }
+    DCHECK_GT(node_index.height, config_.termination_height);
 
-    // Otherwise, test whether the current node is fully occupied;
+    // Test whether the current node is fully occupied;
     // free or unknown; or fully unknown
     const AABB<Point3D> W_cell_aabb =
         convert::nodeIndexToAABB(node_index, min_cell_width_);
     const UpdateType update_type =
-        range_image_intersector_->determineUpdateType(
+        range_image_intersector_->determineUpdateType<ProjectorT>(
             W_cell_aabb, posed_range_image_->getRotationMatrixInverse(),
             posed_range_image_->getOrigin());
 
@@ -162,15 +266,17 @@ void HashedWaveletIntegrator::updateBlock(HashedWaveletOctree::Block& block,
     const Point3D C_node_center =
         posed_range_image_->getPoseInverse() * W_node_center;
     const FloatingPoint d_C_cell =
-        projection_model_->cartesianToSensorZ(C_node_center);
+        projection_model.cartesianToSensorZ(C_node_center);
     const FloatingPoint bounding_sphere_radius =
         kUnitCubeHalfDiagonal * node_width;
     HashedWaveletOctreeBlock::NodeType* node =
         parent_node.getChild(node_index.computeRelativeChildIndex());
-    if (measurement_model_->computeWorstCaseApproximationError(
+    if (measurement_model.computeWorstCaseApproximationError(
             update_type, d_C_cell, bounding_sphere_radius) <
         config_.termination_update_error) {
-      const FloatingPoint sample = computeUpdate(C_node_center);
+      const FloatingPoint sample =
+          computeUpdate<ProjectorT, MeasurementModelT>(C_node_center);
+      block.getDirtySubtrees().markDirty(node_index);
       if (!node || !node->hasAtLeastOneChild()) {
         node_value =
             std::clamp(sample + node_value, min_log_odds_ - kNoiseThreshold,
@@ -192,4 +298,20 @@ void HashedWaveletIntegrator::updateBlock(HashedWaveletOctree::Block& block,
                                    {node_value, node->data()})});
   }
 }
+
+template <typename ProjectorT, typename MeasurementModelT>
+void SpecializedHashedWaveletIntegrator<ProjectorT, MeasurementModelT>::
+    updateBlock(HashedWaveletOctree::Block& block,
+                const OctreeIndex& block_index) {
+  ZoneScoped;
+  updateBlockImpl<ProjectorT, MeasurementModelT>(block, block_index);
+}
+
+// Compile the specializations that the IntegratorFactory creates
+template class SpecializedHashedWaveletIntegrator<OusterProjector,
+                                                  ContinuousBeam>;
+template class SpecializedHashedWaveletIntegrator<PinholeCameraProjector,
+                                                  ContinuousBeam>;
+template class SpecializedHashedWaveletIntegrator<SphericalProjector,
+                                                  ContinuousBeam>;
 }  // namespace wavemap
@@ -0,0 +1,279 @@
+#include "wavemap/integrator/projective/coarse_to_fine/hierarchical_range_bounds.h"
+
+#include <type_traits>
+
+#include <tracy/Tracy.hpp>
+
+#include "wavemap/utils/bits/bit_operations.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#define HIERARCHICAL_RANGE_BOUNDS_SSE_AVAILABLE
+#endif
+
+namespace wavemap {
+namespace {
+// Reductions used to pool the bounds of 2x2 blocks of cells
+// NOTE: Reductions that provide an SSE implementation through apply() set
+//       kVectorizable to true.
+struct MinReduction {
+  static constexpr bool kVectorizable = true;
+  FloatingPoint operator()(FloatingPoint a, FloatingPoint b) const {
+    return std::min(a, b);
+  }
+#ifdef HIERARCHICAL_RANGE_BOUNDS_SSE_AVAILABLE
+  static __m128 apply(__m128 a, __m128 b) { return _mm_min_ps(a, b); }
+#endif
+};
+
+struct MaxReduction {
+  static constexpr bool kVectorizable = true;
+  FloatingPoint operator()(FloatingPoint a, FloatingPoint b) const {
+    return std::max(a, b);
+  }
+#ifdef HIERARCHICAL_RANGE_BOUNDS_SSE_AVAILABLE
+  static __m128 apply(__m128 a, __m128 b) { return _mm_max_ps(a, b); }
+#endif
+};
+
+struct OrReduction {
+  static constexpr bool kVectorizable = false;
+  bool operator()(bool a, bool b) const { return a || b; }
+};
+
+// Transforms applied to the input values before pooling them, i.e. to the
+// range image's values when computing the first level of each pyramid
+struct Identity {
+  static constexpr bool kVectorizable = true;
+  template <typename T>
+  T operator()(T value) const {
+    return value;
+  }
+#ifdef HIERARCHICAL_RANGE_BOUNDS_SSE_AVAILABLE
+  static __m128 apply(__m128 value) { return value; }
+#endif
+};
+
+struct ValueOrInit {
+  static constexpr bool kVectorizable = true;
+  FloatingPoint min_range;
+  FloatingPoint init;
+  FloatingPoint operator()(FloatingPoint value) const {
+    return value < min_range ? init : value;
+  }
+#ifdef HIERARCHICAL_RANGE_BOUNDS_SSE_AVAILABLE
+  __m128 apply(__m128 value) const {
+    const __m128 is_unobserved = _mm_cmplt_ps(value, _mm_set1_ps(min_range));
+    return _mm_or_ps(_mm_and_ps(is_unobserved, _mm_set1_ps(init)),
+                     _mm_andnot_ps(is_unobserved, value));
+  }
+#endif
+};
+
+struct IsUnobserved {
+  static constexpr bool kVectorizable = false;
+  FloatingPoint min_range;
+  bool operator()(FloatingPoint value) const { return value < min_range; }
+};
+
+// Pool two columns of the input image into one column of the output image.
+// Along the rows, either pairs of adjacent values are pooled or, if the rows
+// were upscaled to make the pyramid's cells square, the values are copied.
+template <typename T, typename InputT, typename ReductionT, typename TransformT>
+void poolColumnPair(const InputT* first_column, const InputT* second_column,
+                    IndexElement num_input_rows, T* output_column,
+                    IndexElement num_output_rows, bool pool_rows,
+                    ReductionT reduction, TransformT transform, T init) {
+  IndexElement row_idx = 0;
+#ifdef HIERARCHICAL_RANGE_BOUNDS_SSE_AVAILABLE
+  if constexpr (std::is_same_v<T, float> && std::is_same_v<InputT, float> &&
+                ReductionT::kVectorizable && TransformT::kVectorizable) {
+    if (pool_rows) {
+      // Pool 2x8 input values into 4 output values per iteration
+      for (; row_idx + 4 <= num_output_rows &&
+             2 * row_idx + 8 <= num_input_rows;
+           row_idx += 4) {
+        const InputT* first = first_column + 2 * row_idx;
+        const InputT* second = second_column + 2 * row_idx;
+        const __m128 lower_half = ReductionT::apply(
+            transform.apply(_mm_loadu_ps(first)),
+            transform.apply(_mm_loadu_ps(second)));
+        const __m128 upper_half = ReductionT::apply(
+            transform.apply(_mm_loadu_ps(first + 4)),
+            transform.apply(_mm_loadu_ps(second + 4)));
+        const __m128 even_rows =
+            _mm_shuffle_ps(lower_half, upper_half, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 odd_rows =
+            _mm_shuffle_ps(lower_half, upper_half, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(output_column + row_idx,
+                      ReductionT::apply(even_rows, odd_rows));
+      }
+    } else {
+      // Pool 2x4 input values into 4 output values per iteration
+      for (; row_idx + 4 <= num_output_rows; row_idx += 4) {
+        _mm_storeu_ps(output_column + row_idx,
+                      ReductionT::apply(
+                          transform.apply(_mm_loadu_ps(first_column + row_idx)),
+                          transform.apply(
+                              _mm_loadu_ps(second_column + row_idx))));
+      }
+    }
+  }
+#endif
+
+  // Pool the remaining values, virtually padding the input with 'init' where
+  // the row pairs extend beyond its border
+  for (; row_idx < num_output_rows; ++row_idx) {
+    const IndexElement first_row_idx = pool_rows ? 2 * row_idx : row_idx;
+    const IndexElement second_row_idx = pool_rows ? first_row_idx + 1 : -1;
+    T value = reduction(transform(first_column[first_row_idx]),
+                        transform(second_column[first_row_idx]));
+    if (0 <= second_row_idx && second_row_idx < num_input_rows) {
+      value = reduction(value,
+                        reduction(transform(first_column[second_row_idx]),
+                                  transform(second_column[second_row_idx])));
+    } else if (pool_rows) {
+      value = reduction(value, init);
+    }
+    output_column[row_idx] = value;
+  }
+}
+
+// Pool the input image, which is either the range image or the previous
+// pyramid level, into the output image (the current pyramid level)
+template <typename T, typename InputT, typename ReductionT, typename TransformT>
+void poolLevel(const Image<InputT>& input, Image<T>& output, bool pool_rows,
+               bool pool_columns, bool wrap_columns, ReductionT reduction,
+               TransformT transform, T init) {
+  const IndexElement num_input_rows = input.getNumRows();
+  const IndexElement num_input_columns = input.getNumColumns();
+  const IndexElement num_output_rows = output.getNumRows();
+  const IndexElement num_output_columns = output.getNumColumns();
+  DCHECK(pool_rows || num_input_rows == num_output_rows);
+  DCHECK(pool_columns || num_input_columns == num_output_columns);
+
+  // NOTE: Images are stored in column-major order, so each column is
+  //       contiguous in memory.
+  const InputT* input_data = input.getData().data();
+  T* output_data = output.getData().data();
+  for (IndexElement column_idx = 0; column_idx < num_output_columns;
+       ++column_idx) {
+    const IndexElement first_column_idx =
+        pool_columns ? 2 * column_idx : column_idx;
+    IndexElement second_column_idx =
+        pool_columns ? first_column_idx + 1 : first_column_idx;
+    if (wrap_columns && second_column_idx == num_input_columns) {
+      second_column_idx = 0;
+    }
+    DCHECK_LT(first_column_idx, num_input_columns);
+
+    const InputT* first_column = input_data + first_column_idx * num_input_rows;
+    T* output_column = output_data + column_idx * num_output_rows;
+    if (second_column_idx < num_input_columns) {
+      const InputT* second_column =
+          input_data + second_column_idx * num_input_rows;
+      poolColumnPair(first_column, second_column, num_input_rows,
+                     output_column, num_output_rows, pool_rows, reduction,
+                     transform, init);
+    } else {
+      // Pad the missing second column with 'init'
+      poolColumnPair(first_column, first_column, num_input_rows,
+                     output_column, num_output_rows, pool_rows, reduction,
+                     transform, init);
+      for (IndexElement row_idx = 0; row_idx < num_output_rows; ++row_idx) {
+        output_column[row_idx] = reduction(output_column[row_idx], init);
+      }
+    }
+  }
+}
+}  // namespace
+
+void HierarchicalRangeBounds::update(ThreadPool* thread_pool) {
+  ZoneScoped;
+  // Only (re)allocate the pyramid levels if the range image's size changed
+  const Index2D range_image_dims = range_image_->getDimensions();
+  if (range_image_dims != range_image_dims_) {
+    allocateLevels(range_image_dims);
+  }
+
+  // Compute the bounds
+  auto update_lower_bounds = [this]() {
+    computeReducedPyramid(
+        lower_bound_levels_, MinReduction{},
+        ValueOrInit{min_range_, kUnknownValueLowerBound},
+        kUnknownValueLowerBound);
+  };
+  auto update_upper_bounds = [this]() {
+    computeReducedPyramid(
+        upper_bound_levels_, MaxReduction{},
+        ValueOrInit{min_range_, kUnknownValueUpperBound},
+        kUnknownValueUpperBound);
+  };
+  auto update_unobserved_mask = [this]() {
+    computeReducedPyramid(unobserved_mask_levels_, OrReduction{},
+                          IsUnobserved{min_range_}, true);
+  };
+  if (thread_pool) {
+    // NOTE: We wait on the tasks' group instead of calling wait_all, s.t.
+    //       we don't wait for unrelated tasks that share the same pool.
+    ThreadPool::TaskGroup bound_tasks;
+    thread_pool->add_detached_task(bound_tasks, update_lower_bounds);
+    thread_pool->add_detached_task(bound_tasks, update_upper_bounds);
+    update_unobserved_mask();
+    thread_pool->wait_for(bound_tasks);
+  } else {
+    update_lower_bounds();
+    update_upper_bounds();
+    update_unobserved_mask();
+  }
+}
+
+void HierarchicalRangeBounds::allocateLevels(const Index2D& range_image_dims) {
+  CHECK(!azimuth_wraps_pi_ || bit_ops::popcount(range_image_dims.y()))
+      << "For LiDAR range images that wrap around horizontally (FoV of "
+         "360deg), only column numbers that are exact powers of 2 are "
+         "currently supported.";
+
+  const Index2D range_image_dims_scaled =
+      image_to_pyramid_scale_factor_.cwiseProduct(range_image_dims);
+  const int max_num_halvings =
+      int_math::log2_ceil(range_image_dims_scaled.maxCoeff());
+
+  lower_bound_levels_.clear();
+  upper_bound_levels_.clear();
+  unobserved_mask_levels_.clear();
+  lower_bound_levels_.reserve(max_num_halvings);
+  upper_bound_levels_.reserve(max_num_halvings);
+  unobserved_mask_levels_.reserve(max_num_halvings);
+  for (int level_idx = 0; level_idx < max_num_halvings; ++level_idx) {
+    const Index2D level_dims =
+        int_math::div_exp2_ceil(range_image_dims_scaled, level_idx + 1);
+    lower_bound_levels_.emplace_back(level_dims, kUnknownValueLowerBound);
+    upper_bound_levels_.emplace_back(level_dims, kUnknownValueUpperBound);
+    unobserved_mask_levels_.emplace_back(level_dims, true);
+  }
+
+  range_image_dims_ = range_image_dims;
+  max_height_ = static_cast<NdtreeIndexElement>(max_num_halvings);
+}
+
+template <typename T, typename ReductionT, typename LeafTransformT>
+void HierarchicalRangeBounds::computeReducedPyramid(
+    std::vector<Image<T>>& pyramid, ReductionT reduction,
+    LeafTransformT leaf_transform, T init) const {
+  // If the range image is upscaled along an axis to make the pyramid's cells
+  // square, the first level does not pool along this axis
+  const bool pool_leaf_rows = image_to_pyramid_scale_factor_.x() == 1;
+  const bool pool_leaf_columns = image_to_pyramid_scale_factor_.y() == 1;
+  for (size_t level_idx = 0; level_idx < pyramid.size(); ++level_idx) {
+    if (level_idx == 0) {
+      poolLevel(*range_image_, pyramid[level_idx], pool_leaf_rows,
+                pool_leaf_columns, azimuth_wraps_pi_, reduction,
+                leaf_transform, init);
+    } else {
+      poolLevel(pyramid[level_idx - 1], pyramid[level_idx], true, true,
+                azimuth_wraps_pi_, reduction, Identity{}, init);
+    }
+  }
+}
+}  // namespace wavemap
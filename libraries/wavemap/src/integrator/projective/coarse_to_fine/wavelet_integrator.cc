@@ -1,12 +1,18 @@
 #include "wavemap/integrator/projective/coarse_to_fine/wavelet_integrator.h"
 
 namespace wavemap {
-void WaveletIntegrator::updateMap() {
-  // Update the range image intersector
-  range_image_intersector_ = std::make_shared<RangeImageIntersector>(
-      posed_range_image_, projection_model_, *measurement_model_,
-      config_.min_range, config_.max_range);
+void WaveletIntegrator::prepareMapUpdate() {
+  // Update the range image intersector, reusing it if it already exists
+  if (range_image_intersector_) {
+    range_image_intersector_->update();
+  } else {
+    range_image_intersector_ = std::make_shared<RangeImageIntersector>(
+        posed_range_image_, projection_model_, *measurement_model_,
+        config_.min_range, config_.max_range);
+  }
+}
 
+void WaveletIntegrator::updateMap() {
   // Recursively update all relevant cells
   const auto first_child_indices = occupancy_map_->getFirstChildIndices();
   WaveletOctree::Coefficients::CoefficientsArray
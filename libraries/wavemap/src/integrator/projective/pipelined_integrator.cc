@@ -0,0 +1,113 @@
+#include "wavemap/integrator/projective/pipelined_integrator.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <tracy/Tracy.hpp>
+
+namespace wavemap {
+PipelinedIntegrator::PipelinedIntegrator(
+    std::vector<ProjectiveIntegrator::Ptr> stages,
+    std::shared_ptr<ThreadPool> thread_pool)
+    : stages_(std::move(stages)),
+      thread_pool_(std::move(CHECK_NOTNULL(thread_pool))),
+      stage_done_(stages_.size()) {
+  CHECK(!stages_.empty());
+  for (const auto& stage : stages_) {
+    CHECK(stage != nullptr);
+  }
+}
+
+void PipelinedIntegrator::integratePointcloud(
+    const PosedPointcloud<>& pointcloud) {
+  ZoneScoped;
+  enqueue([pointcloud](ProjectiveIntegrator& stage) {
+    return stage.preparePointcloud(pointcloud);
+  });
+}
+
+void PipelinedIntegrator::integrateRangeImage(
+    const PosedImage<>& range_image) {
+  ZoneScoped;
+  enqueue([range_image](ProjectiveIntegrator& stage) {
+    return stage.prepareRangeImage(range_image);
+  });
+}
+
+bool PipelinedIntegrator::locksMapBlocks() const {
+  return std::all_of(stages_.begin(), stages_.end(), [](const auto& stage) {
+    return stage->locksMapBlocks();
+  });
+}
+
+void PipelinedIntegrator::flush() {
+  ZoneScoped;
+  // NOTE: Since the measurements are committed one at a time in order, the
+  //       last one completes after all others.
+  if (last_measurement_done_.valid()) {
+    thread_pool_->wait_for(last_measurement_done_);
+  }
+}
+
+template <typename PrepareFn>
+void PipelinedIntegrator::enqueue(PrepareFn prepare) {
+  // Wait for the next stage to finish its previous measurement, s.t. its range
+  // image and range image intersector can be overwritten
+  ProjectiveIntegrator* stage = stages_[next_stage_idx_].get();
+  std::shared_future<void>& stage_done = stage_done_[next_stage_idx_];
+  if (stage_done.valid()) {
+    ZoneScopedN("waitForFreeStage");
+    thread_pool_->wait_for(stage_done);
+  }
+  next_stage_idx_ = (next_stage_idx_ + 1) % stages_.size();
+
+  auto measurement = std::make_shared<PendingMeasurement>();
+  measurement->stage = stage;
+  stage_done = measurement->done.get_future().share();
+  last_measurement_done_ = stage_done;
+  {
+    std::scoped_lock lock(mutex_);
+    pending_measurements_.emplace_back(measurement);
+  }
+
+  // Prepare the measurement while the previous measurements are committed
+  thread_pool_->add_detached_task(
+      [this, measurement = std::move(measurement),
+       prepare = std::move(prepare)]() {
+        const bool is_valid = prepare(*measurement->stage);
+        std::scoped_lock lock(mutex_);
+        measurement->is_valid = is_valid;
+        scheduleNextCommit();
+      });
+}
+
+void PipelinedIntegrator::scheduleNextCommit() {
+  if (is_committing_ || pending_measurements_.empty() ||
+      !pending_measurements_.front()->is_valid.has_value()) {
+    return;
+  }
+  is_committing_ = true;
+  auto measurement = std::move(pending_measurements_.front());
+  pending_measurements_.pop_front();
+
+  // NOTE: The commit itself waits on the tasks it spawns through the thread
+  //       pool's wait_for, which keeps the worker busy with other tasks. These
+  //       can include the commits of other integrators that update the same
+  //       map, which is why the integrators never hold the map's blocks mutex
+  //       while waiting.
+  //       Once done, the commit schedules its successor before signaling its
+  //       completion, s.t. it no longer accesses this integrator afterwards.
+  thread_pool_->add_detached_task([this,
+                                   measurement = std::move(measurement)]() {
+    if (measurement->is_valid.value()) {
+      measurement->stage->commitPreparedMeasurement();
+    }
+    {
+      std::scoped_lock lock(mutex_);
+      is_committing_ = false;
+      scheduleNextCommit();
+    }
+    measurement->done.set_value();
+  });
+}
+}  // namespace wavemap
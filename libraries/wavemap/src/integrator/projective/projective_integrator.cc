@@ -2,12 +2,16 @@
 
 #include <tracy/Tracy.hpp>
 
+#include "wavemap/utils/time/stopwatch.h"
+
 namespace wavemap {
 DECLARE_CONFIG_MEMBERS(ProjectiveIntegratorConfig,
                       (min_range)
                       (max_range)
                       (termination_height)
-                      (termination_update_error));
+                      (termination_update_error)
+                      (pipeline_depth)
+                      (locality_aware_block_scheduling));
 
 bool ProjectiveIntegratorConfig::isValid(bool verbose) const {
   bool is_valid = true;
@@ -17,6 +21,7 @@ bool ProjectiveIntegratorConfig::isValid(bool verbose) const {
   is_valid &= IS_PARAM_LT(min_range, max_range, verbose);
   is_valid &= IS_PARAM_GE(termination_height, 0, verbose);
   is_valid &= IS_PARAM_GT(termination_update_error, 0.f, verbose);
+  is_valid &= IS_PARAM_GE(pipeline_depth, 1, verbose);
 
   return is_valid;
 }
@@ -24,18 +29,60 @@ bool ProjectiveIntegratorConfig::isValid(bool verbose) const {
 void ProjectiveIntegrator::integratePointcloud(
     const PosedPointcloud<Point<3>>& pointcloud) {
   ZoneScoped;
-  if (!isPointcloudValid(pointcloud)) {
-    return;
+  if (preparePointcloud(pointcloud)) {
+    commitPreparedMeasurement();
   }
-  importPointcloud(pointcloud);
-  updateMap();
 }
 
 void ProjectiveIntegrator::integrateRangeImage(
     const PosedImage<>& range_image) {
   ZoneScoped;
+  if (prepareRangeImage(range_image)) {
+    commitPreparedMeasurement();
+  }
+}
+
+bool ProjectiveIntegrator::preparePointcloud(
+    const PosedPointcloud<Point<3>>& pointcloud) {
+  ZoneScoped;
+  if (!isPointcloudValid(pointcloud)) {
+    return false;
+  }
+  last_stage_timings_ = {};
+  Stopwatch stage_timer;
+  stage_timer.start();
+  importPointcloud(pointcloud);
+  stage_timer.stop();
+  last_stage_timings_.import_measurement = stage_timer.getLastEpisodeDuration();
+  stage_timer.start();
+  prepareMapUpdate();
+  stage_timer.stop();
+  last_stage_timings_.prepare_map_update = stage_timer.getLastEpisodeDuration();
+  return true;
+}
+
+bool ProjectiveIntegrator::prepareRangeImage(const PosedImage<>& range_image) {
+  ZoneScoped;
+  last_stage_timings_ = {};
+  Stopwatch stage_timer;
+  stage_timer.start();
   importRangeImage(range_image);
+  stage_timer.stop();
+  last_stage_timings_.import_measurement = stage_timer.getLastEpisodeDuration();
+  stage_timer.start();
+  prepareMapUpdate();
+  stage_timer.stop();
+  last_stage_timings_.prepare_map_update = stage_timer.getLastEpisodeDuration();
+  return true;
+}
+
+void ProjectiveIntegrator::commitPreparedMeasurement() {
+  ZoneScoped;
+  Stopwatch stage_timer;
+  stage_timer.start();
   updateMap();
+  stage_timer.stop();
+  last_stage_timings_.update_map = stage_timer.getLastEpisodeDuration();
 }
 
 void ProjectiveIntegrator::importPointcloud(
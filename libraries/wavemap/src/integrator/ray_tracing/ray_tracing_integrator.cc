@@ -1,5 +1,16 @@
 #include "wavemap/integrator/ray_tracing/ray_tracing_integrator.h"
 
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+
+#include <tracy/Tracy.hpp>
+
+#include "wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h"
+#include "wavemap/data_structure/volumetric/hashed_wavelet_octree.h"
+#include "wavemap/utils/math/int_math.h"
+
 namespace wavemap {
 DECLARE_CONFIG_MEMBERS(RayTracingIntegratorConfig,
                       (min_range)
@@ -17,10 +28,49 @@ bool RayTracingIntegratorConfig::isValid(bool verbose) const {
 
 void RayTracingIntegrator::integratePointcloud(
     const PosedPointcloud<>& pointcloud) {
+  ZoneScoped;
   if (!isPointcloudValid(pointcloud)) {
     return;
   }
 
+  // Trace the rays in parallel if we have a thread pool and the map's blocks
+  // can be updated independently
+  if (thread_pool_) {
+    if (auto hashed_blocks =
+            std::dynamic_pointer_cast<HashedBlocks>(occupancy_map_);
+        hashed_blocks) {
+      integratePointcloudParallel(pointcloud, *hashed_blocks);
+      return;
+    }
+    if (auto hashed_wavelet_octree =
+            std::dynamic_pointer_cast<HashedWaveletOctree>(occupancy_map_);
+        hashed_wavelet_octree) {
+      integratePointcloudParallel(pointcloud, *hashed_wavelet_octree);
+      return;
+    }
+    if (auto hashed_chunked_wavelet_octree =
+            std::dynamic_pointer_cast<HashedChunkedWaveletOctree>(
+                occupancy_map_);
+        hashed_chunked_wavelet_octree) {
+      integratePointcloudParallel(pointcloud, *hashed_chunked_wavelet_octree);
+      return;
+    }
+  }
+
+  integratePointcloudSerial(pointcloud);
+}
+
+bool RayTracingIntegrator::locksMapBlocks() const {
+  // NOTE: Only the parallel integration of hashed wavelet octrees goes through
+  //       the block locks. Serial integration and HashedBlocks do not.
+  return thread_pool_ &&
+         (std::dynamic_pointer_cast<HashedWaveletOctree>(occupancy_map_) ||
+          std::dynamic_pointer_cast<HashedChunkedWaveletOctree>(
+              occupancy_map_));
+}
+
+void RayTracingIntegrator::integratePointcloudSerial(
+    const PosedPointcloud<>& pointcloud) {
   const FloatingPoint min_cell_width = occupancy_map_->getMinCellWidth();
   const Point3D& W_start_point = pointcloud.getOrigin();
 
@@ -45,4 +95,168 @@ void RayTracingIntegrator::integratePointcloud(
     }
   }
 }
+
+template <typename MapT>
+void RayTracingIntegrator::integratePointcloudParallel(
+    const PosedPointcloud<>& pointcloud, MapT& occupancy_map) {
+  const Pointcloud<> W_points = pointcloud.getPointsGlobal();
+  const Point3D& W_start_point = pointcloud.getOrigin();
+  const IndexElement block_height =
+      int_math::log2_floor(occupancy_map.getBlockSize().x());
+
+  // Trace the rays in parallel, in contiguous batches with one update buffer
+  // per batch
+  const size_t num_points = W_points.size();
+  const size_t num_batches =
+      std::clamp(thread_pool_->size(), size_t{1}, num_points);
+  batch_updates_.resize(num_batches);
+  ThreadPool::TaskGroup trace_tasks;
+  for (size_t batch_idx = 0; batch_idx < num_batches; ++batch_idx) {
+    const size_t first_point_idx = batch_idx * num_points / num_batches;
+    const size_t last_point_idx = (batch_idx + 1) * num_points / num_batches;
+    thread_pool_->add_detached_task(
+        trace_tasks,
+        [this, &W_points, &W_start_point, first_point_idx, last_point_idx,
+         block_height, batch_idx]() {
+          BlockUpdates& block_updates = batch_updates_[batch_idx];
+          block_updates.clear();
+          traceRays(W_points, W_start_point, first_point_idx, last_point_idx,
+                    block_height, block_updates);
+        });
+  }
+  thread_pool_->wait_for(trace_tasks);
+
+  // Gather the indices of all blocks that were touched by any batch
+  std::vector<Index3D> blocks_to_update;
+  {
+    ZoneScopedN("mergeBlockLists");
+    std::unordered_set<Index3D, IndexHash<3>> unique_blocks;
+    for (const BlockUpdates& block_updates : batch_updates_) {
+      for (const auto& [block_index, updates] : block_updates) {
+        if (unique_blocks.emplace(block_index).second) {
+          blocks_to_update.emplace_back(block_index);
+        }
+      }
+    }
+  }
+
+  // Apply the updates, processing each block in a single task
+  applyUpdates(occupancy_map, blocks_to_update);
+}
+
+void RayTracingIntegrator::traceRays(const Pointcloud<>& W_points,
+                                     const Point3D& W_start_point,
+                                     size_t first_point_idx,
+                                     size_t last_point_idx,
+                                     IndexElement block_height,
+                                     BlockUpdates& block_updates) const {
+  ZoneScoped;
+  MeasurementModelType measurement_model(occupancy_map_->getMinCellWidth());
+  measurement_model.setStartPoint(W_start_point);
+
+  // NOTE: Consecutive cells along a ray mostly lie in the same block, so we
+  //       only look up the block's update list when the block changes.
+  std::vector<CellUpdate>* current_block_updates = nullptr;
+  Index3D current_block_index = Index3D::Zero();
+  for (size_t point_idx = first_point_idx; point_idx < last_point_idx;
+       ++point_idx) {
+    const Point3D W_end_point = W_points[static_cast<Eigen::Index>(point_idx)];
+    measurement_model.setEndPoint(W_end_point);
+
+    if (!isMeasurementValid(W_end_point - W_start_point)) {
+      continue;
+    }
+
+    const FloatingPoint measured_distance =
+        (W_start_point - W_end_point).norm();
+    const Point3D W_end_point_truncated = getEndPointOrMaxRange(
+        W_start_point, W_end_point, measured_distance, config_.max_range);
+    const Ray ray(W_start_point, W_end_point_truncated, measured_distance);
+    for (const auto& index : ray) {
+      const FloatingPoint update = measurement_model.computeUpdate(index);
+      const Index3D block_index = int_math::div_exp2_floor(index, block_height);
+      if (!current_block_updates || block_index != current_block_index) {
+        current_block_updates = &block_updates[block_index];
+        current_block_index = block_index;
+      }
+      current_block_updates->emplace_back(CellUpdate{index, update});
+    }
+  }
+}
+
+template <typename MapT>
+void RayTracingIntegrator::applyUpdates(
+    MapT& occupancy_map, const std::vector<Index3D>& blocks_to_update) {
+  ZoneScoped;
+  const IndexElement block_height = occupancy_map.getTreeHeight();
+
+  // Make sure the to-be-updated blocks are allocated
+  // NOTE: The blocks mutex is not held while waiting on the update tasks, since
+  //       the waiting thread might run other queued tasks that lock it again.
+  occupancy_map.allocateBlocks(blocks_to_update);
+
+  ThreadPool::TaskGroup update_tasks;
+  for (const Index3D& block_index : blocks_to_update) {
+    thread_pool_->add_detached_task(
+        update_tasks, [this, &occupancy_map, block_index, block_height]() {
+          // Gather the block's updates, in block coordinates
+          const Index3D block_origin =
+              int_math::mult_exp2(block_index, block_height);
+          NodeUpdateList node_updates;
+          forEachUpdateInBlock(
+              block_index, [&node_updates, &block_origin](
+                               const CellUpdate& cell_update) {
+                node_updates.emplace_back(
+                    NodeUpdate{{0, cell_update.index - block_origin},
+                               cell_update.update});
+              });
+          sortNodeUpdates(node_updates);
+
+          // Apply them in a single pass over the block's tree, reallocating
+          // the block if it was removed since it was allocated above (e.g. by
+          // background pruning) and keeping it from being removed meanwhile
+          auto blocks_lock = std::shared_lock(occupancy_map.getBlocksMutex());
+          occupancy_map.allocateBlocks({block_index}, blocks_lock);
+          auto& block = occupancy_map.getBlock(block_index);
+          auto block_lock = std::scoped_lock(block.getMutex());
+          block.addToCellValues(node_updates);
+        });
+  }
+  thread_pool_->wait_for(update_tasks);
+}
+
+void RayTracingIntegrator::applyUpdates(
+    HashedBlocks& occupancy_map, const std::vector<Index3D>& blocks_to_update) {
+  ZoneScoped;
+  occupancy_map.allocateBlocks(blocks_to_update);
+
+  ThreadPool::TaskGroup update_tasks;
+  for (const Index3D& block_index : blocks_to_update) {
+    thread_pool_->add_detached_task(
+        update_tasks, [this, &occupancy_map, block_index]() {
+          // NOTE: Since all blocks are allocated, updating the cells does not
+          //       modify the block hash map. We also call HashedBlocks'
+          //       implementation directly, to skip the virtual dispatch.
+          forEachUpdateInBlock(
+              block_index, [&occupancy_map](const CellUpdate& cell_update) {
+                occupancy_map.HashedBlocks::addToCellValue(cell_update.index,
+                                                           cell_update.update);
+              });
+        });
+  }
+  thread_pool_->wait_for(update_tasks);
+}
+
+template <typename VisitorFn>
+void RayTracingIntegrator::forEachUpdateInBlock(const Index3D& block_index,
+                                                VisitorFn visitor_fn) const {
+  for (const BlockUpdates& block_updates : batch_updates_) {
+    if (const auto it = block_updates.find(block_index);
+        it != block_updates.end()) {
+      for (const CellUpdate& cell_update : it->second) {
+        visitor_fn(cell_update);
+      }
+    }
+  }
+}
 }  // namespace wavemap
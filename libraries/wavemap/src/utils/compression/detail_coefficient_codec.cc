@@ -0,0 +1,109 @@
+#include "wavemap/utils/compression/detail_coefficient_codec.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "wavemap/utils/bits/bit_operations.h"
+
+namespace wavemap {
+namespace {
+// Quantized values are clamped s.t. their zigzag encoding fits in 31 bits
+constexpr FloatingPoint kMaxQuantizedValue =
+    static_cast<FloatingPoint>(1 << 30);
+
+// Map signed to unsigned values s.t. values of small magnitude stay small,
+// i.e. 0, -1, 1, -2, 2, ... are mapped to 0, 1, 2, 3, 4, ...
+uint32_t zigzagEncode(int32_t value) {
+  return (static_cast<uint32_t>(value) << 1) ^
+         static_cast<uint32_t>(value >> 31);
+}
+int32_t zigzagDecode(uint32_t value) {
+  return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1u);
+}
+}  // namespace
+
+DetailCoefficientEncoder::DetailCoefficientEncoder(
+    FloatingPoint quantization_step, std::vector<uint8_t>& output)
+    : quantization_step_inv_(1.f / quantization_step), range_encoder_(output) {
+  CHECK_GT(quantization_step, 0.f);
+}
+
+void DetailCoefficientEncoder::encodeNode(const Details& details,
+                                          uint8_t allocated_children_bitset) {
+  // Quantize the coefficients
+  std::array<uint32_t, DetailCoefficientModel::kNumDetails> values{};
+  uint32_t nonzero_mask = 0u;
+  for (int coeff_idx = 0; coeff_idx < DetailCoefficientModel::kNumDetails;
+       ++coeff_idx) {
+    const FloatingPoint quantized =
+        std::clamp(std::round(details[coeff_idx] * quantization_step_inv_),
+                   -kMaxQuantizedValue, kMaxQuantizedValue);
+    values[coeff_idx] = zigzagEncode(static_cast<int32_t>(quantized));
+    if (values[coeff_idx] != 0u) {
+      nonzero_mask |= 1u << coeff_idx;
+    }
+  }
+
+  // Encode the node's structure
+  range_encoder_.encodeBitTree(model_.allocated_children_bitset.data(), 8,
+                               allocated_children_bitset);
+  const bool has_children = allocated_children_bitset != 0u;
+  range_encoder_.encodeBitTree(model_.nonzero_mask[has_children].data(),
+                               DetailCoefficientModel::kNumDetails,
+                               nonzero_mask);
+
+  // Encode the non-zero values as their number of significant bits, followed
+  // by the bits below the most significant (which is always one)
+  for (int coeff_idx = 0; coeff_idx < DetailCoefficientModel::kNumDetails;
+       ++coeff_idx) {
+    const uint32_t value = values[coeff_idx];
+    if (value == 0u) {
+      continue;
+    }
+    const int num_bits = 32 - static_cast<int>(bit_ops::clz(value));
+    range_encoder_.encodeBitTree(model_.value_length[coeff_idx].data(),
+                                 DetailCoefficientModel::kNumValueLengthBits,
+                                 num_bits - 1);
+    range_encoder_.encodeDirectBits(value, num_bits - 1);
+  }
+}
+
+DetailCoefficientDecoder::DetailCoefficientDecoder(
+    FloatingPoint quantization_step, const uint8_t* data_begin,
+    const uint8_t* data_end)
+    : quantization_step_(quantization_step),
+      range_decoder_(data_begin, data_end) {
+  CHECK_GT(quantization_step, 0.f);
+}
+
+bool DetailCoefficientDecoder::decodeNode(Details& details,
+                                          uint8_t& allocated_children_bitset) {
+  // Decode the node's structure
+  allocated_children_bitset = static_cast<uint8_t>(
+      range_decoder_.decodeBitTree(model_.allocated_children_bitset.data(), 8));
+  const bool has_children = allocated_children_bitset != 0u;
+  const uint32_t nonzero_mask = range_decoder_.decodeBitTree(
+      model_.nonzero_mask[has_children].data(),
+      DetailCoefficientModel::kNumDetails);
+
+  // Decode the non-zero values
+  for (int coeff_idx = 0; coeff_idx < DetailCoefficientModel::kNumDetails;
+       ++coeff_idx) {
+    if (!(nonzero_mask & (1u << coeff_idx))) {
+      details[coeff_idx] = 0.f;
+      continue;
+    }
+    const int num_bits =
+        static_cast<int>(range_decoder_.decodeBitTree(
+            model_.value_length[coeff_idx].data(),
+            DetailCoefficientModel::kNumValueLengthBits)) +
+        1;
+    const uint32_t value = (1u << (num_bits - 1)) |
+                           range_decoder_.decodeDirectBits(num_bits - 1);
+    details[coeff_idx] =
+        static_cast<FloatingPoint>(zigzagDecode(value)) * quantization_step_;
+  }
+
+  return !range_decoder_.overran();
+}
+}  // namespace wavemap
@@ -0,0 +1,181 @@
+#include "wavemap/utils/query/batched_query_accelerator.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <tracy/Tracy.hpp>
+
+#include "wavemap/indexing/index_conversions.h"
+#include "wavemap/utils/bits/morton_encoding.h"
+#include "wavemap/utils/math/int_math.h"
+#include "wavemap/utils/query/query_accelerator.h"
+
+namespace wavemap {
+namespace {
+struct SortItem {
+  MortonIndex key;
+  size_t query_idx;
+};
+
+// Stable LSD radix sort, which skips the digits that all keys have in common
+// NOTE: Since the keys are computed relative to the batch's minimum corner,
+//       their upper bits are zero unless the batch spans a huge region. For
+//       typical batches, only two or three passes are therefore required.
+void radixSortByKey(std::vector<SortItem>& items) {
+  constexpr int kNumBitsPerDigit = 11;
+  constexpr size_t kNumBuckets = 1u << kNumBitsPerDigit;
+  constexpr MortonIndex kDigitMask = kNumBuckets - 1u;
+
+  MortonIndex varying_bits = 0u;
+  for (const SortItem& item : items) {
+    varying_bits |= item.key ^ items.front().key;
+  }
+
+  std::vector<SortItem> buffer(items.size());
+  std::vector<size_t> bucket_offsets(kNumBuckets);
+  for (int shift = 0; shift < 8 * static_cast<int>(sizeof(MortonIndex));
+       shift += kNumBitsPerDigit) {
+    if (((varying_bits >> shift) & kDigitMask) == 0u) {
+      continue;
+    }
+    std::fill(bucket_offsets.begin(), bucket_offsets.end(), 0u);
+    for (const SortItem& item : items) {
+      ++bucket_offsets[(item.key >> shift) & kDigitMask];
+    }
+    size_t offset = 0u;
+    for (size_t& bucket_offset : bucket_offsets) {
+      offset += std::exchange(bucket_offset, offset);
+    }
+    for (const SortItem& item : items) {
+      buffer[bucket_offsets[(item.key >> shift) & kDigitMask]++] = item;
+    }
+    items.swap(buffer);
+  }
+}
+}  // namespace
+
+void BatchedQueryAccelerator::getCellValues(const Point3D* points,
+                                            size_t num_queries,
+                                            FloatingPoint* values) const {
+  const FloatingPoint cell_width_inv = 1.f / map_.getMinCellWidth();
+  getCellValuesImpl(points, num_queries, values,
+                    [cell_width_inv](const Point3D& point) {
+                      return OctreeIndex{
+                          0, convert::pointToNearestIndex(point,
+                                                          cell_width_inv)};
+                    });
+}
+
+void BatchedQueryAccelerator::getCellValues(const Index3D* indices,
+                                            size_t num_queries,
+                                            FloatingPoint* values) const {
+  getCellValuesImpl(indices, num_queries, values, [](const Index3D& index) {
+    return OctreeIndex{0, index};
+  });
+}
+
+void BatchedQueryAccelerator::getCellValues(const OctreeIndex* node_indices,
+                                            size_t num_queries,
+                                            FloatingPoint* values) const {
+  getCellValuesImpl(node_indices, num_queries, values,
+                    [](const OctreeIndex& node_index) { return node_index; });
+}
+
+template <typename QueryT, typename ToNodeIndexFn>
+void BatchedQueryAccelerator::getCellValuesImpl(
+    const QueryT* queries, size_t num_queries, FloatingPoint* values,
+    ToNodeIndexFn to_node_index) const {
+  ZoneScoped;
+  if (num_queries == 0u) {
+    return;
+  }
+
+  // Find the minimum corner of the batch, aligned to the map's blocks
+  const size_t num_chunks = (num_queries + kChunkSize - 1u) / kChunkSize;
+  std::vector<Index3D> chunk_min_corners(
+      num_chunks, Index3D::Constant(std::numeric_limits<IndexElement>::max()));
+  forEachChunk(num_queries, [&](size_t chunk_start, size_t chunk_end) {
+    Index3D& chunk_min_corner = chunk_min_corners[chunk_start / kChunkSize];
+    for (size_t query_idx = chunk_start; query_idx < chunk_end; ++query_idx) {
+      chunk_min_corner =
+          chunk_min_corner.cwiseMin(convert::nodeIndexToMinCornerIndex(
+              to_node_index(queries[query_idx])));
+    }
+  });
+  Index3D min_corner = chunk_min_corners.front();
+  for (const Index3D& chunk_min_corner : chunk_min_corners) {
+    min_corner = min_corner.cwiseMin(chunk_min_corner);
+  }
+  const IndexElement tree_height = map_.getTreeHeight();
+  const Index3D origin = int_math::mult_exp2(
+      int_math::div_exp2_floor(min_corner, tree_height), tree_height);
+
+  // Compute the sort keys, as Morton codes relative to the origin
+  // NOTE: Since the origin is aligned to the blocks, all queries in a block
+  //       will end up next to each other. The keys only determine the order in
+  //       which the queries are evaluated, not their results. Batches that
+  //       exceed the range supported by the Morton encoding are therefore
+  //       simply clamped.
+  std::vector<SortItem> evaluation_order(num_queries);
+  forEachChunk(num_queries, [&](size_t chunk_start, size_t chunk_end) {
+    for (size_t query_idx = chunk_start; query_idx < chunk_end; ++query_idx) {
+      const Index3D offset = convert::nodeIndexToMinCornerIndex(
+                                 to_node_index(queries[query_idx])) -
+                             origin;
+      evaluation_order[query_idx] = {
+          morton::encode<3>(
+              offset.cwiseMin(morton::kMaxSingleCoordinate<3>).eval()),
+          query_idx};
+    }
+  });
+
+  // Sort the queries in Morton order
+  // NOTE: Batches that are already ordered, e.g. because they were generated
+  //       by iterating over a grid in Morton order, do not need to be sorted.
+  const bool is_sorted =
+      std::is_sorted(evaluation_order.begin(), evaluation_order.end(),
+                     [](const SortItem& lhs, const SortItem& rhs) {
+                       return lhs.key < rhs.key;
+                     });
+  if (!is_sorted) {
+    ZoneScopedN("sortQueries");
+    radixSortByKey(evaluation_order);
+  }
+
+  // Evaluate the queries
+  // NOTE: The QueryAccelerator only descends from the last ancestor each query
+  //       has in common with the previous query, which is the reason why the
+  //       queries are sorted.
+  forEachChunk(num_queries, [&](size_t chunk_start, size_t chunk_end) {
+    QueryAccelerator query_accelerator(map_);
+    for (size_t sorted_idx = chunk_start; sorted_idx < chunk_end;
+         ++sorted_idx) {
+      const size_t query_idx = evaluation_order[sorted_idx].query_idx;
+      values[query_idx] =
+          query_accelerator.getCellValue(to_node_index(queries[query_idx]));
+    }
+  });
+}
+
+template <typename ChunkFn>
+void BatchedQueryAccelerator::forEachChunk(size_t num_queries,
+                                           ChunkFn chunk_fn) const {
+  if (!thread_pool_ || num_queries <= kChunkSize) {
+    chunk_fn(0u, num_queries);
+    return;
+  }
+  ThreadPool::TaskGroup chunk_tasks;
+  for (size_t chunk_start = 0u; chunk_start < num_queries;
+       chunk_start += kChunkSize) {
+    const size_t chunk_end = std::min(chunk_start + kChunkSize, num_queries);
+    thread_pool_->add_detached_task(
+        chunk_tasks, [&chunk_fn, chunk_start, chunk_end]() {
+          ZoneScopedN("processQueryChunk");
+          chunk_fn(chunk_start, chunk_end);
+        });
+  }
+  thread_pool_->wait_for(chunk_tasks);
+}
+}  // namespace wavemap
@@ -1,18 +1,47 @@
 #include "wavemap/utils/thread_pool.h"
 
+#include <glog/logging.h>
 #include <tracy/Tracy.hpp>
 
 namespace wavemap {
+namespace {
+// Pool and deque index of the worker running on the current thread, if any
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_worker_idx = 0;
+}  // namespace
+
+ThreadPool::TaskGroup::~TaskGroup() {
+  CHECK(is_done()) << "Task groups must be waited on before destroying them.";
+}
+
+void ThreadPool::TaskGroup::task_done() {
+  // NOTE: The count is decremented while holding the mutex, s.t. waiting
+  //       threads can not return and destroy the group while it is still used.
+  auto lock = std::scoped_lock<std::mutex>(mutex_);
+  if (--pending_task_count_ == 0) {
+    condition_.notify_all();
+  }
+}
+
 ThreadPool::ThreadPool(size_t thread_count)
-    : task_count_(0), terminate_(false) {
+    : queues_(std::make_unique<WorkerQueue[]>(thread_count)),
+      next_queue_idx_(0),
+      queued_task_count_(0),
+      task_count_(0),
+      sleeping_worker_count_(0),
+      terminate_(false) {
+  CHECK_GT(thread_count, 0u);
+
   // Create the worker threads
   static int pool_id = 0;
   for (size_t i = 0; i < thread_count; ++i) {
     const std::string thread_name =
         "pool_" + std::to_string(pool_id) + "_worker_" + std::to_string(i);
-    workers_.emplace_back([this, thread_name] {
+    workers_.emplace_back([this, thread_name, i] {
       tracy::SetThreadName(thread_name.c_str());
-      worker_loop();
+      current_pool = this;
+      current_worker_idx = i;
+      worker_loop(i);
     });
   }
   ++pool_id;
@@ -20,50 +49,143 @@ ThreadPool::ThreadPool(size_t thread_count)
 
 ThreadPool::~ThreadPool() {
   {
-    auto lock = std::scoped_lock<std::mutex>(tasks_mutex_);
+    auto lock = std::scoped_lock<std::mutex>(worker_mutex_);
     terminate_ = true;
   }
   worker_condition_.notify_all();
   for (auto& worker : workers_) {
     worker.join();
   }
-  wait_all_condition_.notify_all();
+  {
+    auto lock = std::scoped_lock<std::mutex>(wait_all_mutex_);
+    wait_all_condition_.notify_all();
+  }
 }
 
+bool ThreadPool::is_worker_thread() const { return current_pool == this; }
+
 void ThreadPool::wait_all() {
-  auto lock = std::unique_lock<std::mutex>(tasks_mutex_);
+  auto lock = std::unique_lock<std::mutex>(wait_all_mutex_);
   wait_all_condition_.wait(lock,
                            [this] { return terminate_ || task_count_ == 0; });
 }
 
-void ThreadPool::worker_loop() {
+void ThreadPool::wait_for(TaskGroup& task_group) {
+  if (is_worker_thread()) {
+    // Help out instead of blocking, since the group's tasks might still be
+    // queued behind the task that is waiting for them
+    while (!task_group.is_done()) {
+      if (!run_pending_task()) {
+        auto lock = std::unique_lock<std::mutex>(task_group.mutex_);
+        task_group.condition_.wait_for(lock, kWaitForPollingInterval, [&] {
+          return task_group.is_done();
+        });
+      }
+    }
+  }
+  // Wait until the group's last task released the group
+  auto lock = std::unique_lock<std::mutex>(task_group.mutex_);
+  task_group.condition_.wait(lock, [&] { return task_group.is_done(); });
+}
+
+void ThreadPool::enqueue(InplaceTask&& task) {
+  if (terminate_) {
+    LOG(FATAL) << "Adding tasks to an already stopped pool.";
+  }
+
+  // Tasks spawned by our own workers go to the back of their own deque, all
+  // other tasks are distributed over the deques in a round-robin fashion
+  const size_t queue_idx =
+      current_pool == this
+          ? current_worker_idx
+          : next_queue_idx_.fetch_add(1, std::memory_order_relaxed) %
+                workers_.size();
+  task_count_++;
+  {
+    auto& queue = queues_[queue_idx];
+    auto lock = std::scoped_lock<std::mutex>(queue.mutex);
+    queue.tasks.emplace_back(std::move(task));
+  }
+  queued_task_count_++;
+
+  // Wake up a sleeping worker, if there is one
+  // NOTE: Sleeping workers increment the sleeping worker count before checking
+  //       the queued task count, which guarantees that either the worker sees
+  //       the new task or we see the sleeping worker.
+  if (0 < sleeping_worker_count_) {
+    { auto lock = std::scoped_lock<std::mutex>(worker_mutex_); }
+    worker_condition_.notify_one();
+  }
+}
+
+bool ThreadPool::try_pop(size_t worker_idx, InplaceTask& task) {
+  // Try to take the most recently added task from our own deque
+  {
+    auto& own_queue = queues_[worker_idx];
+    auto lock = std::scoped_lock<std::mutex>(own_queue.mutex);
+    if (!own_queue.tasks.empty()) {
+      task = std::move(own_queue.tasks.back());
+      own_queue.tasks.pop_back();
+      return true;
+    }
+  }
+
+  // Otherwise, try to steal the oldest task from another worker's deque
+  const size_t num_queues = workers_.size();
+  for (size_t offset = 1; offset < num_queues; ++offset) {
+    auto& victim_queue = queues_[(worker_idx + offset) % num_queues];
+    auto lock = std::scoped_lock<std::mutex>(victim_queue.mutex);
+    if (!victim_queue.tasks.empty()) {
+      task = std::move(victim_queue.tasks.front());
+      victim_queue.tasks.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ThreadPool::worker_loop(size_t worker_idx) {
+  InplaceTask task;
   while (true) {
     // Obtain the next task
-    auto task = std::function<void()>();
-    {
-      auto lock = std::unique_lock<std::mutex>(tasks_mutex_);
-
+    if (!try_pop(worker_idx, task)) {
       // Wait for something to do
-      worker_condition_.wait(lock,
-                             [this] { return terminate_ || !tasks_.empty(); });
-
-      if (terminate_ && tasks_.empty()) {
+      auto lock = std::unique_lock<std::mutex>(worker_mutex_);
+      sleeping_worker_count_++;
+      worker_condition_.wait(
+          lock, [this] { return terminate_ || 0 < queued_task_count_; });
+      sleeping_worker_count_--;
+      if (terminate_ && queued_task_count_ == 0) {
         return;
       }
-
-      task = std::move(tasks_.front());
-      tasks_.pop();
+      continue;
     }
+    queued_task_count_--;
+    run_task(task);
+  }
+}
 
-    // Execute the task
-    task();
-    task_count_--;
+void ThreadPool::run_task(InplaceTask& task) {
+  // Execute the task
+  task();
+  task.reset();
 
-    // Notify the waiting threads if we're done
-    if (task_count_ == 0) {
-      auto lock = std::unique_lock<std::mutex>(tasks_mutex_);
-      wait_all_condition_.notify_all();
-    }
+  // Notify the waiting threads if we're done
+  if (--task_count_ == 0) {
+    auto lock = std::scoped_lock<std::mutex>(wait_all_mutex_);
+    wait_all_condition_.notify_all();
+  }
+}
+
+bool ThreadPool::run_pending_task() {
+  DCHECK(is_worker_thread());
+  InplaceTask task;
+  if (!try_pop(current_worker_idx, task)) {
+    return false;
   }
+  queued_task_count_--;
+  run_task(task);
+  return true;
 }
 }  // namespace wavemap
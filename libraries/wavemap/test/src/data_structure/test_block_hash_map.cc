@@ -0,0 +1,144 @@
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "wavemap/common.h"
+#include "wavemap/data_structure/block_hash_map.h"
+#include "wavemap/indexing/index_hashes.h"
+#include "wavemap/test/fixture_base.h"
+#include "wavemap/test/geometry_generator.h"
+
+namespace wavemap {
+class BlockHashMapTest : public FixtureBase, public GeometryGenerator {};
+
+namespace {
+// Block type that can not be moved or copied, like the hashed map's blocks
+struct TestBlock {
+  explicit TestBlock(int value) : value(value) {}
+  TestBlock(const TestBlock&) = delete;
+  TestBlock& operator=(const TestBlock&) = delete;
+
+  int value;
+};
+}  // namespace
+
+TEST_F(BlockHashMapTest, EquivalenceToStdUnorderedMap) {
+  constexpr int kNumRepetitions = 10;
+  for (int repetition = 0; repetition < kNumRepetitions; ++repetition) {
+    BlockHashMap<TestBlock, 3> block_map;
+    std::unordered_map<Index3D, int, Index3DHash> reference_map;
+
+    // Perform a random sequence of insertions and removals
+    // NOTE: The indices are drawn from a small range, s.t. the same indices
+    //       get inserted, found and removed repeatedly.
+    const int num_operations = getRandomInteger(0, 5000);
+    const IndexElement max_coordinate = getRandomInteger(1, 20);
+    for (int op_idx = 0; op_idx < num_operations; ++op_idx) {
+      const Index3D block_index =
+          getRandomIndex<3>(Index3D::Constant(-max_coordinate),
+                            Index3D::Constant(max_coordinate));
+      if (getRandomInteger(0, 2) != 0) {
+        const auto [it, inserted] = block_map.try_emplace(block_index, op_idx);
+        const auto [reference_it, reference_inserted] =
+            reference_map.try_emplace(block_index, op_idx);
+        EXPECT_EQ(inserted, reference_inserted);
+        EXPECT_EQ(it->first, block_index);
+        EXPECT_EQ(it->second.value, reference_it->second);
+      } else {
+        EXPECT_EQ(block_map.erase(block_index),
+                  reference_map.erase(block_index));
+      }
+      ASSERT_EQ(block_map.size(), reference_map.size());
+    }
+
+    // Check that lookups and iteration match the reference
+    EXPECT_EQ(block_map.empty(), reference_map.empty());
+    for (const auto& [block_index, reference_value] : reference_map) {
+      ASSERT_TRUE(block_map.contains(block_index));
+      EXPECT_EQ(block_map.count(block_index), 1u);
+      EXPECT_EQ(block_map.at(block_index).value, reference_value);
+    }
+    size_t num_iterated_blocks = 0u;
+    for (const auto& [block_index, block] : block_map) {
+      ASSERT_TRUE(reference_map.count(block_index));
+      EXPECT_EQ(block.value, reference_map.at(block_index));
+      ++num_iterated_blocks;
+    }
+    EXPECT_EQ(num_iterated_blocks, reference_map.size());
+
+    // Check that blocks that do not exist are not found
+    const Index3D missing_index = Index3D::Constant(max_coordinate + 1);
+    EXPECT_FALSE(block_map.contains(missing_index));
+    EXPECT_EQ(block_map.find(missing_index), block_map.end());
+    EXPECT_THROW(block_map.at(missing_index), std::out_of_range);
+  }
+}
+
+TEST_F(BlockHashMapTest, ReferenceStability) {
+  BlockHashMap<TestBlock, 3> block_map;
+  const Index3D first_index = getRandomIndex<3>();
+  TestBlock* first_block = &block_map.try_emplace(first_index, 1).first->second;
+  const size_t initial_capacity = block_map.capacity();
+
+  // Grow the table until it is rehashed several times
+  for (int idx = 0; block_map.capacity() < 16u * initial_capacity; ++idx) {
+    block_map.try_emplace(Index3D{idx, 0, 0}, idx);
+  }
+  EXPECT_EQ(&block_map.at(first_index), first_block);
+  EXPECT_EQ(first_block->value, 1);
+}
+
+TEST_F(BlockHashMapTest, EraseWhileIterating) {
+  BlockHashMap<TestBlock, 3> block_map;
+  const int num_blocks = getRandomInteger(1, 1000);
+  for (int idx = 0; idx < num_blocks; ++idx) {
+    block_map.try_emplace(getRandomIndex<3>(), idx);
+  }
+
+  // Erase the blocks with an odd value
+  const size_t num_blocks_before = block_map.size();
+  size_t num_odd_blocks = 0u;
+  for (auto it = block_map.begin(); it != block_map.end();) {
+    if (it->second.value % 2 == 1) {
+      it = block_map.erase(it);
+      ++num_odd_blocks;
+    } else {
+      ++it;
+    }
+  }
+  EXPECT_EQ(block_map.size(), num_blocks_before - num_odd_blocks);
+  for (const auto& [block_index, block] : block_map) {
+    EXPECT_EQ(block.value % 2, 0);
+  }
+
+  block_map.clear();
+  EXPECT_TRUE(block_map.empty());
+  EXPECT_EQ(block_map.begin(), block_map.end());
+}
+
+TEST_F(BlockHashMapTest, IterateFromLookup) {
+  BlockHashMap<TestBlock, 3> block_map;
+  const int num_blocks = getRandomInteger(1, 1000);
+  for (int idx = 0; idx < num_blocks; ++idx) {
+    block_map.try_emplace(getRandomIndex<3>(), idx);
+  }
+  std::vector<Index3D> iteration_order;
+  for (const auto& [block_index, block] : block_map) {
+    iteration_order.emplace_back(block_index);
+  }
+
+  // Iterators returned by lookups must continue in the same order as the ones
+  // that started at begin()
+  for (size_t start_idx = 0; start_idx < iteration_order.size(); ++start_idx) {
+    size_t idx = start_idx;
+    for (auto it = block_map.find(iteration_order[start_idx]);
+         it != block_map.end(); ++it, ++idx) {
+      ASSERT_LT(idx, iteration_order.size());
+      EXPECT_EQ(it->first, iteration_order[idx]);
+    }
+    EXPECT_EQ(idx, iteration_order.size());
+  }
+}
+}  // namespace wavemap
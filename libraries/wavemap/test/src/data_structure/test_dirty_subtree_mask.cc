@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include "wavemap/common.h"
+#include "wavemap/data_structure/volumetric/dirty_subtree_mask.h"
+#include "wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree_block.h"
+#include "wavemap/data_structure/volumetric/hashed_wavelet_octree_block.h"
+#include "wavemap/test/fixture_base.h"
+#include "wavemap/test/geometry_generator.h"
+
+namespace wavemap {
+class DirtySubtreeMaskTest : public FixtureBase, public GeometryGenerator {};
+
+TEST_F(DirtySubtreeMaskTest, SubtreeIndices) {
+  constexpr int kNumRepetitions = 100;
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    const IndexElement tree_height = getRandomInteger(4, 9);
+    const IndexElement subtree_height =
+        tree_height - DirtySubtreeMask::kSubtreeDepth;
+    const Index3D block_index =
+        getRandomIndex<3>(Index3D::Constant(-100), Index3D::Constant(100));
+    const OctreeIndex block_node_index{tree_height, block_index};
+
+    // New masks should be fully dirty
+    DirtySubtreeMask mask(tree_height);
+    EXPECT_TRUE(mask.tracksSubtrees());
+    EXPECT_EQ(mask.getSubtreeHeight(), subtree_height);
+    EXPECT_TRUE(mask.all());
+    mask.clear();
+    EXPECT_FALSE(mask.any());
+
+    // Marking a cell should only flag the subtree that contains it
+    const Index3D cell_offset = getRandomIndex<3>(
+        Index3D::Zero(), Index3D::Constant(int_math::exp2(tree_height) - 1));
+    const OctreeIndex cell_index{
+        0, convert::nodeIndexToMinCornerIndex(block_node_index) + cell_offset};
+    mask.markDirty(cell_index);
+    ASSERT_EQ(mask.count(), 1u);
+    for (LinearIndex subtree_idx = 0;
+         subtree_idx < DirtySubtreeMask::kNumSubtrees; ++subtree_idx) {
+      if (mask.isDirty(subtree_idx)) {
+        EXPECT_EQ(mask.getSubtreeIndex(block_index, subtree_idx),
+                  cell_index.computeParentIndex(subtree_height));
+      }
+    }
+
+    // Marking a coarser node should flag all the subtrees it overlaps
+    mask.clear();
+    const IndexElement node_height =
+        getRandomInteger(subtree_height + 1, tree_height - 1);
+    const OctreeIndex node_index = cell_index.computeParentIndex(node_height);
+    mask.markDirty(node_index);
+    EXPECT_EQ(mask.count(),
+              static_cast<size_t>(int_math::exp2(
+                  OctreeIndex::kDim * (node_height - subtree_height))));
+    for (LinearIndex subtree_idx = 0;
+         subtree_idx < DirtySubtreeMask::kNumSubtrees; ++subtree_idx) {
+      const OctreeIndex subtree_index =
+          mask.getSubtreeIndex(block_index, subtree_idx);
+      EXPECT_EQ(mask.isDirty(subtree_idx),
+                subtree_index.computeParentIndex(node_height) == node_index);
+    }
+
+    // Updates to the whole block should flag all subtrees
+    mask.clear();
+    mask.markDirty(block_node_index);
+    EXPECT_TRUE(mask.all());
+  }
+}
+
+TEST_F(DirtySubtreeMaskTest, ShallowTrees) {
+  // Blocks that are not deeper than the subtrees should be tracked as a whole
+  DirtySubtreeMask mask(DirtySubtreeMask::kSubtreeDepth);
+  EXPECT_FALSE(mask.tracksSubtrees());
+  mask.clear();
+  mask.markDirty(OctreeIndex{0, Index3D::Zero()});
+  EXPECT_TRUE(mask.all());
+}
+
+template <typename BlockType>
+class DirtySubtreeMaskBlockTest : public FixtureBase,
+                                  public GeometryGenerator {};
+
+using BlockTypes =
+    ::testing::Types<HashedWaveletOctreeBlock, HashedChunkedWaveletOctreeBlock>;
+TYPED_TEST_SUITE(DirtySubtreeMaskBlockTest, BlockTypes, );
+
+TYPED_TEST(DirtySubtreeMaskBlockTest, BlockUpdates) {
+  constexpr IndexElement kTreeHeight = 6;
+  TypeParam block(kTreeHeight, -2.f, 4.f);
+  EXPECT_TRUE(block.getDirtySubtrees().all());
+  block.getDirtySubtrees().clear();
+
+  // Each update method should flag the subtree it touches
+  const Index3D max_index = Index3D::Constant(int_math::exp2(kTreeHeight) - 1);
+  const OctreeIndex first_index{
+      0, TestFixture::template getRandomIndex<3>(Index3D::Zero(), max_index)};
+  block.addToCellValue(first_index, 1.f);
+  EXPECT_EQ(block.getDirtySubtrees().count(), 1u);
+  const OctreeIndex second_index{
+      0, TestFixture::template getRandomIndex<3>(Index3D::Zero(), max_index)};
+  block.setCellValue(second_index, -1.f);
+  EXPECT_EQ(block.getDirtySubtrees().count(),
+            first_index.computeParentIndex(3) ==
+                    second_index.computeParentIndex(3)
+                ? 1u
+                : 2u);
+
+  // Thresholding and pruning should not flag any subtrees
+  block.getDirtySubtrees().clear();
+  block.threshold();
+  block.prune();
+  EXPECT_FALSE(block.getDirtySubtrees().any());
+}
+}  // namespace wavemap
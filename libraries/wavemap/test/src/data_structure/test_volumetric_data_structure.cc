@@ -4,6 +4,7 @@
 #include "wavemap/data_structure/volumetric/hashed_blocks.h"
 #include "wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h"
 #include "wavemap/data_structure/volumetric/hashed_wavelet_octree.h"
+#include "wavemap/data_structure/volumetric/node_update.h"
 #include "wavemap/data_structure/volumetric/volumetric_data_structure_base.h"
 #include "wavemap/data_structure/volumetric/volumetric_octree.h"
 #include "wavemap/data_structure/volumetric/wavelet_octree.h"
@@ -11,6 +12,7 @@
 #include "wavemap/test/config_generator.h"
 #include "wavemap/test/fixture_base.h"
 #include "wavemap/test/geometry_generator.h"
+#include "wavemap/utils/thread_pool.h"
 
 namespace wavemap {
 template <typename VolumetricDataStructureType>
@@ -208,6 +210,135 @@ TYPED_TEST(VolumetricDataStructureTest, InsertionAndLeafVisitor) {
   }
 }
 
+template <typename HashedMapType>
+class HashedMapTest : public FixtureBase,
+                      public GeometryGenerator,
+                      public ConfigGenerator {};
+
+using HashedMapTypes =
+    ::testing::Types<HashedWaveletOctree, HashedChunkedWaveletOctree>;
+TYPED_TEST_SUITE(HashedMapTest, HashedMapTypes, );
+
+TYPED_TEST(HashedMapTest, ParallelAndSerialPruningEquivalence) {
+  constexpr int kNumRepetitions = 3;
+  ThreadPool thread_pool(4);
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    // Create two identical random maps
+    auto config =
+        ConfigGenerator::getRandomConfig<typename TypeParam::Config>();
+    config.only_prune_blocks_if_unused_for = -1.f;
+    TypeParam serial_map(config);
+    TypeParam parallel_map(config);
+    const std::vector<Index3D> random_indices =
+        GeometryGenerator::getRandomIndexVector<3>(
+            1000u, 2000u, Index3D::Constant(-5000), Index3D::Constant(5000));
+    for (const Index3D& index : random_indices) {
+      // Include zero updates, such that some blocks can be removed entirely
+      const FloatingPoint update =
+          TestFixture::getRandomInteger(0, 1)
+              ? TestFixture::getRandomUpdate(-1e1f, 1e1f)
+              : 0.f;
+      serial_map.addToCellValue(index, update);
+      parallel_map.addToCellValue(index, update);
+    }
+
+    // Process them using the serial and parallel maintenance methods
+    serial_map.threshold();
+    parallel_map.threshold(thread_pool);
+    serial_map.pruneSmart();
+    parallel_map.pruneSmart(thread_pool);
+    serial_map.prune();
+    parallel_map.prune(thread_pool);
+
+    // Check that the results are identical
+    ASSERT_EQ(serial_map.getBlocks().size(), parallel_map.getBlocks().size());
+    EXPECT_EQ(serial_map.size(), parallel_map.size());
+    for (const auto& [block_index, block] : serial_map.getBlocks()) {
+      ASSERT_TRUE(parallel_map.hasBlock(block_index));
+    }
+    std::unordered_map<OctreeIndex, FloatingPoint, OctreeIndexHash>
+        serial_leaves;
+    serial_map.forEachLeaf(
+        [&serial_leaves](const OctreeIndex& node_index, FloatingPoint value) {
+          serial_leaves.emplace(node_index, value);
+        });
+    size_t num_parallel_leaves = 0u;
+    parallel_map.forEachLeaf([&serial_leaves, &num_parallel_leaves](
+                                 const OctreeIndex& node_index,
+                                 FloatingPoint value) {
+      ++num_parallel_leaves;
+      ASSERT_TRUE(serial_leaves.count(node_index))
+          << "At node index " << node_index.toString();
+      EXPECT_EQ(serial_leaves[node_index], value)
+          << "At node index " << node_index.toString();
+    });
+    EXPECT_EQ(num_parallel_leaves, serial_leaves.size());
+  }
+}
+
+TYPED_TEST(HashedMapTest, BulkAndPerNodeUpdateEquivalence) {
+  constexpr int kNumRepetitions = 3;
+  constexpr FloatingPoint kTolerance = 1e-5f;
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    const auto config =
+        ConfigGenerator::getRandomConfig<typename TypeParam::Config>();
+    const IndexElement tree_height = config.tree_height;
+    TypeParam per_node_map(config);
+    TypeParam bulk_map(config);
+
+    // Generate random updates at all heights, incl. repeated updates
+    NodeUpdateList node_updates;
+    const std::vector<Index3D> random_indices =
+        GeometryGenerator::getRandomIndexVector<3>(
+            1000u, 2000u, Index3D::Constant(-100), Index3D::Constant(100));
+    for (const Index3D& index : random_indices) {
+      const IndexElement height = TestFixture::getRandomInteger(
+          0, TestFixture::getRandomInteger(0, 1) ? 0 : tree_height);
+      const OctreeIndex node_index =
+          convert::indexAndHeightToNodeIndex(index, height);
+      const int num_repetitions = TestFixture::getRandomInteger(1, 2);
+      for (int repetition = 0; repetition < num_repetitions; ++repetition) {
+        node_updates.emplace_back(
+            NodeUpdate{node_index, TestFixture::getRandomUpdate()});
+      }
+    }
+
+    // Apply them one by one and in bulk
+    for (const NodeUpdate& node_update : node_updates) {
+      const Index3D block_index = int_math::div_exp2_floor(
+          node_update.index.position, tree_height - node_update.index.height);
+      const OctreeIndex cell_index{
+          node_update.index.height,
+          node_update.index.position -
+              int_math::mult_exp2(block_index,
+                                  tree_height - node_update.index.height)};
+      per_node_map.getOrAllocateBlock(block_index)
+          .addToCellValue(cell_index, node_update.update);
+    }
+    bulk_map.addToCellValues(node_updates);
+
+    // Check that both maps have the same structure and values, up to floating
+    // point rounding errors that scale with the magnitude of the values
+    ASSERT_EQ(per_node_map.getBlocks().size(), bulk_map.getBlocks().size());
+    EXPECT_EQ(per_node_map.size(), bulk_map.size());
+    FloatingPoint max_abs_value = 0.f;
+    per_node_map.forEachLeaf([&max_abs_value](
+                                 const OctreeIndex& /*node_index*/,
+                                 FloatingPoint value) {
+      max_abs_value = std::max(max_abs_value, std::abs(value));
+    });
+    const FloatingPoint tolerance = kTolerance * (1.f + max_abs_value);
+    auto compare_maps = [&](const OctreeIndex& node_index,
+                            FloatingPoint /*value*/) {
+      EXPECT_NEAR(bulk_map.getCellValue(node_index),
+                  per_node_map.getCellValue(node_index), tolerance)
+          << "At node index " << node_index.toString();
+    };
+    per_node_map.forEachLeaf(compare_maps);
+    bulk_map.forEachLeaf(compare_maps);
+  }
+}
+
 // TODO(victorr): For classes derived from VolumetricOctreeInterface, test
 //                NodeIndex based setters and getters (incl. whether values of
 //                all children are updated but nothing spills to the
@@ -93,5 +93,31 @@ TEST_F(SphericalProjectorTest, CellToBeamAngles) {
   }
 }
 
+TEST_F(SphericalProjectorTest, CartesianToSensorBatch) {
+  constexpr FloatingPoint kNoiseTolerance = 1e-5f;
+  const auto projector = getRandomProjectionModel();
+  for (int repetition = 0; repetition < 1000; ++repetition) {
+    ProjectorBase::CartesianBatch C_points;
+    for (int point_idx = 0; point_idx < ProjectorBase::kBatchSize;
+         ++point_idx) {
+      C_points.col(point_idx) = getRandomPoint<3>();
+    }
+    ProjectorBase::SensorCoordinatesBatch sensor_coordinates_batch;
+    projector.cartesianToSensorBatch(C_points, sensor_coordinates_batch);
+    for (int point_idx = 0; point_idx < ProjectorBase::kBatchSize;
+         ++point_idx) {
+      const auto sensor_coordinates =
+          projector.cartesianToSensor(C_points.col(point_idx));
+      const ImageCoordinates batch_image_coordinates =
+          sensor_coordinates_batch.image.col(point_idx);
+      EXPECT_EIGEN_NEAR(batch_image_coordinates, sensor_coordinates.image,
+                        kNoiseTolerance);
+      EXPECT_NEAR(sensor_coordinates_batch.depth[point_idx],
+                  sensor_coordinates.depth,
+                  kNoiseTolerance * sensor_coordinates.depth);
+    }
+  }
+}
+
 // TODO(victorr): Test boundaries
 }  // namespace wavemap
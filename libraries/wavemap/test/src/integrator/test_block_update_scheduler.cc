@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "wavemap/common.h"
+#include "wavemap/integrator/projection_model/spherical_projector.h"
+#include "wavemap/integrator/projective/coarse_to_fine/block_update_scheduler.h"
+#include "wavemap/test/config_generator.h"
+#include "wavemap/test/fixture_base.h"
+#include "wavemap/test/geometry_generator.h"
+#include "wavemap/utils/iterate/grid_iterator.h"
+
+namespace wavemap {
+class BlockUpdateSchedulerTest : public FixtureBase,
+                                 public GeometryGenerator,
+                                 public ConfigGenerator {
+ protected:
+  std::vector<Index3D> getRandomBlockList() {
+    // Generate a random set of unique blocks around the origin
+    const Index3D max_index = Index3D::Constant(getRandomIndexElement(1, 8));
+    std::vector<Index3D> blocks;
+    for (const Index3D& index : Grid<3>(-max_index, max_index)) {
+      if (getRandomInteger(0, 2) == 0) {
+        blocks.emplace_back(index);
+      }
+    }
+    return blocks;
+  }
+
+  static std::vector<Index3D> sorted(std::vector<Index3D> blocks) {
+    std::sort(blocks.begin(), blocks.end(),
+              [](const auto& lhs, const auto& rhs) {
+                return std::lexicographical_compare(lhs.data(), lhs.data() + 3,
+                                                    rhs.data(), rhs.data() + 3);
+              });
+    return blocks;
+  }
+};
+
+TEST_F(BlockUpdateSchedulerTest, TasksCoverAllBlocks) {
+  constexpr FloatingPoint kMinCellWidth = 0.1f;
+  constexpr IndexElement kTreeHeight = 4;
+  for (int repetition = 0; repetition < 10; ++repetition) {
+    const auto projection_model = std::make_shared<SphericalProjector>(
+        getRandomConfig<SphericalProjectorConfig>());
+    const Transformation3D T_W_C = getRandomTransformation<3>();
+    const std::vector<Index3D> blocks = getRandomBlockList();
+    const size_t num_workers = getRandomInteger(1, 8);
+
+    for (const bool locality_aware : {false, true}) {
+      const BlockUpdateScheduler scheduler(locality_aware, projection_model,
+                                           kMinCellWidth, kTreeHeight,
+                                           num_workers);
+      std::vector<Index3D> scheduled_blocks = blocks;
+      const auto tasks = scheduler.schedule(
+          scheduled_blocks, T_W_C.inverse().getRotationMatrix(),
+          T_W_C.getPosition());
+
+      // The blocks should only be reordered
+      if (locality_aware) {
+        EXPECT_EQ(sorted(scheduled_blocks), sorted(blocks));
+      } else {
+        EXPECT_EQ(scheduled_blocks, blocks);
+        EXPECT_EQ(tasks.size(), blocks.size());
+      }
+
+      // The tasks should be non-empty, consecutive and cover all blocks
+      size_t next_block_idx = 0;
+      for (const auto& [first_block_idx, last_block_idx] : tasks) {
+        EXPECT_EQ(first_block_idx, next_block_idx);
+        EXPECT_LT(first_block_idx, last_block_idx);
+        next_block_idx = last_block_idx;
+      }
+      EXPECT_EQ(next_block_idx, blocks.size());
+
+      // There should be enough tasks to keep all workers busy
+      if (locality_aware) {
+        EXPECT_GE(tasks.size(),
+                  std::min(blocks.size(),
+                           BlockUpdateScheduler::kMinNumTasksPerWorker *
+                               num_workers) /
+                      2);
+      }
+    }
+  }
+}
+}  // namespace wavemap
@@ -228,4 +228,54 @@ TEST_F(HierarchicalRangeImage2DTest, RangeBoundQueries) {
     }
   }
 }
+
+TEST_F(HierarchicalRangeImage2DTest, IncrementalUpdates) {
+  constexpr bool kAzimuthMayWrap = false;
+  constexpr FloatingPoint kPointcloudIntegratorMinRange = 0.5f;
+  ThreadPool thread_pool;
+  auto range_image = std::make_shared<Image<>>(getRandomRangeImage());
+  HierarchicalRangeBounds hierarchical_range_image(
+      range_image, kAzimuthMayWrap, kPointcloudIntegratorMinRange);
+  for (int repetition = 0; repetition < 4; ++repetition) {
+    // Change the range image's content, and occasionally its size
+    if (repetition == 2) {
+      *range_image = getRandomRangeImage();
+    } else {
+      const Image<> new_range_image = getRandomRangeImage();
+      const Index2D max_index = range_image->getDimensions().cwiseMin(
+                                    new_range_image.getDimensions()) -
+                                Index2D::Ones();
+      for (const Index2D& index : Grid<2>(Index2D::Zero(), max_index)) {
+        range_image->at(index) = new_range_image.at(index);
+      }
+    }
+
+    // Update the bounds in place, alternating between serial and parallel
+    // updates, and compare them to bounds that are computed from scratch
+    const bool use_thread_pool = repetition % 2;
+    hierarchical_range_image.update(use_thread_pool ? &thread_pool : nullptr);
+    const HierarchicalRangeBounds reference(range_image, kAzimuthMayWrap,
+                                            kPointcloudIntegratorMinRange);
+    ASSERT_EQ(hierarchical_range_image.getMaxHeight(),
+              reference.getMaxHeight());
+    for (NdtreeIndexElement height = 1; height <= reference.getMaxHeight();
+         ++height) {
+      const Index2D level_dims =
+          int_math::div_exp2_ceil(range_image->getDimensions(), height);
+      for (const Index2D& position :
+           Grid<2>(Index2D::Zero(), level_dims - Index2D::Ones())) {
+        const QuadtreeIndex index{height, position};
+        EXPECT_EQ(hierarchical_range_image.getLowerBound(index),
+                  reference.getLowerBound(index))
+            << "For index " << index.toString();
+        EXPECT_EQ(hierarchical_range_image.getUpperBound(index),
+                  reference.getUpperBound(index))
+            << "For index " << index.toString();
+        EXPECT_EQ(hierarchical_range_image.hasUnobserved(index),
+                  reference.hasUnobserved(index))
+            << "For index " << index.toString();
+      }
+    }
+  }
+}
 }  // namespace wavemap
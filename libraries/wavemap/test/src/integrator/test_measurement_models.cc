@@ -4,6 +4,7 @@
 #include "wavemap/integrator/measurement_model/constant_ray.h"
 #include "wavemap/integrator/measurement_model/continuous_beam.h"
 #include "wavemap/integrator/measurement_model/continuous_ray.h"
+#include "wavemap/integrator/projection_model/ouster_projector.h"
 #include "wavemap/test/fixture_base.h"
 #include "wavemap/utils/iterate/grid_iterator.h"
 #include "wavemap/utils/iterate/ray_iterator.h"
@@ -31,4 +32,126 @@ TEST_F(MeasurementModelTest, DISABLED_ContinuousBeam) {
   for (int i = 0; i < kNumRepetitions; ++i) {
   }
 }
+
+TEST_F(MeasurementModelTest, ContinuousBeamBatch) {
+  OusterProjectorConfig projector_config;
+  projector_config.elevation = {-kQuarterPi / 2.f, kQuarterPi / 2.f, 64};
+  projector_config.azimuth = {-kPi, kPi, 1024};
+  const auto projection_model =
+      std::make_shared<OusterProjector>(projector_config);
+
+  // Create a range image with random ranges and beam offsets
+  const auto range_image =
+      std::make_shared<Image<>>(projection_model->getDimensions());
+  const auto beam_offset_image =
+      std::make_shared<Image<Vector2D>>(projection_model->getDimensions());
+  for (int row_idx = 0; row_idx < projection_model->getNumRows(); ++row_idx) {
+    for (int col_idx = 0; col_idx < projection_model->getNumColumns();
+         ++col_idx) {
+      range_image->at({row_idx, col_idx}) = getRandomFloat(1.f, 10.f);
+      beam_offset_image->at({row_idx, col_idx}) = {
+          getRandomFloat(-0.002f, 0.002f), getRandomFloat(-0.002f, 0.002f)};
+    }
+  }
+  const ContinuousBeam measurement_model(
+      ContinuousBeamConfig{0.0035f, 0.1f, 0.2f, 0.4f}, projection_model,
+      range_image, beam_offset_image);
+
+  // Check that the batched updates match the updates computed one by one
+  constexpr int kNumRepetitions = 1000;
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    ProjectorBase::CartesianBatch C_points;
+    for (int point_idx = 0; point_idx < ProjectorBase::kBatchSize;
+         ++point_idx) {
+      const Index2D index{
+          getRandomInteger(0, projection_model->getNumRows() - 1),
+          getRandomInteger(0, projection_model->getNumColumns() - 1)};
+      const FloatingPoint range =
+          range_image->at(index) + getRandomFloat(-0.5f, 0.5f);
+      C_points.col(point_idx) = projection_model->sensorToCartesian(
+          {projection_model->indexToImage(index), range});
+    }
+    ProjectorBase::SensorCoordinatesBatch sensor_coordinates;
+    projection_model->cartesianToSensorBatch(C_points, sensor_coordinates);
+    MeasurementModelBase::UpdateBatch updates;
+    measurement_model.computeUpdateBatch(sensor_coordinates, updates);
+    for (int point_idx = 0; point_idx < ProjectorBase::kBatchSize;
+         ++point_idx) {
+      const ImageCoordinates image_coordinates =
+          sensor_coordinates.image.col(point_idx);
+      const FloatingPoint expected_update = measurement_model.computeUpdate(
+          {image_coordinates, sensor_coordinates.depth[point_idx]});
+      EXPECT_NEAR(updates[point_idx], expected_update, 1e-5f);
+    }
+  }
+}
+
+TEST_F(MeasurementModelTest, ContinuousBeamTabulatedKernel) {
+  OusterProjectorConfig projector_config;
+  projector_config.elevation = {-kQuarterPi / 2.f, kQuarterPi / 2.f, 64};
+  projector_config.azimuth = {-kPi, kPi, 1024};
+  const auto projection_model =
+      std::make_shared<OusterProjector>(projector_config);
+
+  // Create a range image with random ranges and beam offsets
+  const auto range_image =
+      std::make_shared<Image<>>(projection_model->getDimensions());
+  const auto beam_offset_image =
+      std::make_shared<Image<Vector2D>>(projection_model->getDimensions());
+  for (int row_idx = 0; row_idx < projection_model->getNumRows(); ++row_idx) {
+    for (int col_idx = 0; col_idx < projection_model->getNumColumns();
+         ++col_idx) {
+      range_image->at({row_idx, col_idx}) = getRandomFloat(1.f, 10.f);
+      beam_offset_image->at({row_idx, col_idx}) = {
+          getRandomFloat(-0.002f, 0.002f), getRandomFloat(-0.002f, 0.002f)};
+    }
+  }
+  ContinuousBeamConfig config{0.0035f, 0.1f, 0.2f, 0.4f};
+  const ContinuousBeam reference_model(config, projection_model, range_image,
+                                       beam_offset_image);
+  EXPECT_FALSE(reference_model.usesTabulatedKernel());
+
+  // Check that the approximate updates stay within the configured error bound
+  for (const FloatingPoint max_kernel_error : {1e-1f, 1e-2f, 1e-3f}) {
+    config.max_kernel_error = max_kernel_error;
+    const ContinuousBeam tabulated_model(config, projection_model, range_image,
+                                         beam_offset_image);
+    EXPECT_TRUE(tabulated_model.usesTabulatedKernel());
+
+    // NOTE: The update of each cell is the sum of the updates of its four
+    //       neighboring beams, each of which can be off by max_kernel_error.
+    const FloatingPoint tolerance = 4.f * max_kernel_error + 1e-5f;
+    constexpr int kNumRepetitions = 1000;
+    for (int i = 0; i < kNumRepetitions; ++i) {
+      ProjectorBase::CartesianBatch C_points;
+      for (int point_idx = 0; point_idx < ProjectorBase::kBatchSize;
+           ++point_idx) {
+        const Index2D index{
+            getRandomInteger(0, projection_model->getNumRows() - 1),
+            getRandomInteger(0, projection_model->getNumColumns() - 1)};
+        const FloatingPoint range =
+            range_image->at(index) + getRandomFloat(-0.5f, 0.5f);
+        const ImageCoordinates image_offset{getRandomFloat(-0.01f, 0.01f),
+                                            getRandomFloat(-0.01f, 0.01f)};
+        C_points.col(point_idx) = projection_model->sensorToCartesian(
+            {projection_model->indexToImage(index) + image_offset, range});
+      }
+      ProjectorBase::SensorCoordinatesBatch sensor_coordinates;
+      projection_model->cartesianToSensorBatch(C_points, sensor_coordinates);
+      MeasurementModelBase::UpdateBatch updates;
+      tabulated_model.computeUpdateBatch(sensor_coordinates, updates);
+      for (int point_idx = 0; point_idx < ProjectorBase::kBatchSize;
+           ++point_idx) {
+        const SensorCoordinates point_sensor_coordinates{
+            sensor_coordinates.image.col(point_idx),
+            sensor_coordinates.depth[point_idx]};
+        const FloatingPoint expected_update =
+            reference_model.computeUpdate(point_sensor_coordinates);
+        EXPECT_NEAR(tabulated_model.computeUpdate(point_sensor_coordinates),
+                    expected_update, tolerance);
+        EXPECT_NEAR(updates[point_idx], expected_update, tolerance);
+      }
+    }
+  }
+}
 }  // namespace wavemap
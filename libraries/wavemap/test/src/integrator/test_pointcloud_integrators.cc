@@ -1,9 +1,11 @@
+#include <limits>
 #include <unordered_set>
 
 #include <gtest/gtest.h>
 
 #include "wavemap/common.h"
 #include "wavemap/data_structure/volumetric/hashed_blocks.h"
+#include "wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h"
 #include "wavemap/data_structure/volumetric/hashed_wavelet_octree.h"
 #include "wavemap/data_structure/volumetric/volumetric_data_structure_base.h"
 #include "wavemap/data_structure/volumetric/volumetric_octree.h"
@@ -17,6 +19,7 @@
 #include "wavemap/integrator/projective/coarse_to_fine/hashed_wavelet_integrator.h"
 #include "wavemap/integrator/projective/coarse_to_fine/wavelet_integrator.h"
 #include "wavemap/integrator/projective/fixed_resolution/fixed_resolution_integrator.h"
+#include "wavemap/integrator/projective/pipelined_integrator.h"
 #include "wavemap/integrator/ray_tracing/ray_tracing_integrator.h"
 #include "wavemap/test/config_generator.h"
 #include "wavemap/test/fixture_base.h"
@@ -69,6 +72,12 @@ using IntegratorTypes = ::testing::Types<
     IntegratorDataStructurePair<WaveletIntegrator, WaveletOctree>,
     IntegratorDataStructurePair<HashedWaveletIntegrator, HashedWaveletOctree>,
     IntegratorDataStructurePair<HashedChunkedWaveletIntegrator,
+                                HashedChunkedWaveletOctree>,
+    IntegratorDataStructurePair<
+        SpecializedHashedWaveletIntegrator<SphericalProjector, ContinuousBeam>,
+        HashedWaveletOctree>,
+    IntegratorDataStructurePair<SpecializedHashedChunkedWaveletIntegrator<
+                                    SphericalProjector, ContinuousBeam>,
                                 HashedChunkedWaveletOctree>>;
 TYPED_TEST_SUITE(PointcloudIntegratorTypedTest, IntegratorTypes, );
 
@@ -145,6 +154,144 @@ TYPED_TEST(PointcloudIntegratorTypedTest,
   }
 }
 
+template <typename T>
+using PipelinedIntegratorTypedTest = PointcloudIntegratorTest;
+
+using PipelinedIntegratorTypes = ::testing::Types<
+    IntegratorDataStructurePair<HashedWaveletIntegrator, HashedWaveletOctree>,
+    IntegratorDataStructurePair<HashedChunkedWaveletIntegrator,
+                                HashedChunkedWaveletOctree>>;
+TYPED_TEST_SUITE(PipelinedIntegratorTypedTest, PipelinedIntegratorTypes, );
+
+TYPED_TEST(PipelinedIntegratorTypedTest, EquivalenceToSequentialIntegration) {
+  constexpr int kNumRepetitions = 3;
+  constexpr int kNumPointclouds = 10;
+  for (int idx = 0; idx < kNumRepetitions; ++idx) {
+    const auto projective_integrator_config =
+        ConfigGenerator::getRandomConfig<ProjectiveIntegratorConfig>();
+    const auto data_structure_config = ConfigGenerator::getRandomConfig<
+        typename TypeParam::DataStructureType::Config>();
+    const auto projection_model = std::make_shared<SphericalProjector>(
+        ConfigGenerator::getRandomConfig<SphericalProjectorConfig>());
+    const auto measurement_model_config =
+        ConfigGenerator::getRandomConfig<ContinuousBeamConfig>(
+            *projection_model);
+    auto thread_pool = std::make_shared<ThreadPool>();
+
+    // Create an integrator with its own range and beam offset images
+    auto create_integrator = [&](auto occupancy_map) {
+      auto posed_range_image =
+          std::make_shared<PosedImage<>>(projection_model->getDimensions());
+      auto beam_offset_image =
+          std::make_shared<Image<Vector2D>>(projection_model->getDimensions());
+      auto measurement_model = std::make_shared<ContinuousBeam>(
+          measurement_model_config, projection_model, posed_range_image,
+          beam_offset_image);
+      return std::make_shared<typename TypeParam::IntegratorType>(
+          projective_integrator_config, projection_model, posed_range_image,
+          beam_offset_image, measurement_model, std::move(occupancy_map),
+          thread_pool);
+    };
+
+    auto reference_occupancy_map =
+        std::make_shared<typename TypeParam::DataStructureType>(
+            data_structure_config);
+    auto reference_integrator = create_integrator(reference_occupancy_map);
+
+    const int pipeline_depth = TestFixture::getRandomInteger(2, 4);
+    auto evaluated_occupancy_map =
+        std::make_shared<typename TypeParam::DataStructureType>(
+            data_structure_config);
+    std::vector<ProjectiveIntegrator::Ptr> stages;
+    for (int stage_idx = 0; stage_idx < pipeline_depth; ++stage_idx) {
+      stages.emplace_back(create_integrator(evaluated_occupancy_map));
+    }
+    auto evaluated_integrator =
+        std::make_shared<PipelinedIntegrator>(std::move(stages), thread_pool);
+
+    for (int cloud_idx = 0; cloud_idx < kNumPointclouds; ++cloud_idx) {
+      const PosedPointcloud<> random_pointcloud =
+          TestFixture::getRandomPointcloud(*projection_model);
+      reference_integrator->integratePointcloud(random_pointcloud);
+      evaluated_integrator->integratePointcloud(random_pointcloud);
+    }
+    evaluated_integrator->flush();
+
+    // Since the map updates are applied in order, the maps should be identical
+    EXPECT_EQ(evaluated_occupancy_map->getMemoryUsage(),
+              reference_occupancy_map->getMemoryUsage());
+    reference_occupancy_map->forEachLeaf(
+        [&](const OctreeIndex& node_index, FloatingPoint /*value*/) {
+          const Index3D index = convert::nodeIndexToMinCornerIndex(node_index);
+          EXPECT_EQ(evaluated_occupancy_map->getCellValue(index),
+                    reference_occupancy_map->getCellValue(index))
+              << "For cell index " << print::eigen::oneLine(index);
+        });
+  }
+}
+
+TYPED_TEST(PipelinedIntegratorTypedTest, SharedMapOnSingleThreadPool) {
+  constexpr int kNumRepetitions = 3;
+  constexpr int kNumPointclouds = 10;
+  constexpr int kNumPipelinedIntegrators = 2;
+  for (int idx = 0; idx < kNumRepetitions; ++idx) {
+    const auto projective_integrator_config =
+        ConfigGenerator::getRandomConfig<ProjectiveIntegratorConfig>();
+    const auto data_structure_config = ConfigGenerator::getRandomConfig<
+        typename TypeParam::DataStructureType::Config>();
+    const auto projection_model = std::make_shared<SphericalProjector>(
+        ConfigGenerator::getRandomConfig<SphericalProjectorConfig>());
+    const auto measurement_model_config =
+        ConfigGenerator::getRandomConfig<ContinuousBeamConfig>(
+            *projection_model);
+    // NOTE: With a single worker, the commits of one pipelined integrator run
+    //       nested inside the other's waits on the thread pool.
+    auto thread_pool = std::make_shared<ThreadPool>(1);
+    auto occupancy_map =
+        std::make_shared<typename TypeParam::DataStructureType>(
+            data_structure_config);
+
+    // Create pipelined integrators that all update the same map
+    std::vector<std::shared_ptr<PipelinedIntegrator>> pipelined_integrators;
+    for (int integrator_idx = 0; integrator_idx < kNumPipelinedIntegrators;
+         ++integrator_idx) {
+      std::vector<ProjectiveIntegrator::Ptr> stages;
+      for (int stage_idx = 0; stage_idx < 2; ++stage_idx) {
+        auto posed_range_image =
+            std::make_shared<PosedImage<>>(projection_model->getDimensions());
+        auto beam_offset_image = std::make_shared<Image<Vector2D>>(
+            projection_model->getDimensions());
+        auto measurement_model = std::make_shared<ContinuousBeam>(
+            measurement_model_config, projection_model, posed_range_image,
+            beam_offset_image);
+        stages.emplace_back(
+            std::make_shared<typename TypeParam::IntegratorType>(
+                projective_integrator_config, projection_model,
+                posed_range_image, beam_offset_image, measurement_model,
+                occupancy_map, thread_pool));
+      }
+      pipelined_integrators.emplace_back(std::make_shared<PipelinedIntegrator>(
+          std::move(stages), thread_pool));
+    }
+
+    // Interleave the pointclouds of both integrators
+    for (int cloud_idx = 0; cloud_idx < kNumPointclouds; ++cloud_idx) {
+      for (auto& pipelined_integrator : pipelined_integrators) {
+        pipelined_integrator->integratePointcloud(
+            TestFixture::getRandomPointcloud(*projection_model));
+      }
+    }
+    for (auto& pipelined_integrator : pipelined_integrators) {
+      pipelined_integrator->flush();
+    }
+
+    // NOTE: The order in which the two integrators' commits are applied is
+    //       not deterministic, so we only check that all of them completed
+    //       without deadlocking and updated the map.
+    EXPECT_FALSE(occupancy_map->empty());
+  }
+}
+
 TEST_F(PointcloudIntegratorTest, RayTracingIntegrator) {
   for (int idx = 0; idx < 3; ++idx) {
     const auto ray_tracing_integrator_config =
@@ -207,4 +354,69 @@ TEST_F(PointcloudIntegratorTest, RayTracingIntegrator) {
     }
   }
 }
+
+template <typename T>
+using RayTracingIntegratorTypedTest = PointcloudIntegratorTest;
+
+using RayTracingDataStructureTypes =
+    ::testing::Types<HashedBlocks, HashedWaveletOctree,
+                     HashedChunkedWaveletOctree>;
+TYPED_TEST_SUITE(RayTracingIntegratorTypedTest, RayTracingDataStructureTypes, );
+
+TYPED_TEST(RayTracingIntegratorTypedTest, EquivalenceToSerialIntegration) {
+  constexpr int kNumRepetitions = 3;
+  constexpr int kNumPointclouds = 3;
+  for (int idx = 0; idx < kNumRepetitions; ++idx) {
+    const auto ray_tracing_integrator_config =
+        ConfigGenerator::getRandomConfig<RayTracingIntegratorConfig>();
+    const auto data_structure_config =
+        ConfigGenerator::getRandomConfig<typename TypeParam::Config>();
+    const auto projection_model = SphericalProjector(
+        ConfigGenerator::getRandomConfig<SphericalProjectorConfig>());
+
+    auto reference_occupancy_map =
+        std::make_shared<TypeParam>(data_structure_config);
+    RayTracingIntegrator reference_integrator(ray_tracing_integrator_config,
+                                              reference_occupancy_map);
+
+    auto evaluated_occupancy_map =
+        std::make_shared<TypeParam>(data_structure_config);
+    RayTracingIntegrator evaluated_integrator(
+        ray_tracing_integrator_config, evaluated_occupancy_map,
+        std::make_shared<ThreadPool>());
+
+    const size_t num_points = projection_model.getNumRows() *
+                              projection_model.getNumColumns();
+    for (int cloud_idx = 0; cloud_idx < kNumPointclouds; ++cloud_idx) {
+      const PosedPointcloud<> random_pointcloud =
+          TestFixture::getRandomPointcloud(projection_model);
+      reference_integrator.integratePointcloud(random_pointcloud);
+      evaluated_integrator.integratePointcloud(random_pointcloud);
+    }
+
+    // The maps should be identical, up to floating point rounding differences
+    // caused by applying the wavelet octrees' updates in bulk. Since cells
+    // close to the sensor are updated by every ray, these differences can
+    // accumulate up to the number of rays times the machine epsilon, relative
+    // to the magnitude of the accumulated values.
+    FloatingPoint max_abs_value = 0.f;
+    reference_occupancy_map->forEachLeaf(
+        [&max_abs_value](const OctreeIndex& /*node_index*/,
+                         FloatingPoint value) {
+          max_abs_value = std::max(max_abs_value, std::abs(value));
+        });
+    const FloatingPoint tolerance =
+        static_cast<FloatingPoint>(kNumPointclouds * num_points) *
+        std::numeric_limits<FloatingPoint>::epsilon() * (1.f + max_abs_value);
+    auto compare_maps = [&](const OctreeIndex& node_index,
+                            FloatingPoint /*value*/) {
+      const Index3D index = convert::nodeIndexToMinCornerIndex(node_index);
+      EXPECT_NEAR(evaluated_occupancy_map->getCellValue(index),
+                  reference_occupancy_map->getCellValue(index), tolerance)
+          << "For cell index " << print::eigen::oneLine(index);
+    };
+    reference_occupancy_map->forEachLeaf(compare_maps);
+    evaluated_occupancy_map->forEachLeaf(compare_maps);
+  }
+}
 }  // namespace wavemap
@@ -0,0 +1,99 @@
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "wavemap/common.h"
+#include "wavemap/data_structure/volumetric/hashed_wavelet_octree.h"
+#include "wavemap/test/config_generator.h"
+#include "wavemap/test/fixture_base.h"
+#include "wavemap/test/geometry_generator.h"
+#include "wavemap/utils/query/batched_query_accelerator.h"
+#include "wavemap/utils/thread_pool.h"
+
+namespace wavemap {
+class BatchedQueryAcceleratorTest : public FixtureBase,
+                                    public GeometryGenerator,
+                                    public ConfigGenerator {
+ protected:
+  std::unique_ptr<HashedWaveletOctree> getRandomMap() {
+    const auto config =
+        ConfigGenerator::getRandomConfig<HashedWaveletOctree::Config>();
+    auto map = std::make_unique<HashedWaveletOctree>(config);
+    const std::vector<Index3D> random_indices = getRandomIndexVector<3>(
+        10000u, 20000u, Index3D::Constant(-500), Index3D::Constant(500));
+    for (const Index3D& index : random_indices) {
+      map->addToCellValue(index, getRandomUpdate());
+    }
+    map->prune();
+    return map;
+  }
+};
+
+TEST_F(BatchedQueryAcceleratorTest, Equivalence) {
+  constexpr int kNumRepetitions = 3;
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    const auto map_ptr = getRandomMap();
+    const HashedWaveletOctree& map = *map_ptr;
+    const IndexElement tree_height = map.getTreeHeight();
+
+    // Generate random queries, making sure that the batches span multiple
+    // chunks and include both allocated and unallocated blocks
+    const size_t num_queries = getRandomInteger(
+        1, 3 * static_cast<int>(BatchedQueryAccelerator::kChunkSize));
+    std::vector<Point3D> points(num_queries);
+    std::vector<Index3D> indices(num_queries);
+    std::vector<OctreeIndex> node_indices(num_queries);
+    for (size_t query_idx = 0u; query_idx < num_queries; ++query_idx) {
+      points[query_idx] = getRandomPoint<3>(0.f, 600.f * map.getMinCellWidth());
+      indices[query_idx] = getRandomIndex<3>(Index3D::Constant(-600),
+                                             Index3D::Constant(600));
+      const IndexElement height = getRandomInteger(0, tree_height);
+      node_indices[query_idx] =
+          OctreeIndex{0, indices[query_idx]}.computeParentIndex(height);
+    }
+
+    // Compare the batched results to the regular queries, when evaluating the
+    // batches serially and on a thread pool
+    for (const auto& thread_pool :
+         {std::shared_ptr<ThreadPool>{}, std::make_shared<ThreadPool>(4)}) {
+      BatchedQueryAccelerator batched_query_accelerator(map, thread_pool);
+
+      const auto point_values = batched_query_accelerator.getCellValues(points);
+      ASSERT_EQ(point_values.size(), num_queries);
+      const FloatingPoint cell_width_inv = 1.f / map.getMinCellWidth();
+      for (size_t query_idx = 0u; query_idx < num_queries; ++query_idx) {
+        const Index3D index =
+            convert::pointToNearestIndex(points[query_idx], cell_width_inv);
+        EXPECT_NEAR(point_values[query_idx], map.getCellValue(index),
+                    kEpsilon);
+      }
+
+      const auto index_values =
+          batched_query_accelerator.getCellValues(indices);
+      ASSERT_EQ(index_values.size(), num_queries);
+      for (size_t query_idx = 0u; query_idx < num_queries; ++query_idx) {
+        EXPECT_NEAR(index_values[query_idx],
+                    map.getCellValue(indices[query_idx]), kEpsilon);
+      }
+
+      const auto node_values =
+          batched_query_accelerator.getCellValues(node_indices);
+      ASSERT_EQ(node_values.size(), num_queries);
+      for (size_t query_idx = 0u; query_idx < num_queries; ++query_idx) {
+        EXPECT_NEAR(node_values[query_idx],
+                    map.getCellValue(node_indices[query_idx]), kEpsilon)
+            << "For node_index " << node_indices[query_idx].toString();
+      }
+    }
+  }
+}
+
+TEST_F(BatchedQueryAcceleratorTest, EmptyBatch) {
+  const auto map = getRandomMap();
+  BatchedQueryAccelerator batched_query_accelerator(
+      *map, std::make_shared<ThreadPool>(2));
+  EXPECT_TRUE(
+      batched_query_accelerator.getCellValues(std::vector<Index3D>{}).empty());
+}
+}  // namespace wavemap
@@ -185,6 +185,21 @@ TEST_F(BitManipulationTest, CountLeadingZeros) {
   EXPECT_EQ(bit_ops::clz(static_cast<int64_t>(1) << 62), 1);
 }
 
+TEST_F(BitManipulationTest, CountTrailingZeros) {
+  EXPECT_EQ(bit_ops::ctz(static_cast<uint32_t>(1) << 0), 0);
+  EXPECT_EQ(bit_ops::ctz(static_cast<uint32_t>(1) << 30), 30);
+  EXPECT_EQ(bit_ops::ctz(static_cast<uint32_t>(0b1011) << 31), 31);
+
+  EXPECT_EQ(bit_ops::ctz(static_cast<int32_t>(1) << 0), 0);
+  EXPECT_EQ(bit_ops::ctz(static_cast<int32_t>(0b110) << 20), 21);
+
+  EXPECT_EQ(bit_ops::ctz(static_cast<uint64_t>(1) << 0), 0);
+  EXPECT_EQ(bit_ops::ctz(static_cast<uint64_t>(1) << 62), 62);
+  EXPECT_EQ(bit_ops::ctz(static_cast<uint64_t>(1) << 63), 63);
+
+  EXPECT_EQ(bit_ops::ctz(static_cast<int64_t>(0b1010) << 40), 41);
+}
+
 TEST_F(BitManipulationTest, RepeatBlock) {
   EXPECT_EQ(bit_ops::repeat_block<uint32_t>(2, 0b01),
             0b01010101010101010101010101010101);
@@ -0,0 +1,93 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "wavemap/common.h"
+#include "wavemap/test/fixture_base.h"
+#include "wavemap/utils/compression/detail_coefficient_codec.h"
+
+namespace wavemap {
+class DetailCoefficientCodecTest : public FixtureBase {
+ protected:
+  struct Node {
+    DetailCoefficientEncoder::Details details{};
+    uint8_t allocated_children_bitset{};
+  };
+
+  // Generate nodes whose coefficients are mostly zero, as in thresholded maps
+  std::vector<Node> getRandomNodes(int num_nodes) {
+    std::vector<Node> nodes(num_nodes);
+    for (auto& node : nodes) {
+      for (auto& coefficient : node.details) {
+        if (getRandomInteger(0, 3) == 0) {
+          coefficient = getRandomFloat(-10.f, 10.f);
+        }
+      }
+      if (getRandomInteger(0, 1) == 0) {
+        node.allocated_children_bitset =
+            static_cast<uint8_t>(getRandomInteger(0, 255));
+      }
+    }
+    return nodes;
+  }
+};
+
+TEST_F(DetailCoefficientCodecTest, RoundTrip) {
+  constexpr int kNumRepetitions = 10;
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    const FloatingPoint quantization_step = getRandomFloat(1e-4f, 1e-1f);
+    const auto nodes = getRandomNodes(getRandomInteger(1, 2000));
+
+    // Encode
+    std::vector<uint8_t> data;
+    DetailCoefficientEncoder encoder(quantization_step, data);
+    for (const auto& node : nodes) {
+      encoder.encodeNode(node.details, node.allocated_children_bitset);
+    }
+    encoder.flush();
+
+    // Compressed nodes should take less space than the raw 29 bytes per node
+    EXPECT_LT(data.size(), nodes.size() * 29u);
+
+    // Decode and check that the coefficients are within half a step
+    DetailCoefficientDecoder decoder(quantization_step, data.data(),
+                                     data.data() + data.size());
+    for (const auto& node : nodes) {
+      DetailCoefficientDecoder::Details details;
+      uint8_t allocated_children_bitset;
+      ASSERT_TRUE(decoder.decodeNode(details, allocated_children_bitset));
+      EXPECT_EQ(allocated_children_bitset, node.allocated_children_bitset);
+      for (int coeff_idx = 0; coeff_idx < DetailCoefficientModel::kNumDetails;
+           ++coeff_idx) {
+        EXPECT_NEAR(details[coeff_idx], node.details[coeff_idx],
+                    0.5f * quantization_step + 1e-6f);
+        if (node.details[coeff_idx] == 0.f) {
+          EXPECT_EQ(details[coeff_idx], 0.f);
+        }
+      }
+    }
+  }
+}
+
+TEST_F(DetailCoefficientCodecTest, TruncatedData) {
+  const auto nodes = getRandomNodes(100);
+  std::vector<uint8_t> data;
+  DetailCoefficientEncoder encoder(1e-3f, data);
+  for (const auto& node : nodes) {
+    encoder.encodeNode(node.details, node.allocated_children_bitset);
+  }
+  encoder.flush();
+
+  // Decoding should fail once the decoder runs out of data
+  data.resize(data.size() / 2);
+  DetailCoefficientDecoder decoder(1e-3f, data.data(),
+                                   data.data() + data.size());
+  bool all_decoded = true;
+  for (size_t node_idx = 0; node_idx < nodes.size(); ++node_idx) {
+    DetailCoefficientDecoder::Details details;
+    uint8_t allocated_children_bitset;
+    all_decoded &= decoder.decodeNode(details, allocated_children_bitset);
+  }
+  EXPECT_FALSE(all_decoded);
+}
+}  // namespace wavemap
@@ -0,0 +1,56 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+
+#include "wavemap/common.h"
+#include "wavemap/test/fixture_base.h"
+#include "wavemap/utils/math/lookup_table.h"
+
+namespace wavemap {
+using LookupTableTest = FixtureBase;
+
+TEST_F(LookupTableTest, ErrorBound) {
+  const auto function = [](FloatingPoint x) {
+    return std::sin(x) + 0.1f * x * x;
+  };
+  for (const FloatingPoint max_error : {1e-1f, 1e-2f, 1e-3f, 1e-4f}) {
+    const LookupTable lookup_table(function, -kPi, kTwoPi, max_error);
+    EXPECT_LE(lookup_table.getMaxError(), max_error);
+
+    constexpr int kNumRepetitions = 10000;
+    for (int i = 0; i < kNumRepetitions; ++i) {
+      const FloatingPoint x = getRandomFloat(-kPi, kTwoPi);
+      // NOTE: Since the error is measured at a finite number of points, we
+      //       allow it to be exceeded by a small margin.
+      EXPECT_NEAR(lookup_table(x), function(x), 1.01f * max_error + 1e-6f);
+    }
+  }
+}
+
+TEST_F(LookupTableTest, Resolution) {
+  // Tighter error bounds should never result in coarser tables
+  const auto function = [](FloatingPoint x) { return std::sqrt(x); };
+  int previous_num_intervals = 0;
+  for (const FloatingPoint max_error : {1e-1f, 1e-2f, 1e-3f}) {
+    const LookupTable lookup_table(function, 0.f, 4.f, max_error);
+    EXPECT_GE(lookup_table.getNumIntervals(), previous_num_intervals);
+    previous_num_intervals = lookup_table.getNumIntervals();
+  }
+
+  // Linear functions should be represented exactly by the coarsest table
+  const LookupTable linear_table([](FloatingPoint x) { return 2.f * x + 1.f; },
+                                 -1.f, 1.f, 1e-6f);
+  EXPECT_EQ(linear_table.getNumIntervals(), LookupTable::kMinNumIntervals);
+}
+
+TEST_F(LookupTableTest, Clamping) {
+  const auto function = [](FloatingPoint x) { return x * x; };
+  const LookupTable lookup_table(function, -1.f, 2.f, 1e-3f);
+  EXPECT_FLOAT_EQ(lookup_table(-1.f), 1.f);
+  EXPECT_FLOAT_EQ(lookup_table(2.f), 4.f);
+  EXPECT_FLOAT_EQ(lookup_table(-10.f), 1.f);
+  EXPECT_FLOAT_EQ(lookup_table(10.f), 4.f);
+  EXPECT_NEAR(lookup_table.getMinValue(), 0.f, 1e-3f);
+  EXPECT_FLOAT_EQ(lookup_table.getMaxValue(), 4.f);
+}
+}  // namespace wavemap
@@ -0,0 +1,149 @@
+#include <array>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "wavemap/common.h"
+#include "wavemap/test/fixture_base.h"
+#include "wavemap/utils/memory/object_pool.h"
+
+namespace wavemap {
+class ObjectPoolTest : public FixtureBase {};
+
+namespace {
+// Each test uses its own object type, s.t. they do not share a pool
+template <int tag>
+struct alignas(32) TestObject {
+  static inline int num_alive = 0;
+
+  explicit TestObject(IndexElement value) : value(value) { ++num_alive; }
+  ~TestObject() { --num_alive; }
+
+  IndexElement value;
+  std::array<char, 100> padding{};
+};
+}  // namespace
+
+TEST_F(ObjectPoolTest, ConstructionAndDestruction) {
+  using ObjectType = TestObject<0>;
+  std::vector<PooledUniquePtr<ObjectType>> objects;
+  const int num_objects = getRandomInteger(1, 1000);
+  for (int idx = 0; idx < num_objects; ++idx) {
+    objects.emplace_back(makePooledUnique<ObjectType>(idx));
+  }
+  EXPECT_EQ(ObjectType::num_alive, num_objects);
+
+  std::set<const ObjectType*> unique_addresses;
+  for (int idx = 0; idx < num_objects; ++idx) {
+    const ObjectType* object = objects[idx].get();
+    EXPECT_EQ(object->value, idx);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(object) % alignof(ObjectType),
+              0u);
+    unique_addresses.emplace(object);
+  }
+  EXPECT_EQ(unique_addresses.size(), static_cast<size_t>(num_objects));
+
+  objects.clear();
+  EXPECT_EQ(ObjectType::num_alive, 0);
+  EXPECT_LE(ObjectPool<ObjectType>::getNumSlabs() *
+                ObjectPool<ObjectType>::getNumObjectsPerSlab(),
+            num_objects + ObjectPool<ObjectType>::getNumObjectsPerSlab());
+}
+
+TEST_F(ObjectPoolTest, RecyclesReleasedObjects) {
+  using ObjectType = TestObject<1>;
+  using Pool = ObjectPool<ObjectType>;
+
+  // The most recently released object is reused first
+  ObjectType* first_object = Pool::create(1);
+  Pool::destroy(first_object);
+  ObjectType* second_object = Pool::create(2);
+  EXPECT_EQ(first_object, second_object);
+  EXPECT_EQ(second_object->value, 2);
+  Pool::destroy(second_object);
+
+  // Repeatedly growing and shrinking the pool's usage does not allocate more
+  // memory than required by its peak usage
+  const size_t num_objects = 3 * Pool::getNumObjectsPerSlab();
+  std::vector<ObjectType*> objects;
+  for (int iteration = 0; iteration < 10; ++iteration) {
+    for (size_t idx = 0; idx < num_objects; ++idx) {
+      objects.emplace_back(Pool::create(static_cast<IndexElement>(idx)));
+    }
+    for (ObjectType* object : objects) {
+      Pool::destroy(object);
+    }
+    objects.clear();
+    EXPECT_LE(Pool::getNumSlabs(), 4u);
+  }
+  EXPECT_EQ(ObjectType::num_alive, 0);
+}
+
+TEST_F(ObjectPoolTest, ReleaseOnOtherThreads) {
+  using ObjectType = TestObject<2>;
+  using Pool = ObjectPool<ObjectType>;
+  constexpr int kNumThreads = 4;
+  const size_t num_objects_per_thread = 5 * Pool::getNumObjectsPerSlab();
+
+  // Allocate the objects on the main thread
+  std::vector<std::vector<PooledUniquePtr<ObjectType>>> objects(kNumThreads);
+  for (auto& thread_objects : objects) {
+    for (size_t idx = 0; idx < num_objects_per_thread; ++idx) {
+      thread_objects.emplace_back(
+          makePooledUnique<ObjectType>(static_cast<IndexElement>(idx)));
+    }
+  }
+  const size_t num_slabs = Pool::getNumSlabs();
+
+  // Concurrently release them on other threads, while also allocating and
+  // releasing new objects on those threads
+  std::vector<std::thread> threads;
+  for (auto& thread_objects : objects) {
+    threads.emplace_back([&thread_objects]() {
+      for (size_t idx = 0; idx < thread_objects.size(); ++idx) {
+        EXPECT_EQ(thread_objects[idx]->value, static_cast<IndexElement>(idx));
+        thread_objects[idx].reset();
+        auto temporary_object = makePooledUnique<ObjectType>(-1);
+        EXPECT_EQ(temporary_object->value, -1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(ObjectType::num_alive, 0);
+
+  // Now that the threads exited, their free lists were returned to the shared
+  // pool, which released the slabs that became entirely free
+  EXPECT_LT(Pool::getNumSlabs(), num_slabs);
+}
+
+TEST_F(ObjectPoolTest, ReleasesEmptySlabs) {
+  using ObjectType = TestObject<3>;
+  using Pool = ObjectPool<ObjectType>;
+  constexpr size_t kNumSlabs = 50;
+  std::vector<PooledUniquePtr<ObjectType>> objects;
+  for (size_t idx = 0; idx < kNumSlabs * Pool::getNumObjectsPerSlab(); ++idx) {
+    objects.emplace_back(makePooledUnique<ObjectType>(0));
+  }
+  EXPECT_GE(Pool::getNumSlabs(), kNumSlabs);
+
+  // Once the objects are released, only the slabs holding the objects that
+  // are still cached by this thread or awaiting reuse are retained
+  objects.clear();
+  EXPECT_EQ(ObjectType::num_alive, 0);
+  EXPECT_LE(Pool::getNumSlabs(), 10u);
+
+  // The pool keeps working after releasing its slabs
+  for (size_t idx = 0; idx < kNumSlabs * Pool::getNumObjectsPerSlab(); ++idx) {
+    objects.emplace_back(
+        makePooledUnique<ObjectType>(static_cast<IndexElement>(idx)));
+  }
+  for (size_t idx = 0; idx < objects.size(); ++idx) {
+    EXPECT_EQ(objects[idx]->value, static_cast<IndexElement>(idx));
+  }
+}
+}  // namespace wavemap
@@ -1,8 +1,14 @@
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <future>
+#include <memory>
 #include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "wavemap/utils/inplace_task.h"
 #include "wavemap/utils/thread_pool.h"
 
 TEST(ThreadPoolTest, WaitAll) {
@@ -18,3 +24,227 @@ TEST(ThreadPoolTest, WaitAll) {
 
   pool.wait_all();
 }
+
+TEST(ThreadPoolTest, Futures) {
+  wavemap::ThreadPool pool(2);
+  std::vector<std::future<int>> futures;
+  for (int task_idx = 0; task_idx < 100; ++task_idx) {
+    futures.emplace_back(
+        pool.add_task([](int a, int b) { return a * b; }, task_idx, 2));
+  }
+  for (int task_idx = 0; task_idx < 100; ++task_idx) {
+    EXPECT_EQ(futures[task_idx].get(), 2 * task_idx);
+  }
+}
+
+TEST(ThreadPoolTest, DetachedTasks) {
+  constexpr int kNumTasks = 10000;
+  for (const size_t num_threads : {1u, 2u, 4u}) {
+    wavemap::ThreadPool pool(num_threads);
+    std::vector<int> results(kNumTasks, 0);
+    std::atomic<int> num_executed_tasks = 0;
+    for (int task_idx = 0; task_idx < kNumTasks; ++task_idx) {
+      pool.add_detached_task([&results, &num_executed_tasks, task_idx]() {
+        results[task_idx] = task_idx;
+        ++num_executed_tasks;
+      });
+    }
+    pool.wait_all();
+    EXPECT_EQ(num_executed_tasks, kNumTasks);
+    for (int task_idx = 0; task_idx < kNumTasks; ++task_idx) {
+      EXPECT_EQ(results[task_idx], task_idx);
+    }
+  }
+}
+
+TEST(ThreadPoolTest, NestedTasks) {
+  // Tasks spawned from within a worker go to its own deque, from which the
+  // other workers then have to steal
+  constexpr int kNumOuterTasks = 8;
+  constexpr int kNumInnerTasks = 500;
+  wavemap::ThreadPool pool(4);
+  std::atomic<int> num_executed_tasks = 0;
+  for (int outer_idx = 0; outer_idx < kNumOuterTasks; ++outer_idx) {
+    pool.add_detached_task([&pool, &num_executed_tasks]() {
+      for (int inner_idx = 0; inner_idx < kNumInnerTasks; ++inner_idx) {
+        pool.add_detached_task([&num_executed_tasks]() {
+          std::this_thread::yield();
+          ++num_executed_tasks;
+        });
+      }
+      ++num_executed_tasks;
+    });
+  }
+  pool.wait_all();
+  EXPECT_EQ(num_executed_tasks, kNumOuterTasks * (kNumInnerTasks + 1));
+}
+
+TEST(ThreadPoolTest, WorkerThreadDetection) {
+  wavemap::ThreadPool pool(2);
+  wavemap::ThreadPool other_pool(1);
+  EXPECT_FALSE(pool.is_worker_thread());
+  EXPECT_TRUE(pool.add_task([&pool]() { return pool.is_worker_thread(); })
+                  .get());
+  EXPECT_FALSE(other_pool
+                   .add_task([&pool]() { return pool.is_worker_thread(); })
+                   .get());
+}
+
+TEST(ThreadPoolTest, WaitForIgnoresUnrelatedTasks) {
+  wavemap::ThreadPool pool(2);
+  std::promise<void> release_unrelated_task;
+  std::shared_future<void> unrelated_task_released =
+      release_unrelated_task.get_future().share();
+  auto unrelated_task = pool.add_task(
+      [unrelated_task_released]() { unrelated_task_released.wait(); });
+  std::vector<std::future<int>> futures;
+  for (int task_idx = 0; task_idx < 10; ++task_idx) {
+    futures.emplace_back(pool.add_task([task_idx]() { return task_idx; }));
+  }
+  pool.wait_for(futures);
+  for (int task_idx = 0; task_idx < 10; ++task_idx) {
+    EXPECT_EQ(futures[task_idx].get(), task_idx);
+  }
+  EXPECT_NE(unrelated_task.wait_for(std::chrono::seconds(0)),
+            std::future_status::ready);
+  release_unrelated_task.set_value();
+  pool.wait_for(unrelated_task);
+}
+
+TEST(ThreadPoolTest, WaitForFromWorkers) {
+  // Workers that wait on the tasks they spawned run queued tasks instead of
+  // blocking, which would deadlock a pool whose workers are all waiting
+  constexpr int kNumOuterTasks = 4;
+  constexpr int kNumInnerTasks = 100;
+  for (const size_t num_threads : {1u, 2u}) {
+    wavemap::ThreadPool pool(num_threads);
+    std::vector<std::future<int>> outer_futures;
+    for (int outer_idx = 0; outer_idx < kNumOuterTasks; ++outer_idx) {
+      outer_futures.emplace_back(pool.add_task([&pool]() {
+        std::vector<std::future<int>> inner_futures;
+        for (int inner_idx = 0; inner_idx < kNumInnerTasks; ++inner_idx) {
+          inner_futures.emplace_back(pool.add_task([]() { return 1; }));
+        }
+        pool.wait_for(inner_futures);
+        int sum = 0;
+        for (auto& inner_future : inner_futures) {
+          sum += inner_future.get();
+        }
+        return sum;
+      }));
+    }
+    pool.wait_for(outer_futures);
+    for (auto& outer_future : outer_futures) {
+      EXPECT_EQ(outer_future.get(), kNumInnerTasks);
+    }
+  }
+}
+
+TEST(ThreadPoolTest, WaitForTaskGroupIgnoresUnrelatedTasks) {
+  wavemap::ThreadPool pool(2);
+  std::promise<void> release_unrelated_task;
+  std::shared_future<void> unrelated_task_released =
+      release_unrelated_task.get_future().share();
+  auto unrelated_task = pool.add_task(
+      [unrelated_task_released]() { unrelated_task_released.wait(); });
+  constexpr int kNumTasks = 10;
+  std::atomic<int> num_executed_tasks = 0;
+  wavemap::ThreadPool::TaskGroup tasks;
+  for (int task_idx = 0; task_idx < kNumTasks; ++task_idx) {
+    pool.add_detached_task(tasks,
+                           [&num_executed_tasks]() { ++num_executed_tasks; });
+  }
+  pool.wait_for(tasks);
+  EXPECT_TRUE(tasks.is_done());
+  EXPECT_EQ(num_executed_tasks, kNumTasks);
+  EXPECT_NE(unrelated_task.wait_for(std::chrono::seconds(0)),
+            std::future_status::ready);
+  release_unrelated_task.set_value();
+  pool.wait_for(unrelated_task);
+}
+
+TEST(ThreadPoolTest, WaitForTaskGroupFromWorkers) {
+  // Same as WaitForFromWorkers, but for detached tasks grouped in TaskGroups
+  constexpr int kNumOuterTasks = 4;
+  constexpr int kNumInnerTasks = 100;
+  for (const size_t num_threads : {1u, 2u}) {
+    wavemap::ThreadPool pool(num_threads);
+    std::array<std::atomic<int>, kNumOuterTasks> counts{};
+    wavemap::ThreadPool::TaskGroup outer_tasks;
+    for (int outer_idx = 0; outer_idx < kNumOuterTasks; ++outer_idx) {
+      pool.add_detached_task(outer_tasks, [&pool, &counts, outer_idx]() {
+        wavemap::ThreadPool::TaskGroup inner_tasks;
+        for (int inner_idx = 0; inner_idx < kNumInnerTasks; ++inner_idx) {
+          pool.add_detached_task(
+              inner_tasks, [&counts, outer_idx]() { ++counts[outer_idx]; });
+        }
+        pool.wait_for(inner_tasks);
+        EXPECT_TRUE(counts[outer_idx] == kNumInnerTasks);
+      });
+    }
+    pool.wait_for(outer_tasks);
+    for (const auto& count : counts) {
+      EXPECT_EQ(count, kNumInnerTasks);
+    }
+  }
+}
+
+TEST(ThreadPoolTest, DestructorCompletesQueuedTasks) {
+  constexpr int kNumTasks = 100;
+  std::atomic<int> num_executed_tasks = 0;
+  {
+    wavemap::ThreadPool pool(2);
+    for (int task_idx = 0; task_idx < kNumTasks; ++task_idx) {
+      pool.add_detached_task([&num_executed_tasks]() { ++num_executed_tasks; });
+    }
+  }
+  EXPECT_EQ(num_executed_tasks, kNumTasks);
+}
+
+TEST(InplaceTaskTest, StorageAndOwnership) {
+  using wavemap::InplaceTask;
+
+  // Small callables are stored inline, large ones on the heap
+  struct SmallCallable {
+    int* counter;
+    void operator()() const { ++*counter; }
+  };
+  struct LargeCallable {
+    std::array<char, 2 * InplaceTask::kInlineStorageSize> padding{};
+    int* counter;
+    void operator()() const { ++*counter; }
+  };
+  EXPECT_TRUE(InplaceTask::isStoredInline<SmallCallable>());
+  EXPECT_FALSE(InplaceTask::isStoredInline<LargeCallable>());
+
+  int counter = 0;
+  InplaceTask small_task{SmallCallable{&counter}};
+  LargeCallable large_callable;
+  large_callable.counter = &counter;
+  InplaceTask large_task{large_callable};
+  small_task();
+  large_task();
+  EXPECT_EQ(counter, 2);
+
+  // Moving transfers ownership
+  InplaceTask moved_task = std::move(large_task);
+  EXPECT_FALSE(large_task);  // NOLINT
+  ASSERT_TRUE(moved_task);
+  moved_task();
+  EXPECT_EQ(counter, 3);
+  moved_task = std::move(small_task);
+  EXPECT_FALSE(small_task);  // NOLINT
+  moved_task();
+  EXPECT_EQ(counter, 4);
+
+  // Captured resources are released exactly once
+  auto resource = std::make_shared<int>(0);
+  {
+    InplaceTask task{[resource]() { ++*resource; }};
+    InplaceTask other_task{std::move(task)};
+    EXPECT_EQ(resource.use_count(), 2);
+    other_task();
+  }
+  EXPECT_EQ(*resource, 1);
+  EXPECT_EQ(resource.use_count(), 1);
+}
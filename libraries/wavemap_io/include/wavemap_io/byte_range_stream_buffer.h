@@ -0,0 +1,24 @@
+#ifndef WAVEMAP_IO_BYTE_RANGE_STREAM_BUFFER_H_
+#define WAVEMAP_IO_BYTE_RANGE_STREAM_BUFFER_H_
+
+#include <streambuf>
+
+namespace wavemap::io {
+// Read-only stream buffer over bytes that are already in memory, used to
+// deserialize data straight from the buffer or file mapping that holds it
+class ByteRangeStreamBuffer : public std::streambuf {
+ public:
+  ByteRangeStreamBuffer(const char* begin, const char* end) {
+    // NOTE: The get area is only ever read from, s.t. casting away the
+    //       constness is safe.
+    char* mutable_begin = const_cast<char*>(begin);
+    char* mutable_end = const_cast<char*>(end);
+    setg(mutable_begin, mutable_begin, mutable_end);
+  }
+
+  // Pointer to the next byte that will be read
+  const char* position() const { return gptr(); }
+};
+}  // namespace wavemap::io
+
+#endif  // WAVEMAP_IO_BYTE_RANGE_STREAM_BUFFER_H_
@@ -4,14 +4,20 @@
 #include <filesystem>
 
 #include <wavemap/data_structure/volumetric/volumetric_data_structure_base.h>
+#include <wavemap/utils/thread_pool.h>
 
 #include "wavemap_io/stream_conversions.h"
 
 namespace wavemap::io {
 bool mapToFile(const VolumetricDataStructureBase& map,
                const std::filesystem::path& file_path);
+bool mapToFile(const VolumetricDataStructureBase& map,
+               const std::filesystem::path& file_path,
+               ThreadPool& thread_pool);
 bool fileToMap(const std::filesystem::path& file_path,
                VolumetricDataStructureBase::Ptr& map);
+bool fileToMap(const std::filesystem::path& file_path,
+               VolumetricDataStructureBase::Ptr& map, ThreadPool& thread_pool);
 }  // namespace wavemap::io
 
 #endif  // WAVEMAP_IO_FILE_CONVERSIONS_H_
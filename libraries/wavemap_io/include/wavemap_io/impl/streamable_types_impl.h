@@ -108,6 +108,40 @@ HashedWaveletOctreeHeader HashedWaveletOctreeHeader::read(
   return instance;
 }
 
+void HashedWaveletOctreeCompressionHeader::write(std::ostream& ostream) const {
+  ostream.write(reinterpret_cast<const char*>(&quantization_step),
+                sizeof(quantization_step));
+}
+
+HashedWaveletOctreeCompressionHeader
+HashedWaveletOctreeCompressionHeader::read(std::istream& istream) {
+  HashedWaveletOctreeCompressionHeader instance;
+  istream.read(reinterpret_cast<char*>(&instance.quantization_step),
+               sizeof(quantization_step));
+  return instance;
+}
+
+void HashedWaveletOctreeBlockTable::write(std::ostream& ostream) const {
+  for (const Index3D& block_index : block_indices) {
+    block_index.write(ostream);
+  }
+  ostream.write(reinterpret_cast<const char*>(block_offsets.data()),
+                block_offsets.size() * sizeof(UInt64));
+}
+
+HashedWaveletOctreeBlockTable HashedWaveletOctreeBlockTable::read(
+    std::istream& istream, UInt64 num_blocks) {
+  HashedWaveletOctreeBlockTable instance;
+  instance.block_indices.reserve(num_blocks);
+  for (UInt64 block_idx = 0; block_idx < num_blocks && istream; ++block_idx) {
+    instance.block_indices.emplace_back(Index3D::read(istream));
+  }
+  instance.block_offsets.resize(num_blocks + 1);
+  istream.read(reinterpret_cast<char*>(instance.block_offsets.data()),
+               instance.block_offsets.size() * sizeof(UInt64));
+  return instance;
+}
+
 void StorageFormat::write(std::ostream& ostream) const {
   ostream.write(reinterpret_cast<const char*>(&id_), sizeof(id_));
 }
@@ -0,0 +1,128 @@
+#ifndef WAVEMAP_IO_MAPPED_HASHED_WAVELET_OCTREE_H_
+#define WAVEMAP_IO_MAPPED_HASHED_WAVELET_OCTREE_H_
+
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <wavemap/common.h>
+#include <wavemap/config/config_base.h>
+#include <wavemap/data_structure/volumetric/hashed_wavelet_octree.h>
+#include <wavemap/indexing/index_hashes.h>
+
+namespace wavemap::io {
+/**
+ * Config struct for memory mapped hashed wavelet octrees.
+ */
+struct MappedHashedWaveletOctreeConfig
+    : ConfigBase<MappedHashedWaveletOctreeConfig, 1> {
+  //! Maximum number of decoded blocks that are kept in memory. Once it is
+  //! exceeded, the least recently accessed blocks are evicted.
+  int max_num_resident_blocks = 4096;
+
+  static MemberMap memberMap;
+
+  // Constructors
+  MappedHashedWaveletOctreeConfig() = default;
+  explicit MappedHashedWaveletOctreeConfig(int max_num_resident_blocks)
+      : max_num_resident_blocks(max_num_resident_blocks) {}
+
+  bool isValid(bool verbose) const override;
+};
+
+/**
+ * \brief Read-only hashed wavelet octree, backed by a memory mapped map file.
+ *
+ * Opening a map only parses the file's header and block table, such that the
+ * map can be queried right away. Each block is decoded the first time it is
+ * accessed and kept in a cache of recently accessed blocks, whose size is
+ * bounded by the config's max_num_resident_blocks. The decoded blocks are
+ * returned as shared pointers, such that they remain valid while in use even
+ * if they get evicted from the cache. Queries can be issued concurrently from
+ * multiple threads.
+ *
+ * \note Only files that were saved in the block table format, by passing a
+ *       thread pool to io::mapToFile, can be memory mapped. Both hashed
+ *       wavelet octrees and hashed chunked wavelet octrees can be stored in
+ *       this format.
+ */
+class MappedHashedWaveletOctree {
+ public:
+  using Ptr = std::shared_ptr<MappedHashedWaveletOctree>;
+  using ConstPtr = std::shared_ptr<const MappedHashedWaveletOctree>;
+  using Config = MappedHashedWaveletOctreeConfig;
+  using Block = HashedWaveletOctreeBlock;
+  using BlockIndex = Block::BlockIndex;
+  using CellIndex = OctreeIndex;
+
+  // Memory map the map stored in the given file
+  // NOTE: Returns nullptr if the file could not be opened or is not stored in
+  //       the block table format.
+  static Ptr open(const std::filesystem::path& file_path,
+                  const Config& config = {});
+  ~MappedHashedWaveletOctree();
+
+  // Prevent copying, as the object owns the mapping
+  MappedHashedWaveletOctree(const MappedHashedWaveletOctree&) = delete;
+  MappedHashedWaveletOctree& operator=(const MappedHashedWaveletOctree&) =
+      delete;
+
+  FloatingPoint getMinCellWidth() const { return map_config_.min_cell_width; }
+  FloatingPoint getMinLogOdds() const { return map_config_.min_log_odds; }
+  FloatingPoint getMaxLogOdds() const { return map_config_.max_log_odds; }
+  IndexElement getTreeHeight() const { return map_config_.tree_height; }
+  size_t getNumBlocks() const { return block_entries_.size(); }
+  size_t getNumResidentBlocks() const;
+
+  bool hasBlock(const BlockIndex& block_index) const {
+    return block_entries_.count(block_index);
+  }
+  // Get the block, decoding it if it is not yet resident
+  // NOTE: Returns nullptr if the map contains no block at the given index, or
+  //       if the block's data is corrupted.
+  std::shared_ptr<const Block> getBlock(const BlockIndex& block_index) const;
+
+  FloatingPoint getCellValue(const Index3D& index) const {
+    return getCellValue(OctreeIndex{0, index});
+  }
+  FloatingPoint getCellValue(const OctreeIndex& index) const;
+
+ private:
+  struct BlockEntry {
+    size_t offset;
+    size_t size;
+  };
+  struct ResidentBlock {
+    std::shared_ptr<const Block> block;
+    std::list<BlockIndex>::iterator lru_position;
+  };
+
+  MappedHashedWaveletOctree(const Config& config, const char* mapping,
+                            size_t mapping_size)
+      : config_(config.checkValid()),
+        mapping_(mapping),
+        mapping_size_(mapping_size) {}
+
+  const Config config_;
+  const char* const mapping_;
+  const size_t mapping_size_;
+
+  HashedWaveletOctreeConfig map_config_;
+  const char* block_data_ = nullptr;
+  std::unordered_map<BlockIndex, BlockEntry, IndexHash<3>> block_entries_;
+
+  mutable std::mutex resident_blocks_mutex_;
+  mutable std::list<BlockIndex> lru_list_;
+  mutable std::unordered_map<BlockIndex, ResidentBlock, IndexHash<3>>
+      resident_blocks_;
+
+  // Parse the file's header and block table
+  bool parseFileIndex();
+  // Decode a block, returns nullptr if its data is corrupted
+  std::shared_ptr<const Block> decodeBlock(const BlockEntry& entry) const;
+};
+}  // namespace wavemap::io
+
+#endif  // WAVEMAP_IO_MAPPED_HASHED_WAVELET_OCTREE_H_
@@ -3,26 +3,106 @@
 
 #include <istream>
 #include <ostream>
+#include <vector>
 
 #include <wavemap/common.h>
 #include <wavemap/data_structure/volumetric/cell_types/haar_coefficients.h>
 #include <wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h>
 #include <wavemap/data_structure/volumetric/hashed_wavelet_octree.h>
 #include <wavemap/data_structure/volumetric/wavelet_octree.h>
+#include <wavemap/utils/thread_pool.h>
 
 #include "wavemap_io/streamable_types.h"
 
 namespace wavemap::io {
+// NOTE: The overloads that take a thread pool store hashed maps in the block
+//       table format. This format starts with a table of offsets to each
+//       block's data, s.t. the blocks can be serialized and deserialized in
+//       parallel. All formats can be read by all streamToMap overloads.
+// NOTE: The overloads that take a quantization step store hashed maps in the
+//       compressed format. This format also uses a block table, but quantizes
+//       each detail coefficient to a multiple of quantization_step and entropy
+//       codes the nodes. This introduces an error of at most half a step per
+//       coefficient, but typically shrinks the map several times.
+//       Other map types are stored without compression.
+// NOTE: Hashed wavelet octrees and hashed chunked wavelet octrees are stored in
+//       the same format. When deserializing into a VolumetricDataStructureBase
+//       pointer, the map is loaded as a hashed chunked wavelet octree if the
+//       pointer already holds one, and as a hashed wavelet octree otherwise.
 bool mapToStream(const VolumetricDataStructureBase& map, std::ostream& ostream);
+bool mapToStream(const VolumetricDataStructureBase& map, std::ostream& ostream,
+                 ThreadPool& thread_pool);
+bool mapToStream(const VolumetricDataStructureBase& map, std::ostream& ostream,
+                 FloatingPoint quantization_step);
+bool mapToStream(const VolumetricDataStructureBase& map, std::ostream& ostream,
+                 FloatingPoint quantization_step, ThreadPool& thread_pool);
 bool streamToMap(std::istream& istream, VolumetricDataStructureBase::Ptr& map);
+bool streamToMap(std::istream& istream, VolumetricDataStructureBase::Ptr& map,
+                 ThreadPool& thread_pool);
 
 void mapToStream(const WaveletOctree& map, std::ostream& ostream);
 bool streamToMap(std::istream& istream, WaveletOctree::Ptr& map);
 
 void mapToStream(const HashedWaveletOctree& map, std::ostream& ostream);
+void mapToStream(const HashedWaveletOctree& map, std::ostream& ostream,
+                 ThreadPool& thread_pool);
+void mapToStream(const HashedWaveletOctree& map, std::ostream& ostream,
+                 FloatingPoint quantization_step);
+void mapToStream(const HashedWaveletOctree& map, std::ostream& ostream,
+                 FloatingPoint quantization_step, ThreadPool& thread_pool);
 bool streamToMap(std::istream& istream, HashedWaveletOctree::Ptr& map);
+bool streamToMap(std::istream& istream, HashedWaveletOctree::Ptr& map,
+                 ThreadPool& thread_pool);
 
 void mapToStream(const HashedChunkedWaveletOctree& map, std::ostream& ostream);
+void mapToStream(const HashedChunkedWaveletOctree& map, std::ostream& ostream,
+                 ThreadPool& thread_pool);
+void mapToStream(const HashedChunkedWaveletOctree& map, std::ostream& ostream,
+                 FloatingPoint quantization_step);
+void mapToStream(const HashedChunkedWaveletOctree& map, std::ostream& ostream,
+                 FloatingPoint quantization_step, ThreadPool& thread_pool);
+
+bool streamToMap(std::istream& istream, HashedChunkedWaveletOctree::Ptr& map);
+bool streamToMap(std::istream& istream, HashedChunkedWaveletOctree::Ptr& map,
+                 ThreadPool& thread_pool);
+
+// Serialize a single block of a hashed map into the layout used for each block
+// in the block table formats, i.e. its header followed by all its nodes
+void blockToBytes(const HashedWaveletOctree& map, const Index3D& block_index,
+                  const HashedWaveletOctreeBlock& block,
+                  std::vector<uint8_t>& bytes);
+void blockToBytes(const HashedChunkedWaveletOctree& map,
+                  const Index3D& block_index,
+                  const HashedChunkedWaveletOctreeBlock& block,
+                  std::vector<uint8_t>& bytes);
+// Same as above, for blocks stored in the compressed format
+void blockToBytes(const HashedWaveletOctree& map, const Index3D& block_index,
+                  const HashedWaveletOctreeBlock& block,
+                  FloatingPoint quantization_step,
+                  std::vector<uint8_t>& bytes);
+void blockToBytes(const HashedChunkedWaveletOctree& map,
+                  const Index3D& block_index,
+                  const HashedChunkedWaveletOctreeBlock& block,
+                  FloatingPoint quantization_step,
+                  std::vector<uint8_t>& bytes);
+
+// Read the index of a block serialized with blockToBytes from its header
+bool bytesToBlockIndex(const char* data_begin, const char* data_end,
+                       Index3D& block_index);
+
+// Deserialize a single block of a hashed map stored in the block table format,
+// given the range of bytes that holds its header and all its nodes
+bool bytesToBlock(const char* data_begin, const char* data_end,
+                  HashedWaveletOctreeBlock& block);
+bool bytesToBlock(const char* data_begin, const char* data_end,
+                  HashedChunkedWaveletOctreeBlock& block);
+// Same as above, for blocks stored in the compressed format
+bool bytesToBlock(const char* data_begin, const char* data_end,
+                  FloatingPoint quantization_step,
+                  HashedWaveletOctreeBlock& block);
+bool bytesToBlock(const char* data_begin, const char* data_end,
+                  FloatingPoint quantization_step,
+                  HashedChunkedWaveletOctreeBlock& block);
 }  // namespace wavemap::io
 
 #endif  // WAVEMAP_IO_STREAM_CONVERSIONS_H_
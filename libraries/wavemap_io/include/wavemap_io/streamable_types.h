@@ -3,6 +3,7 @@
 
 #include <istream>
 #include <ostream>
+#include <vector>
 
 namespace wavemap::io::streamable {
 // NOTE: This file defines the serialization format for all types that might be
@@ -65,16 +66,41 @@ struct HashedWaveletOctreeHeader {
   inline static HashedWaveletOctreeHeader read(std::istream& istream);
 };
 
+struct HashedWaveletOctreeCompressionHeader {
+  // Step to which the detail coefficients were quantized
+  Float quantization_step{};
+
+  inline void write(std::ostream& ostream) const;
+  inline static HashedWaveletOctreeCompressionHeader read(
+      std::istream& istream);
+};
+
+struct HashedWaveletOctreeBlockTable {
+  // Index of each block
+  std::vector<Index3D> block_indices{};
+  // Offset of each block's data, relative to the end of the table, followed by
+  // the offset at which the data of the last block ends
+  std::vector<UInt64> block_offsets{};
+
+  inline void write(std::ostream& ostream) const;
+  inline static HashedWaveletOctreeBlockTable read(std::istream& istream,
+                                                   UInt64 num_blocks);
+};
+
 struct StorageFormat : TypeSelector<StorageFormat> {
   using TypeSelector<StorageFormat>::TypeSelector;
 
   enum Id : TypeId {
     kWaveletOctree,
     kHashedWaveletOctree,
+    kHashedWaveletOctreeWithBlockTable,
+    kHashedWaveletOctreeCompressed,
   };
 
-  static constexpr std::array names = {"wavelet_octree",
-                                       "hashed_wavelet_octree"};
+  static constexpr std::array names = {
+      "wavelet_octree", "hashed_wavelet_octree",
+      "hashed_wavelet_octree_with_block_table",
+      "hashed_wavelet_octree_compressed"};
 
   inline void write(std::ostream& ostream) const;
   inline static StorageFormat read(std::istream& istream);
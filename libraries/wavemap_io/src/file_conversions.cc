@@ -3,8 +3,10 @@
 #include <fstream>
 
 namespace wavemap::io {
-bool mapToFile(const VolumetricDataStructureBase& map,
-               const std::filesystem::path& file_path) {
+namespace {
+bool mapToFileImpl(const VolumetricDataStructureBase& map,
+                   const std::filesystem::path& file_path,
+                   ThreadPool* thread_pool) {
   if (file_path.empty()) {
     LOG(WARNING)
         << "Could open file for writing. Specified file path is empty.";
@@ -21,7 +23,10 @@ bool mapToFile(const VolumetricDataStructureBase& map,
   }
 
   // Serialize to bytestream
-  if (!mapToStream(map, file_ostream)) {
+  const bool success = thread_pool
+                           ? mapToStream(map, file_ostream, *thread_pool)
+                           : mapToStream(map, file_ostream);
+  if (!success) {
     return false;
   }
 
@@ -30,8 +35,9 @@ bool mapToFile(const VolumetricDataStructureBase& map,
   return static_cast<bool>(file_ostream);
 }
 
-bool fileToMap(const std::filesystem::path& file_path,
-               VolumetricDataStructureBase::Ptr& map) {
+bool fileToMapImpl(const std::filesystem::path& file_path,
+                   VolumetricDataStructureBase::Ptr& map,
+                   ThreadPool* thread_pool) {
   if (file_path.empty()) {
     LOG(WARNING)
         << "Could not open file for reading. Specified file path is empty.";
@@ -48,11 +54,36 @@ bool fileToMap(const std::filesystem::path& file_path,
   }
 
   // Deserialize from bytestream
-  if (!streamToMap(file_istream, map)) {
+  const bool success = thread_pool
+                           ? streamToMap(file_istream, map, *thread_pool)
+                           : streamToMap(file_istream, map);
+  if (!success) {
     LOG(WARNING) << "Failed to parse map from file " << file_path << ".";
     return false;
   }
 
   return true;
 }
+}  // namespace
+
+bool mapToFile(const VolumetricDataStructureBase& map,
+               const std::filesystem::path& file_path) {
+  return mapToFileImpl(map, file_path, nullptr);
+}
+
+bool mapToFile(const VolumetricDataStructureBase& map,
+               const std::filesystem::path& file_path,
+               ThreadPool& thread_pool) {
+  return mapToFileImpl(map, file_path, &thread_pool);
+}
+
+bool fileToMap(const std::filesystem::path& file_path,
+               VolumetricDataStructureBase::Ptr& map) {
+  return fileToMapImpl(file_path, map, nullptr);
+}
+
+bool fileToMap(const std::filesystem::path& file_path,
+               VolumetricDataStructureBase::Ptr& map, ThreadPool& thread_pool) {
+  return fileToMapImpl(file_path, map, &thread_pool);
+}
 }  // namespace wavemap::io
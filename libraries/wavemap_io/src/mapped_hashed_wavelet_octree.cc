@@ -0,0 +1,228 @@
+#include "wavemap_io/mapped_hashed_wavelet_octree.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <istream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "wavemap_io/byte_range_stream_buffer.h"
+#include "wavemap_io/stream_conversions.h"
+#include "wavemap_io/streamable_types.h"
+
+namespace wavemap::io {
+DECLARE_CONFIG_MEMBERS(MappedHashedWaveletOctreeConfig,
+                      (max_num_resident_blocks));
+
+bool MappedHashedWaveletOctreeConfig::isValid(bool verbose) const {
+  bool is_valid = true;
+
+  is_valid &= IS_PARAM_GT(max_num_resident_blocks, 0, verbose);
+
+  return is_valid;
+}
+
+MappedHashedWaveletOctree::Ptr MappedHashedWaveletOctree::open(
+    const std::filesystem::path& file_path, const Config& config) {
+  if (!config.isValid(true)) {
+    return nullptr;
+  }
+
+  // Open the file and map it into memory
+  const int file_descriptor = ::open(file_path.c_str(), O_RDONLY);
+  if (file_descriptor < 0) {
+    LOG(WARNING) << "Could not open file " << file_path
+                 << " for reading. Error: " << strerror(errno);
+    return nullptr;
+  }
+  struct stat file_status {};
+  if (fstat(file_descriptor, &file_status) != 0 || file_status.st_size <= 0) {
+    LOG(WARNING) << "Could not map file " << file_path
+                 << ". File is empty or its size could not be determined.";
+    close(file_descriptor);
+    return nullptr;
+  }
+  const auto mapping_size = static_cast<size_t>(file_status.st_size);
+  void* mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE,
+                       file_descriptor, 0);
+  // NOTE: The mapping remains valid after the file descriptor is closed.
+  close(file_descriptor);
+  if (mapping == MAP_FAILED) {
+    LOG(WARNING) << "Could not map file " << file_path
+                 << ". Error: " << strerror(errno);
+    return nullptr;
+  }
+
+  // Parse the header and block table, leaving the blocks' data untouched
+  Ptr map{new MappedHashedWaveletOctree(
+      config, static_cast<const char*>(mapping), mapping_size)};
+  if (!map->parseFileIndex()) {
+    LOG(WARNING) << "Failed to parse map from file " << file_path << ".";
+    return nullptr;
+  }
+
+  return map;
+}
+
+MappedHashedWaveletOctree::~MappedHashedWaveletOctree() {
+  munmap(const_cast<char*>(mapping_), mapping_size_);
+}
+
+size_t MappedHashedWaveletOctree::getNumResidentBlocks() const {
+  std::scoped_lock lock(resident_blocks_mutex_);
+  return resident_blocks_.size();
+}
+
+std::shared_ptr<const MappedHashedWaveletOctree::Block>
+MappedHashedWaveletOctree::getBlock(const BlockIndex& block_index) const {
+  // Check whether the map contains the block
+  const auto entry_it = block_entries_.find(block_index);
+  if (entry_it == block_entries_.end()) {
+    return nullptr;
+  }
+
+  // Return the block directly if it is resident
+  {
+    std::scoped_lock lock(resident_blocks_mutex_);
+    if (const auto it = resident_blocks_.find(block_index);
+        it != resident_blocks_.end()) {
+      lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_position);
+      return it->second.block;
+    }
+  }
+
+  // Otherwise decode it
+  // NOTE: The mutex is released while decoding, s.t. queries to other blocks
+  //       are not blocked. If another thread decoded the same block in the
+  //       meantime, its copy is kept and ours is discarded.
+  auto block = decodeBlock(entry_it->second);
+  if (!block) {
+    return nullptr;
+  }
+  std::scoped_lock lock(resident_blocks_mutex_);
+  if (const auto it = resident_blocks_.find(block_index);
+      it != resident_blocks_.end()) {
+    lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_position);
+    return it->second.block;
+  }
+  lru_list_.emplace_front(block_index);
+  resident_blocks_.emplace(block_index,
+                           ResidentBlock{block, lru_list_.begin()});
+
+  // Evict the least recently accessed blocks if the cache is full
+  const auto max_num_resident_blocks =
+      static_cast<size_t>(config_.max_num_resident_blocks);
+  while (max_num_resident_blocks < resident_blocks_.size()) {
+    resident_blocks_.erase(lru_list_.back());
+    lru_list_.pop_back();
+  }
+
+  return block;
+}
+
+FloatingPoint MappedHashedWaveletOctree::getCellValue(
+    const OctreeIndex& index) const {
+  const IndexElement tree_height = map_config_.tree_height;
+  DCHECK_LE(index.height, tree_height);
+  const BlockIndex block_index = int_math::div_exp2_floor(
+      convert::nodeIndexToMinCornerIndex(index), tree_height);
+  if (const auto block = getBlock(block_index); block) {
+    CellIndex cell_index = index;
+    cell_index.position -=
+        int_math::mult_exp2(block_index, tree_height - index.height);
+    return block->getCellValue(cell_index);
+  }
+  return 0.f;
+}
+
+bool MappedHashedWaveletOctree::parseFileIndex() {
+  ByteRangeStreamBuffer file_buffer(mapping_, mapping_ + mapping_size_);
+  std::istream file_istream(&file_buffer);
+
+  // Make sure the map is stored in the block table format
+  if (streamable::StorageFormat::read(file_istream) !=
+      streamable::StorageFormat::kHashedWaveletOctreeWithBlockTable) {
+    LOG(WARNING) << "Only maps stored in the block table format can be memory "
+                    "mapped. Load and save the map with a thread pool to "
+                    "convert it.";
+    return false;
+  }
+
+  // Deserialize the map's config
+  const auto header = streamable::HashedWaveletOctreeHeader::read(file_istream);
+  map_config_.min_cell_width = header.min_cell_width;
+  map_config_.min_log_odds = header.min_log_odds;
+  map_config_.max_log_odds = header.max_log_odds;
+  map_config_.tree_height = header.tree_height;
+  if (!file_istream || !map_config_.isValid(true)) {
+    return false;
+  }
+
+  // Deserialize the block table
+  // NOTE: Each block takes up at least 20 bytes in the table, which we use to
+  //       reject corrupted block counts before allocating memory for them.
+  constexpr size_t kMinBlockTableEntrySize = 20u;
+  if (mapping_size_ / kMinBlockTableEntrySize < header.num_blocks) {
+    return false;
+  }
+  const auto block_table = streamable::HashedWaveletOctreeBlockTable::read(
+      file_istream, header.num_blocks);
+  const auto& block_offsets = block_table.block_offsets;
+  if (!file_istream || block_offsets.front() != 0u ||
+      !std::is_sorted(block_offsets.begin(), block_offsets.end())) {
+    return false;
+  }
+  block_data_ = file_buffer.position();
+  const auto block_data_size =
+      static_cast<size_t>(mapping_ + mapping_size_ - block_data_);
+  if (block_data_size < block_offsets.back()) {
+    return false;
+  }
+
+  // Index the blocks
+  block_entries_.reserve(header.num_blocks);
+  for (size_t block_idx = 0; block_idx < header.num_blocks; ++block_idx) {
+    const auto& block_index = block_table.block_indices[block_idx];
+    block_entries_.try_emplace(
+        BlockIndex{block_index.x, block_index.y, block_index.z},
+        BlockEntry{block_offsets[block_idx],
+                   block_offsets[block_idx + 1] - block_offsets[block_idx]});
+  }
+
+  return true;
+}
+
+std::shared_ptr<const MappedHashedWaveletOctree::Block>
+MappedHashedWaveletOctree::decodeBlock(const BlockEntry& entry) const {
+  auto block = std::make_shared<Block>(map_config_.tree_height,
+                                       map_config_.min_log_odds,
+                                       map_config_.max_log_odds);
+  const char* data_begin = block_data_ + entry.offset;
+  const char* data_end = data_begin + entry.size;
+  const bool success = bytesToBlock(data_begin, data_end, *block);
+
+  // Release the pages that only hold this block's data, as they are no longer
+  // needed once it is decoded. This keeps the resident set bounded by the
+  // decoded blocks, instead of growing with every block that was accessed.
+  const auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const uintptr_t pages_begin =
+      (reinterpret_cast<uintptr_t>(data_begin) + page_size - 1) / page_size *
+      page_size;
+  const uintptr_t pages_end =
+      reinterpret_cast<uintptr_t>(data_end) / page_size * page_size;
+  if (pages_begin < pages_end) {
+    madvise(reinterpret_cast<void*>(pages_begin), pages_end - pages_begin,
+            MADV_DONTNEED);
+  }
+
+  if (!success) {
+    LOG(WARNING) << "Could not decode block. Its data is corrupted.";
+    return nullptr;
+  }
+  return block;
+}
+}  // namespace wavemap::io
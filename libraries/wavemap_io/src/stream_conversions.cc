@@ -1,24 +1,64 @@
 #include "wavemap_io/stream_conversions.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <stack>
+#include <string>
+#include <vector>
+
+#include <wavemap/utils/compression/detail_coefficient_codec.h>
+
+#include "wavemap_io/byte_range_stream_buffer.h"
+
 namespace wavemap::io {
-bool mapToStream(const VolumetricDataStructureBase& map,
-                 std::ostream& ostream) {
+namespace {
+template <typename HashedMapT>
+void mapToStreamWithBlockTable(const HashedMapT& map, std::ostream& ostream,
+                               ThreadPool* thread_pool,
+                               std::optional<FloatingPoint> quantization_step);
+
+template <typename HashedMapT>
+void hashedMapToStreamImpl(const HashedMapT& map, std::ostream& ostream,
+                           ThreadPool* thread_pool,
+                           std::optional<FloatingPoint> quantization_step) {
+  if (quantization_step) {
+    mapToStreamWithBlockTable(map, ostream, thread_pool, quantization_step);
+  } else if (thread_pool) {
+    io::mapToStream(map, ostream, *thread_pool);
+  } else {
+    io::mapToStream(map, ostream);
+  }
+}
+
+bool mapToStreamImpl(const VolumetricDataStructureBase& map,
+                     std::ostream& ostream, ThreadPool* thread_pool,
+                     std::optional<FloatingPoint> quantization_step) {
   // Call the appropriate mapToStream converter based on the map's derived type
   if (const auto* wavelet_octree = dynamic_cast<const WaveletOctree*>(&map);
       wavelet_octree) {
+    if (quantization_step) {
+      LOG(WARNING) << "Compression is only supported for hashed maps. "
+                      "Serializing the map without compression.";
+    }
     io::mapToStream(*wavelet_octree, ostream);
     return true;
   }
   if (const auto* hashed_wavelet_octree =
           dynamic_cast<const HashedWaveletOctree*>(&map);
       hashed_wavelet_octree) {
-    io::mapToStream(*hashed_wavelet_octree, ostream);
+    hashedMapToStreamImpl(*hashed_wavelet_octree, ostream, thread_pool,
+                          quantization_step);
     return true;
   }
   if (const auto* hashed_chunked_wavelet_octree =
           dynamic_cast<const HashedChunkedWaveletOctree*>(&map);
       hashed_chunked_wavelet_octree) {
-    io::mapToStream(*hashed_chunked_wavelet_octree, ostream);
+    hashedMapToStreamImpl(*hashed_chunked_wavelet_octree, ostream,
+                          thread_pool, quantization_step);
     return true;
   }
 
@@ -27,7 +67,9 @@ bool mapToStream(const VolumetricDataStructureBase& map,
   return false;
 }
 
-bool streamToMap(std::istream& istream, VolumetricDataStructureBase::Ptr& map) {
+bool streamToMapImpl(std::istream& istream,
+                     VolumetricDataStructureBase::Ptr& map,
+                     ThreadPool* thread_pool) {
   // Call the appropriate streamToMap converter based on the received map's type
   const auto storage_format = streamable::StorageFormat::peek(istream);
   switch (storage_format.toTypeId()) {
@@ -39,10 +81,32 @@ bool streamToMap(std::istream& istream, VolumetricDataStructureBase::Ptr& map) {
       map = wavelet_octree;
       return true;
     }
-    case streamable::StorageFormat::kHashedWaveletOctree: {
+    case streamable::StorageFormat::kHashedWaveletOctree:
+    case streamable::StorageFormat::kHashedWaveletOctreeWithBlockTable:
+    case streamable::StorageFormat::kHashedWaveletOctreeCompressed: {
+      // Hashed chunked wavelet octrees are stored in the same formats as
+      // regular hashed wavelet octrees. Load the map as a chunked octree if
+      // that is the type of the map that was passed in.
+      if (auto hashed_chunked_wavelet_octree =
+              std::dynamic_pointer_cast<HashedChunkedWaveletOctree>(map);
+          hashed_chunked_wavelet_octree) {
+        const bool success =
+            thread_pool ? streamToMap(istream, hashed_chunked_wavelet_octree,
+                                      *thread_pool)
+                        : streamToMap(istream, hashed_chunked_wavelet_octree);
+        if (!success) {
+          return false;
+        }
+        map = hashed_chunked_wavelet_octree;
+        return true;
+      }
       auto hashed_wavelet_octree =
           std::dynamic_pointer_cast<HashedWaveletOctree>(map);
-      if (!streamToMap(istream, hashed_wavelet_octree)) {
+      const bool success =
+          thread_pool
+              ? streamToMap(istream, hashed_wavelet_octree, *thread_pool)
+              : streamToMap(istream, hashed_wavelet_octree);
+      if (!success) {
         return false;
       }
       map = hashed_wavelet_octree;
@@ -56,6 +120,742 @@ bool streamToMap(std::istream& istream, VolumetricDataStructureBase::Ptr& map) {
   }
 }
 
+template <typename HashedMapT>
+void hashedMapHeaderToStream(const HashedMapT& map,
+                             streamable::StorageFormat storage_format,
+                             std::ostream& ostream) {
+  // Indicate the map's data structure type
+  storage_format.write(ostream);
+
+  // Serialize the map and data structure's metadata
+  streamable::HashedWaveletOctreeHeader hashed_wavelet_octree_header;
+  hashed_wavelet_octree_header.min_cell_width = map.getMinCellWidth();
+  hashed_wavelet_octree_header.min_log_odds = map.getMinLogOdds();
+  hashed_wavelet_octree_header.max_log_odds = map.getMaxLogOdds();
+  hashed_wavelet_octree_header.tree_height = map.getTreeHeight();
+  hashed_wavelet_octree_header.num_blocks = map.getBlocks().size();
+  hashed_wavelet_octree_header.write(ostream);
+}
+
+template <typename BlockT>
+void blockHeaderToStream(const Index3D& block_index, const BlockT& block,
+                         std::ostream& ostream) {
+  streamable::HashedWaveletOctreeBlockHeader block_header;
+  block_header.root_node_offset = {block_index.x(), block_index.y(),
+                                   block_index.z()};
+  // Wavelet scale coefficient of the block's root node
+  block_header.root_node_scale_coefficient = block.getRootScale();
+  block_header.write(ostream);
+}
+
+// Writes octree nodes to a stream in their raw (uncompressed) format
+class StreamNodeWriter {
+ public:
+  explicit StreamNodeWriter(std::ostream& ostream) : ostream_(ostream) {}
+
+  void write(
+      const HaarCoefficients<FloatingPoint, 3>::Details& detail_coefficients,
+      streamable::UInt8 allocated_children_bitset) {
+    streamable::WaveletOctreeNode streamable_node;
+    std::copy(detail_coefficients.begin(), detail_coefficients.end(),
+              streamable_node.detail_coefficients.begin());
+    streamable_node.allocated_children_bitset = allocated_children_bitset;
+    streamable_node.write(ostream_);
+  }
+
+ private:
+  std::ostream& ostream_;
+};
+
+// Writes octree nodes with quantized and entropy coded detail coefficients
+class CompressedNodeWriter {
+ public:
+  CompressedNodeWriter(FloatingPoint quantization_step,
+                       std::vector<uint8_t>& output)
+      : encoder_(quantization_step, output) {}
+
+  void write(
+      const HaarCoefficients<FloatingPoint, 3>::Details& detail_coefficients,
+      streamable::UInt8 allocated_children_bitset) {
+    encoder_.encodeNode(detail_coefficients, allocated_children_bitset);
+  }
+
+  void flush() { encoder_.flush(); }
+
+ private:
+  DetailCoefficientEncoder encoder_;
+};
+
+template <typename NodeWriterT>
+void writeBlockNodes(const HashedWaveletOctree& map,
+                     const Index3D& /*block_index*/,
+                     const HashedWaveletOctreeBlock& block,
+                     NodeWriterT& node_writer) {
+  // Define convenience types and constants
+  struct StackElement {
+    const FloatingPoint scale;
+    const HashedWaveletOctreeBlock::NodeType& node;
+  };
+  constexpr FloatingPoint kNumericalNoise = 1e-3f;
+  const auto min_log_odds = map.getMinLogOdds() + kNumericalNoise;
+  const auto max_log_odds = map.getMaxLogOdds() - kNumericalNoise;
+
+  // Serialize the block's data (all nodes of its octree)
+  std::stack<StackElement> stack;
+  stack.emplace(StackElement{block.getRootScale(), block.getRootNode()});
+  while (!stack.empty()) {
+    const FloatingPoint scale = stack.top().scale;
+    const auto& node = stack.top().node;
+    stack.pop();
+
+    // Evaluate which of its children should be serialized
+    streamable::UInt8 allocated_children_bitset = 0u;
+    const auto child_scales =
+        HashedWaveletOctreeBlock::Transform::backward({scale, node.data()});
+    // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
+    //       the nodes are popped from the stack in increasing order.
+    for (int relative_child_idx = OctreeIndex::kNumChildren - 1;
+         0 <= relative_child_idx; --relative_child_idx) {
+      // If the child is saturated, we don't need to store its descendants
+      const auto child_scale = child_scales[relative_child_idx];
+      if (child_scale < min_log_odds || max_log_odds < child_scale) {
+        continue;
+      }
+      // Otherwise, indicate that the child will be serialized
+      // and add it to the stack
+      const auto* child = node.getChild(relative_child_idx);
+      if (child) {
+        stack.emplace(StackElement{child_scale, *child});
+        allocated_children_bitset += (1 << relative_child_idx);
+      }
+    }
+
+    // Serialize the node's data
+    node_writer.write(node.data(), allocated_children_bitset);
+  }
+}
+
+template <typename NodeWriterT>
+void writeBlockNodes(const HashedChunkedWaveletOctree& map,
+                     const Index3D& block_index,
+                     const HashedChunkedWaveletOctreeBlock& block,
+                     NodeWriterT& node_writer) {
+  // Define convenience types and constants
+  struct StackElement {
+    const OctreeIndex node_index;
+    const HashedChunkedWaveletOctreeBlock::NodeChunkType& chunk;
+    const FloatingPoint scale_coefficient;
+  };
+  constexpr FloatingPoint kNumericalNoise = 1e-3f;
+  const auto min_log_odds = map.getMinLogOdds() + kNumericalNoise;
+  const auto max_log_odds = map.getMaxLogOdds() - kNumericalNoise;
+  const auto tree_height = map.getTreeHeight();
+  const auto chunk_height = map.getChunkHeight();
+
+  // Serialize the block's data (all nodes of its octree)
+  std::stack<StackElement> stack;
+  stack.emplace(StackElement{
+      {tree_height, block_index}, block.getRootChunk(), block.getRootScale()});
+  while (!stack.empty()) {
+    const OctreeIndex index = stack.top().node_index;
+    const FloatingPoint scale = stack.top().scale_coefficient;
+    const auto& chunk = stack.top().chunk;
+    stack.pop();
+
+    // Compute the node's index w.r.t. the data chunk that contains it
+    const MortonIndex morton_code = convert::nodeIndexToMorton(index);
+    const int chunk_top_height =
+        tree_height -
+        chunk_height * ((tree_height - index.height) / chunk_height);
+    const LinearIndex relative_node_index =
+        OctreeIndex::computeTreeTraversalDistance(morton_code, chunk_top_height,
+                                                  index.height);
+
+    // If the node has no children, serialize its data and continue
+    const auto& node_data = chunk.nodeData(relative_node_index);
+    if (!chunk.nodeHasAtLeastOneChild(relative_node_index)) {
+      node_writer.write(node_data, 0u);
+      continue;
+    }
+
+    // Otherwise, evaluate which of its children should be serialized
+    streamable::UInt8 allocated_children_bitset = 0u;
+    const auto child_scales =
+        HashedWaveletOctreeBlock::Transform::backward({scale, node_data});
+    // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
+    //       the nodes are popped from the stack in increasing order.
+    for (int relative_child_idx = OctreeIndex::kNumChildren - 1;
+         0 <= relative_child_idx; --relative_child_idx) {
+      // If the child is saturated, we don't need to store its descendants
+      const FloatingPoint child_scale = child_scales[relative_child_idx];
+      if (child_scale < min_log_odds || max_log_odds < child_scale) {
+        continue;
+      }
+
+      // Check if the child is no longer in the current chunk
+      const OctreeIndex child_index =
+          index.computeChildIndex(relative_child_idx);
+      if ((tree_height - child_index.height) % chunk_height == 0) {
+        // If so, check if the chunk exists
+        const MortonIndex child_morton =
+            convert::nodeIndexToMorton(child_index);
+        const LinearIndex linear_child_index =
+            OctreeIndex::computeLevelTraversalDistance(
+                child_morton, chunk_top_height, child_index.height);
+        if (chunk.hasChild(linear_child_index)) {
+          const auto& child_chunk = *chunk.getChild(linear_child_index);
+          // Indicate that the child will be serialized
+          // and add it to the stack
+          stack.emplace(StackElement{child_index, child_chunk, child_scale});
+          allocated_children_bitset += (1 << relative_child_idx);
+        }
+      } else {
+        // Indicate that the child will be serialized and add it to the stack
+        stack.emplace(StackElement{child_index, chunk, child_scale});
+        allocated_children_bitset += (1 << relative_child_idx);
+      }
+    }
+
+    // Serialize the node's data
+    node_writer.write(node_data, allocated_children_bitset);
+  }
+}
+
+template <typename HashedMapT>
+void blockToStream(const HashedMapT& map, const Index3D& block_index,
+                   const typename HashedMapT::Block& block,
+                   std::ostream& ostream) {
+  blockHeaderToStream(block_index, block, ostream);
+  StreamNodeWriter node_writer(ostream);
+  writeBlockNodes(map, block_index, block, node_writer);
+}
+
+template <typename HashedMapT>
+void compressedBlockToStream(const HashedMapT& map, const Index3D& block_index,
+                             const typename HashedMapT::Block& block,
+                             FloatingPoint quantization_step,
+                             std::ostream& ostream) {
+  blockHeaderToStream(block_index, block, ostream);
+  std::vector<uint8_t> compressed_nodes;
+  CompressedNodeWriter node_writer(quantization_step, compressed_nodes);
+  writeBlockNodes(map, block_index, block, node_writer);
+  node_writer.flush();
+  ostream.write(reinterpret_cast<const char*>(compressed_nodes.data()),
+                static_cast<std::streamsize>(compressed_nodes.size()));
+}
+
+// Appends octree nodes to a byte vector in their raw (uncompressed) format,
+// copying each node's detail coefficients in bulk
+class MemoryNodeWriter {
+ public:
+  explicit MemoryNodeWriter(std::vector<uint8_t>& output) : output_(output) {}
+
+  void write(
+      const HaarCoefficients<FloatingPoint, 3>::Details& detail_coefficients,
+      streamable::UInt8 allocated_children_bitset) {
+    static_assert(sizeof(detail_coefficients) == kDetailCoefficientsSize);
+    const size_t position = output_.size();
+    output_.resize(position + kNodeSize);
+    std::memcpy(output_.data() + position, detail_coefficients.data(),
+                kDetailCoefficientsSize);
+    output_[position + kDetailCoefficientsSize] = allocated_children_bitset;
+  }
+
+ private:
+  static constexpr size_t kDetailCoefficientsSize =
+      sizeof(streamable::WaveletOctreeNode::detail_coefficients);
+  static constexpr size_t kNodeSize =
+      kDetailCoefficientsSize + sizeof(streamable::UInt8);
+
+  std::vector<uint8_t>& output_;
+};
+
+template <typename HashedMapT>
+void blockToBytesImpl(const HashedMapT& map, const Index3D& block_index,
+                      const typename HashedMapT::Block& block,
+                      std::optional<FloatingPoint> quantization_step,
+                      std::vector<uint8_t>& bytes) {
+  // Serialize the block's metadata
+  std::ostringstream header_ostream;
+  blockHeaderToStream(block_index, block, header_ostream);
+  const std::string header = header_ostream.str();
+  bytes.assign(header.begin(), header.end());
+
+  // Followed by its nodes
+  if (quantization_step) {
+    CompressedNodeWriter node_writer(quantization_step.value(), bytes);
+    writeBlockNodes(map, block_index, block, node_writer);
+    node_writer.flush();
+  } else {
+    MemoryNodeWriter node_writer(bytes);
+    writeBlockNodes(map, block_index, block, node_writer);
+  }
+}
+
+template <typename HashedMapT>
+void mapToStreamWithBlockTable(const HashedMapT& map, std::ostream& ostream,
+                               ThreadPool* thread_pool,
+                               std::optional<FloatingPoint> quantization_step) {
+  // Serialize the map's type and metadata
+  if (quantization_step) {
+    hashedMapHeaderToStream(
+        map, streamable::StorageFormat::kHashedWaveletOctreeCompressed,
+        ostream);
+    streamable::HashedWaveletOctreeCompressionHeader compression_header;
+    compression_header.quantization_step = quantization_step.value();
+    compression_header.write(ostream);
+  } else {
+    hashedMapHeaderToStream(
+        map, streamable::StorageFormat::kHashedWaveletOctreeWithBlockTable,
+        ostream);
+  }
+
+  // Serialize all blocks, in parallel if a thread pool is available, each
+  // into its own buffer
+  const auto& blocks = map.getBlocks();
+  std::vector<std::string> block_data(blocks.size());
+  streamable::HashedWaveletOctreeBlockTable block_table;
+  block_table.block_indices.reserve(blocks.size());
+  ThreadPool::TaskGroup serialization_tasks;
+  size_t block_idx = 0u;
+  for (const auto& [block_index, block] : blocks) {
+    block_table.block_indices.emplace_back(streamable::Index3D{
+        block_index.x(), block_index.y(), block_index.z()});
+    auto serialize_block = [&map, block_index = block_index,
+                            block_ptr = &block,
+                            block_data_ptr = &block_data[block_idx],
+                            quantization_step]() {
+      std::ostringstream block_ostream;
+      if (quantization_step) {
+        compressedBlockToStream(map, block_index, *block_ptr,
+                                quantization_step.value(), block_ostream);
+      } else {
+        blockToStream(map, block_index, *block_ptr, block_ostream);
+      }
+      *block_data_ptr = block_ostream.str();
+    };
+    if (thread_pool) {
+      thread_pool->add_detached_task(
+          serialization_tasks, std::move(serialize_block));
+    } else {
+      serialize_block();
+    }
+    ++block_idx;
+  }
+  if (thread_pool) {
+    thread_pool->wait_for(serialization_tasks);
+  }
+
+  // Serialize the index and offset of each block, followed by their data
+  block_table.block_offsets.reserve(block_data.size() + 1);
+  block_table.block_offsets.emplace_back(0u);
+  for (const std::string& data : block_data) {
+    block_table.block_offsets.emplace_back(block_table.block_offsets.back() +
+                                           data.size());
+  }
+  block_table.write(ostream);
+  for (const std::string& data : block_data) {
+    ostream.write(data.data(), static_cast<std::streamsize>(data.size()));
+  }
+}
+
+// Reads serialized octree nodes from a stream, one coefficient at a time
+class StreamNodeReader {
+ public:
+  explicit StreamNodeReader(std::istream& istream) : istream_(istream) {}
+
+  bool read(HaarCoefficients<FloatingPoint, 3>::Details& detail_coefficients,
+            streamable::UInt8& allocated_children_bitset) {
+    const auto read_node = streamable::WaveletOctreeNode::read(istream_);
+    std::copy(read_node.detail_coefficients.begin(),
+              read_node.detail_coefficients.end(), detail_coefficients.begin());
+    allocated_children_bitset = read_node.allocated_children_bitset;
+    return static_cast<bool>(istream_);
+  }
+
+ private:
+  std::istream& istream_;
+};
+
+// Reads serialized octree nodes straight from memory, copying each node's
+// detail coefficients in bulk
+class MemoryNodeReader {
+ public:
+  MemoryNodeReader(const char* data_begin, const char* data_end)
+      : position_(data_begin), end_(data_end) {}
+
+  bool read(HaarCoefficients<FloatingPoint, 3>::Details& detail_coefficients,
+            streamable::UInt8& allocated_children_bitset) {
+    static_assert(sizeof(detail_coefficients) == kDetailCoefficientsSize);
+    if (end_ - position_ < kNodeSize) {
+      return false;
+    }
+    std::memcpy(detail_coefficients.data(), position_,
+                kDetailCoefficientsSize);
+    std::memcpy(&allocated_children_bitset,
+                position_ + kDetailCoefficientsSize,
+                sizeof(allocated_children_bitset));
+    position_ += kNodeSize;
+    return true;
+  }
+
+ private:
+  static constexpr std::ptrdiff_t kDetailCoefficientsSize =
+      sizeof(streamable::WaveletOctreeNode::detail_coefficients);
+  static constexpr std::ptrdiff_t kNodeSize =
+      kDetailCoefficientsSize + sizeof(streamable::UInt8);
+
+  const char* position_;
+  const char* const end_;
+};
+
+// Reads octree nodes with quantized and entropy coded detail coefficients
+class CompressedNodeReader {
+ public:
+  CompressedNodeReader(FloatingPoint quantization_step, const char* data_begin,
+                       const char* data_end)
+      : decoder_(quantization_step,
+                 reinterpret_cast<const uint8_t*>(data_begin),
+                 reinterpret_cast<const uint8_t*>(data_end)) {}
+
+  bool read(HaarCoefficients<FloatingPoint, 3>::Details& detail_coefficients,
+            streamable::UInt8& allocated_children_bitset) {
+    return decoder_.decodeNode(detail_coefficients, allocated_children_bitset);
+  }
+
+ private:
+  DetailCoefficientDecoder decoder_;
+};
+
+template <typename NodeReaderT>
+bool readBlockNodes(NodeReaderT& node_reader,
+                    HashedWaveletOctreeBlock& block) {
+  // Deserialize the block's data into octree nodes
+  std::stack<HashedWaveletOctreeBlock::NodeType*> stack;
+  stack.emplace(&block.getRootNode());
+  while (!stack.empty()) {
+    HashedWaveletOctreeBlock::NodeType* node = stack.top();
+    stack.pop();
+
+    // Deserialize the node's (wavelet) detail coefficients
+    streamable::UInt8 allocated_children_bitset;
+    if (!node_reader.read(node->data(), allocated_children_bitset)) {
+      return false;
+    }
+
+    // Evaluate which of the node's children are coming next
+    // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
+    //       the nodes are popped from the stack in increasing order.
+    for (int relative_child_idx = wavemap::OctreeIndex::kNumChildren - 1;
+         0 <= relative_child_idx; --relative_child_idx) {
+      const bool child_exists =
+          allocated_children_bitset & (1 << relative_child_idx);
+      if (child_exists) {
+        stack.emplace(node->allocateChild(relative_child_idx));
+      }
+    }
+  }
+  return true;
+}
+
+template <typename NodeReaderT>
+bool readBlockNodes(NodeReaderT& node_reader,
+                    HashedChunkedWaveletOctreeBlock& block) {
+  // Define convenience types and constants
+  struct StackElement {
+    const OctreeIndex node_index;
+    HashedChunkedWaveletOctreeBlock::NodeChunkType& chunk;
+    const IndexElement chunk_top_height;
+  };
+  const IndexElement tree_height = block.getTreeHeight();
+  constexpr IndexElement kChunkHeight =
+      HashedChunkedWaveletOctreeBlock::kChunkHeight;
+
+  // Deserialize the block's data directly into the chunks that hold its nodes
+  std::stack<StackElement> stack;
+  stack.emplace(StackElement{
+      {tree_height, Index3D::Zero()}, block.getRootChunk(), tree_height});
+  while (!stack.empty()) {
+    const OctreeIndex index = stack.top().node_index;
+    auto& chunk = stack.top().chunk;
+    const IndexElement chunk_top_height = stack.top().chunk_top_height;
+    stack.pop();
+
+    // Compute the node's index w.r.t. the data chunk that contains it
+    const MortonIndex morton_code = convert::nodeIndexToMorton(index);
+    const LinearIndex relative_node_index =
+        OctreeIndex::computeTreeTraversalDistance(morton_code, chunk_top_height,
+                                                  index.height);
+
+    // Deserialize the node's (wavelet) detail coefficients
+    streamable::UInt8 allocated_children_bitset;
+    if (!node_reader.read(chunk.nodeData(relative_node_index),
+                          allocated_children_bitset)) {
+      return false;
+    }
+
+    // If the node has no children, continue
+    if (!allocated_children_bitset) {
+      continue;
+    }
+    // Nodes at the leaf level cannot have children
+    if (index.height <= 0) {
+      return false;
+    }
+    chunk.nodeHasAtLeastOneChild(relative_node_index) = true;
+
+    // Otherwise, evaluate which of the node's children are coming next
+    // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
+    //       the nodes are popped from the stack in increasing order.
+    for (int relative_child_idx = OctreeIndex::kNumChildren - 1;
+         0 <= relative_child_idx; --relative_child_idx) {
+      const bool child_exists =
+          allocated_children_bitset & (1 << relative_child_idx);
+      if (!child_exists) {
+        continue;
+      }
+      // If the child starts a new chunk, allocate it
+      const OctreeIndex child_index =
+          index.computeChildIndex(relative_child_idx);
+      if (child_index.height == chunk_top_height - kChunkHeight) {
+        const MortonIndex child_morton =
+            convert::nodeIndexToMorton(child_index);
+        const LinearIndex linear_child_index =
+            OctreeIndex::computeLevelTraversalDistance(
+                child_morton, chunk_top_height, child_index.height);
+        auto* child_chunk = chunk.allocateChild(linear_child_index);
+        stack.emplace(
+            StackElement{child_index, *child_chunk, child_index.height});
+      } else {
+        stack.emplace(StackElement{child_index, chunk, chunk_top_height});
+      }
+    }
+  }
+  return true;
+}
+
+template <typename BlockT>
+bool bytesToBlockImpl(const char* data_begin, const char* data_end,
+                      BlockT& block,
+                      std::optional<FloatingPoint> quantization_step) {
+  // Deserialize the block header, of which only the scale coefficient is used
+  // since the block's index is already known
+  ByteRangeStreamBuffer block_buffer(data_begin, data_end);
+  std::istream block_istream(&block_buffer);
+  const auto block_header =
+      streamable::HashedWaveletOctreeBlockHeader::read(block_istream);
+  if (!block_istream) {
+    return false;
+  }
+  block.getRootScale() = block_header.root_node_scale_coefficient;
+
+  // Followed by its nodes
+  if (quantization_step) {
+    CompressedNodeReader node_reader(quantization_step.value(),
+                                     block_buffer.position(), data_end);
+    return readBlockNodes(node_reader, block);
+  }
+  MemoryNodeReader node_reader(block_buffer.position(), data_end);
+  return readBlockNodes(node_reader, block);
+}
+
+// Number of bytes left to read from the stream, or std::nullopt if its
+// buffer does not support seeking
+std::optional<size_t> getRemainingStreamSize(std::istream& istream) {
+  const auto current_position = istream.tellg();
+  if (current_position == std::istream::pos_type(-1)) {
+    return std::nullopt;
+  }
+  istream.seekg(0, std::ios::end);
+  const auto end_position = istream.tellg();
+  istream.seekg(current_position);
+  if (!istream || end_position < current_position) {
+    return std::nullopt;
+  }
+  return static_cast<size_t>(end_position - current_position);
+}
+
+template <typename HashedMapT>
+bool streamToMapImpl(std::istream& istream, std::shared_ptr<HashedMapT>& map,
+                     ThreadPool* thread_pool) {
+  // Make sure the map in the input stream is of the correct type
+  const auto storage_format = streamable::StorageFormat::read(istream);
+  if (storage_format != streamable::StorageFormat::kHashedWaveletOctree &&
+      storage_format !=
+          streamable::StorageFormat::kHashedWaveletOctreeWithBlockTable &&
+      storage_format !=
+          streamable::StorageFormat::kHashedWaveletOctreeCompressed) {
+    return false;
+  }
+
+  // Deserialize the map's config and initialize the data structure
+  const auto hashed_wavelet_octree_header =
+      streamable::HashedWaveletOctreeHeader::read(istream);
+  typename HashedMapT::Config config;
+  config.min_cell_width = hashed_wavelet_octree_header.min_cell_width;
+  config.min_log_odds = hashed_wavelet_octree_header.min_log_odds;
+  config.max_log_odds = hashed_wavelet_octree_header.max_log_odds;
+  config.tree_height = hashed_wavelet_octree_header.tree_height;
+  // NOTE: Maps can be loaded as a different type than they were saved as,
+  //       e.g. hashed wavelet octrees as hashed chunked wavelet octrees, whose
+  //       configs are more restrictive.
+  if (!istream || !config.isValid(true)) {
+    LOG(WARNING) << "Could not deserialize map stream. "
+                    "Invalid map config for the requested map type.";
+    return false;
+  }
+  map = std::make_shared<HashedMapT>(config);
+  const size_t num_blocks = hashed_wavelet_octree_header.num_blocks;
+
+  // In the compressed format, the header is followed by the step to which the
+  // detail coefficients were quantized
+  std::optional<FloatingPoint> quantization_step;
+  if (storage_format ==
+      streamable::StorageFormat::kHashedWaveletOctreeCompressed) {
+    const auto compression_header =
+        streamable::HashedWaveletOctreeCompressionHeader::read(istream);
+    if (!istream || !(0.f < compression_header.quantization_step)) {
+      LOG(WARNING) << "Could not deserialize map stream. "
+                      "Invalid compression header.";
+      return false;
+    }
+    quantization_step = compression_header.quantization_step;
+  }
+
+  // In the original format, the blocks directly follow each other and can
+  // therefore only be deserialized one by one
+  if (storage_format == streamable::StorageFormat::kHashedWaveletOctree) {
+    StreamNodeReader node_reader(istream);
+    for (size_t block_idx = 0; block_idx < num_blocks; ++block_idx) {
+      // Deserialize the block header, containing its position and scale coeff.
+      const auto block_header =
+          streamable::HashedWaveletOctreeBlockHeader::read(istream);
+      const Index3D block_index{block_header.root_node_offset.x,
+                                block_header.root_node_offset.y,
+                                block_header.root_node_offset.z};
+      auto& block = map->getOrAllocateBlock(block_index);
+      // Wavelet scale coefficient of the block's root node
+      block.getRootScale() = block_header.root_node_scale_coefficient;
+      // Followed by its nodes
+      if (!readBlockNodes(node_reader, block)) {
+        LOG(WARNING) << "Could not deserialize map stream. Data truncated.";
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Otherwise, read the block table and load the data of all blocks at once
+  // NOTE: Each block takes up at least 20 bytes in the table, which we use to
+  //       reject corrupted block counts before allocating memory for them.
+  constexpr size_t kMinBlockTableEntrySize = 20u;
+  if (const auto remaining_size = getRemainingStreamSize(istream);
+      remaining_size &&
+      remaining_size.value() / kMinBlockTableEntrySize < num_blocks) {
+    LOG(WARNING) << "Could not deserialize map stream. Invalid block count.";
+    return false;
+  }
+  const auto block_table =
+      streamable::HashedWaveletOctreeBlockTable::read(istream, num_blocks);
+  const auto& block_offsets = block_table.block_offsets;
+  if (!istream || block_offsets.front() != 0u ||
+      !std::is_sorted(block_offsets.begin(), block_offsets.end())) {
+    LOG(WARNING) << "Could not deserialize map stream. Invalid block table.";
+    return false;
+  }
+  if (const auto block_data_size = getRemainingStreamSize(istream);
+      block_data_size && block_data_size.value() < block_offsets.back()) {
+    LOG(WARNING) << "Could not deserialize map stream. Block data truncated.";
+    return false;
+  }
+  std::vector<char> block_data(block_offsets.back());
+  istream.read(block_data.data(),
+               static_cast<std::streamsize>(block_data.size()));
+  if (!istream) {
+    LOG(WARNING) << "Could not deserialize map stream. Block data truncated.";
+    return false;
+  }
+
+  // Allocate the blocks serially, as this modifies the hash map itself
+  // NOTE: Each block may only be listed once, since blocks that are listed
+  //       multiple times would be deserialized by concurrent tasks.
+  std::vector<typename HashedMapT::Block*> blocks(num_blocks);
+  for (size_t block_idx = 0; block_idx < num_blocks; ++block_idx) {
+    const auto& block_table_index = block_table.block_indices[block_idx];
+    const Index3D block_index{block_table_index.x, block_table_index.y,
+                              block_table_index.z};
+    if (map->hasBlock(block_index)) {
+      LOG(WARNING) << "Could not deserialize map stream. "
+                      "Duplicate block in block table.";
+      return false;
+    }
+    blocks[block_idx] = &map->getOrAllocateBlock(block_index);
+  }
+
+  // Deserialize the blocks, in parallel if a thread pool is available
+  std::atomic<bool> all_blocks_valid = true;
+  ThreadPool::TaskGroup deserialization_tasks;
+  for (size_t block_idx = 0; block_idx < num_blocks; ++block_idx) {
+    auto deserialize_block =
+        [block_ptr = blocks[block_idx],
+         data_begin = block_data.data() + block_offsets[block_idx],
+         data_end = block_data.data() + block_offsets[block_idx + 1],
+         quantization_step, &all_blocks_valid]() {
+          if (!bytesToBlockImpl(data_begin, data_end, *block_ptr,
+                                quantization_step)) {
+            all_blocks_valid = false;
+          }
+        };
+    if (thread_pool) {
+      thread_pool->add_detached_task(
+          deserialization_tasks, std::move(deserialize_block));
+    } else {
+      deserialize_block();
+    }
+  }
+  if (thread_pool) {
+    thread_pool->wait_for(deserialization_tasks);
+  }
+  if (!all_blocks_valid) {
+    LOG(WARNING) << "Could not deserialize map stream. Invalid block data.";
+    return false;
+  }
+
+  return true;
+}
+}  // namespace
+
+bool mapToStream(const VolumetricDataStructureBase& map,
+                 std::ostream& ostream) {
+  return mapToStreamImpl(map, ostream, nullptr, std::nullopt);
+}
+
+bool mapToStream(const VolumetricDataStructureBase& map, std::ostream& ostream,
+                 ThreadPool& thread_pool) {
+  return mapToStreamImpl(map, ostream, &thread_pool, std::nullopt);
+}
+
+bool mapToStream(const VolumetricDataStructureBase& map, std::ostream& ostream,
+                 FloatingPoint quantization_step) {
+  CHECK_GT(quantization_step, 0.f);
+  return mapToStreamImpl(map, ostream, nullptr, quantization_step);
+}
+
+bool mapToStream(const VolumetricDataStructureBase& map, std::ostream& ostream,
+                 FloatingPoint quantization_step, ThreadPool& thread_pool) {
+  CHECK_GT(quantization_step, 0.f);
+  return mapToStreamImpl(map, ostream, &thread_pool, quantization_step);
+}
+
+bool streamToMap(std::istream& istream, VolumetricDataStructureBase::Ptr& map) {
+  return streamToMapImpl(istream, map, nullptr);
+}
+
+bool streamToMap(std::istream& istream, VolumetricDataStructureBase::Ptr& map,
+                 ThreadPool& thread_pool) {
+  return streamToMapImpl(istream, map, &thread_pool);
+}
+
 void mapToStream(const WaveletOctree& map, std::ostream& ostream) {
   // Serialize the map's data structure type
   streamable::StorageFormat storage_format =
@@ -141,245 +941,145 @@ bool streamToMap(std::istream& istream, WaveletOctree::Ptr& map) {
 }
 
 void mapToStream(const HashedWaveletOctree& map, std::ostream& ostream) {
-  // Define convenience types and constants
-  struct StackElement {
-    const FloatingPoint scale;
-    const HashedWaveletOctreeBlock::NodeType& node;
-  };
-  constexpr FloatingPoint kNumericalNoise = 1e-3f;
-  const auto min_log_odds = map.getMinLogOdds() + kNumericalNoise;
-  const auto max_log_odds = map.getMaxLogOdds() - kNumericalNoise;
+  // Serialize the map's type and metadata
+  hashedMapHeaderToStream(
+      map, streamable::StorageFormat::kHashedWaveletOctree, ostream);
 
-  // Indicate the map's data structure type
-  streamable::StorageFormat storage_format =
-      streamable::StorageFormat::kHashedWaveletOctree;
-  storage_format.write(ostream);
-
-  // Serialize the map and data structure's metadata
-  streamable::HashedWaveletOctreeHeader hashed_wavelet_octree_header;
-  hashed_wavelet_octree_header.min_cell_width = map.getMinCellWidth();
-  hashed_wavelet_octree_header.min_log_odds = map.getMinLogOdds();
-  hashed_wavelet_octree_header.max_log_odds = map.getMaxLogOdds();
-  hashed_wavelet_octree_header.tree_height = map.getTreeHeight();
-  hashed_wavelet_octree_header.num_blocks = map.getBlocks().size();
-  hashed_wavelet_octree_header.write(ostream);
-
-  // Iterate over all the map's blocks
+  // Serialize all the map's blocks, one after the other
   for (const auto& [block_index, block] : map.getBlocks()) {
-    // Serialize the block's metadata
-    streamable::HashedWaveletOctreeBlockHeader block_header;
-    block_header.root_node_offset = {block_index.x(), block_index.y(),
-                                     block_index.z()};
-    // Wavelet scale coefficient of the block's root node
-    block_header.root_node_scale_coefficient = block.getRootScale();
-    block_header.write(ostream);
-
-    // Serialize the block's data (all nodes of its octree)
-    std::stack<StackElement> stack;
-    stack.emplace(StackElement{block.getRootScale(), block.getRootNode()});
-    while (!stack.empty()) {
-      const FloatingPoint scale = stack.top().scale;
-      const auto& node = stack.top().node;
-      stack.pop();
-
-      // Serialize the node's data
-      streamable::WaveletOctreeNode streamable_node;
-      std::copy(node.data().begin(), node.data().end(),
-                streamable_node.detail_coefficients.begin());
-
-      // Evaluate which of its children should be serialized
-      const auto child_scales =
-          HashedWaveletOctreeBlock::Transform::backward({scale, node.data()});
-      // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
-      //       the nodes are popped from the stack in increasing order.
-      for (int relative_child_idx = OctreeIndex::kNumChildren - 1;
-           0 <= relative_child_idx; --relative_child_idx) {
-        // If the child is saturated, we don't need to store its descendants
-        const auto child_scale = child_scales[relative_child_idx];
-        if (child_scale < min_log_odds || max_log_odds < child_scale) {
-          continue;
-        }
-        // Otherwise, indicate that the child will be serialized
-        // and add it to the stack
-        const auto* child = node.getChild(relative_child_idx);
-        if (child) {
-          stack.emplace(StackElement{child_scale, *child});
-          streamable_node.allocated_children_bitset +=
-              (1 << relative_child_idx);
-        }
-      }
-      streamable_node.write(ostream);
-    }
+    blockToStream(map, block_index, block, ostream);
   }
 }
 
+void mapToStream(const HashedWaveletOctree& map, std::ostream& ostream,
+                 ThreadPool& thread_pool) {
+  mapToStreamWithBlockTable(map, ostream, &thread_pool, std::nullopt);
+}
+
+void mapToStream(const HashedWaveletOctree& map, std::ostream& ostream,
+                 FloatingPoint quantization_step) {
+  CHECK_GT(quantization_step, 0.f);
+  mapToStreamWithBlockTable(map, ostream, nullptr, quantization_step);
+}
+
+void mapToStream(const HashedWaveletOctree& map, std::ostream& ostream,
+                 FloatingPoint quantization_step, ThreadPool& thread_pool) {
+  CHECK_GT(quantization_step, 0.f);
+  mapToStreamWithBlockTable(map, ostream, &thread_pool, quantization_step);
+}
+
 bool streamToMap(std::istream& istream, HashedWaveletOctree::Ptr& map) {
-  // Make sure the map in the input stream is of the correct type
-  if (streamable::StorageFormat::read(istream) !=
-      streamable::StorageFormat::kHashedWaveletOctree) {
-    return false;
-  }
+  return streamToMapImpl(istream, map, nullptr);
+}
 
-  // Deserialize the map's config and initialize the data structure
-  const auto hashed_wavelet_octree_header =
-      streamable::HashedWaveletOctreeHeader::read(istream);
-  HashedWaveletOctreeConfig config;
-  config.min_cell_width = hashed_wavelet_octree_header.min_cell_width;
-  config.min_log_odds = hashed_wavelet_octree_header.min_log_odds;
-  config.max_log_odds = hashed_wavelet_octree_header.max_log_odds;
-  config.tree_height = hashed_wavelet_octree_header.tree_height;
-  map = std::make_shared<HashedWaveletOctree>(config);
-
-  // Deserialize all the blocks
-  for (size_t block_idx = 0;
-       block_idx < hashed_wavelet_octree_header.num_blocks; ++block_idx) {
-    // Deserialize the block header, containing its position and scale coeff.
-    const auto block_header =
-        streamable::HashedWaveletOctreeBlockHeader::read(istream);
-    const Index3D block_index{block_header.root_node_offset.x,
-                              block_header.root_node_offset.y,
-                              block_header.root_node_offset.z};
-    auto& block = map->getOrAllocateBlock(block_index);
-    // Wavelet scale coefficient of the block's root node
-    block.getRootScale() = block_header.root_node_scale_coefficient;
-
-    // Deserialize the block's remaining data into octree nodes
-    std::stack<WaveletOctree::NodeType*> stack;
-    stack.emplace(&block.getRootNode());
-    while (!stack.empty()) {
-      WaveletOctree::NodeType* node = stack.top();
-      stack.pop();
-
-      // Deserialize the node's (wavelet) detail coefficients
-      const auto read_node = streamable::WaveletOctreeNode::read(istream);
-      std::copy(read_node.detail_coefficients.begin(),
-                read_node.detail_coefficients.end(), node->data().begin());
-
-      // Evaluate which of the node's children are coming next
-      // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
-      //       the nodes are popped from the stack in increasing order.
-      for (int relative_child_idx = wavemap::OctreeIndex::kNumChildren - 1;
-           0 <= relative_child_idx; --relative_child_idx) {
-        const bool child_exists =
-            read_node.allocated_children_bitset & (1 << relative_child_idx);
-        if (child_exists) {
-          stack.emplace(node->allocateChild(relative_child_idx));
-        }
-      }
-    }
+bool streamToMap(std::istream& istream, HashedWaveletOctree::Ptr& map,
+                 ThreadPool& thread_pool) {
+  return streamToMapImpl(istream, map, &thread_pool);
+}
+
+void mapToStream(const HashedChunkedWaveletOctree& map, std::ostream& ostream) {
+  // Serialize the map's type and metadata
+  // NOTE: Hashed chunked wavelet octrees are stored in the same format as
+  //       regular hashed wavelet octrees.
+  hashedMapHeaderToStream(
+      map, streamable::StorageFormat::kHashedWaveletOctree, ostream);
+
+  // Serialize all the map's blocks, one after the other
+  for (const auto& [block_index, block] : map.getBlocks()) {
+    blockToStream(map, block_index, block, ostream);
   }
+}
 
-  return true;
+void mapToStream(const HashedChunkedWaveletOctree& map, std::ostream& ostream,
+                 ThreadPool& thread_pool) {
+  mapToStreamWithBlockTable(map, ostream, &thread_pool, std::nullopt);
 }
 
-void mapToStream(const HashedChunkedWaveletOctree& map, std::ostream& ostream) {
-  // Define convenience types and constants
-  struct StackElement {
-    const OctreeIndex node_index;
-    const HashedChunkedWaveletOctreeBlock::NodeChunkType& chunk;
-    const FloatingPoint scale_coefficient;
-  };
-  constexpr FloatingPoint kNumericalNoise = 1e-3f;
-  const auto min_log_odds = map.getMinLogOdds() + kNumericalNoise;
-  const auto max_log_odds = map.getMaxLogOdds() - kNumericalNoise;
-  const auto tree_height = map.getTreeHeight();
-  const auto chunk_height = map.getChunkHeight();
+void mapToStream(const HashedChunkedWaveletOctree& map, std::ostream& ostream,
+                 FloatingPoint quantization_step) {
+  CHECK_GT(quantization_step, 0.f);
+  mapToStreamWithBlockTable(map, ostream, nullptr, quantization_step);
+}
 
-  // Indicate the map's data structure type
-  streamable::StorageFormat storage_format =
-      streamable::StorageFormat::kHashedWaveletOctree;
-  storage_format.write(ostream);
+void mapToStream(const HashedChunkedWaveletOctree& map, std::ostream& ostream,
+                 FloatingPoint quantization_step, ThreadPool& thread_pool) {
+  CHECK_GT(quantization_step, 0.f);
+  mapToStreamWithBlockTable(map, ostream, &thread_pool, quantization_step);
+}
 
-  // Serialize the map and data structure's metadata
-  streamable::HashedWaveletOctreeHeader hashed_wavelet_octree_header;
-  hashed_wavelet_octree_header.min_cell_width = map.getMinCellWidth();
-  hashed_wavelet_octree_header.min_log_odds = map.getMinLogOdds();
-  hashed_wavelet_octree_header.max_log_odds = map.getMaxLogOdds();
-  hashed_wavelet_octree_header.tree_height = map.getTreeHeight();
-  hashed_wavelet_octree_header.num_blocks = map.getBlocks().size();
-  hashed_wavelet_octree_header.write(ostream);
+bool streamToMap(std::istream& istream, HashedChunkedWaveletOctree::Ptr& map) {
+  return streamToMapImpl(istream, map, nullptr);
+}
 
-  // Iterate over all the map's blocks
-  for (const auto& [block_index, block] : map.getBlocks()) {
-    // Serialize the block's metadata
-    streamable::HashedWaveletOctreeBlockHeader block_header;
-    block_header.root_node_offset = {block_index.x(), block_index.y(),
-                                     block_index.z()};
-    // Wavelet scale coefficient of the block's root node
-    block_header.root_node_scale_coefficient = block.getRootScale();
-    block_header.write(ostream);
-
-    // Serialize the block's data (all nodes of its octree)
-    std::stack<StackElement> stack;
-    stack.emplace(StackElement{{tree_height, block_index},
-                               block.getRootChunk(),
-                               block.getRootScale()});
-    while (!stack.empty()) {
-      const OctreeIndex index = stack.top().node_index;
-      const FloatingPoint scale = stack.top().scale_coefficient;
-      const auto& chunk = stack.top().chunk;
-      stack.pop();
-
-      // Compute the node's index w.r.t. the data chunk that contains it
-      const MortonIndex morton_code = convert::nodeIndexToMorton(index);
-      const int chunk_top_height =
-          chunk_height * int_math::div_round_up(index.height, chunk_height);
-      const LinearIndex relative_node_index =
-          OctreeIndex::computeTreeTraversalDistance(
-              morton_code, chunk_top_height, index.height);
-
-      // Serialize the node's data
-      streamable::WaveletOctreeNode streamable_node;
-      const auto& node_data = chunk.nodeData(relative_node_index);
-      std::copy(node_data.begin(), node_data.end(),
-                streamable_node.detail_coefficients.begin());
-
-      // If the node has no children, continue
-      if (!chunk.nodeHasAtLeastOneChild(relative_node_index)) {
-        streamable_node.write(ostream);
-        continue;
-      }
+bool streamToMap(std::istream& istream, HashedChunkedWaveletOctree::Ptr& map,
+                 ThreadPool& thread_pool) {
+  return streamToMapImpl(istream, map, &thread_pool);
+}
 
-      // Otherwise, evaluate which of its children should be serialized
-      const auto child_scales =
-          HashedWaveletOctreeBlock::Transform::backward({scale, node_data});
-      // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
-      //       the nodes are popped from the stack in increasing order.
-      for (int relative_child_idx = OctreeIndex::kNumChildren - 1;
-           0 <= relative_child_idx; --relative_child_idx) {
-        // If the child is saturated, we don't need to store its descendants
-        const FloatingPoint child_scale = child_scales[relative_child_idx];
-        if (child_scale < min_log_odds || max_log_odds < child_scale) {
-          continue;
-        }
+void blockToBytes(const HashedWaveletOctree& map, const Index3D& block_index,
+                  const HashedWaveletOctreeBlock& block,
+                  std::vector<uint8_t>& bytes) {
+  blockToBytesImpl(map, block_index, block, std::nullopt, bytes);
+}
 
-        // Check if the child is no longer in the current chunk
-        const OctreeIndex child_index =
-            index.computeChildIndex(relative_child_idx);
-        if (child_index.height % chunk_height == 0) {
-          // If so, check if the chunk exists
-          const MortonIndex child_morton =
-              convert::nodeIndexToMorton(child_index);
-          const LinearIndex linear_child_index =
-              OctreeIndex::computeLevelTraversalDistance(
-                  child_morton, chunk_top_height, child_index.height);
-          if (chunk.hasChild(linear_child_index)) {
-            const auto& child_chunk = *chunk.getChild(linear_child_index);
-            // Indicate that the child will be serialized
-            // and add it to the stack
-            stack.emplace(StackElement{child_index, child_chunk, child_scale});
-            streamable_node.allocated_children_bitset +=
-                (1 << relative_child_idx);
-          }
-        } else {
-          // Indicate that the child will be serialized and add it to the stack
-          stack.emplace(StackElement{child_index, chunk, child_scale});
-          streamable_node.allocated_children_bitset +=
-              (1 << relative_child_idx);
-        }
-      }
-      streamable_node.write(ostream);
-    }
+void blockToBytes(const HashedWaveletOctree& map, const Index3D& block_index,
+                  const HashedWaveletOctreeBlock& block,
+                  FloatingPoint quantization_step,
+                  std::vector<uint8_t>& bytes) {
+  CHECK_GT(quantization_step, 0.f);
+  blockToBytesImpl(map, block_index, block, quantization_step, bytes);
+}
+
+void blockToBytes(const HashedChunkedWaveletOctree& map,
+                  const Index3D& block_index,
+                  const HashedChunkedWaveletOctreeBlock& block,
+                  std::vector<uint8_t>& bytes) {
+  blockToBytesImpl(map, block_index, block, std::nullopt, bytes);
+}
+
+void blockToBytes(const HashedChunkedWaveletOctree& map,
+                  const Index3D& block_index,
+                  const HashedChunkedWaveletOctreeBlock& block,
+                  FloatingPoint quantization_step,
+                  std::vector<uint8_t>& bytes) {
+  CHECK_GT(quantization_step, 0.f);
+  blockToBytesImpl(map, block_index, block, quantization_step, bytes);
+}
+
+bool bytesToBlockIndex(const char* data_begin, const char* data_end,
+                       Index3D& block_index) {
+  ByteRangeStreamBuffer block_buffer(data_begin, data_end);
+  std::istream block_istream(&block_buffer);
+  const auto block_header =
+      streamable::HashedWaveletOctreeBlockHeader::read(block_istream);
+  if (!block_istream) {
+    return false;
   }
+  block_index = {block_header.root_node_offset.x,
+                 block_header.root_node_offset.y,
+                 block_header.root_node_offset.z};
+  return true;
+}
+
+bool bytesToBlock(const char* data_begin, const char* data_end,
+                  HashedWaveletOctreeBlock& block) {
+  return bytesToBlockImpl(data_begin, data_end, block, std::nullopt);
+}
+
+bool bytesToBlock(const char* data_begin, const char* data_end,
+                  FloatingPoint quantization_step,
+                  HashedWaveletOctreeBlock& block) {
+  return bytesToBlockImpl(data_begin, data_end, block, quantization_step);
+}
+
+bool bytesToBlock(const char* data_begin, const char* data_end,
+                  HashedChunkedWaveletOctreeBlock& block) {
+  return bytesToBlockImpl(data_begin, data_end, block, std::nullopt);
+}
+
+bool bytesToBlock(const char* data_begin, const char* data_end,
+                  FloatingPoint quantization_step,
+                  HashedChunkedWaveletOctreeBlock& block) {
+  return bytesToBlockImpl(data_begin, data_end, block, quantization_step);
 }
 }  // namespace wavemap::io
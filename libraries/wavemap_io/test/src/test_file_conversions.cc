@@ -1,3 +1,8 @@
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include <wavemap/common.h>
 #include <wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h>
@@ -7,8 +12,10 @@
 #include <wavemap/test/config_generator.h>
 #include <wavemap/test/fixture_base.h>
 #include <wavemap/test/geometry_generator.h>
+#include <wavemap/utils/thread_pool.h>
 
 #include "wavemap_io/file_conversions.h"
+#include "wavemap_io/streamable_types.h"
 
 namespace wavemap {
 template <typename VolumetricDataStructureType>
@@ -43,36 +50,23 @@ TYPED_TEST(FileConversionsTest, MetadataPreservation) {
   ASSERT_EQ(map_base->getMaxLogOdds(), config.max_log_odds);
 
   // Serialize and deserialize
+  // NOTE: Passing in a map of the original type makes hashed chunked wavelet
+  //       octrees get loaded as such, instead of as hashed wavelet octrees.
   ASSERT_TRUE(io::mapToFile(*map_base, TestFixture::kTemporaryFilePath));
-  VolumetricDataStructureBase::Ptr map_base_round_trip;
+  VolumetricDataStructureBase::Ptr map_base_round_trip =
+      std::make_shared<TypeParam>(config);
   ASSERT_TRUE(
       io::fileToMap(TestFixture::kTemporaryFilePath, map_base_round_trip));
   ASSERT_TRUE(map_base_round_trip);
+  typename TypeParam::ConstPtr map_round_trip =
+      std::dynamic_pointer_cast<TypeParam>(map_base_round_trip);
+  ASSERT_TRUE(map_round_trip);
 
-  // TODO(victorr): Add option to deserialize into hashed chunked wavelet
-  //                octrees, instead of implicitly converting them to regular
-  //                hashed wavelet octrees.
-  if (std::is_same_v<TypeParam, HashedChunkedWaveletOctree>) {
-    HashedWaveletOctree::ConstPtr map_round_trip =
-        std::dynamic_pointer_cast<HashedWaveletOctree>(map_base_round_trip);
-    ASSERT_TRUE(map_round_trip);
-
-    // Check that the metadata still matches the original config
-    EXPECT_EQ(map_round_trip->getMinCellWidth(), config.min_cell_width);
-    EXPECT_EQ(map_round_trip->getMinLogOdds(), config.min_log_odds);
-    EXPECT_EQ(map_round_trip->getMaxLogOdds(), config.max_log_odds);
-    EXPECT_EQ(map_round_trip->getTreeHeight(), config.tree_height);
-  } else {
-    typename TypeParam::ConstPtr map_round_trip =
-        std::dynamic_pointer_cast<TypeParam>(map_base_round_trip);
-    ASSERT_TRUE(map_round_trip);
-
-    // Check that the metadata still matches the original config
-    EXPECT_EQ(map_round_trip->getMinCellWidth(), config.min_cell_width);
-    EXPECT_EQ(map_round_trip->getMinLogOdds(), config.min_log_odds);
-    EXPECT_EQ(map_round_trip->getMaxLogOdds(), config.max_log_odds);
-    EXPECT_EQ(map_round_trip->getTreeHeight(), config.tree_height);
-  }
+  // Check that the metadata still matches the original config
+  EXPECT_EQ(map_round_trip->getMinCellWidth(), config.min_cell_width);
+  EXPECT_EQ(map_round_trip->getMinLogOdds(), config.min_log_odds);
+  EXPECT_EQ(map_round_trip->getMaxLogOdds(), config.max_log_odds);
+  EXPECT_EQ(map_round_trip->getTreeHeight(), config.tree_height);
 }
 
 TYPED_TEST(FileConversionsTest, InsertionAndLeafVisitor) {
@@ -93,42 +87,314 @@ TYPED_TEST(FileConversionsTest, InsertionAndLeafVisitor) {
 
     // Serialize and deserialize
     ASSERT_TRUE(io::mapToFile(map_original, TestFixture::kTemporaryFilePath));
-    VolumetricDataStructureBase::Ptr map_base_round_trip;
+    VolumetricDataStructureBase::Ptr map_base_round_trip =
+        std::make_shared<TypeParam>(config);
     ASSERT_TRUE(
         io::fileToMap(TestFixture::kTemporaryFilePath, map_base_round_trip));
     ASSERT_TRUE(map_base_round_trip);
+    typename TypeParam::ConstPtr map_round_trip =
+        std::dynamic_pointer_cast<TypeParam>(map_base_round_trip);
+    ASSERT_TRUE(map_round_trip);
 
     // Check that both maps contain the same leaves
-    map_base_round_trip->forEachLeaf(
+    map_round_trip->forEachLeaf(
         [&map_original](const OctreeIndex& node_index,
                         FloatingPoint round_trip_value) {
           EXPECT_NEAR(round_trip_value, map_original.getCellValue(node_index),
                       TestFixture::kAcceptableReconstructionError);
         });
+    map_original.forEachLeaf([&map_round_trip](const OctreeIndex& node_index,
+                                               FloatingPoint original_value) {
+      EXPECT_NEAR(original_value, map_round_trip->getCellValue(node_index),
+                  TestFixture::kAcceptableReconstructionError);
+    });
+  }
+}
+
+TYPED_TEST(FileConversionsTest, ParallelEquivalence) {
+  ThreadPool thread_pool(4);
+  constexpr int kNumRepetitions = 3;
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    // Create a random map
+    const auto config =
+        ConfigGenerator::getRandomConfig<typename TypeParam::Config>();
+    TypeParam map_original(config);
+    const std::vector<Index3D> random_indices =
+        GeometryGenerator::getRandomIndexVector<3>(
+            1000u, 2000u, Index3D::Constant(-5000), Index3D::Constant(5000));
+    for (const Index3D& index : random_indices) {
+      const FloatingPoint update = TestFixture::getRandomUpdate();
+      map_original.addToCellValue(index, update);
+    }
+    map_original.prune();
+
+    // Serialize the map single-threaded and using the thread pool
+    const VolumetricDataStructureBase& map_base = map_original;
+    std::stringstream serial_stream;
+    ASSERT_TRUE(io::mapToStream(map_base, serial_stream));
+    std::stringstream parallel_stream;
+    ASSERT_TRUE(io::mapToStream(map_base, parallel_stream, thread_pool));
+    const std::string parallel_data = parallel_stream.str();
 
-    // TODO(victorr): Remove this special case once deserializing directly
-    //                into HashedChunkedWaveletOctrees is supported
-    if (std::is_same_v<TypeParam, HashedChunkedWaveletOctree>) {
-      HashedWaveletOctree::ConstPtr map_round_trip =
-          std::dynamic_pointer_cast<HashedWaveletOctree>(map_base_round_trip);
-      ASSERT_TRUE(map_round_trip);
+    // Deserialize the original format single-threaded, and the parallel
+    // format both single-threaded and using the thread pool
+    // NOTE: The original format is deserialized without specifying the map
+    //       type, s.t. hashed chunked wavelet octrees are loaded as regular
+    //       hashed wavelet octrees. The parallel format is loaded natively.
+    using SerialRoundTripType = std::conditional_t<
+        std::is_same_v<TypeParam, HashedChunkedWaveletOctree>,
+        HashedWaveletOctree, TypeParam>;
+    VolumetricDataStructureBase::Ptr serial_base;
+    ASSERT_TRUE(io::streamToMap(serial_stream, serial_base));
+    std::istringstream parallel_istream(parallel_data);
+    VolumetricDataStructureBase::Ptr parallel_base =
+        std::make_shared<TypeParam>(config);
+    ASSERT_TRUE(io::streamToMap(parallel_istream, parallel_base, thread_pool));
+    std::istringstream mixed_istream(parallel_data);
+    VolumetricDataStructureBase::Ptr mixed_base =
+        std::make_shared<TypeParam>(config);
+    ASSERT_TRUE(io::streamToMap(mixed_istream, mixed_base));
+    const auto serial_round_trip =
+        std::dynamic_pointer_cast<SerialRoundTripType>(serial_base);
+    const auto parallel_round_trip =
+        std::dynamic_pointer_cast<TypeParam>(parallel_base);
+    const auto mixed_round_trip =
+        std::dynamic_pointer_cast<TypeParam>(mixed_base);
+    ASSERT_TRUE(serial_round_trip);
+    ASSERT_TRUE(parallel_round_trip);
+    ASSERT_TRUE(mixed_round_trip);
 
-      map_original.forEachLeaf([&map_round_trip](const OctreeIndex& node_index,
-                                                 FloatingPoint original_value) {
-        EXPECT_NEAR(original_value, map_round_trip->getCellValue(node_index),
+    // Check that all deserialized maps are identical
+    EXPECT_EQ(mixed_round_trip->size(), parallel_round_trip->size());
+    serial_round_trip->forEachLeaf(
+        [&parallel_round_trip, &mixed_round_trip](
+            const OctreeIndex& node_index, FloatingPoint serial_value) {
+          EXPECT_NEAR(parallel_round_trip->getCellValue(node_index),
+                      serial_value, kEpsilon);
+          EXPECT_NEAR(mixed_round_trip->getCellValue(node_index), serial_value,
+                      kEpsilon);
+        });
+    parallel_round_trip->forEachLeaf(
+        [&serial_round_trip](const OctreeIndex& node_index,
+                             FloatingPoint parallel_value) {
+          EXPECT_NEAR(serial_round_trip->getCellValue(node_index),
+                      parallel_value, kEpsilon);
+        });
+  }
+}
+
+TYPED_TEST(FileConversionsTest, Compression) {
+  ThreadPool thread_pool(4);
+  constexpr FloatingPoint kQuantizationStep = 1e-4f;
+  constexpr int kNumRepetitions = 3;
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    // Create a random map
+    const auto config =
+        ConfigGenerator::getRandomConfig<typename TypeParam::Config>();
+    TypeParam map_original(config);
+    const std::vector<Index3D> random_indices =
+        GeometryGenerator::getRandomIndexVector<3>(
+            1000u, 2000u, Index3D::Constant(-5000), Index3D::Constant(5000));
+    for (const Index3D& index : random_indices) {
+      const FloatingPoint update = TestFixture::getRandomUpdate();
+      map_original.addToCellValue(index, update);
+    }
+    map_original.prune();
+
+    // Serialize the map with and without compression
+    const VolumetricDataStructureBase& map_base = map_original;
+    std::stringstream uncompressed_stream;
+    ASSERT_TRUE(io::mapToStream(map_base, uncompressed_stream, thread_pool));
+    std::stringstream serial_stream;
+    ASSERT_TRUE(io::mapToStream(map_base, serial_stream, kQuantizationStep));
+    std::stringstream parallel_stream;
+    ASSERT_TRUE(io::mapToStream(map_base, parallel_stream, kQuantizationStep,
+                                thread_pool));
+    EXPECT_EQ(serial_stream.str(), parallel_stream.str());
+    if constexpr (!std::is_same_v<TypeParam, WaveletOctree>) {
+      EXPECT_LT(serial_stream.str().size(), uncompressed_stream.str().size());
+    }
+
+    // Deserialize the compressed map
+    VolumetricDataStructureBase::Ptr map_base_round_trip =
+        std::make_shared<TypeParam>(config);
+    ASSERT_TRUE(io::streamToMap(parallel_stream, map_base_round_trip,
+                                thread_pool));
+    const auto map_round_trip =
+        std::dynamic_pointer_cast<TypeParam>(map_base_round_trip);
+    ASSERT_TRUE(map_round_trip);
+
+    // Check that the map was reconstructed up to the quantization error
+    map_original.forEachLeaf([&map_round_trip](const OctreeIndex& node_index,
+                                               FloatingPoint original_value) {
+      EXPECT_NEAR(original_value, map_round_trip->getCellValue(node_index),
+                  TestFixture::kAcceptableReconstructionError);
+    });
+  }
+}
+
+TYPED_TEST(FileConversionsTest, BlockBytesRoundTrip) {
+  if constexpr (std::is_same_v<TypeParam, WaveletOctree>) {
+    GTEST_SKIP() << "Only hashed maps are serialized block by block";
+  } else {
+    constexpr FloatingPoint kQuantizationStep = 1e-4f;
+    constexpr int kNumRepetitions = 3;
+    for (int i = 0; i < kNumRepetitions; ++i) {
+      // Create a random map
+      const auto config =
+          ConfigGenerator::getRandomConfig<typename TypeParam::Config>();
+      TypeParam map_original(config);
+      const std::vector<Index3D> random_indices =
+          GeometryGenerator::getRandomIndexVector<3>(
+              1000u, 2000u, Index3D::Constant(-5000), Index3D::Constant(5000));
+      for (const Index3D& index : random_indices) {
+        const FloatingPoint update = TestFixture::getRandomUpdate();
+        map_original.addToCellValue(index, update);
+      }
+      map_original.prune();
+
+      // Copy each block through its byte representation, with and without
+      // compression
+      TypeParam map_uncompressed(config);
+      TypeParam map_compressed(config);
+      std::vector<uint8_t> bytes;
+      for (const auto& [block_index, block] : map_original.getBlocks()) {
+        io::blockToBytes(map_original, block_index, block, bytes);
+        const auto* begin = reinterpret_cast<const char*>(bytes.data());
+        Index3D read_block_index;
+        ASSERT_TRUE(io::bytesToBlockIndex(begin, begin + bytes.size(),
+                                          read_block_index));
+        EXPECT_EQ(read_block_index, block_index);
+        ASSERT_TRUE(io::bytesToBlock(
+            begin, begin + bytes.size(),
+            map_uncompressed.getOrAllocateBlock(block_index)));
+
+        io::blockToBytes(map_original, block_index, block, kQuantizationStep,
+                         bytes);
+        begin = reinterpret_cast<const char*>(bytes.data());
+        ASSERT_TRUE(io::bytesToBlock(
+            begin, begin + bytes.size(), kQuantizationStep,
+            map_compressed.getOrAllocateBlock(block_index)));
+      }
+
+      // Check that the maps were reconstructed
+      map_original.forEachLeaf([&](const OctreeIndex& node_index,
+                                   FloatingPoint original_value) {
+        EXPECT_NEAR(original_value, map_uncompressed.getCellValue(node_index),
                     TestFixture::kAcceptableReconstructionError);
-      });
-    } else {
-      typename TypeParam::ConstPtr map_round_trip =
-          std::dynamic_pointer_cast<TypeParam>(map_base_round_trip);
-      ASSERT_TRUE(map_round_trip);
-
-      map_original.forEachLeaf([&map_round_trip](const OctreeIndex& node_index,
-                                                 FloatingPoint original_value) {
-        EXPECT_NEAR(original_value, map_round_trip->getCellValue(node_index),
+        EXPECT_NEAR(original_value, map_compressed.getCellValue(node_index),
                     TestFixture::kAcceptableReconstructionError);
       });
     }
   }
 }
+
+TEST(HashedFileConversionsTest, RejectUnsupportedTreeHeight) {
+  // Hashed wavelet octrees support taller trees than hashed chunked wavelet
+  // octrees, which they can therefore not always be loaded as
+  HashedWaveletOctreeConfig config;
+  config.tree_height =
+      HashedChunkedWaveletOctreeConfig::kMaxSupportedTreeHeight + 1;
+  HashedWaveletOctree map(config);
+  map.addToCellValue(Index3D::Zero(), 1.f);
+
+  constexpr auto kTemporaryFilePath = "/tmp/tmp_tree_height.wvmp";
+  ThreadPool thread_pool(2);
+  for (const bool use_block_table : {false, true}) {
+    ASSERT_TRUE(use_block_table
+                    ? io::mapToFile(map, kTemporaryFilePath, thread_pool)
+                    : io::mapToFile(map, kTemporaryFilePath));
+
+    // Loading the map as a hashed chunked wavelet octree should fail
+    // gracefully, leaving the map that was passed in untouched
+    auto chunked_map = std::make_shared<HashedChunkedWaveletOctree>(
+        HashedChunkedWaveletOctreeConfig{});
+    VolumetricDataStructureBase::Ptr map_base = chunked_map;
+    EXPECT_FALSE(io::fileToMap(kTemporaryFilePath, map_base));
+    EXPECT_EQ(map_base, chunked_map);
+
+    // Loading it as a regular hashed wavelet octree should still work
+    VolumetricDataStructureBase::Ptr map_loaded;
+    ASSERT_TRUE(io::fileToMap(kTemporaryFilePath, map_loaded));
+    EXPECT_EQ(map_loaded->getTreeHeight(), config.tree_height);
+  }
+}
+
+TEST(HashedFileConversionsTest, RejectCorruptedBlockTable) {
+  // Write the header of a map in the block table format, whose block count or
+  // block data size exceeds what the stream actually contains
+  const HashedWaveletOctreeConfig config;
+  auto write_header = [&config](std::ostream& ostream, uint64_t num_blocks) {
+    io::streamable::StorageFormat(
+        io::streamable::StorageFormat::kHashedWaveletOctreeWithBlockTable)
+        .write(ostream);
+    io::streamable::HashedWaveletOctreeHeader header;
+    header.min_cell_width = config.min_cell_width;
+    header.min_log_odds = config.min_log_odds;
+    header.max_log_odds = config.max_log_odds;
+    header.tree_height = config.tree_height;
+    header.num_blocks = num_blocks;
+    header.write(ostream);
+  };
+
+  // Loading either should fail gracefully, instead of attempting to allocate
+  // memory for all the blocks or block data
+  std::stringstream invalid_block_count_stream;
+  write_header(invalid_block_count_stream, uint64_t{1} << 50);
+  VolumetricDataStructureBase::Ptr map_base;
+  EXPECT_FALSE(io::streamToMap(invalid_block_count_stream, map_base));
+
+  std::stringstream invalid_block_offset_stream;
+  write_header(invalid_block_offset_stream, 1u);
+  io::streamable::HashedWaveletOctreeBlockTable block_table;
+  block_table.block_indices.emplace_back();
+  block_table.block_offsets = {0u, uint64_t{1} << 50};
+  block_table.write(invalid_block_offset_stream);
+  EXPECT_FALSE(io::streamToMap(invalid_block_offset_stream, map_base));
+
+  // Blocks that are listed multiple times should also be rejected, since they
+  // would otherwise be deserialized by concurrent tasks
+  HashedWaveletOctree map(config);
+  map.addToCellValue(Index3D::Zero(), 1.f);
+  const auto& [block_index, block] = *map.getBlocks().begin();
+  std::vector<uint8_t> block_bytes;
+  io::blockToBytes(map, block_index, block, block_bytes);
+  std::stringstream duplicate_block_stream;
+  write_header(duplicate_block_stream, 2u);
+  block_table.block_indices = {{block_index.x(), block_index.y(),
+                                block_index.z()},
+                               {block_index.x(), block_index.y(),
+                                block_index.z()}};
+  block_table.block_offsets = {0u, block_bytes.size(),
+                               2u * block_bytes.size()};
+  block_table.write(duplicate_block_stream);
+  for (int copy_idx = 0; copy_idx < 2; ++copy_idx) {
+    duplicate_block_stream.write(
+        reinterpret_cast<const char*>(block_bytes.data()),
+        static_cast<std::streamsize>(block_bytes.size()));
+  }
+  ThreadPool thread_pool(2);
+  EXPECT_FALSE(io::streamToMap(duplicate_block_stream, map_base, thread_pool));
+}
+
+TEST(HashedFileConversionsTest, RejectChildrenBelowLeafLevel) {
+  // Serialize a block with a branch that continues below the leaf level
+  const HashedChunkedWaveletOctreeConfig config;
+  std::stringstream block_stream;
+  io::streamable::HashedWaveletOctreeBlockHeader{}.write(block_stream);
+  io::streamable::WaveletOctreeNode node;
+  node.allocated_children_bitset = 1u;
+  for (int height = config.tree_height; 0 <= height; --height) {
+    node.write(block_stream);
+  }
+  node.allocated_children_bitset = 0u;
+  node.write(block_stream);
+  const std::string block_bytes = block_stream.str();
+
+  // Deserializing it should fail gracefully
+  HashedChunkedWaveletOctree map(config);
+  EXPECT_FALSE(io::bytesToBlock(block_bytes.data(),
+                                block_bytes.data() + block_bytes.size(),
+                                map.getOrAllocateBlock(Index3D::Zero())));
+}
 }  // namespace wavemap
@@ -0,0 +1,105 @@
+#include <memory>
+
+#include <gtest/gtest.h>
+#include <wavemap/common.h>
+#include <wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h>
+#include <wavemap/data_structure/volumetric/hashed_wavelet_octree.h>
+#include <wavemap/test/config_generator.h>
+#include <wavemap/test/fixture_base.h>
+#include <wavemap/test/geometry_generator.h>
+#include <wavemap/utils/thread_pool.h>
+
+#include "wavemap_io/file_conversions.h"
+#include "wavemap_io/mapped_hashed_wavelet_octree.h"
+
+namespace wavemap {
+template <typename VolumetricDataStructureType>
+class MappedHashedWaveletOctreeTest : public FixtureBase,
+                                      public GeometryGenerator,
+                                      public ConfigGenerator {
+ protected:
+  static constexpr auto kTemporaryFilePath = "/tmp/tmp_mapped.wvmp";
+
+  std::unique_ptr<VolumetricDataStructureType> getRandomMap() {
+    const auto config = ConfigGenerator::getRandomConfig<
+        typename VolumetricDataStructureType::Config>();
+    auto map = std::make_unique<VolumetricDataStructureType>(config);
+    const std::vector<Index3D> random_indices =
+        GeometryGenerator::getRandomIndexVector<3>(
+            1000u, 2000u, Index3D::Constant(-5000), Index3D::Constant(5000));
+    for (const Index3D& index : random_indices) {
+      map->addToCellValue(index, getRandomUpdate());
+    }
+    map->prune();
+    return map;
+  }
+};
+
+using HashedDataStructureTypes =
+    ::testing::Types<HashedWaveletOctree, HashedChunkedWaveletOctree>;
+TYPED_TEST_SUITE(MappedHashedWaveletOctreeTest, HashedDataStructureTypes, );
+
+TYPED_TEST(MappedHashedWaveletOctreeTest, Equivalence) {
+  ThreadPool thread_pool(2);
+  constexpr int kNumRepetitions = 3;
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    // Save a random map in the block table format
+    const auto map_original = TestFixture::getRandomMap();
+    ASSERT_TRUE(io::mapToFile(*map_original, TestFixture::kTemporaryFilePath,
+                              thread_pool));
+
+    // Load it regularly and through a memory mapping with a small cache
+    VolumetricDataStructureBase::Ptr map_base_loaded;
+    ASSERT_TRUE(
+        io::fileToMap(TestFixture::kTemporaryFilePath, map_base_loaded));
+    const auto map_loaded =
+        std::dynamic_pointer_cast<HashedWaveletOctree>(map_base_loaded);
+    ASSERT_TRUE(map_loaded);
+    const int max_num_resident_blocks = TestFixture::getRandomInteger(1, 8);
+    const auto map_mapped = io::MappedHashedWaveletOctree::open(
+        TestFixture::kTemporaryFilePath,
+        io::MappedHashedWaveletOctreeConfig{max_num_resident_blocks});
+    ASSERT_TRUE(map_mapped);
+
+    // Check that the metadata and blocks match
+    EXPECT_EQ(map_mapped->getMinCellWidth(), map_loaded->getMinCellWidth());
+    EXPECT_EQ(map_mapped->getMinLogOdds(), map_loaded->getMinLogOdds());
+    EXPECT_EQ(map_mapped->getMaxLogOdds(), map_loaded->getMaxLogOdds());
+    EXPECT_EQ(map_mapped->getTreeHeight(), map_loaded->getTreeHeight());
+    EXPECT_EQ(map_mapped->getNumBlocks(), map_loaded->getBlocks().size());
+    EXPECT_EQ(map_mapped->getNumResidentBlocks(), 0u);
+    for (const auto& [block_index, block] : map_loaded->getBlocks()) {
+      EXPECT_TRUE(map_mapped->hasBlock(block_index));
+    }
+
+    // Check that both maps contain the same values, including at the cells
+    // around each leaf s.t. unallocated blocks are covered too
+    const IndexElement tree_height = map_loaded->getTreeHeight();
+    map_loaded->forEachLeaf([&](const OctreeIndex& node_index,
+                                FloatingPoint loaded_value) {
+      EXPECT_NEAR(map_mapped->getCellValue(node_index), loaded_value,
+                  kEpsilon);
+      const IndexElement height = TestFixture::getRandomInteger(0, tree_height);
+      const auto random_index =
+          OctreeIndex{0, convert::nodeIndexToMinCornerIndex(node_index) +
+                             TestFixture::template getRandomIndex<3>(
+                                 Index3D::Constant(-100),
+                                 Index3D::Constant(100))}
+              .computeParentIndex(height);
+      EXPECT_NEAR(map_mapped->getCellValue(random_index),
+                  map_loaded->getCellValue(random_index), kEpsilon);
+    });
+    EXPECT_LE(map_mapped->getNumResidentBlocks(),
+              static_cast<size_t>(max_num_resident_blocks));
+  }
+}
+
+TYPED_TEST(MappedHashedWaveletOctreeTest, RejectOriginalFormat) {
+  // Maps saved without a thread pool have no block table and can therefore
+  // not be memory mapped
+  const auto map_original = TestFixture::getRandomMap();
+  ASSERT_TRUE(io::mapToFile(*map_original, TestFixture::kTemporaryFilePath));
+  EXPECT_FALSE(
+      io::MappedHashedWaveletOctree::open(TestFixture::kTemporaryFilePath));
+}
+}  // namespace wavemap
@@ -0,0 +1,403 @@
+#ifndef WAVEMAP_ROS_IMPL_MAP_MAINTENANCE_EXECUTOR_INL_H_
+#define WAVEMAP_ROS_IMPL_MAP_MAINTENANCE_EXECUTOR_INL_H_
+
+#include <algorithm>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <ros/serialization.h>
+#include <tracy/Tracy.hpp>
+#include <wavemap_msgs/Map.h>
+#include <wavemap_ros_conversions/map_msg_conversions.h>
+
+namespace wavemap {
+template <typename HashedMapT>
+MapMaintenanceExecutor<HashedMapT>::MapMaintenanceExecutor(
+    std::shared_ptr<HashedMapT> occupancy_map,
+    FloatingPoint thresholding_period, FloatingPoint pruning_period,
+    FloatingPoint publication_period, FloatingPoint pass_time_budget,
+    int max_num_blocks_per_msg, FloatingPoint map_msg_quantization_step,
+    bool map_msg_send_block_blobs, bool map_msg_send_subtree_deltas,
+    std::shared_ptr<MapStreamScheduler> map_stream_scheduler,
+    std::string world_frame, ros::Publisher map_pub)
+    : occupancy_map_(std::move(CHECK_NOTNULL(occupancy_map))),
+      pass_time_budget_(std::chrono::duration_cast<Duration>(
+          std::chrono::duration<FloatingPoint>(pass_time_budget))),
+      max_num_blocks_per_msg_(max_num_blocks_per_msg),
+      map_msg_quantization_step_(map_msg_quantization_step),
+      map_msg_send_block_blobs_(map_msg_send_block_blobs),
+      map_msg_send_subtree_deltas_(map_msg_send_subtree_deltas),
+      map_stream_scheduler_(std::move(CHECK_NOTNULL(map_stream_scheduler))),
+      world_frame_(std::move(world_frame)),
+      map_pub_(std::move(map_pub)) {
+  const Timestamp now = Time::now();
+  auto to_duration = [](FloatingPoint seconds) {
+    return std::chrono::duration_cast<Duration>(
+        std::chrono::duration<FloatingPoint>(seconds));
+  };
+  if (0.f < thresholding_period) {
+    auto& task = tasks_.emplace_back(
+        Task{TaskType::kThresholding, to_duration(thresholding_period)});
+    task.next_pass_time = now + task.period;
+  }
+  if (0.f < pruning_period) {
+    auto& task = tasks_.emplace_back(
+        Task{TaskType::kPruning, to_duration(pruning_period)});
+    task.next_pass_time = now + task.period;
+  }
+  // NOTE: The publication task is always added, s.t. publications can still
+  //       be requested explicitly if periodic publishing is disabled.
+  auto& publication_task = tasks_.emplace_back(
+      Task{TaskType::kPublication,
+           0.f < publication_period ? to_duration(publication_period)
+                                    : Duration::zero()});
+  if (0.f < publication_period) {
+    publication_task.next_pass_time = now + publication_task.period;
+  }
+
+  worker_ = std::thread([this]() { workerLoop(); });
+}
+
+template <typename HashedMapT>
+MapMaintenanceExecutor<HashedMapT>::~MapMaintenanceExecutor() {
+  {
+    auto lock = std::scoped_lock(request_mutex_);
+    terminate_ = true;
+  }
+  request_condition_.notify_all();
+  worker_.join();
+}
+
+template <typename HashedMapT>
+void MapMaintenanceExecutor<HashedMapT>::requestPublication(
+    bool republish_whole_map) {
+  {
+    auto lock = std::scoped_lock(request_mutex_);
+    publication_requested_ = true;
+    republish_whole_map_requested_ |= republish_whole_map;
+  }
+  request_condition_.notify_all();
+}
+
+template <typename HashedMapT>
+void MapMaintenanceExecutor<HashedMapT>::workerLoop() {
+  tracy::SetThreadName("map_maintenance");
+  while (true) {
+    // Select the task that has been waiting the longest
+    // NOTE: Tasks that yield after exceeding their time budget are rescheduled
+    //       immediately, but tasks that were already overdue go first.
+    auto next_task = std::min_element(
+        tasks_.begin(), tasks_.end(), [](const Task& lhs, const Task& rhs) {
+          return lhs.next_pass_time < rhs.next_pass_time;
+        });
+
+    // Wait until it is due, unless a publication is requested in the meantime
+    {
+      auto lock = std::unique_lock(request_mutex_);
+      auto is_ready = [this, next_task]() {
+        return terminate_ || publication_requested_ ||
+               next_task->next_pass_time <= Time::now();
+      };
+      if (next_task->next_pass_time == Timestamp::max()) {
+        request_condition_.wait(lock, is_ready);
+      } else {
+        request_condition_.wait_until(lock, next_task->next_pass_time,
+                                      is_ready);
+      }
+      if (terminate_) {
+        return;
+      }
+      if (publication_requested_) {
+        // Restart the publication task, s.t. it covers the requested blocks
+        auto& publication_task = tasks_.back();
+        publication_task.in_progress = false;
+        publication_task.next_pass_time = Time::now();
+        republish_whole_map_ |= republish_whole_map_requested_;
+        publication_requested_ = false;
+        republish_whole_map_requested_ = false;
+        continue;
+      }
+    }
+
+    // Run the next pass
+    Task& task = *next_task;
+    if (!task.in_progress) {
+      startCycle(task);
+    }
+    const Timestamp deadline = Time::now() + pass_time_budget_;
+    if (runPass(task, deadline)) {
+      task.in_progress = false;
+      task.pending_blocks.clear();
+      if (task.period == Duration::zero()) {
+        task.next_pass_time = Timestamp::max();
+      } else {
+        task.next_pass_time =
+            std::max(Time::now(), task.cycle_start_time + task.period);
+      }
+    } else {
+      task.next_pass_time = Time::now();
+    }
+  }
+}
+
+template <typename HashedMapT>
+void MapMaintenanceExecutor<HashedMapT>::startCycle(Task& task) {
+  ZoneScoped;
+  task.in_progress = true;
+  task.cycle_start_time = Time::now();
+  task.next_block_idx = 0u;
+  task.pending_blocks.clear();
+  auto blocks_lock = std::shared_lock(occupancy_map_->getBlocksMutex());
+  task.pending_blocks.reserve(occupancy_map_->getBlocks().size());
+  for (const auto& [block_index, block] : occupancy_map_->getBlocks()) {
+    task.pending_blocks.emplace_back(block_index);
+  }
+}
+
+template <typename HashedMapT>
+bool MapMaintenanceExecutor<HashedMapT>::runPass(Task& task,
+                                                 Timestamp deadline) {
+  switch (task.type) {
+    case TaskType::kThresholding:
+      return runThresholdingPass(task, deadline);
+    case TaskType::kPruning:
+      return runPruningPass(task, deadline);
+    case TaskType::kPublication:
+      return runPublicationPass(task, deadline);
+  }
+  return true;
+}
+
+template <typename HashedMapT>
+bool MapMaintenanceExecutor<HashedMapT>::runThresholdingPass(
+    Task& task, Timestamp deadline) {
+  ZoneScoped;
+  while (task.next_block_idx < task.pending_blocks.size()) {
+    if (deadline < Time::now()) {
+      return false;
+    }
+    const BlockIndex& block_index = task.pending_blocks[task.next_block_idx++];
+    // NOTE: The block map is only locked while processing a single block, s.t.
+    //       the integrators can allocate new blocks between our iterations.
+    auto blocks_lock = std::shared_lock(occupancy_map_->getBlocksMutex());
+    if (occupancy_map_->hasBlock(block_index)) {
+      auto& block = occupancy_map_->getBlock(block_index);
+      auto block_lock = std::scoped_lock(block.getMutex());
+      block.threshold();
+    }
+  }
+  return true;
+}
+
+template <typename HashedMapT>
+bool MapMaintenanceExecutor<HashedMapT>::runPruningPass(Task& task,
+                                                        Timestamp deadline) {
+  ZoneScoped;
+  const FloatingPoint only_prune_blocks_if_unused_for =
+      occupancy_map_->getConfig().only_prune_blocks_if_unused_for;
+
+  // Prune the blocks that have not been updated recently
+  bool cycle_complete = true;
+  std::vector<BlockIndex> empty_blocks;
+  while (task.next_block_idx < task.pending_blocks.size()) {
+    if (deadline < Time::now()) {
+      cycle_complete = false;
+      break;
+    }
+    const BlockIndex& block_index = task.pending_blocks[task.next_block_idx++];
+    auto blocks_lock = std::shared_lock(occupancy_map_->getBlocksMutex());
+    if (occupancy_map_->hasBlock(block_index)) {
+      auto& block = occupancy_map_->getBlock(block_index);
+      auto block_lock = std::scoped_lock(block.getMutex());
+      if (only_prune_blocks_if_unused_for < block.getTimeSinceLastUpdated()) {
+        block.prune();
+      }
+      if (block.empty()) {
+        empty_blocks.emplace_back(block_index);
+      }
+    }
+  }
+
+  // Remove the blocks that became empty
+  // NOTE: Removing blocks modifies the block map itself, which therefore has to
+  //       be locked exclusively. Integrators hold a shared lock while they
+  //       access blocks, so we check that the blocks are still empty first.
+  if (!empty_blocks.empty()) {
+    ZoneScopedN("removeEmptyBlocks");
+    auto blocks_lock = std::unique_lock(occupancy_map_->getBlocksMutex());
+    auto& blocks = occupancy_map_->getBlocks();
+    for (const BlockIndex& block_index : empty_blocks) {
+      if (auto it = blocks.find(block_index);
+          it != blocks.end() && it->second.empty()) {
+        blocks.erase(it);
+      }
+    }
+  }
+
+  return cycle_complete;
+}
+
+template <typename HashedMapT>
+bool MapMaintenanceExecutor<HashedMapT>::runPublicationPass(
+    Task& task, Timestamp deadline) {
+  ZoneScoped;
+  // Constants
+  constexpr FloatingPoint kNumericalNoise = 1e-3f;
+  const auto min_log_odds = occupancy_map_->getMinLogOdds() + kNumericalNoise;
+  const auto max_log_odds = occupancy_map_->getMaxLogOdds() - kNumericalNoise;
+
+  // Queue the blocks that changed since the previous publication cycle
+  // NOTE: Whole blocks are sent when the whole map is republished, since the
+  //       subscribers might not have the previous version of the blocks.
+  while (task.next_block_idx < task.pending_blocks.size()) {
+    if (deadline < Time::now()) {
+      return false;
+    }
+    const BlockIndex& block_index = task.pending_blocks[task.next_block_idx++];
+    auto blocks_lock = std::shared_lock(occupancy_map_->getBlocksMutex());
+    if (!occupancy_map_->hasBlock(block_index)) {
+      continue;
+    }
+    auto& block = occupancy_map_->getBlock(block_index);
+    auto block_lock = std::scoped_lock(block.getMutex());
+    if (republish_whole_map_) {
+      block.getDirtySubtrees().markAllDirty();
+      map_stream_scheduler_->enqueueBlock(block_index);
+    } else if (last_publication_cycle_start_time_ <
+               block.getLastUpdatedStamp()) {
+      map_stream_scheduler_->enqueueBlock(block_index);
+    }
+  }
+
+  // Publish the queued blocks, 'max_num_blocks_per_msg' at a time, until they
+  // were all sent or the bandwidth budget is used up
+  while (!map_stream_scheduler_->empty() &&
+         map_stream_scheduler_->hasBandwidthLeft(Time::now())) {
+    if (deadline < Time::now()) {
+      return false;
+    }
+
+    // Serialize the map's metadata
+    wavemap_msgs::Map map_msg;
+    map_msg.header.frame_id = world_frame_;
+    map_msg.header.stamp = ros::Time::now();
+    auto& msg = map_msg.hashed_wavelet_octree.emplace_back();
+    msg.min_cell_width = occupancy_map_->getMinCellWidth();
+    msg.min_log_odds = occupancy_map_->getMinLogOdds();
+    msg.max_log_odds = occupancy_map_->getMaxLogOdds();
+    msg.tree_height = occupancy_map_->getTreeHeight();
+    msg.quantization_step = map_msg_quantization_step_;
+
+    // Serialize the next batch of queued blocks
+    auto blocks_lock = std::shared_lock(occupancy_map_->getBlocksMutex());
+    int num_serialized_blocks = 0;
+    while (num_serialized_blocks < max_num_blocks_per_msg_) {
+      const auto queued_block = map_stream_scheduler_->popNextBlock();
+      if (!queued_block) {
+        break;
+      }
+      const auto& [block_index, termination_height] = queued_block.value();
+      if (!occupancy_map_->hasBlock(block_index)) {
+        map_stream_scheduler_->dropBlock(block_index);
+        continue;
+      }
+      auto& block = occupancy_map_->getBlock(block_index);
+      auto block_lock = std::scoped_lock(block.getMutex());
+      auto& dirty_subtrees = block.getDirtySubtrees();
+      if (termination_height == 0 && map_msg_send_subtree_deltas_ &&
+          !dirty_subtrees.any()) {
+        continue;
+      }
+      block.threshold();
+      ++num_serialized_blocks;
+      // NOTE: Coarse versions of blocks are always sent as node msgs, after
+      //       which the blocks are marked as fully dirty since the subscribers
+      //       do not have them at full resolution yet.
+      if (0 < termination_height) {
+        if constexpr (std::is_same_v<HashedMapT, HashedChunkedWaveletOctree>) {
+          convert::blockToRosMsg(block_index, block, min_log_odds,
+                                 max_log_odds, occupancy_map_->getTreeHeight(),
+                                 msg.blocks.emplace_back(), termination_height);
+        } else {
+          convert::blockToRosMsg(block_index, block, min_log_odds,
+                                 max_log_odds, msg.blocks.emplace_back(),
+                                 termination_height);
+        }
+        dirty_subtrees.markAllDirty();
+        continue;
+      }
+      if (map_msg_send_subtree_deltas_ &&
+          convert::sendAsSubtrees(dirty_subtrees)) {
+        for (LinearIndex subtree_idx = 0;
+             subtree_idx < DirtySubtreeMask::kNumSubtrees; ++subtree_idx) {
+          if (dirty_subtrees.isDirty(subtree_idx)) {
+            convert::subtreeToRosMsg(block_index, block, subtree_idx,
+                                     min_log_odds, max_log_odds,
+                                     msg.subtrees.emplace_back());
+          }
+        }
+      } else if (map_msg_send_block_blobs_) {
+        convert::blockToRosMsg(*occupancy_map_, block_index, block,
+                               map_msg_quantization_step_,
+                               msg.block_blobs.emplace_back());
+      } else if constexpr (std::is_same_v<HashedMapT,
+                                          HashedChunkedWaveletOctree>) {
+        convert::blockToRosMsg(block_index, block, min_log_odds, max_log_odds,
+                               occupancy_map_->getTreeHeight(),
+                               msg.blocks.emplace_back());
+      } else {
+        convert::blockToRosMsg(block_index, block, min_log_odds, max_log_odds,
+                               msg.blocks.emplace_back());
+      }
+      dirty_subtrees.clear();
+    }
+    if (num_serialized_blocks == 0) {
+      break;
+    }
+
+    // Indicate which blocks are allocated in the map
+    // NOTE: This is done such that subscribers know when blocks should be
+    //       removed during incremental map transmission.
+    msg.allocated_block_indices.reserve(occupancy_map_->getBlocks().size());
+    for (const auto& [block_index, _] : occupancy_map_->getBlocks()) {
+      auto& block_index_msg = msg.allocated_block_indices.emplace_back();
+      block_index_msg.x = block_index.x();
+      block_index_msg.y = block_index.y();
+      block_index_msg.z = block_index.z();
+    }
+    blocks_lock.unlock();
+
+    // Compress the blocks and subtrees' nodes if requested
+    if (0.f < map_msg_quantization_step_) {
+      for (auto& block_msg : msg.blocks) {
+        convert::compressBlockNodes(block_msg.nodes,
+                                    map_msg_quantization_step_,
+                                    block_msg.compressed_nodes);
+        block_msg.nodes.clear();
+      }
+      for (auto& subtree_msg : msg.subtrees) {
+        convert::compressBlockNodes(subtree_msg.nodes,
+                                    map_msg_quantization_step_,
+                                    subtree_msg.compressed_nodes);
+        subtree_msg.nodes.clear();
+      }
+    }
+
+    {
+      ZoneScopedN("publishMapRosMsg");
+      map_pub_.publish(map_msg);
+    }
+    map_stream_scheduler_->consumeBandwidth(
+        ros::serialization::serializationLength(map_msg));
+  }
+
+  // The cycle is complete
+  last_publication_cycle_start_time_ = task.cycle_start_time;
+  republish_whole_map_ = false;
+  return true;
+}
+}  // namespace wavemap
+
+#endif  // WAVEMAP_ROS_IMPL_MAP_MAINTENANCE_EXECUTOR_INL_H_
@@ -1,11 +1,11 @@
 #ifndef WAVEMAP_ROS_IMPL_WAVEMAP_SERVER_INL_H_
 #define WAVEMAP_ROS_IMPL_WAVEMAP_SERVER_INL_H_
 
-#include <functional>
+#include <type_traits>
 #include <unordered_set>
-#include <utility>
 #include <vector>
 
+#include <ros/serialization.h>
 #include <tracy/Tracy.hpp>
 #include <wavemap_msgs/Map.h>
 #include <wavemap_ros_conversions/map_msg_conversions.h>
@@ -14,46 +14,96 @@ namespace wavemap {
 template <typename HashedMapT>
 void WavemapServer::publishHashedMap(HashedMapT* hashed_map,
                                      bool republish_whole_map) {
-  // Find the blocks that changed since the last publication time
+  // Constants
+  constexpr FloatingPoint kNumericalNoise = 1e-3f;
+  const auto min_log_odds = hashed_map->getMinLogOdds() + kNumericalNoise;
+  const auto max_log_odds = hashed_map->getMaxLogOdds() - kNumericalNoise;
+
+  // Queue the blocks that changed since the last publication time
+  // NOTE: Whole blocks are sent when the whole map is republished, since
+  //       the subscribers might not have the previous version of the blocks.
   const Timestamp start_time = Time::now();
-  std::unordered_set<Index3D, Index3DHash> changed_blocks;
-  for (const auto& [block_idx, block] : hashed_map->getBlocks()) {
-    if (republish_whole_map ||
-        last_map_pub_time_ < block.getLastUpdatedStamp()) {
-      changed_blocks.emplace(block_idx);
+  for (auto& [block_idx, block] : hashed_map->getBlocks()) {
+    if (republish_whole_map) {
+      block.getDirtySubtrees().markAllDirty();
+      map_stream_scheduler_->enqueueBlock(block_idx);
+    } else if (last_map_pub_time_ < block.getLastUpdatedStamp()) {
+      map_stream_scheduler_->enqueueBlock(block_idx);
     }
   }
   last_map_pub_time_ = start_time;
 
-  // Publish the changed blocks, 'max_num_blocks_per_msg' at a time
-  while (!changed_blocks.empty()) {
+  // Publish the queued blocks, 'max_num_blocks_per_msg' at a time, until they
+  // were all sent or the bandwidth budget is used up
+  while (!map_stream_scheduler_->empty() &&
+         map_stream_scheduler_->hasBandwidthLeft(Time::now())) {
     // Prepare the blocks to publish in the current iteration
     std::unordered_set<Index3D, Index3DHash> blocks_to_publish;
+    std::vector<MapStreamScheduler::QueuedBlock> coarse_blocks_to_publish;
     int block_cnt = 0;
-    for (const auto& block_idx : changed_blocks) {
-      hashed_map->getBlock(block_idx).threshold();
-      blocks_to_publish.insert(block_idx);
-      if (config_.max_num_blocks_per_msg <= ++block_cnt) {
+    while (block_cnt < config_.max_num_blocks_per_msg) {
+      const auto queued_block = map_stream_scheduler_->popNextBlock();
+      if (!queued_block) {
         break;
       }
+      const Index3D& block_idx = queued_block->block_index;
+      if (!hashed_map->hasBlock(block_idx)) {
+        map_stream_scheduler_->dropBlock(block_idx);
+        continue;
+      }
+      auto& block = hashed_map->getBlock(block_idx);
+      block.threshold();
+      ++block_cnt;
+      if (queued_block->termination_height == 0) {
+        blocks_to_publish.insert(block_idx);
+      } else {
+        coarse_blocks_to_publish.emplace_back(queued_block.value());
+      }
+    }
+    if (block_cnt == 0) {
+      break;
     }
 
     // Serialize and publish the selected blocks
     wavemap_msgs::Map map_msg;
     map_msg.header.frame_id = config_.world_frame;
     map_msg.header.stamp = ros::Time::now();
-    convert::mapToRosMsg(*hashed_map,
-                         map_msg.hashed_wavelet_octree.emplace_back(),
-                         blocks_to_publish, thread_pool_);
+    auto& msg = map_msg.hashed_wavelet_octree.emplace_back();
+    convert::mapToRosMsg(*hashed_map, msg, blocks_to_publish, thread_pool_,
+                         config_.map_msg_quantization_step,
+                         config_.map_msg_send_block_blobs,
+                         config_.map_msg_send_subtree_deltas);
+    for (const auto& block_idx : blocks_to_publish) {
+      hashed_map->getBlock(block_idx).getDirtySubtrees().clear();
+    }
+    // NOTE: Coarse versions of blocks are always sent as node msgs. Since the
+    //       subscribers do not have the blocks at full resolution yet, they
+    //       are marked as fully dirty.
+    for (const auto& [block_idx, termination_height] :
+         coarse_blocks_to_publish) {
+      auto& block = hashed_map->getBlock(block_idx);
+      auto& block_msg = msg.blocks.emplace_back();
+      if constexpr (std::is_same_v<HashedMapT, HashedChunkedWaveletOctree>) {
+        convert::blockToRosMsg(block_idx, block, min_log_odds, max_log_odds,
+                               hashed_map->getTreeHeight(), block_msg,
+                               termination_height);
+      } else {
+        convert::blockToRosMsg(block_idx, block, min_log_odds, max_log_odds,
+                               block_msg, termination_height);
+      }
+      if (0.f < msg.quantization_step) {
+        convert::compressBlockNodes(block_msg.nodes, msg.quantization_step,
+                                    block_msg.compressed_nodes);
+        block_msg.nodes.clear();
+      }
+      block.getDirtySubtrees().markAllDirty();
+    }
     {
       ZoneScopedN("publishMapRosMsg");
       map_pub_.publish(map_msg);
     }
-
-    // Remove the published blocks from the publication queue
-    auto last_published_block = changed_blocks.begin();
-    std::advance(last_published_block, blocks_to_publish.size());
-    changed_blocks.erase(changed_blocks.begin(), last_published_block);
+    map_stream_scheduler_->consumeBandwidth(
+        ros::serialization::serializationLength(map_msg));
   }
 }
 }  // namespace wavemap
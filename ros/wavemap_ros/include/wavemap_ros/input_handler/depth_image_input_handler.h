@@ -1,6 +1,7 @@
 #ifndef WAVEMAP_ROS_INPUT_HANDLER_DEPTH_IMAGE_INPUT_HANDLER_H_
 #define WAVEMAP_ROS_INPUT_HANDLER_DEPTH_IMAGE_INPUT_HANDLER_H_
 
+#include <functional>
 #include <memory>
 #include <queue>
 #include <string>
@@ -9,6 +10,7 @@
 #include <image_transport/image_transport.h>
 #include <sensor_msgs/Image.h>
 #include <wavemap/data_structure/image.h>
+#include <wavemap/integrator/projective/pipelined_integrator.h>
 #include <wavemap/integrator/projective/projective_integrator.h>
 
 #include "wavemap_ros/input_handler/input_handler.h"
@@ -88,7 +90,8 @@ class DepthImageInputHandler : public InputHandler {
 
  private:
   const DepthImageInputHandlerConfig config_;
-  std::vector<ProjectiveIntegrator::Ptr> scanwise_integrators_;
+  std::vector<std::function<void(const PosedImage<>&)>>
+      range_image_integrators_;
 
   image_transport::Subscriber depth_image_sub_;
   std::queue<sensor_msgs::Image> depth_image_queue_;
@@ -68,6 +68,14 @@ class InputHandler {
 
   const std::string& getTopicName() { return config_.topic_name; }
 
+  // Wait until all measurements that were passed to the integrators have been
+  // integrated into the map
+  // NOTE: Only pipelined integrators update the map asynchronously.
+  void flushIntegrators();
+
+  // Whether all integrators only modify the map while holding its block locks
+  bool integratorsLockMapBlocks() const;
+
   bool shouldPublishReprojectedPointcloud() const {
     return !config_.reprojected_pointcloud_topic_name.empty() &&
            0 < reprojected_pointcloud_pub_.getNumSubscribers();
@@ -0,0 +1,127 @@
+#ifndef WAVEMAP_ROS_MAP_MAINTENANCE_EXECUTOR_H_
+#define WAVEMAP_ROS_MAP_MAINTENANCE_EXECUTOR_H_
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <glog/logging.h>
+#include <ros/ros.h>
+#include <wavemap/common.h>
+#include <wavemap/utils/time/time.h>
+
+#include "wavemap_ros/map_stream_scheduler.h"
+
+namespace wavemap {
+class MapMaintenanceExecutorBase {
+ public:
+  virtual ~MapMaintenanceExecutorBase() = default;
+
+  // Schedule a map publication as soon as possible
+  virtual void requestPublication(bool republish_whole_map) = 0;
+
+  // Lock the map exclusively, pausing both the maintenance executor and the
+  // integrators, e.g. to clear or save the whole map
+  virtual std::unique_lock<std::shared_mutex> lockMap() = 0;
+};
+
+/**
+ * Runs the thresholding, pruning and publishing of hashed maps on a dedicated
+ * background thread, such that these maintenance operations no longer block
+ * the ROS callback queue that is used for integration.
+ * The operations are processed incrementally, one block at a time. Each pass
+ * yields once its time budget is exceeded and resumes where it left off in the
+ * next pass, such that no operation starves the others. While a block is being
+ * processed, only that block is locked. This allows the integrators to keep
+ * updating all other blocks concurrently. Blocks that become empty are removed
+ * at the end of each pruning pass, with the whole block map briefly locked.
+ * Each publication cycle queues the blocks that changed in the stream
+ * scheduler, which determines in which order and at which resolution they are
+ * sent. Blocks that exceed its bandwidth budget are sent in later cycles.
+ */
+template <typename HashedMapT>
+class MapMaintenanceExecutor : public MapMaintenanceExecutorBase {
+ public:
+  using BlockIndex = typename HashedMapT::BlockIndex;
+  using Block = typename HashedMapT::Block;
+
+  // NOTE: Maintenance operations whose period is not positive are disabled.
+  MapMaintenanceExecutor(
+      std::shared_ptr<HashedMapT> occupancy_map,
+      FloatingPoint thresholding_period, FloatingPoint pruning_period,
+      FloatingPoint publication_period, FloatingPoint pass_time_budget,
+      int max_num_blocks_per_msg, FloatingPoint map_msg_quantization_step,
+      bool map_msg_send_block_blobs, bool map_msg_send_subtree_deltas,
+      std::shared_ptr<MapStreamScheduler> map_stream_scheduler,
+      std::string world_frame, ros::Publisher map_pub);
+  ~MapMaintenanceExecutor() override;
+
+  // Prevent copying etc. of this class
+  MapMaintenanceExecutor(const MapMaintenanceExecutor&) = delete;
+  MapMaintenanceExecutor& operator=(const MapMaintenanceExecutor&) = delete;
+
+  void requestPublication(bool republish_whole_map) override;
+  std::unique_lock<std::shared_mutex> lockMap() override {
+    return std::unique_lock(occupancy_map_->getBlocksMutex());
+  }
+
+ private:
+  enum class TaskType { kThresholding, kPruning, kPublication };
+  struct Task {
+    Task(TaskType type, Duration period) : type(type), period(period) {}
+
+    const TaskType type;
+    // Time between the start of consecutive cycles, or zero if the task
+    // only runs on request
+    const Duration period;
+
+    Timestamp next_pass_time = Timestamp::max();
+    // State of the current cycle, which can span multiple passes
+    bool in_progress = false;
+    Timestamp cycle_start_time;
+    std::vector<BlockIndex> pending_blocks;
+    size_t next_block_idx = 0u;
+  };
+
+  const std::shared_ptr<HashedMapT> occupancy_map_;
+  const Duration pass_time_budget_;
+  const int max_num_blocks_per_msg_;
+  const FloatingPoint map_msg_quantization_step_;
+  const bool map_msg_send_block_blobs_;
+  const bool map_msg_send_subtree_deltas_;
+  const std::shared_ptr<MapStreamScheduler> map_stream_scheduler_;
+  const std::string world_frame_;
+  ros::Publisher map_pub_;
+
+  std::vector<Task> tasks_;
+  Timestamp last_publication_cycle_start_time_;
+  bool republish_whole_map_ = true;
+
+  // Synchronization with the threads that request publications or terminate
+  std::mutex request_mutex_;
+  std::condition_variable request_condition_;
+  bool publication_requested_ = false;
+  bool republish_whole_map_requested_ = false;
+  bool terminate_ = false;
+
+  std::thread worker_;
+  void workerLoop();
+
+  void startCycle(Task& task);
+  // Process the task's pending blocks until the deadline is exceeded, returns
+  // true once the current cycle is complete
+  bool runPass(Task& task, Timestamp deadline);
+  bool runThresholdingPass(Task& task, Timestamp deadline);
+  bool runPruningPass(Task& task, Timestamp deadline);
+  bool runPublicationPass(Task& task, Timestamp deadline);
+};
+}  // namespace wavemap
+
+#include "wavemap_ros/impl/map_maintenance_executor_inl.h"
+
+#endif  // WAVEMAP_ROS_MAP_MAINTENANCE_EXECUTOR_H_
@@ -0,0 +1,121 @@
+#ifndef WAVEMAP_ROS_MAP_STREAM_SCHEDULER_H_
+#define WAVEMAP_ROS_MAP_STREAM_SCHEDULER_H_
+
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include <wavemap/common.h>
+#include <wavemap/indexing/index_hashes.h>
+#include <wavemap/utils/time/time.h>
+
+namespace wavemap {
+/**
+ * Decides in which order, at which resolution and how fast the blocks of
+ * hashed maps are streamed to subscribers.
+ * Changed blocks are queued and sent in order of their distance to the focus
+ * points, such as the robot's position or regions of interest requested by
+ * subscribers. Blocks that were never sent are first sent down to a coarse
+ * termination height, and then refined step by step once all queued blocks
+ * were sent at the coarser level. This way, subscribers quickly get a coarse
+ * map of their surroundings, even over links with little bandwidth. Blocks
+ * that change after they were sent are only resent at the finest resolution
+ * at which they were already sent, s.t. subscribers never receive a coarser
+ * copy of a block than the one they have.
+ * The bandwidth is limited with a token bucket. Once its budget is used up,
+ * the remaining blocks stay queued until the budget is refilled.
+ */
+class MapStreamScheduler {
+ public:
+  struct QueuedBlock {
+    Index3D block_index;
+    // Height of the finest cells of the block that should be sent
+    IndexElement termination_height;
+  };
+
+  // NOTE: Rate limiting is disabled if max_bytes_per_second is not positive,
+  //       and progressive refinement if initial_termination_height is zero.
+  MapStreamScheduler(FloatingPoint block_width,
+                     FloatingPoint max_bytes_per_second,
+                     FloatingPoint max_burst_bytes,
+                     IndexElement initial_termination_height,
+                     IndexElement refinement_step);
+
+  // Queue a block that changed, s.t. it is sent from coarse to fine
+  // NOTE: Blocks that are already queued keep their current termination height.
+  void enqueueBlock(const Index3D& block_index);
+  // Remove a block from the queue and forget up to which resolution it was
+  // sent, e.g. if it was removed from the map
+  void dropBlock(const Index3D& block_index);
+  void clear();
+
+  // Height of the finest cells at which the block was sent, if it was sent
+  std::optional<IndexElement> getFinestSentHeight(
+      const Index3D& block_index) const;
+
+  bool empty() const { return queued_blocks_.empty(); }
+  size_t size() const { return queued_blocks_.size(); }
+
+  // Get the highest priority block and remove it from the queue
+  // NOTE: The block is assumed to be sent at the returned termination height.
+  //       Blocks that are returned with a positive termination height are
+  //       queued again to be refined.
+  std::optional<QueuedBlock> popNextBlock();
+
+  // Set the points whose surroundings should be sent first
+  // NOTE: Unlike the other methods, this method can safely be called from any
+  //       thread. The new points are used from the next call to popNextBlock.
+  void setFocusPoints(std::vector<Point3D> focus_points);
+
+  // Whether part of the bandwidth budget is left, after refilling it for the
+  // time elapsed until the given time
+  bool hasBandwidthLeft(Timestamp now);
+  // Subtract the size of a sent message from the budget
+  // NOTE: The budget can go negative, s.t. messages can be sent whole and
+  //       the time until the budget is positive again makes up for it.
+  void consumeBandwidth(size_t num_bytes);
+
+ private:
+  const FloatingPoint block_width_;
+  const FloatingPoint max_bytes_per_second_;
+  const FloatingPoint max_burst_bytes_;
+  const IndexElement initial_termination_height_;
+  const IndexElement refinement_step_;
+
+  struct QueueEntry {
+    IndexElement termination_height;
+    FloatingPoint distance;
+    Index3D block_index;
+  };
+  // Blocks that are coarser go first, followed by the blocks that are closest
+  // to the focus points
+  struct HasLowerPriority {
+    bool operator()(const QueueEntry& lhs, const QueueEntry& rhs) const {
+      if (lhs.termination_height != rhs.termination_height) {
+        return lhs.termination_height < rhs.termination_height;
+      }
+      return rhs.distance < lhs.distance;
+    }
+  };
+  // NOTE: Entries are not removed from the priority queue when their block is
+  //       dropped or requeued, but skipped if they no longer match the
+  //       termination height stored in queued_blocks_.
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>, HasLowerPriority>
+      queue_;
+  std::unordered_map<Index3D, IndexElement, Index3DHash> queued_blocks_;
+  std::unordered_map<Index3D, IndexElement, Index3DHash> finest_sent_heights_;
+
+  std::vector<Point3D> focus_points_;
+  std::mutex new_focus_points_mutex_;
+  std::optional<std::vector<Point3D>> new_focus_points_;
+  FloatingPoint computeDistance(const Index3D& block_index) const;
+  void rebuildQueue();
+
+  FloatingPoint available_bytes_;
+  std::optional<Timestamp> last_refill_time_;
+};
+}  // namespace wavemap
+
+#endif  // WAVEMAP_ROS_MAP_STREAM_SCHEDULER_H_
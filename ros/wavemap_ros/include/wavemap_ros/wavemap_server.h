@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <filesystem>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -21,13 +22,16 @@
 #include <wavemap_ros/logging_level.h>
 
 #include "wavemap_ros/input_handler/input_handler.h"
+#include "wavemap_ros/map_maintenance_executor.h"
+#include "wavemap_ros/map_stream_scheduler.h"
 #include "wavemap_ros/tf_transformer.h"
 
 namespace wavemap {
 /**
  * Config struct for wavemap's ROS server.
  */
-struct WavemapServerConfig : ConfigBase<WavemapServerConfig, 8, LoggingLevel> {
+struct WavemapServerConfig
+    : ConfigBase<WavemapServerConfig, 17, LoggingLevel> {
   //! Name of the coordinate frame in which to store the map.
   //! Will be used as the frame_id for ROS TF lookups.
   std::string world_frame = "odom";
@@ -44,6 +48,44 @@ struct WavemapServerConfig : ConfigBase<WavemapServerConfig, 8, LoggingLevel> {
   //! Used to control the maximum message size. Only works in combination with
   //! hash-based map data structures.
   int max_num_blocks_per_msg = 1000;
+  //! Step to which the detail coefficients are quantized when compressing
+  //! wavemap map messages. Typically shrinks the messages several times, at
+  //! the cost of an error of at most half a step per coefficient.
+  //! To publish uncompressed messages, set it to zero.
+  //! Only works in combination with hash-based map data structures.
+  FloatingPoint map_msg_quantization_step = 0.f;
+  //! Whether to send each block as a single blob of bytes in the wavemap_io
+  //! block format, instead of as a list of node messages. Blobs are much
+  //! cheaper to (de)serialize, since ROS copies them with a single memcpy.
+  //! Only works in combination with hash-based map data structures.
+  bool map_msg_send_block_blobs = false;
+  //! Whether to only send the parts of blocks that changed since they were
+  //! last published, as long as most of the block did not change. Subscribers
+  //! then need to receive every map message to keep their map up to date, and
+  //! can otherwise resynchronize through the republish_whole_map service.
+  //! Only works in combination with hash-based map data structures.
+  bool map_msg_send_subtree_deltas = false;
+  //! Maximum average bandwidth used to publish the map, in bytes per second.
+  //! Blocks that do not fit in the budget stay queued until the next
+  //! publication. To publish without rate limiting, set it to zero.
+  //! Only works in combination with hash-based map data structures.
+  FloatingPoint map_msg_max_bytes_per_second = 0.f;
+  //! Height of the finest cells that are sent when a block is first
+  //! published. The block is then refined by map_msg_refinement_step levels
+  //! at a time, once all other queued blocks were sent at the current level.
+  //! To always publish blocks at full resolution, set it to zero.
+  //! Only works in combination with hash-based map data structures.
+  int map_msg_initial_termination_height = 0;
+  //! Number of levels by which the resolution of queued blocks is increased
+  //! per refinement step.
+  int map_msg_refinement_step = 2;
+  //! Frame whose position determines which blocks are published first, in
+  //! addition to the points received on the map_focus_point topic.
+  //! To prioritize blocks based on these points only, leave it empty.
+  std::string map_msg_focus_frame;
+  //! Time period controlling how often the position of map_msg_focus_frame is
+  //! updated.
+  Seconds<FloatingPoint> map_msg_focus_update_period = 1.f;
   //! Maximum number of threads to use.
   //! Defaults to the number of threads supported by the CPU.
   int num_threads =
@@ -52,6 +94,16 @@ struct WavemapServerConfig : ConfigBase<WavemapServerConfig, 8, LoggingLevel> {
   LoggingLevel logging_level = LoggingLevel::kInfo;
   //! Whether or not to allow resetting the map through the reset_map service.
   bool allow_reset_map_service = false;
+  //! Whether to threshold, prune and publish the map on a dedicated background
+  //! thread, instead of in the ROS callback queue used for integration.
+  //! Only works in combination with hash-based map data structures and
+  //! integrators that lock the map's blocks while updating them, which are the
+  //! hashed wavelet integrators and the ray tracing integrator.
+  bool run_maintenance_in_background = false;
+  //! Maximum time the background thread spends on a single maintenance pass.
+  //! Long operations, such as pruning large maps, are split over multiple
+  //! passes such that they do not delay the other maintenance operations.
+  Seconds<FloatingPoint> maintenance_pass_time_budget = 0.02f;
 
   static MemberMap memberMap;
 
@@ -64,6 +116,8 @@ class WavemapServer {
   WavemapServer(ros::NodeHandle nh, ros::NodeHandle nh_private,
                 const WavemapServerConfig& config);
 
+  void thresholdMap();
+  void pruneMap();
   void publishMap(bool republish_whole_map = false);
   bool saveMap(const std::filesystem::path& file_path) const;
   bool loadMap(const std::filesystem::path& file_path);
@@ -85,12 +139,33 @@ class WavemapServer {
   std::shared_ptr<ThreadPool> thread_pool_;
   std::vector<std::unique_ptr<InputHandler>> input_handlers_;
 
+  // Wait for the integrators that update the map asynchronously, s.t. the map
+  // can safely be accessed without going through its locks
+  void flushIntegrators() const;
+
   void subscribeToTimers(const ros::NodeHandle& nh);
+  void subscribeToMaintenanceTimers(const ros::NodeHandle& nh);
   ros::Timer map_pruning_timer_;
   ros::Timer map_thresholding_timer_;
   ros::Timer map_publication_timer_;
 
+  // Background thread that maintains hashed maps, used instead of the timers
+  // if config_.run_maintenance_in_background is enabled
+  // NOTE: The executor only locks the blocks it modifies, so it is only
+  //       started if all inputs' integrators lock the blocks they update.
+  bool inputsLockMapBlocks() const;
+  void startMaintenanceExecutor();
+  std::unique_ptr<MapMaintenanceExecutorBase> maintenance_executor_;
+
   void subscribeToTopics(ros::NodeHandle& nh);
+  ros::Subscriber map_focus_point_sub_;
+
+  // Prioritization and rate limiting of the published map blocks
+  void createMapStreamScheduler();
+  void updateMapStreamFocusPoints();
+  std::shared_ptr<MapStreamScheduler> map_stream_scheduler_;
+  std::optional<Point3D> requested_focus_point_;
+  ros::Timer map_focus_update_timer_;
 
   void advertiseTopics(ros::NodeHandle& nh_private);
   ros::Publisher map_pub_;
@@ -113,6 +188,9 @@ class WavemapServer {
   //       terms of packet loss, or when the change is so large that
   //       transmitting it as a single message would exceed the maximum ROS
   //       message size (1GB).
+  //       The changed blocks are queued in the map_stream_scheduler_, which
+  //       sends them in order of their distance to the focus points, from
+  //       coarse to fine, and without exceeding the configured bandwidth.
   template <typename HashedMapT>
   void publishHashedMap(HashedMapT* hashed_map,
                         bool republish_whole_map = false);
@@ -42,12 +42,24 @@ DepthImageInputHandler::DepthImageInputHandler(
       config_(config.checkValid()) {
   // Get pointers to the underlying scanwise integrators
   for (const auto& integrator : integrators_) {
-    auto scanwise_integrator =
-        std::dynamic_pointer_cast<ProjectiveIntegrator>(integrator);
-    CHECK(scanwise_integrator)
-        << "Depth image inputs are currently only supported in "
-           "combination with projective integrators.";
-    scanwise_integrators_.emplace_back(std::move(scanwise_integrator));
+    if (auto scanwise_integrator =
+            std::dynamic_pointer_cast<ProjectiveIntegrator>(integrator);
+        scanwise_integrator) {
+      range_image_integrators_.emplace_back(
+          [scanwise_integrator](const PosedImage<>& range_image) {
+            scanwise_integrator->integrateRangeImage(range_image);
+          });
+    } else if (auto pipelined_integrator =
+                   std::dynamic_pointer_cast<PipelinedIntegrator>(integrator);
+               pipelined_integrator) {
+      range_image_integrators_.emplace_back(
+          [pipelined_integrator](const PosedImage<>& range_image) {
+            pipelined_integrator->integrateRangeImage(range_image);
+          });
+    } else {
+      LOG(FATAL) << "Depth image inputs are currently only supported in "
+                    "combination with projective integrators.";
+    }
   }
 
   // Subscribe to the depth image input
@@ -109,8 +121,8 @@ void DepthImageInputHandler::processQueue() {
                      << " points. Remaining pointclouds in queue: "
                      << depth_image_queue_.size() - 1 << ".");
     integration_timer_.start();
-    for (const auto& integrator : scanwise_integrators_) {
-      integrator->integrateRangeImage(posed_range_image);
+    for (const auto& integrate_range_image : range_image_integrators_) {
+      integrate_range_image(posed_range_image);
     }
     integration_timer_.stop();
     ROS_DEBUG_STREAM("Integrated new depth image in "
@@ -143,8 +155,15 @@ void DepthImageInputHandler::processQueue() {
 PosedPointcloud<> DepthImageInputHandler::reproject(
     const PosedImage<>& posed_range_image) {
   ZoneScoped;
+  // NOTE: The stages of pipelined integrators all use the same projection
+  //       model settings, so we can reproject using the first stage's.
   auto projective_integrator =
       std::dynamic_pointer_cast<ProjectiveIntegrator>(integrators_.front());
+  if (auto pipelined_integrator =
+          std::dynamic_pointer_cast<PipelinedIntegrator>(integrators_.front());
+      pipelined_integrator) {
+    projective_integrator = pipelined_integrator->getStages().front();
+  }
   if (!projective_integrator) {
     return {};
   }
@@ -1,5 +1,7 @@
 #include "wavemap_ros/input_handler/input_handler.h"
 
+#include <algorithm>
+
 #include <cv_bridge/cv_bridge.h>
 #include <opencv2/core/eigen.hpp>
 #include <sensor_msgs/PointCloud.h>
@@ -7,6 +9,7 @@
 #include <sensor_msgs/point_cloud_conversion.h>
 #include <tracy/Tracy.hpp>
 #include <wavemap/integrator/integrator_factory.h>
+#include <wavemap/integrator/projective/pipelined_integrator.h>
 #include <wavemap/integrator/projective/projective_integrator.h>
 
 namespace wavemap {
@@ -79,6 +82,22 @@ InputHandler::InputHandler(const InputHandlerConfig& config,
   }
 }
 
+void InputHandler::flushIntegrators() {
+  for (const auto& integrator : integrators_) {
+    if (auto pipelined_integrator =
+            std::dynamic_pointer_cast<PipelinedIntegrator>(integrator);
+        pipelined_integrator) {
+      pipelined_integrator->flush();
+    }
+  }
+}
+
+bool InputHandler::integratorsLockMapBlocks() const {
+  return std::all_of(
+      integrators_.begin(), integrators_.end(),
+      [](const auto& integrator) { return integrator->locksMapBlocks(); });
+}
+
 void InputHandler::publishReprojectedPointcloud(
     const ros::Time& stamp, const PosedPointcloud<>& posed_pointcloud) {
   ZoneScoped;
@@ -0,0 +1,150 @@
+#include "wavemap_ros/map_stream_scheduler.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace wavemap {
+MapStreamScheduler::MapStreamScheduler(FloatingPoint block_width,
+                                       FloatingPoint max_bytes_per_second,
+                                       FloatingPoint max_burst_bytes,
+                                       IndexElement initial_termination_height,
+                                       IndexElement refinement_step)
+    : block_width_(block_width),
+      max_bytes_per_second_(max_bytes_per_second),
+      max_burst_bytes_(std::max(max_burst_bytes, max_bytes_per_second)),
+      initial_termination_height_(std::max(initial_termination_height, 0)),
+      refinement_step_(std::max(refinement_step, 1)),
+      available_bytes_(max_burst_bytes_) {}
+
+void MapStreamScheduler::enqueueBlock(const Index3D& block_index) {
+  // Only refine blocks progressively up to the resolution at which they were
+  // already sent, s.t. subscribers never receive a coarser version of a block
+  // than the one they already have
+  IndexElement termination_height = initial_termination_height_;
+  if (const auto it = finest_sent_heights_.find(block_index);
+      it != finest_sent_heights_.end()) {
+    termination_height = std::min(termination_height, it->second);
+  }
+  if (queued_blocks_.try_emplace(block_index, termination_height).second) {
+    queue_.emplace(QueueEntry{termination_height, computeDistance(block_index),
+                              block_index});
+  }
+}
+
+void MapStreamScheduler::dropBlock(const Index3D& block_index) {
+  queued_blocks_.erase(block_index);
+  finest_sent_heights_.erase(block_index);
+}
+
+void MapStreamScheduler::clear() {
+  queued_blocks_.clear();
+  finest_sent_heights_.clear();
+  queue_ = {};
+}
+
+std::optional<IndexElement> MapStreamScheduler::getFinestSentHeight(
+    const Index3D& block_index) const {
+  if (const auto it = finest_sent_heights_.find(block_index);
+      it != finest_sent_heights_.end()) {
+    return it->second;
+  }
+  return std::nullopt;
+}
+
+std::optional<MapStreamScheduler::QueuedBlock>
+MapStreamScheduler::popNextBlock() {
+  // Reprioritize the queue if the focus points changed
+  {
+    auto lock = std::scoped_lock(new_focus_points_mutex_);
+    if (new_focus_points_) {
+      focus_points_ = std::move(new_focus_points_.value());
+      new_focus_points_.reset();
+      rebuildQueue();
+    }
+  }
+
+  while (!queue_.empty()) {
+    const QueueEntry entry = queue_.top();
+    queue_.pop();
+
+    // Skip entries whose block was dropped or already popped at this level
+    auto it = queued_blocks_.find(entry.block_index);
+    if (it == queued_blocks_.end() ||
+        it->second != entry.termination_height) {
+      continue;
+    }
+
+    // Remember up to which resolution the block was sent
+    if (auto [sent_it, inserted] = finest_sent_heights_.try_emplace(
+            entry.block_index, entry.termination_height);
+        !inserted) {
+      sent_it->second = std::min(sent_it->second, entry.termination_height);
+    }
+
+    // Queue the block again at the next finer level, unless it is complete
+    if (0 < entry.termination_height) {
+      it->second = std::max(entry.termination_height - refinement_step_, 0);
+      queue_.emplace(
+          QueueEntry{it->second, entry.distance, entry.block_index});
+    } else {
+      queued_blocks_.erase(it);
+    }
+    return QueuedBlock{entry.block_index, entry.termination_height};
+  }
+  return std::nullopt;
+}
+
+void MapStreamScheduler::setFocusPoints(std::vector<Point3D> focus_points) {
+  auto lock = std::scoped_lock(new_focus_points_mutex_);
+  new_focus_points_ = std::move(focus_points);
+}
+
+bool MapStreamScheduler::hasBandwidthLeft(Timestamp now) {
+  if (max_bytes_per_second_ <= 0.f) {
+    return true;
+  }
+  if (last_refill_time_) {
+    const auto elapsed_time =
+        time::to_seconds<FloatingPoint>(now - last_refill_time_.value());
+    available_bytes_ =
+        std::min(available_bytes_ + elapsed_time * max_bytes_per_second_,
+                 max_burst_bytes_);
+  }
+  last_refill_time_ = now;
+  return 0.f < available_bytes_;
+}
+
+void MapStreamScheduler::consumeBandwidth(size_t num_bytes) {
+  if (0.f < max_bytes_per_second_) {
+    available_bytes_ -= static_cast<FloatingPoint>(num_bytes);
+  }
+}
+
+FloatingPoint MapStreamScheduler::computeDistance(
+    const Index3D& block_index) const {
+  if (focus_points_.empty()) {
+    return 0.f;
+  }
+  const Point3D block_center =
+      (block_index.cast<FloatingPoint>().array() + 0.5f) * block_width_;
+  FloatingPoint min_squared_distance =
+      std::numeric_limits<FloatingPoint>::max();
+  for (const Point3D& focus_point : focus_points_) {
+    min_squared_distance = std::min(
+        min_squared_distance, (focus_point - block_center).squaredNorm());
+  }
+  return min_squared_distance;
+}
+
+void MapStreamScheduler::rebuildQueue() {
+  // NOTE: Rebuilding the queue also discards the entries that were skipped.
+  std::vector<QueueEntry> entries;
+  entries.reserve(queued_blocks_.size());
+  for (const auto& [block_index, termination_height] : queued_blocks_) {
+    entries.emplace_back(QueueEntry{termination_height,
+                                    computeDistance(block_index), block_index});
+  }
+  queue_ = decltype(queue_)(HasLowerPriority{}, std::move(entries));
+}
+}  // namespace wavemap
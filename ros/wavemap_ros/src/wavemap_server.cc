@@ -1,5 +1,6 @@
 #include "wavemap_ros/wavemap_server.h"
 
+#include <geometry_msgs/PointStamped.h>
 #include <std_srvs/Empty.h>
 #include <std_srvs/Trigger.h>
 #include <tracy/Tracy.hpp>
@@ -19,16 +20,31 @@ DECLARE_CONFIG_MEMBERS(WavemapServerConfig,
                       (pruning_period)
                       (publication_period)
                       (max_num_blocks_per_msg)
+                      (map_msg_quantization_step)
+                      (map_msg_send_block_blobs)
+                      (map_msg_send_subtree_deltas)
+                      (map_msg_max_bytes_per_second)
+                      (map_msg_initial_termination_height)
+                      (map_msg_refinement_step)
+                      (map_msg_focus_frame)
+                      (map_msg_focus_update_period)
                       (num_threads)
                       (logging_level)
-                      (allow_reset_map_service));
+                      (allow_reset_map_service)
+                      (run_maintenance_in_background)
+                      (maintenance_pass_time_budget));
 
 bool WavemapServerConfig::isValid(bool verbose) const {
   bool all_valid = true;
 
   all_valid &= IS_PARAM_NE(world_frame, std::string(""), verbose);
   all_valid &= IS_PARAM_GT(max_num_blocks_per_msg, 0, verbose);
+  all_valid &= IS_PARAM_GE(map_msg_quantization_step, 0.f, verbose);
+  all_valid &= IS_PARAM_GE(map_msg_max_bytes_per_second, 0.f, verbose);
+  all_valid &= IS_PARAM_GE(map_msg_initial_termination_height, 0, verbose);
+  all_valid &= IS_PARAM_GT(map_msg_refinement_step, 0, verbose);
   all_valid &= IS_PARAM_GT(num_threads, 0, verbose);
+  all_valid &= IS_PARAM_GT(maintenance_pass_time_budget, 0.f, verbose);
 
   return all_valid;
 }
@@ -58,6 +74,7 @@ WavemapServer::WavemapServer(ros::NodeHandle nh, ros::NodeHandle nh_private,
   occupancy_map_ = VolumetricDataStructureFactory::create(
       data_structure_params, VolumetricDataStructureType::kHashedBlocks);
   CHECK_NOTNULL(occupancy_map_);
+  createMapStreamScheduler();
 
   // Setup thread pool
   ROS_INFO_STREAM("Creating thread pool with " << config_.num_threads
@@ -73,14 +90,55 @@ WavemapServer::WavemapServer(ros::NodeHandle nh, ros::NodeHandle nh_private,
   }
 
   // Connect to ROS
+  advertiseTopics(nh_private);
   subscribeToTimers(nh);
   subscribeToTopics(nh);
-  advertiseTopics(nh_private);
   advertiseServices(nh_private);
 }
 
+void WavemapServer::thresholdMap() {
+  ZoneScoped;
+  flushIntegrators();
+  // Use the thread pool for the map types that support it
+  if (auto* hashed_wavelet_octree =
+          dynamic_cast<HashedWaveletOctree*>(occupancy_map_.get());
+      hashed_wavelet_octree) {
+    hashed_wavelet_octree->threshold(*thread_pool_);
+  } else if (auto* hashed_chunked_wavelet_octree =
+                 dynamic_cast<HashedChunkedWaveletOctree*>(
+                     occupancy_map_.get());
+             hashed_chunked_wavelet_octree) {
+    hashed_chunked_wavelet_octree->threshold(*thread_pool_);
+  } else if (occupancy_map_) {
+    occupancy_map_->threshold();
+  }
+}
+
+void WavemapServer::pruneMap() {
+  ZoneScoped;
+  flushIntegrators();
+  // Use the thread pool for the map types that support it
+  if (auto* hashed_wavelet_octree =
+          dynamic_cast<HashedWaveletOctree*>(occupancy_map_.get());
+      hashed_wavelet_octree) {
+    hashed_wavelet_octree->pruneSmart(*thread_pool_);
+  } else if (auto* hashed_chunked_wavelet_octree =
+                 dynamic_cast<HashedChunkedWaveletOctree*>(
+                     occupancy_map_.get());
+             hashed_chunked_wavelet_octree) {
+    hashed_chunked_wavelet_octree->pruneSmart(*thread_pool_);
+  } else if (occupancy_map_) {
+    occupancy_map_->pruneSmart();
+  }
+}
+
 void WavemapServer::publishMap(bool republish_whole_map) {
   ZoneScoped;
+  if (maintenance_executor_) {
+    maintenance_executor_->requestPublication(republish_whole_map);
+    return;
+  }
+  flushIntegrators();
   if (occupancy_map_ && !occupancy_map_->empty()) {
     if (auto* hashed_wavelet_octree =
             dynamic_cast<HashedWaveletOctree*>(occupancy_map_.get());
@@ -104,8 +162,14 @@ void WavemapServer::publishMap(bool republish_whole_map) {
 
 bool WavemapServer::saveMap(const std::filesystem::path& file_path) const {
   if (occupancy_map_) {
+    // Make sure the map is not modified while it is being saved
+    flushIntegrators();
+    std::unique_lock<std::shared_mutex> map_lock;
+    if (maintenance_executor_) {
+      map_lock = maintenance_executor_->lockMap();
+    }
     occupancy_map_->threshold();
-    return io::mapToFile(*occupancy_map_, file_path);
+    return io::mapToFile(*occupancy_map_, file_path, *thread_pool_);
   } else {
     ROS_ERROR("Could not save map because it has not yet been allocated.");
   }
@@ -113,7 +177,19 @@ bool WavemapServer::saveMap(const std::filesystem::path& file_path) const {
 }
 
 bool WavemapServer::loadMap(const std::filesystem::path& file_path) {
-  return io::fileToMap(file_path, occupancy_map_);
+  // Stop maintaining the current map before it gets replaced
+  const bool restart_maintenance_executor = maintenance_executor_ != nullptr;
+  maintenance_executor_.reset();
+  flushIntegrators();
+  const bool success = io::fileToMap(file_path, occupancy_map_, *thread_pool_);
+  // The blocks queued for the previous map are no longer valid
+  if (occupancy_map_) {
+    createMapStreamScheduler();
+  }
+  if (restart_maintenance_executor) {
+    startMaintenanceExecutor();
+  }
+  return success;
 }
 
 InputHandler* WavemapServer::addInput(const param::Value& integrator_params,
@@ -122,19 +198,65 @@ InputHandler* WavemapServer::addInput(const param::Value& integrator_params,
   auto input_handler = InputHandlerFactory::create(
       integrator_params, config_.world_frame, occupancy_map_, transformer_,
       thread_pool_, nh, nh_private);
-  if (input_handler) {
-    return input_handlers_.emplace_back(std::move(input_handler)).get();
+  if (!input_handler) {
+    return nullptr;
+  }
+
+  // The background maintenance thread can only run alongside integrators that
+  // lock the map's blocks
+  if (maintenance_executor_ && !input_handler->integratorsLockMapBlocks()) {
+    ROS_WARN_STREAM("The integrators of input \""
+                    << input_handler->getTopicName()
+                    << "\" do not lock the map's blocks. Stopping background "
+                       "map maintenance and falling back to ROS timers.");
+    maintenance_executor_.reset();
+    subscribeToMaintenanceTimers(nh);
+  }
+  return input_handlers_.emplace_back(std::move(input_handler)).get();
+}
+
+void WavemapServer::flushIntegrators() const {
+  for (const auto& input_handler : input_handlers_) {
+    input_handler->flushIntegrators();
   }
-  return nullptr;
 }
 
 void WavemapServer::subscribeToTimers(const ros::NodeHandle& nh) {
+  if (!config_.map_msg_focus_frame.empty() &&
+      0.f < config_.map_msg_focus_update_period) {
+    ROS_INFO_STREAM("Registering map focus point update timer with period "
+                    << config_.map_msg_focus_update_period << "s");
+    map_focus_update_timer_ = nh.createTimer(
+        ros::Duration(config_.map_msg_focus_update_period),
+        [this](const auto& /*event*/) { updateMapStreamFocusPoints(); });
+  }
+
+  if (config_.run_maintenance_in_background) {
+    if (inputsLockMapBlocks()) {
+      startMaintenanceExecutor();
+      if (maintenance_executor_) {
+        return;
+      }
+      ROS_WARN(
+          "Background map maintenance is only supported for hash-based map "
+          "data structures. Falling back to ROS timers.");
+    } else {
+      ROS_WARN(
+          "Background map maintenance is only supported for integrators that "
+          "lock the map's blocks. Falling back to ROS timers.");
+    }
+  }
+
+  subscribeToMaintenanceTimers(nh);
+}
+
+void WavemapServer::subscribeToMaintenanceTimers(const ros::NodeHandle& nh) {
   if (0.f < config_.thresholding_period) {
     ROS_INFO_STREAM("Registering map thresholding timer with period "
                     << config_.thresholding_period << "s");
     map_thresholding_timer_ = nh.createTimer(
         ros::Duration(config_.thresholding_period),
-        [this](const auto& /*event*/) { occupancy_map_->threshold(); });
+        [this](const auto& /*event*/) { thresholdMap(); });
   }
 
   if (0.f < config_.pruning_period) {
@@ -142,7 +264,7 @@ void WavemapServer::subscribeToTimers(const ros::NodeHandle& nh) {
                     << config_.pruning_period << "s");
     map_pruning_timer_ = nh.createTimer(
         ros::Duration(config_.pruning_period),
-        [this](const auto& /*event*/) { occupancy_map_->pruneSmart(); });
+        [this](const auto& /*event*/) { pruneMap(); });
   }
 
   if (0.f < config_.publication_period) {
@@ -154,7 +276,99 @@ void WavemapServer::subscribeToTimers(const ros::NodeHandle& nh) {
   }
 }
 
-void WavemapServer::subscribeToTopics(ros::NodeHandle& /*nh*/) {}
+bool WavemapServer::inputsLockMapBlocks() const {
+  return std::all_of(input_handlers_.begin(), input_handlers_.end(),
+                     [](const auto& input_handler) {
+                       return input_handler->integratorsLockMapBlocks();
+                     });
+}
+
+void WavemapServer::startMaintenanceExecutor() {
+  maintenance_executor_.reset();
+  if (auto hashed_wavelet_octree =
+          std::dynamic_pointer_cast<HashedWaveletOctree>(occupancy_map_);
+      hashed_wavelet_octree) {
+    maintenance_executor_ =
+        std::make_unique<MapMaintenanceExecutor<HashedWaveletOctree>>(
+            hashed_wavelet_octree, config_.thresholding_period,
+            config_.pruning_period, config_.publication_period,
+            config_.maintenance_pass_time_budget,
+            config_.max_num_blocks_per_msg, config_.map_msg_quantization_step,
+            config_.map_msg_send_block_blobs,
+            config_.map_msg_send_subtree_deltas, map_stream_scheduler_,
+            config_.world_frame, map_pub_);
+  } else if (auto hashed_chunked_wavelet_octree =
+                 std::dynamic_pointer_cast<HashedChunkedWaveletOctree>(
+                     occupancy_map_);
+             hashed_chunked_wavelet_octree) {
+    maintenance_executor_ =
+        std::make_unique<MapMaintenanceExecutor<HashedChunkedWaveletOctree>>(
+            hashed_chunked_wavelet_octree, config_.thresholding_period,
+            config_.pruning_period, config_.publication_period,
+            config_.maintenance_pass_time_budget,
+            config_.max_num_blocks_per_msg, config_.map_msg_quantization_step,
+            config_.map_msg_send_block_blobs,
+            config_.map_msg_send_subtree_deltas, map_stream_scheduler_,
+            config_.world_frame, map_pub_);
+  }
+  if (maintenance_executor_) {
+    ROS_INFO("Started background map maintenance thread.");
+  }
+}
+
+void WavemapServer::subscribeToTopics(ros::NodeHandle& nh) {
+  map_focus_point_sub_ = nh.subscribe<geometry_msgs::PointStamped>(
+      "map_focus_point", 1, [this](const auto& point_msg) {
+        // Express the point in the map's frame
+        Point3D point{static_cast<FloatingPoint>(point_msg->point.x),
+                      static_cast<FloatingPoint>(point_msg->point.y),
+                      static_cast<FloatingPoint>(point_msg->point.z)};
+        if (point_msg->header.frame_id != config_.world_frame) {
+          Transformation3D T_W_F;
+          if (!transformer_->lookupLatestTransform(
+                  config_.world_frame, point_msg->header.frame_id, T_W_F)) {
+            ROS_WARN_STREAM("Could not look up the transform from frame \""
+                            << point_msg->header.frame_id << "\" to \""
+                            << config_.world_frame
+                            << "\". Ignoring map focus point.");
+            return;
+          }
+          point = T_W_F * point;
+        }
+        requested_focus_point_ = point;
+        updateMapStreamFocusPoints();
+      });
+}
+
+void WavemapServer::createMapStreamScheduler() {
+  // NOTE: The bandwidth budget can be saved up for one publication period,
+  //       s.t. the blocks of a whole period can be sent in one burst.
+  const FloatingPoint block_width = convert::heightToCellWidth(
+      occupancy_map_->getMinCellWidth(), occupancy_map_->getTreeHeight());
+  const FloatingPoint max_burst_bytes =
+      config_.map_msg_max_bytes_per_second *
+      std::max(static_cast<FloatingPoint>(config_.publication_period), 1.f);
+  map_stream_scheduler_ = std::make_shared<MapStreamScheduler>(
+      block_width, config_.map_msg_max_bytes_per_second, max_burst_bytes,
+      config_.map_msg_initial_termination_height,
+      config_.map_msg_refinement_step);
+  updateMapStreamFocusPoints();
+}
+
+void WavemapServer::updateMapStreamFocusPoints() {
+  std::vector<Point3D> focus_points;
+  if (!config_.map_msg_focus_frame.empty()) {
+    Transformation3D T_W_F;
+    if (transformer_->lookupLatestTransform(
+            config_.world_frame, config_.map_msg_focus_frame, T_W_F)) {
+      focus_points.emplace_back(T_W_F.getPosition());
+    }
+  }
+  if (requested_focus_point_) {
+    focus_points.emplace_back(requested_focus_point_.value());
+  }
+  map_stream_scheduler_->setFocusPoints(std::move(focus_points));
+}
 
 void WavemapServer::advertiseTopics(ros::NodeHandle& nh_private) {
   map_pub_ = nh_private.advertise<wavemap_msgs::Map>("map", 10);
@@ -175,6 +389,11 @@ void WavemapServer::advertiseServices(ros::NodeHandle& nh_private) {
         response.success = false;
         if (config_.allow_reset_map_service) {
           if (occupancy_map_) {
+            flushIntegrators();
+            std::unique_lock<std::shared_mutex> map_lock;
+            if (maintenance_executor_) {
+              map_lock = maintenance_executor_->lockMap();
+            }
             occupancy_map_->clear();
           }
           ROS_INFO("Map reset request was successfully executed.");
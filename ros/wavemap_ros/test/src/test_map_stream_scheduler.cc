@@ -0,0 +1,120 @@
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <wavemap/common.h>
+
+#include "wavemap_ros/map_stream_scheduler.h"
+
+namespace wavemap {
+class MapStreamSchedulerTest : public ::testing::Test {
+ protected:
+  static constexpr FloatingPoint kBlockWidth = 1.f;
+  static constexpr IndexElement kInitialTerminationHeight = 4;
+  static constexpr IndexElement kRefinementStep = 2;
+
+  static MapStreamScheduler createScheduler(
+      FloatingPoint max_bytes_per_second = 0.f,
+      FloatingPoint max_burst_bytes = 0.f) {
+    return {kBlockWidth, max_bytes_per_second, max_burst_bytes,
+            kInitialTerminationHeight, kRefinementStep};
+  }
+
+  // Pop all queued blocks, in the order in which they should be sent
+  static std::vector<MapStreamScheduler::QueuedBlock> popAllBlocks(
+      MapStreamScheduler& scheduler) {
+    std::vector<MapStreamScheduler::QueuedBlock> popped_blocks;
+    while (const auto queued_block = scheduler.popNextBlock()) {
+      popped_blocks.emplace_back(queued_block.value());
+    }
+    EXPECT_TRUE(scheduler.empty());
+    return popped_blocks;
+  }
+};
+
+TEST_F(MapStreamSchedulerTest, ProgressiveRefinement) {
+  // New blocks should be sent from coarse to fine, closest blocks first
+  auto scheduler = createScheduler();
+  scheduler.setFocusPoints({Point3D::Zero()});
+  const std::vector<Index3D> block_indices{
+      {5, 0, 0}, {0, 0, 0}, {-2, 0, 0}, {0, 9, 0}};
+  for (const Index3D& block_index : block_indices) {
+    scheduler.enqueueBlock(block_index);
+  }
+  const std::vector<Index3D> expected_order{
+      {0, 0, 0}, {-2, 0, 0}, {5, 0, 0}, {0, 9, 0}};
+  const auto popped_blocks = popAllBlocks(scheduler);
+  ASSERT_EQ(popped_blocks.size(), 3 * block_indices.size());
+  size_t popped_block_idx = 0;
+  for (const IndexElement termination_height : {4, 2, 0}) {
+    for (const Index3D& block_index : expected_order) {
+      const auto& popped_block = popped_blocks[popped_block_idx++];
+      EXPECT_EQ(popped_block.block_index, block_index);
+      EXPECT_EQ(popped_block.termination_height, termination_height);
+    }
+  }
+}
+
+TEST_F(MapStreamSchedulerTest, ResendAtSentResolution) {
+  auto scheduler = createScheduler();
+  const Index3D block_index{1, 2, 3};
+  EXPECT_FALSE(scheduler.getFinestSentHeight(block_index));
+
+  // Blocks that were already sent at full resolution should be resent at full
+  // resolution only, instead of being overwritten by coarser versions
+  scheduler.enqueueBlock(block_index);
+  EXPECT_EQ(popAllBlocks(scheduler).size(), 3u);
+  EXPECT_EQ(scheduler.getFinestSentHeight(block_index), 0);
+  scheduler.enqueueBlock(block_index);
+  auto popped_blocks = popAllBlocks(scheduler);
+  ASSERT_EQ(popped_blocks.size(), 1u);
+  EXPECT_EQ(popped_blocks.front().termination_height, 0);
+
+  // Blocks that changed while they were being refined should continue to be
+  // refined from the resolution at which they were last sent
+  const Index3D other_block_index{-1, 0, 0};
+  scheduler.enqueueBlock(other_block_index);
+  auto popped_block = scheduler.popNextBlock();
+  ASSERT_TRUE(popped_block);
+  EXPECT_EQ(popped_block->termination_height, 4);
+  scheduler.enqueueBlock(other_block_index);
+  popped_blocks = popAllBlocks(scheduler);
+  ASSERT_EQ(popped_blocks.size(), 2u);
+  EXPECT_EQ(popped_blocks[0].termination_height, 2);
+  EXPECT_EQ(popped_blocks[1].termination_height, 0);
+
+  // Blocks that were removed from the map should start over when they are
+  // allocated again, since the subscribers no longer have them
+  scheduler.dropBlock(block_index);
+  EXPECT_FALSE(scheduler.getFinestSentHeight(block_index));
+  scheduler.enqueueBlock(block_index);
+  popped_block = scheduler.popNextBlock();
+  ASSERT_TRUE(popped_block);
+  EXPECT_EQ(popped_block->termination_height, kInitialTerminationHeight);
+}
+
+TEST_F(MapStreamSchedulerTest, RateLimiting) {
+  // Without rate limiting, the bandwidth should never run out
+  auto unlimited_scheduler = createScheduler();
+  const Timestamp start_time = Time::now();
+  unlimited_scheduler.consumeBandwidth(1000000u);
+  EXPECT_TRUE(unlimited_scheduler.hasBandwidthLeft(start_time));
+
+  // Otherwise, the burst budget should be refilled at the configured rate
+  auto limited_scheduler = createScheduler(100.f, 200.f);
+  EXPECT_TRUE(limited_scheduler.hasBandwidthLeft(start_time));
+  limited_scheduler.consumeBandwidth(250u);
+  EXPECT_FALSE(limited_scheduler.hasBandwidthLeft(start_time));
+  EXPECT_FALSE(limited_scheduler.hasBandwidthLeft(
+      start_time + std::chrono::milliseconds(400)));
+  EXPECT_TRUE(limited_scheduler.hasBandwidthLeft(
+      start_time + std::chrono::milliseconds(600)));
+
+  // And it should not accumulate beyond the burst budget
+  limited_scheduler.consumeBandwidth(150u);
+  EXPECT_TRUE(limited_scheduler.hasBandwidthLeft(
+      start_time + std::chrono::seconds(100)));
+  limited_scheduler.consumeBandwidth(201u);
+  EXPECT_FALSE(limited_scheduler.hasBandwidthLeft(
+      start_time + std::chrono::seconds(100)));
+}
+}  // namespace wavemap
@@ -0,0 +1,120 @@
+#include <map>
+#include <memory>
+#include <utility>
+
+#include <benchmark/benchmark.h>
+#include <wavemap/common.h>
+#include <wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h>
+#include <wavemap/data_structure/volumetric/hashed_wavelet_octree.h>
+#include <wavemap/utils/random_number_generator.h>
+#include <wavemap/utils/thread_pool.h>
+#include <wavemap_msgs/HashedWaveletOctree.h>
+
+#include "wavemap_ros_conversions/map_msg_conversions.h"
+
+namespace wavemap {
+// Generate a map with surfaces in many blocks, and serialize it to a msg as
+// it would be sent when republishing the whole map
+const wavemap_msgs::HashedWaveletOctree& getMapMsg(
+    FloatingPoint quantization_step, bool send_block_blobs) {
+  static HashedWaveletOctree::Ptr map = []() {
+    constexpr int kNumUpdates = 1000000;
+    constexpr IndexElement kMapHalfWidth = 512;
+    RandomNumberGenerator random_number_generator;
+    HashedWaveletOctreeConfig map_config;
+    map_config.min_cell_width = 0.1f;
+    auto map = std::make_shared<HashedWaveletOctree>(map_config);
+    for (int update_idx = 0; update_idx < kNumUpdates; ++update_idx) {
+      // Mostly free space, with occupied cells on a few horizontal surfaces
+      Index3D index;
+      for (int dim_idx = 0; dim_idx < 3; ++dim_idx) {
+        index[dim_idx] = random_number_generator.getRandomInteger(
+            -kMapHalfWidth, kMapHalfWidth);
+      }
+      const bool on_surface = index.z() % 64 == 0;
+      map->addToCellValue(index, on_surface ? 0.8f : -0.4f);
+    }
+    map->threshold();
+    map->prune();
+    return map;
+  }();
+  static std::map<std::pair<FloatingPoint, bool>,
+                  wavemap_msgs::HashedWaveletOctree>
+      msgs;
+  const auto key = std::make_pair(quantization_step, send_block_blobs);
+  if (!msgs.count(key)) {
+    convert::mapToRosMsg(*map, msgs[key], std::nullopt,
+                         std::make_shared<ThreadPool>(), quantization_step,
+                         send_block_blobs);
+  }
+  return msgs[key];
+}
+
+size_t getNumBlocks(const wavemap_msgs::HashedWaveletOctree& msg) {
+  return msg.blocks.size() + msg.block_blobs.size();
+}
+
+// The first argument sets the number of threads to decode with, where zero
+// means the calling thread only, the second whether the msg is compressed and
+// the third whether its blocks are sent as blobs
+template <typename HashedMapT>
+void DecodeMapMsg(benchmark::State& state) {
+  const auto num_threads = static_cast<size_t>(state.range(0));
+  const FloatingPoint quantization_step = state.range(1) ? 1e-3f : 0.f;
+  const bool send_block_blobs = state.range(2);
+  const auto& msg = getMapMsg(quantization_step, send_block_blobs);
+  const auto thread_pool =
+      0u < num_threads ? std::make_shared<ThreadPool>(num_threads) : nullptr;
+  for (auto _ : state) {
+    typename HashedMapT::Ptr map;
+    convert::rosMsgToMap(msg, map, thread_pool);
+    benchmark::DoNotOptimize(map->getBlocks().size());
+  }
+  state.counters["blocks_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * getNumBlocks(msg)),
+      benchmark::Counter::kIsRate);
+}
+
+// Encode and decode a map msg, as done to transfer a map between two nodes
+template <typename HashedMapT>
+void RoundTripMapMsg(benchmark::State& state) {
+  const auto num_threads = static_cast<size_t>(state.range(0));
+  const FloatingPoint quantization_step = state.range(1) ? 1e-3f : 0.f;
+  const bool send_block_blobs = state.range(2);
+  const auto& original_msg = getMapMsg(quantization_step, send_block_blobs);
+  const auto thread_pool =
+      0u < num_threads ? std::make_shared<ThreadPool>(num_threads) : nullptr;
+  typename HashedMapT::Ptr original_map;
+  convert::rosMsgToMap(original_msg, original_map, thread_pool);
+  for (auto _ : state) {
+    wavemap_msgs::HashedWaveletOctree msg;
+    convert::mapToRosMsg(*original_map, msg, std::nullopt, thread_pool,
+                         quantization_step, send_block_blobs);
+    typename HashedMapT::Ptr map;
+    convert::rosMsgToMap(msg, map, thread_pool);
+    benchmark::DoNotOptimize(map->getBlocks().size());
+  }
+  state.counters["blocks_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * getNumBlocks(original_msg)),
+      benchmark::Counter::kIsRate);
+}
+
+BENCHMARK_TEMPLATE(DecodeMapMsg, HashedWaveletOctree)
+    ->ArgsProduct({{0, 2, 4, 8}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(DecodeMapMsg, HashedChunkedWaveletOctree)
+    ->ArgsProduct({{0, 2, 4, 8}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(RoundTripMapMsg, HashedWaveletOctree)
+    ->ArgsProduct({{0, 8}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(RoundTripMapMsg, HashedChunkedWaveletOctree)
+    ->ArgsProduct({{0, 8}, {0, 1}, {0, 1}})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+}  // namespace wavemap
+
+BENCHMARK_MAIN();
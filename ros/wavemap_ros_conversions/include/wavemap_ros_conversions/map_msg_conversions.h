@@ -7,6 +7,7 @@
 #include <string>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include <ros/time.h>
 #include <wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h>
@@ -17,11 +18,32 @@
 #include <wavemap_msgs/Map.h>
 
 namespace wavemap::convert {
+// NOTE: If quantization_step is positive, the nodes of hashed maps are sent in
+//       compressed form. Their detail coefficients are then quantized to
+//       multiples of quantization_step, which introduces an error of at most
+//       half a step per coefficient but typically shrinks the msg several
+//       times.
+// NOTE: If send_block_blobs is true, each block of hashed maps is sent as a
+//       single blob of bytes in the wavemap_io block format. Unlike node msgs,
+//       these blobs are (de)serialized by ROS with a single memcpy.
+// NOTE: If send_subtree_deltas is true, blocks of hashed maps of which only
+//       some subtrees changed since their dirty subtree flags were last
+//       cleared are sent as these subtrees only, while blocks that did not
+//       change are skipped. This assumes that the receiver already has the
+//       previous version of these blocks.
 bool mapToRosMsg(const VolumetricDataStructureBase& map,
                  const std::string& frame_id, const ros::Time& stamp,
-                 wavemap_msgs::Map& msg);
+                 wavemap_msgs::Map& msg, FloatingPoint quantization_step = 0.f,
+                 bool send_block_blobs = false);
+// Whether a block of which the given subtrees changed should be sent as these
+// subtrees, rather than as a whole
+bool sendAsSubtrees(const DirtySubtreeMask& dirty_subtrees);
+// NOTE: Hashed maps are decoded in parallel if a thread pool is provided.
+//       They are loaded as hashed chunked wavelet octrees if the map pointer
+//       already holds one, and as hashed wavelet octrees otherwise.
 bool rosMsgToMap(const wavemap_msgs::Map& msg,
-                 VolumetricDataStructureBase::Ptr& map);
+                 VolumetricDataStructureBase::Ptr& map,
+                 std::shared_ptr<ThreadPool> thread_pool = nullptr);
 
 void mapToRosMsg(const WaveletOctree& map, wavemap_msgs::WaveletOctree& msg);
 void rosMsgToMap(const wavemap_msgs::WaveletOctree& msg,
@@ -31,24 +53,91 @@ void mapToRosMsg(const HashedWaveletOctree& map,
                  wavemap_msgs::HashedWaveletOctree& msg,
                  std::optional<std::unordered_set<Index3D, Index3DHash>>
                      include_blocks = std::nullopt,
-                 std::shared_ptr<ThreadPool> thread_pool = nullptr);
+                 std::shared_ptr<ThreadPool> thread_pool = nullptr,
+                 FloatingPoint quantization_step = 0.f,
+                 bool send_block_blobs = false,
+                 bool send_subtree_deltas = false);
+// NOTE: If termination_height is positive, the block is only sent down to the
+//       resolution of that height, at which each cell's average value then
+//       approximates its subtree. It should be lower than the tree height.
 void blockToRosMsg(const HashedWaveletOctree::BlockIndex& block_index,
                    const HashedWaveletOctree::Block& block,
                    FloatingPoint min_log_odds, FloatingPoint max_log_odds,
-                   wavemap_msgs::HashedWaveletOctreeBlock& msg);
+                   wavemap_msgs::HashedWaveletOctreeBlock& msg,
+                   IndexElement termination_height = 0);
+void blockToRosMsg(const HashedWaveletOctree& map,
+                   const HashedWaveletOctree::BlockIndex& block_index,
+                   const HashedWaveletOctree::Block& block,
+                   FloatingPoint quantization_step,
+                   wavemap_msgs::HashedWaveletOctreeBlockBlob& msg);
+// Serialize one of the block's subtrees, indexed as in its DirtySubtreeMask
+void subtreeToRosMsg(const HashedWaveletOctree::BlockIndex& block_index,
+                     const HashedWaveletOctree::Block& block,
+                     LinearIndex subtree_idx, FloatingPoint min_log_odds,
+                     FloatingPoint max_log_odds,
+                     wavemap_msgs::HashedWaveletOctreeSubtree& msg);
 void rosMsgToMap(const wavemap_msgs::HashedWaveletOctree& msg,
-                 HashedWaveletOctree::Ptr& map);
+                 HashedWaveletOctree::Ptr& map,
+                 std::shared_ptr<ThreadPool> thread_pool = nullptr);
+// Deserialize a block msg into a newly allocated block, returns false if the
+// msg's nodes are invalid or truncated
+bool rosMsgToBlock(const wavemap_msgs::HashedWaveletOctreeBlock& msg,
+                   FloatingPoint quantization_step,
+                   HashedWaveletOctree::Block& block);
+bool rosMsgToBlock(const wavemap_msgs::HashedWaveletOctreeBlockBlob& msg,
+                   FloatingPoint quantization_step,
+                   HashedWaveletOctree::Block& block);
+// Replace one of the block's subtrees with the subtree in the msg, returns
+// false if the msg's subtree is not tracked by the block's DirtySubtreeMask or
+// its nodes are invalid or truncated
+bool rosMsgToSubtree(const wavemap_msgs::HashedWaveletOctreeSubtree& msg,
+                     FloatingPoint quantization_step,
+                     HashedWaveletOctree::Block& block);
 
 void mapToRosMsg(const HashedChunkedWaveletOctree& map,
                  wavemap_msgs::HashedWaveletOctree& msg,
                  std::optional<std::unordered_set<Index3D, Index3DHash>>
                      include_blocks = std::nullopt,
-                 std::shared_ptr<ThreadPool> thread_pool = nullptr);
+                 std::shared_ptr<ThreadPool> thread_pool = nullptr,
+                 FloatingPoint quantization_step = 0.f,
+                 bool send_block_blobs = false,
+                 bool send_subtree_deltas = false);
 void blockToRosMsg(const HashedChunkedWaveletOctree::BlockIndex& block_index,
                    const HashedChunkedWaveletOctree::Block& block,
                    FloatingPoint min_log_odds, FloatingPoint max_log_odds,
                    IndexElement tree_height,
-                   wavemap_msgs::HashedWaveletOctreeBlock& msg);
+                   wavemap_msgs::HashedWaveletOctreeBlock& msg,
+                   IndexElement termination_height = 0);
+void blockToRosMsg(const HashedChunkedWaveletOctree& map,
+                   const HashedChunkedWaveletOctree::BlockIndex& block_index,
+                   const HashedChunkedWaveletOctree::Block& block,
+                   FloatingPoint quantization_step,
+                   wavemap_msgs::HashedWaveletOctreeBlockBlob& msg);
+void subtreeToRosMsg(const HashedChunkedWaveletOctree::BlockIndex& block_index,
+                     const HashedChunkedWaveletOctree::Block& block,
+                     LinearIndex subtree_idx, FloatingPoint min_log_odds,
+                     FloatingPoint max_log_odds,
+                     wavemap_msgs::HashedWaveletOctreeSubtree& msg);
+void rosMsgToMap(const wavemap_msgs::HashedWaveletOctree& msg,
+                 HashedChunkedWaveletOctree::Ptr& map,
+                 std::shared_ptr<ThreadPool> thread_pool = nullptr);
+bool rosMsgToBlock(const wavemap_msgs::HashedWaveletOctreeBlock& msg,
+                   FloatingPoint quantization_step,
+                   HashedChunkedWaveletOctree::Block& block);
+bool rosMsgToBlock(const wavemap_msgs::HashedWaveletOctreeBlockBlob& msg,
+                   FloatingPoint quantization_step,
+                   HashedChunkedWaveletOctree::Block& block);
+bool rosMsgToSubtree(const wavemap_msgs::HashedWaveletOctreeSubtree& msg,
+                     FloatingPoint quantization_step,
+                     HashedChunkedWaveletOctree::Block& block);
+
+// Convert between the regular and compressed representation of a block's nodes
+void compressBlockNodes(
+    const std::vector<wavemap_msgs::WaveletOctreeNode>& nodes,
+    FloatingPoint quantization_step, std::vector<uint8_t>& compressed_nodes);
+bool decompressBlockNodes(const std::vector<uint8_t>& compressed_nodes,
+                          FloatingPoint quantization_step,
+                          std::vector<wavemap_msgs::WaveletOctreeNode>& nodes);
 }  // namespace wavemap::convert
 
 #endif  // WAVEMAP_ROS_CONVERSIONS_MAP_MSG_CONVERSIONS_H_
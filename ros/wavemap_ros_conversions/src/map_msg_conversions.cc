@@ -1,12 +1,421 @@
 #include "wavemap_ros_conversions/map_msg_conversions.h"
 
+#include <atomic>
+#include <functional>
+
 #include <ros/console.h>
 #include <tracy/Tracy.hpp>
+#include <wavemap/utils/bits/bit_operations.h>
+#include <wavemap/utils/compression/detail_coefficient_codec.h>
+#include <wavemap_io/stream_conversions.h>
 
 namespace wavemap::convert {
+namespace {
+template <typename HashedMapT>
+void rosMsgToHashedMap(const wavemap_msgs::HashedWaveletOctree& msg,
+                       std::shared_ptr<HashedMapT>& map,
+                       ThreadPool* thread_pool) {
+  // Deserialize the map's config and initialize the data structure
+  typename HashedMapT::Config config;
+  config.min_cell_width = msg.min_cell_width;
+  config.min_log_odds = msg.min_log_odds;
+  config.max_log_odds = msg.max_log_odds;
+  config.tree_height = msg.tree_height;
+
+  // Check if the map already exists and has compatible settings
+  if (map && map->getConfig() == config) {
+    // Load allocated block list into a hash table for quick membership lookups
+    std::unordered_set<Index3D, Index3DHash> allocated_blocks;
+    for (const auto& block_index : msg.allocated_block_indices) {
+      allocated_blocks.emplace(block_index.x, block_index.y, block_index.z);
+    }
+    // Remove local blocks that should no longer exist according to the map msg
+    for (auto it = map->getBlocks().begin(); it != map->getBlocks().end();) {
+      const auto block_index = it->first;
+      if (!allocated_blocks.count(block_index)) {
+        it = map->getBlocks().erase(it);
+      } else {
+        ++it;
+      }
+    }
+  } else {
+    // Otherwise create a new map
+    map = std::make_shared<HashedMapT>(config);
+  }
+
+  // Get the indices of the transferred blocks, which are stored in the headers
+  // of the blocks sent as blobs
+  // NOTE: The blocks sent as node msgs are indexed first, followed by the
+  //       blocks sent as blobs.
+  const size_t num_block_msgs = msg.blocks.size();
+  const size_t num_blocks = num_block_msgs + msg.block_blobs.size();
+  std::atomic<bool> all_blocks_valid = true;
+  std::vector<std::optional<Index3D>> block_indices(num_blocks);
+  for (size_t block_idx = 0; block_idx < num_block_msgs; ++block_idx) {
+    const auto& block_offset = msg.blocks[block_idx].root_node_offset;
+    block_indices[block_idx] =
+        Index3D{block_offset.x, block_offset.y, block_offset.z};
+  }
+  for (size_t block_idx = num_block_msgs; block_idx < num_blocks;
+       ++block_idx) {
+    const auto& data = msg.block_blobs[block_idx - num_block_msgs].data;
+    const auto* data_begin = reinterpret_cast<const char*>(data.data());
+    Index3D block_index;
+    if (io::bytesToBlockIndex(data_begin, data_begin + data.size(),
+                              block_index)) {
+      block_indices[block_idx] = block_index;
+    } else {
+      all_blocks_valid = false;
+    }
+  }
+
+  // Reset the transferred blocks and allocate them, serially, as this modifies
+  // the hash map itself
+  // NOTE: All blocks are removed before any is allocated, s.t. the pointers to
+  //       the allocated blocks remain valid.
+  for (const auto& block_index : block_indices) {
+    if (block_index) {
+      map->getBlocks().erase(block_index.value());
+    }
+  }
+  std::vector<typename HashedMapT::Block*> blocks(num_blocks, nullptr);
+  for (size_t block_idx = 0; block_idx < num_blocks; ++block_idx) {
+    // If the msg contains the same block multiple times, only load it once
+    const auto& block_index = block_indices[block_idx];
+    if (block_index && !map->hasBlock(block_index.value())) {
+      blocks[block_idx] = &map->getOrAllocateBlock(block_index.value());
+    }
+  }
+
+  // Deserialize the blocks, in parallel if a thread pool is available
+  ThreadPool::TaskGroup deserialization_tasks;
+  for (size_t block_idx = 0; block_idx < num_blocks; ++block_idx) {
+    if (!blocks[block_idx]) {
+      continue;
+    }
+    auto deserialize_block = [&msg, block_idx, num_block_msgs,
+                              block_ptr = blocks[block_idx],
+                              &all_blocks_valid]() {
+      const bool valid =
+          block_idx < num_block_msgs
+              ? rosMsgToBlock(msg.blocks[block_idx], msg.quantization_step,
+                              *block_ptr)
+              : rosMsgToBlock(msg.block_blobs[block_idx - num_block_msgs],
+                              msg.quantization_step, *block_ptr);
+      if (!valid) {
+        all_blocks_valid = false;
+      }
+    };
+    if (thread_pool) {
+      thread_pool->add_detached_task(
+          deserialization_tasks, std::move(deserialize_block));
+    } else {
+      deserialize_block();
+    }
+  }
+  if (thread_pool) {
+    thread_pool->wait_for(deserialization_tasks);
+  }
+
+  // Replace the changed subtrees of the blocks that were sent previously
+  for (const auto& subtree_msg : msg.subtrees) {
+    if (subtree_msg.root_node_height < 0 ||
+        msg.tree_height <= subtree_msg.root_node_height) {
+      all_blocks_valid = false;
+      continue;
+    }
+    const OctreeIndex subtree_index{
+        subtree_msg.root_node_height,
+        {subtree_msg.root_node_offset.x, subtree_msg.root_node_offset.y,
+         subtree_msg.root_node_offset.z}};
+    const Index3D block_index =
+        subtree_index.computeParentIndex(msg.tree_height).position;
+    auto& block = map->getOrAllocateBlock(block_index);
+    if (!rosMsgToSubtree(subtree_msg, msg.quantization_step, block)) {
+      all_blocks_valid = false;
+    }
+  }
+  if (!all_blocks_valid) {
+    ROS_WARN("Could not deserialize all blocks of the map msg. Data invalid.");
+  }
+}
+
+// Serialize the nodes of a (sub)tree in depth-first order, starting from its
+// root node and omitting the descendants of saturated nodes as well as the
+// nodes whose children would be finer than the termination height
+void treeToNodeMsgs(const HashedWaveletOctreeBlock::NodeType& root_node,
+                    IndexElement root_height, FloatingPoint root_scale,
+                    FloatingPoint min_log_odds, FloatingPoint max_log_odds,
+                    IndexElement termination_height,
+                    std::vector<wavemap_msgs::WaveletOctreeNode>& node_msgs) {
+  // Convenience type for elements on the stack used to iterate over the map
+  struct StackElement {
+    const IndexElement height;
+    const FloatingPoint scale;
+    const HashedWaveletOctreeBlock::NodeType& node;
+  };
+
+  std::stack<StackElement> stack;
+  stack.emplace(StackElement{root_height, root_scale, root_node});
+  while (!stack.empty()) {
+    const IndexElement height = stack.top().height;
+    const FloatingPoint scale = stack.top().scale;
+    const auto& node = stack.top().node;
+    stack.pop();
+
+    // Serialize the node's data
+    auto& node_msg = node_msgs.emplace_back();
+    std::copy(node.data().cbegin(), node.data().cend(),
+              node_msg.detail_coefficients.begin());
+    node_msg.allocated_children_bitset = 0;
+
+    // If the node's children are at the termination height, continue
+    if (height <= termination_height + 1) {
+      continue;
+    }
+
+    // Otherwise, evaluate which of its children should be serialized
+    const auto child_scales =
+        HashedWaveletOctreeBlock::Transform::backward({scale, node.data()});
+    // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
+    //       the nodes are popped from the stack in increasing order.
+    for (int relative_child_idx = OctreeIndex::kNumChildren - 1;
+         0 <= relative_child_idx; --relative_child_idx) {
+      // If the child is saturated, we don't need to store its descendants
+      const auto child_scale = child_scales[relative_child_idx];
+      if (child_scale < min_log_odds || max_log_odds < child_scale) {
+        continue;
+      }
+      // Otherwise, indicate that the child will be serialized
+      // and add it to the stack
+      const auto* child = node.getChild(relative_child_idx);
+      if (child) {
+        stack.emplace(StackElement{height - 1, child_scale, *child});
+        node_msg.allocated_children_bitset += (1 << relative_child_idx);
+      }
+    }
+  }
+}
+
+// Equivalent of treeToNodeMsgs for chunked trees, whose root node must be the
+// top node of the given chunk
+void chunkedTreeToNodeMsgs(
+    const OctreeIndex& root_node_index,
+    const HashedChunkedWaveletOctreeBlock::NodeChunkType& root_chunk,
+    FloatingPoint root_scale, FloatingPoint min_log_odds,
+    FloatingPoint max_log_odds, IndexElement termination_height,
+    std::vector<wavemap_msgs::WaveletOctreeNode>& node_msgs) {
+  // Define convenience types and constants
+  struct StackElement {
+    const OctreeIndex node_index;
+    const HashedChunkedWaveletOctreeBlock::NodeChunkType& chunk;
+    const IndexElement chunk_top_height;
+    const FloatingPoint scale_coefficient;
+  };
+  constexpr IndexElement kChunkHeight =
+      HashedChunkedWaveletOctreeBlock::kChunkHeight;
+
+  std::stack<StackElement> stack;
+  stack.emplace(StackElement{root_node_index, root_chunk,
+                             root_node_index.height, root_scale});
+  while (!stack.empty()) {
+    const OctreeIndex index = stack.top().node_index;
+    const auto& chunk = stack.top().chunk;
+    const IndexElement chunk_top_height = stack.top().chunk_top_height;
+    const FloatingPoint scale = stack.top().scale_coefficient;
+    stack.pop();
+
+    // Compute the node's index w.r.t. the data chunk that contains it
+    const MortonIndex morton_code = convert::nodeIndexToMorton(index);
+    const LinearIndex relative_node_index =
+        OctreeIndex::computeTreeTraversalDistance(morton_code, chunk_top_height,
+                                                  index.height);
+
+    // Serialize the node's data
+    auto& node_msg = node_msgs.emplace_back();
+    const auto& node_data = chunk.nodeData(relative_node_index);
+    std::copy(node_data.cbegin(), node_data.cend(),
+              node_msg.detail_coefficients.begin());
+    node_msg.allocated_children_bitset = 0;
+
+    // If the node has no children or they are at the termination height,
+    // continue
+    if (!chunk.nodeHasAtLeastOneChild(relative_node_index) ||
+        index.height <= termination_height + 1) {
+      continue;
+    }
+
+    // Otherwise, evaluate which of its children should be serialized
+    const auto child_scales =
+        HashedWaveletOctreeBlock::Transform::backward({scale, node_data});
+    // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
+    //       the nodes are popped from the stack in increasing order.
+    for (int relative_child_idx = OctreeIndex::kNumChildren - 1;
+         0 <= relative_child_idx; --relative_child_idx) {
+      // If the child is saturated, we don't need to store its descendants
+      const FloatingPoint child_scale = child_scales[relative_child_idx];
+      if (child_scale < min_log_odds || max_log_odds < child_scale) {
+        continue;
+      }
+
+      // Check if the child is no longer in the current chunk
+      const OctreeIndex child_index =
+          index.computeChildIndex(relative_child_idx);
+      if (child_index.height == chunk_top_height - kChunkHeight) {
+        // If so, check if the chunk exists
+        const MortonIndex child_morton =
+            convert::nodeIndexToMorton(child_index);
+        const LinearIndex linear_child_index =
+            OctreeIndex::computeLevelTraversalDistance(
+                child_morton, chunk_top_height, child_index.height);
+        if (chunk.hasChild(linear_child_index)) {
+          const auto& child_chunk = *chunk.getChild(linear_child_index);
+          // Indicate that the child will be serialized
+          // and add it to the stack
+          stack.emplace(StackElement{child_index, child_chunk,
+                                     child_index.height, child_scale});
+          node_msg.allocated_children_bitset += (1 << relative_child_idx);
+        }
+      } else {
+        // Indicate that the child will be serialized and add it to the stack
+        stack.emplace(
+            StackElement{child_index, chunk, chunk_top_height, child_scale});
+        node_msg.allocated_children_bitset += (1 << relative_child_idx);
+      }
+    }
+  }
+}
+
+// Deserialize nodes that were serialized with treeToNodeMsgs into the
+// (sub)tree below the given root node, returns false if they do not form a
+// complete tree
+bool nodeMsgsToTree(
+    const std::vector<wavemap_msgs::WaveletOctreeNode>& node_msgs,
+    HashedWaveletOctreeBlock::NodeType& root_node) {
+  std::stack<HashedWaveletOctreeBlock::NodeType*> stack;
+  stack.emplace(&root_node);
+  for (const auto& node_msg : node_msgs) {
+    if (stack.empty()) {
+      return false;
+    }
+    HashedWaveletOctreeBlock::NodeType* node = stack.top();
+    stack.pop();
+
+    // Deserialize the node's (wavelet) detail coefficients
+    auto& node_data = node->data();
+    std::copy_n(node_msg.detail_coefficients.cbegin(), node_data.size(),
+                node_data.begin());
+
+    // Evaluate which of the node's children are coming next
+    // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
+    //       the nodes are popped from the stack in increasing order.
+    for (int relative_child_idx = wavemap::OctreeIndex::kNumChildren - 1;
+         0 <= relative_child_idx; --relative_child_idx) {
+      const bool child_exists =
+          node_msg.allocated_children_bitset & (1 << relative_child_idx);
+      if (child_exists) {
+        stack.emplace(node->allocateChild(relative_child_idx));
+      }
+    }
+  }
+  return stack.empty();
+}
+
+// Equivalent of nodeMsgsToTree for chunked trees, whose root node is written
+// to the top node of the given chunk
+bool nodeMsgsToChunkedTree(
+    const std::vector<wavemap_msgs::WaveletOctreeNode>& node_msgs,
+    const OctreeIndex& root_node_index,
+    HashedChunkedWaveletOctreeBlock::NodeChunkType& root_chunk) {
+  // Define convenience types and constants
+  struct StackElement {
+    const OctreeIndex node_index;
+    HashedChunkedWaveletOctreeBlock::NodeChunkType& chunk;
+    const IndexElement chunk_top_height;
+  };
+  constexpr IndexElement kChunkHeight =
+      HashedChunkedWaveletOctreeBlock::kChunkHeight;
+
+  // Deserialize the nodes directly into the chunks that hold them
+  std::stack<StackElement> stack;
+  stack.emplace(
+      StackElement{root_node_index, root_chunk, root_node_index.height});
+  for (const auto& node_msg : node_msgs) {
+    if (stack.empty()) {
+      return false;
+    }
+    const OctreeIndex index = stack.top().node_index;
+    auto& chunk = stack.top().chunk;
+    const IndexElement chunk_top_height = stack.top().chunk_top_height;
+    stack.pop();
+
+    // Compute the node's index w.r.t. the data chunk that contains it
+    const MortonIndex morton_code = convert::nodeIndexToMorton(index);
+    const LinearIndex relative_node_index =
+        OctreeIndex::computeTreeTraversalDistance(morton_code, chunk_top_height,
+                                                  index.height);
+
+    // Deserialize the node's (wavelet) detail coefficients
+    auto& node_data = chunk.nodeData(relative_node_index);
+    std::copy_n(node_msg.detail_coefficients.cbegin(), node_data.size(),
+                node_data.begin());
+
+    // If the node has no children, continue
+    if (!node_msg.allocated_children_bitset) {
+      continue;
+    }
+    // Nodes at the leaf level cannot have children
+    if (index.height <= 0) {
+      return false;
+    }
+    chunk.nodeHasAtLeastOneChild(relative_node_index) = true;
+
+    // Otherwise, evaluate which of the node's children are coming next
+    // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
+    //       the nodes are popped from the stack in increasing order.
+    for (int relative_child_idx = OctreeIndex::kNumChildren - 1;
+         0 <= relative_child_idx; --relative_child_idx) {
+      const bool child_exists =
+          node_msg.allocated_children_bitset & (1 << relative_child_idx);
+      if (!child_exists) {
+        continue;
+      }
+      // If the child starts a new chunk, allocate it
+      const OctreeIndex child_index =
+          index.computeChildIndex(relative_child_idx);
+      if (child_index.height == chunk_top_height - kChunkHeight) {
+        const MortonIndex child_morton =
+            convert::nodeIndexToMorton(child_index);
+        const LinearIndex linear_child_index =
+            OctreeIndex::computeLevelTraversalDistance(
+                child_morton, chunk_top_height, child_index.height);
+        auto* child_chunk = chunk.allocateChild(linear_child_index);
+        stack.emplace(
+            StackElement{child_index, *child_chunk, child_index.height});
+      } else {
+        stack.emplace(StackElement{child_index, chunk, chunk_top_height});
+      }
+    }
+  }
+  return stack.empty();
+}
+
+template <typename BlockT>
+bool blobMsgToBlock(const wavemap_msgs::HashedWaveletOctreeBlockBlob& msg,
+                    FloatingPoint quantization_step, BlockT& block) {
+  const auto* data_begin = reinterpret_cast<const char*>(msg.data.data());
+  const auto* data_end = data_begin + msg.data.size();
+  if (0.f < quantization_step) {
+    return io::bytesToBlock(data_begin, data_end, quantization_step, block);
+  }
+  return io::bytesToBlock(data_begin, data_end, block);
+}
+}  // namespace
+
 bool mapToRosMsg(const VolumetricDataStructureBase& map,
                  const std::string& frame_id, const ros::Time& stamp,
-                 wavemap_msgs::Map& msg) {
+                 wavemap_msgs::Map& msg, FloatingPoint quantization_step,
+                 bool send_block_blobs) {
   // Write the msg header
   msg.header.stamp = stamp;
   msg.header.frame_id = frame_id;
@@ -21,14 +430,18 @@ bool mapToRosMsg(const VolumetricDataStructureBase& map,
           dynamic_cast<const HashedWaveletOctree*>(&map);
       hashed_wavelet_octree) {
     convert::mapToRosMsg(*hashed_wavelet_octree,
-                         msg.hashed_wavelet_octree.emplace_back());
+                         msg.hashed_wavelet_octree.emplace_back(),
+                         std::nullopt, nullptr, quantization_step,
+                         send_block_blobs);
     return true;
   }
   if (const auto* hashed_chunked_wavelet_octree =
           dynamic_cast<const HashedChunkedWaveletOctree*>(&map);
       hashed_chunked_wavelet_octree) {
     convert::mapToRosMsg(*hashed_chunked_wavelet_octree,
-                         msg.hashed_wavelet_octree.emplace_back());
+                         msg.hashed_wavelet_octree.emplace_back(),
+                         std::nullopt, nullptr, quantization_step,
+                         send_block_blobs);
     return true;
   }
 
@@ -38,8 +451,16 @@ bool mapToRosMsg(const VolumetricDataStructureBase& map,
   return false;
 }
 
+bool sendAsSubtrees(const DirtySubtreeMask& dirty_subtrees) {
+  // NOTE: Sending the changed subtrees saves bandwidth as long as a fair share
+  //       of the block's subtrees did not change.
+  return dirty_subtrees.tracksSubtrees() &&
+         dirty_subtrees.count() <= DirtySubtreeMask::kNumSubtrees / 2;
+}
+
 bool rosMsgToMap(const wavemap_msgs::Map& msg,
-                 VolumetricDataStructureBase::Ptr& map) {
+                 VolumetricDataStructureBase::Ptr& map,
+                 std::shared_ptr<ThreadPool> thread_pool) {
   ZoneScoped;
   // Check validity
   if ((msg.wavelet_octree.size() == 1) !=
@@ -59,9 +480,21 @@ bool rosMsgToMap(const wavemap_msgs::Map& msg,
     return true;
   }
   if (!msg.hashed_wavelet_octree.empty()) {
+    // Hashed chunked wavelet octrees are sent in the same format as regular
+    // hashed wavelet octrees. Load the map as a chunked octree if that is the
+    // type of the map that was passed in.
+    if (auto hashed_chunked_wavelet_octree =
+            std::dynamic_pointer_cast<HashedChunkedWaveletOctree>(map);
+        hashed_chunked_wavelet_octree) {
+      rosMsgToMap(msg.hashed_wavelet_octree.front(),
+                  hashed_chunked_wavelet_octree, thread_pool);
+      map = hashed_chunked_wavelet_octree;
+      return true;
+    }
     auto hashed_wavelet_octree =
         std::dynamic_pointer_cast<HashedWaveletOctree>(map);
-    rosMsgToMap(msg.hashed_wavelet_octree.front(), hashed_wavelet_octree);
+    rosMsgToMap(msg.hashed_wavelet_octree.front(), hashed_wavelet_octree,
+                thread_pool);
     map = hashed_wavelet_octree;
     return true;
   }
@@ -150,7 +583,8 @@ void rosMsgToMap(const wavemap_msgs::WaveletOctree& msg,
 void mapToRosMsg(
     const HashedWaveletOctree& map, wavemap_msgs::HashedWaveletOctree& msg,
     std::optional<std::unordered_set<Index3D, Index3DHash>> include_blocks,
-    std::shared_ptr<ThreadPool> thread_pool) {
+    std::shared_ptr<ThreadPool> thread_pool, FloatingPoint quantization_step,
+    bool send_block_blobs, bool send_subtree_deltas) {
   ZoneScoped;
   // Constants
   constexpr FloatingPoint kNumericalNoise = 1e-3f;
@@ -162,6 +596,7 @@ void mapToRosMsg(
   msg.min_log_odds = map.getMinLogOdds();
   msg.max_log_odds = map.getMaxLogOdds();
   msg.tree_height = map.getTreeHeight();
+  msg.quantization_step = std::max(quantization_step, 0.f);
 
   // Indicate which blocks are allocated in the map
   // NOTE: This is done such that subscribers know when blocks should be removed
@@ -192,40 +627,105 @@ void mapToRosMsg(
     }
   }
 
+  // Compresses a block or subtree's nodes if requested
+  const auto compress_block_msg =
+      [quantization_step = msg.quantization_step](auto& block_msg) {
+        if (0.f < quantization_step) {
+          compressBlockNodes(block_msg.nodes, quantization_step,
+                             block_msg.compressed_nodes);
+          block_msg.nodes.clear();
+        }
+      };
+
+  // Split the blocks into the ones that are sent as a whole and the ones of
+  // which only the changed subtrees are sent
+  std::vector<Index3D> whole_blocks;
+  std::vector<std::pair<Index3D, LinearIndex>> changed_subtrees;
+  for (const auto& block_index : include_blocks.value()) {
+    const auto& dirty_subtrees = map.getBlock(block_index).getDirtySubtrees();
+    if (!send_subtree_deltas) {
+      whole_blocks.emplace_back(block_index);
+      continue;
+    }
+    if (!dirty_subtrees.any()) {
+      continue;
+    }
+    if (!sendAsSubtrees(dirty_subtrees)) {
+      whole_blocks.emplace_back(block_index);
+      continue;
+    }
+    for (LinearIndex subtree_idx = 0;
+         subtree_idx < DirtySubtreeMask::kNumSubtrees; ++subtree_idx) {
+      if (dirty_subtrees.isDirty(subtree_idx)) {
+        changed_subtrees.emplace_back(block_index, subtree_idx);
+      }
+    }
+  }
+
   // Serialize the specified blocks
+  ThreadPool::TaskGroup serialization_tasks;
   int block_idx = 0;
-  msg.blocks.resize(include_blocks->size());
-  for (const auto& block_index : include_blocks.value()) {
+  if (send_block_blobs) {
+    msg.block_blobs.resize(whole_blocks.size());
+  } else {
+    msg.blocks.resize(whole_blocks.size());
+  }
+  for (const auto& block_index : whole_blocks) {
     const auto& block = map.getBlock(block_index);
-    auto& block_msg = msg.blocks[block_idx++];
-    // If a thread pool was provided, use it
-    if (thread_pool) {
-      thread_pool->add_task([&]() {
+    std::function<void()> serialize_block;
+    if (send_block_blobs) {
+      serialize_block = [&, &blob_msg = msg.block_blobs[block_idx++]]() {
+        blockToRosMsg(map, block_index, block, msg.quantization_step,
+                      blob_msg);
+      };
+    } else {
+      serialize_block = [&, &block_msg = msg.blocks[block_idx++]]() {
         blockToRosMsg(block_index, block, min_log_odds, max_log_odds,
                       block_msg);
-      });
+        compress_block_msg(block_msg);
+      };
+    }
+    // If a thread pool was provided, use it
+    if (thread_pool) {
+      thread_pool->add_detached_task(
+          serialization_tasks, std::move(serialize_block));
     } else {  // Otherwise, use the current thread
-      blockToRosMsg(block_index, block, min_log_odds, max_log_odds, block_msg);
+      serialize_block();
+    }
+  }
+
+  // Serialize the changed subtrees
+  msg.subtrees.resize(changed_subtrees.size());
+  for (size_t subtree_msg_idx = 0; subtree_msg_idx < changed_subtrees.size();
+       ++subtree_msg_idx) {
+    auto serialize_subtree = [&, subtree_msg_idx]() {
+      const auto& [block_index, subtree_idx] =
+          changed_subtrees[subtree_msg_idx];
+      auto& subtree_msg = msg.subtrees[subtree_msg_idx];
+      subtreeToRosMsg(block_index, map.getBlock(block_index), subtree_idx,
+                      min_log_odds, max_log_odds, subtree_msg);
+      compress_block_msg(subtree_msg);
+    };
+    if (thread_pool) {
+      thread_pool->add_detached_task(
+          serialization_tasks, std::move(serialize_subtree));
+    } else {
+      serialize_subtree();
     }
   }
 
   // If a thread pool was used, wait for all jobs to finish
   if (thread_pool) {
-    thread_pool->wait_all();
+    thread_pool->wait_for(serialization_tasks);
   }
 }
 
 void blockToRosMsg(const HashedWaveletOctree::BlockIndex& block_index,
                    const HashedWaveletOctree::Block& block,
                    FloatingPoint min_log_odds, FloatingPoint max_log_odds,
-                   wavemap_msgs::HashedWaveletOctreeBlock& msg) {
+                   wavemap_msgs::HashedWaveletOctreeBlock& msg,
+                   IndexElement termination_height) {
   ZoneScoped;
-  // Convenience type for elements on the stack used to iterate over the map
-  struct StackElement {
-    const FloatingPoint scale;
-    const HashedWaveletOctreeBlock::NodeType& node;
-  };
-
   // Serialize the block's metadata
   msg.root_node_offset.x = block_index.x();
   msg.root_node_offset.y = block_index.y();
@@ -234,121 +734,148 @@ void blockToRosMsg(const HashedWaveletOctree::BlockIndex& block_index,
   msg.root_node_scale_coefficient = block.getRootScale();
 
   // Serialize the block's data (all nodes of its octree)
-  std::stack<StackElement> stack;
-  stack.emplace(StackElement{block.getRootScale(), block.getRootNode()});
-  while (!stack.empty()) {
-    const FloatingPoint scale = stack.top().scale;
-    const auto& node = stack.top().node;
-    stack.pop();
+  treeToNodeMsgs(block.getRootNode(), block.getTreeHeight(),
+                 block.getRootScale(), min_log_odds, max_log_odds,
+                 termination_height, msg.nodes);
+}
 
-    // Serialize the node's data
-    auto& node_msg = msg.nodes.emplace_back();
-    std::copy(node.data().cbegin(), node.data().cend(),
-              node_msg.detail_coefficients.begin());
-    node_msg.allocated_children_bitset = 0;
+void subtreeToRosMsg(const HashedWaveletOctree::BlockIndex& block_index,
+                     const HashedWaveletOctree::Block& block,
+                     LinearIndex subtree_idx, FloatingPoint min_log_odds,
+                     FloatingPoint max_log_odds,
+                     wavemap_msgs::HashedWaveletOctreeSubtree& msg) {
+  ZoneScoped;
+  // Serialize the subtree's metadata
+  const OctreeIndex subtree_index =
+      block.getDirtySubtrees().getSubtreeIndex(block_index, subtree_idx);
+  msg.root_node_height = subtree_index.height;
+  msg.root_node_offset.x = subtree_index.position.x();
+  msg.root_node_offset.y = subtree_index.position.y();
+  msg.root_node_offset.z = subtree_index.position.z();
 
-    // Evaluate which of its children should be serialized
-    const auto child_scales =
-        HashedWaveletOctreeBlock::Transform::backward({scale, node.data()});
-    // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
-    //       the nodes are popped from the stack in increasing order.
-    for (int relative_child_idx = OctreeIndex::kNumChildren - 1;
-         0 <= relative_child_idx; --relative_child_idx) {
-      // If the child is saturated, we don't need to store its descendants
-      const auto child_scale = child_scales[relative_child_idx];
-      if (child_scale < min_log_odds || max_log_odds < child_scale) {
-        continue;
-      }
-      // Otherwise, indicate that the child will be serialized
-      // and add it to the stack
-      const auto* child = node.getChild(relative_child_idx);
-      if (child) {
-        stack.emplace(StackElement{child_scale, *child});
-        node_msg.allocated_children_bitset += (1 << relative_child_idx);
-      }
-    }
+  // Descend to the subtree's root node while computing its scale coefficient
+  // NOTE: Nodes that are not allocated have no details, so their descendants
+  //       share their scale coefficient.
+  const MortonIndex morton_code = convert::nodeIndexToMorton(subtree_index);
+  FloatingPoint scale = block.getRootScale();
+  const HashedWaveletOctreeBlock::NodeType* node = &block.getRootNode();
+  for (IndexElement parent_height = block.getTreeHeight();
+       subtree_index.height < parent_height && node; --parent_height) {
+    const NdtreeIndexRelativeChild relative_child_idx =
+        OctreeIndex::computeRelativeChildIndex(morton_code, parent_height);
+    scale = HashedWaveletOctreeBlock::Transform::backwardSingleChild(
+        scale, node->data(), relative_child_idx);
+    node = node->getChild(relative_child_idx);
+  }
+  msg.root_node_scale_coefficient = scale;
+
+  // Serialize the subtree's nodes, or a single node without details if the
+  // subtree is not allocated
+  if (node) {
+    treeToNodeMsgs(*node, subtree_index.height, scale, min_log_odds,
+                   max_log_odds, 0, msg.nodes);
+  } else {
+    msg.nodes.emplace_back();
+  }
+}
+
+void blockToRosMsg(const HashedWaveletOctree& map,
+                   const HashedWaveletOctree::BlockIndex& block_index,
+                   const HashedWaveletOctree::Block& block,
+                   FloatingPoint quantization_step,
+                   wavemap_msgs::HashedWaveletOctreeBlockBlob& msg) {
+  ZoneScoped;
+  if (0.f < quantization_step) {
+    io::blockToBytes(map, block_index, block, quantization_step, msg.data);
+  } else {
+    io::blockToBytes(map, block_index, block, msg.data);
   }
 }
 
 void rosMsgToMap(const wavemap_msgs::HashedWaveletOctree& msg,
-                 HashedWaveletOctree::Ptr& map) {
+                 HashedWaveletOctree::Ptr& map,
+                 std::shared_ptr<ThreadPool> thread_pool) {
   ZoneScoped;
-  // Deserialize the map's config and initialize the data structure
-  HashedWaveletOctreeConfig config;
-  config.min_cell_width = msg.min_cell_width;
-  config.min_log_odds = msg.min_log_odds;
-  config.max_log_odds = msg.max_log_odds;
-  config.tree_height = msg.tree_height;
+  rosMsgToHashedMap(msg, map, thread_pool.get());
+}
 
-  // Check if the map already exists and has compatible settings
-  if (map && map->getConfig() == config) {
-    // Load allocated block list into a hash table for quick membership lookups
-    std::unordered_set<Index3D, Index3DHash> allocated_blocks;
-    for (const auto& block_index : msg.allocated_block_indices) {
-      allocated_blocks.emplace(block_index.x, block_index.y, block_index.z);
-    }
-    // Remove local blocks that should no longer exist according to the map msg
-    for (auto it = map->getBlocks().begin(); it != map->getBlocks().end();) {
-      const auto block_index = it->first;
-      if (!allocated_blocks.count(block_index)) {
-        it = map->getBlocks().erase(it);
-      } else {
-        ++it;
-      }
-    }
-  } else {
-    // Otherwise create a new map
-    map = std::make_shared<HashedWaveletOctree>(config);
+bool rosMsgToBlock(const wavemap_msgs::HashedWaveletOctreeBlock& msg,
+                   FloatingPoint quantization_step,
+                   HashedWaveletOctree::Block& block) {
+  ZoneScoped;
+  // Deserialize the wavelet scale coefficient of the block's root node
+  block.getRootScale() = msg.root_node_scale_coefficient;
+
+  // Decompress the block's nodes if needed
+  std::vector<wavemap_msgs::WaveletOctreeNode> decompressed_nodes;
+  const bool valid =
+      quantization_step <= 0.f ||
+      decompressBlockNodes(msg.compressed_nodes, quantization_step,
+                           decompressed_nodes);
+  const auto& node_msgs =
+      0.f < quantization_step ? decompressed_nodes : msg.nodes;
+
+  // Deserialize the block's remaining data into octree nodes
+  return nodeMsgsToTree(node_msgs, block.getRootNode()) && valid;
+}
+
+bool rosMsgToSubtree(const wavemap_msgs::HashedWaveletOctreeSubtree& msg,
+                     FloatingPoint quantization_step,
+                     HashedWaveletOctree::Block& block) {
+  ZoneScoped;
+  // Check that the msg holds one of the subtrees tracked for the block
+  const auto& dirty_subtrees = block.getDirtySubtrees();
+  if (!dirty_subtrees.tracksSubtrees() ||
+      msg.root_node_height != dirty_subtrees.getSubtreeHeight()) {
+    return false;
   }
+  const OctreeIndex subtree_index{
+      msg.root_node_height,
+      {msg.root_node_offset.x, msg.root_node_offset.y, msg.root_node_offset.z}};
 
-  // Deserialize all the transferred blocks
-  for (const auto& block_msg : msg.blocks) {
-    const Index3D block_index{block_msg.root_node_offset.x,
-                              block_msg.root_node_offset.y,
-                              block_msg.root_node_offset.z};
+  // Decompress the subtree's nodes if needed
+  std::vector<wavemap_msgs::WaveletOctreeNode> decompressed_nodes;
+  const bool valid =
+      quantization_step <= 0.f ||
+      decompressBlockNodes(msg.compressed_nodes, quantization_step,
+                           decompressed_nodes);
+  const auto& node_msgs =
+      0.f < quantization_step ? decompressed_nodes : msg.nodes;
 
-    // Reset the block if it already existed
-    const bool block_existed = map->hasBlock(block_index);
-    auto& block = map->getOrAllocateBlock(block_index);
-    if (block_existed) {
-      block.clear();
-    }
-
-    // Deserialize the wavelet scale coefficient of the block's root node
-    block.getRootScale() = block_msg.root_node_scale_coefficient;
-
-    // Deserialize the block's remaining data into octree nodes
-    std::stack<WaveletOctree::NodeType*> stack;
-    stack.emplace(&block.getRootNode());
-    for (const auto& node_msg : block_msg.nodes) {
-      DCHECK(!stack.empty());
-      WaveletOctree::NodeType* node = stack.top();
-      stack.pop();
-
-      // Deserialize the node's (wavelet) detail coefficients
-      std::copy(node_msg.detail_coefficients.cbegin(),
-                node_msg.detail_coefficients.cend(), node->data().begin());
-
-      // Evaluate which of the node's children are coming next
-      // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
-      //       the nodes are popped from the stack in increasing order.
-      for (int relative_child_idx = wavemap::OctreeIndex::kNumChildren - 1;
-           0 <= relative_child_idx; --relative_child_idx) {
-        const bool child_exists =
-            node_msg.allocated_children_bitset & (1 << relative_child_idx);
-        if (child_exists) {
-          stack.emplace(node->allocateChild(relative_child_idx));
-        }
-      }
-    }
+  // Set the subtree's average value, which only updates the nodes on the path
+  // from the block's root node to the subtree and leaves the rest untouched
+  block.setCellValue(subtree_index, msg.root_node_scale_coefficient);
+
+  // Replace the subtree's nodes
+  const MortonIndex morton_code = convert::nodeIndexToMorton(subtree_index);
+  HashedWaveletOctreeBlock::NodeType* parent_node = &block.getRootNode();
+  for (IndexElement parent_height = block.getTreeHeight();
+       subtree_index.height + 1 < parent_height; --parent_height) {
+    parent_node = parent_node->getChild(
+        OctreeIndex::computeRelativeChildIndex(morton_code, parent_height));
+    DCHECK_NOTNULL(parent_node);
   }
+  const NdtreeIndexRelativeChild relative_child_idx =
+      OctreeIndex::computeRelativeChildIndex(morton_code,
+                                             subtree_index.height + 1);
+  parent_node->deleteChild(relative_child_idx);
+  auto* subtree_root_node = parent_node->allocateChild(relative_child_idx);
+  return nodeMsgsToTree(node_msgs, *subtree_root_node) && valid;
+}
+
+bool rosMsgToBlock(const wavemap_msgs::HashedWaveletOctreeBlockBlob& msg,
+                   FloatingPoint quantization_step,
+                   HashedWaveletOctree::Block& block) {
+  ZoneScoped;
+  return blobMsgToBlock(msg, quantization_step, block);
 }
 
 void mapToRosMsg(
     const HashedChunkedWaveletOctree& map,
     wavemap_msgs::HashedWaveletOctree& msg,
     std::optional<std::unordered_set<Index3D, Index3DHash>> include_blocks,
-    std::shared_ptr<ThreadPool> thread_pool) {
+    std::shared_ptr<ThreadPool> thread_pool, FloatingPoint quantization_step,
+    bool send_block_blobs, bool send_subtree_deltas) {
   ZoneScoped;
   // Constants
   constexpr FloatingPoint kNumericalNoise = 1e-3f;
@@ -361,6 +888,7 @@ void mapToRosMsg(
   msg.min_log_odds = map.getMinLogOdds();
   msg.max_log_odds = map.getMaxLogOdds();
   msg.tree_height = map.getTreeHeight();
+  msg.quantization_step = std::max(quantization_step, 0.f);
 
   // Indicate which blocks are allocated in the map
   // NOTE: This is done such that subscribers know when blocks should be removed
@@ -391,27 +919,96 @@ void mapToRosMsg(
     }
   }
 
+  // Compresses a block or subtree's nodes if requested
+  const auto compress_block_msg =
+      [quantization_step = msg.quantization_step](auto& block_msg) {
+        if (0.f < quantization_step) {
+          compressBlockNodes(block_msg.nodes, quantization_step,
+                             block_msg.compressed_nodes);
+          block_msg.nodes.clear();
+        }
+      };
+
+  // Split the blocks into the ones that are sent as a whole and the ones of
+  // which only the changed subtrees are sent
+  std::vector<Index3D> whole_blocks;
+  std::vector<std::pair<Index3D, LinearIndex>> changed_subtrees;
+  for (const auto& block_index : include_blocks.value()) {
+    const auto& dirty_subtrees = map.getBlock(block_index).getDirtySubtrees();
+    if (!send_subtree_deltas) {
+      whole_blocks.emplace_back(block_index);
+      continue;
+    }
+    if (!dirty_subtrees.any()) {
+      continue;
+    }
+    if (!sendAsSubtrees(dirty_subtrees)) {
+      whole_blocks.emplace_back(block_index);
+      continue;
+    }
+    for (LinearIndex subtree_idx = 0;
+         subtree_idx < DirtySubtreeMask::kNumSubtrees; ++subtree_idx) {
+      if (dirty_subtrees.isDirty(subtree_idx)) {
+        changed_subtrees.emplace_back(block_index, subtree_idx);
+      }
+    }
+  }
+
   // Serialize the specified blocks
+  ThreadPool::TaskGroup serialization_tasks;
   int block_idx = 0;
-  msg.blocks.resize(include_blocks->size());
-  for (const auto& block_index : include_blocks.value()) {
+  if (send_block_blobs) {
+    msg.block_blobs.resize(whole_blocks.size());
+  } else {
+    msg.blocks.resize(whole_blocks.size());
+  }
+  for (const auto& block_index : whole_blocks) {
     const auto& block = map.getBlock(block_index);
-    auto& block_msg = msg.blocks[block_idx++];
-    // If a thread pool was provided, use it
-    if (thread_pool) {
-      thread_pool->add_task([&]() {
+    std::function<void()> serialize_block;
+    if (send_block_blobs) {
+      serialize_block = [&, &blob_msg = msg.block_blobs[block_idx++]]() {
+        blockToRosMsg(map, block_index, block, msg.quantization_step,
+                      blob_msg);
+      };
+    } else {
+      serialize_block = [&, &block_msg = msg.blocks[block_idx++]]() {
         blockToRosMsg(block_index, block, min_log_odds, max_log_odds,
                       tree_height, block_msg);
-      });
+        compress_block_msg(block_msg);
+      };
+    }
+    // If a thread pool was provided, use it
+    if (thread_pool) {
+      thread_pool->add_detached_task(
+          serialization_tasks, std::move(serialize_block));
     } else {  // Otherwise, use the current thread
-      blockToRosMsg(block_index, block, min_log_odds, max_log_odds, tree_height,
-                    block_msg);
+      serialize_block();
+    }
+  }
+
+  // Serialize the changed subtrees
+  msg.subtrees.resize(changed_subtrees.size());
+  for (size_t subtree_msg_idx = 0; subtree_msg_idx < changed_subtrees.size();
+       ++subtree_msg_idx) {
+    auto serialize_subtree = [&, subtree_msg_idx]() {
+      const auto& [block_index, subtree_idx] =
+          changed_subtrees[subtree_msg_idx];
+      auto& subtree_msg = msg.subtrees[subtree_msg_idx];
+      subtreeToRosMsg(block_index, map.getBlock(block_index), subtree_idx,
+                      min_log_odds, max_log_odds, subtree_msg);
+      compress_block_msg(subtree_msg);
+    };
+    if (thread_pool) {
+      thread_pool->add_detached_task(
+          serialization_tasks, std::move(serialize_subtree));
+    } else {
+      serialize_subtree();
     }
   }
 
   // If a thread pool was used, wait for all jobs to finish
   if (thread_pool) {
-    thread_pool->wait_all();
+    thread_pool->wait_for(serialization_tasks);
   }
 }
 
@@ -419,17 +1016,9 @@ void blockToRosMsg(const HashedChunkedWaveletOctree::BlockIndex& block_index,
                    const HashedChunkedWaveletOctree::Block& block,
                    FloatingPoint min_log_odds, FloatingPoint max_log_odds,
                    IndexElement tree_height,
-                   wavemap_msgs::HashedWaveletOctreeBlock& msg) {
+                   wavemap_msgs::HashedWaveletOctreeBlock& msg,
+                   IndexElement termination_height) {
   ZoneScoped;
-  // Define convenience types and constants
-  struct StackElement {
-    const OctreeIndex node_index;
-    const HashedChunkedWaveletOctreeBlock::NodeChunkType& chunk;
-    const FloatingPoint scale_coefficient;
-  };
-  constexpr IndexElement chunk_height =
-      HashedChunkedWaveletOctreeBlock::kChunkHeight;
-
   // Serialize the block's metadata
   msg.root_node_offset.x = block_index.x();
   msg.root_node_offset.y = block_index.y();
@@ -438,71 +1027,170 @@ void blockToRosMsg(const HashedChunkedWaveletOctree::BlockIndex& block_index,
   msg.root_node_scale_coefficient = block.getRootScale();
 
   // Serialize the block's data (all nodes of its octree)
-  std::stack<StackElement> stack;
-  stack.emplace(StackElement{
-      {tree_height, block_index}, block.getRootChunk(), block.getRootScale()});
-  while (!stack.empty()) {
-    const OctreeIndex index = stack.top().node_index;
-    const FloatingPoint scale = stack.top().scale_coefficient;
-    const auto& chunk = stack.top().chunk;
-    stack.pop();
+  chunkedTreeToNodeMsgs({tree_height, block_index}, block.getRootChunk(),
+                        block.getRootScale(), min_log_odds, max_log_odds,
+                        termination_height, msg.nodes);
+}
 
-    // Compute the node's index w.r.t. the data chunk that contains it
-    const MortonIndex morton_code = convert::nodeIndexToMorton(index);
-    const int chunk_top_height =
-        chunk_height * int_math::div_round_up(index.height, chunk_height);
-    const LinearIndex relative_node_index =
-        OctreeIndex::computeTreeTraversalDistance(morton_code, chunk_top_height,
-                                                  index.height);
+void subtreeToRosMsg(const HashedChunkedWaveletOctree::BlockIndex& block_index,
+                     const HashedChunkedWaveletOctree::Block& block,
+                     LinearIndex subtree_idx, FloatingPoint min_log_odds,
+                     FloatingPoint max_log_odds,
+                     wavemap_msgs::HashedWaveletOctreeSubtree& msg) {
+  ZoneScoped;
+  // Serialize the subtree's metadata
+  const OctreeIndex subtree_index =
+      block.getDirtySubtrees().getSubtreeIndex(block_index, subtree_idx);
+  msg.root_node_height = subtree_index.height;
+  msg.root_node_offset.x = subtree_index.position.x();
+  msg.root_node_offset.y = subtree_index.position.y();
+  msg.root_node_offset.z = subtree_index.position.z();
+  const FloatingPoint scale = block.getCellValue(subtree_index);
+  msg.root_node_scale_coefficient = scale;
 
-    // Serialize the node's data
-    auto& node_msg = msg.nodes.emplace_back();
-    const auto& node_data = chunk.nodeData(relative_node_index);
-    std::copy(node_data.cbegin(), node_data.cend(),
-              node_msg.detail_coefficients.begin());
-    node_msg.allocated_children_bitset = 0;
+  // Serialize the subtree's nodes, which are stored in the root chunk's child
+  // chunks, or a single node without details if the subtree is not allocated
+  // NOTE: The subtrees and root chunk's children are both indexed in Morton
+  //       order.
+  if (const auto* subtree_chunk = block.getRootChunk().getChild(subtree_idx);
+      subtree_chunk) {
+    chunkedTreeToNodeMsgs(subtree_index, *subtree_chunk, scale, min_log_odds,
+                          max_log_odds, 0, msg.nodes);
+  } else {
+    msg.nodes.emplace_back();
+  }
+}
 
-    // If the node has no children, continue
-    if (!chunk.nodeHasAtLeastOneChild(relative_node_index)) {
-      continue;
-    }
+void blockToRosMsg(const HashedChunkedWaveletOctree& map,
+                   const HashedChunkedWaveletOctree::BlockIndex& block_index,
+                   const HashedChunkedWaveletOctree::Block& block,
+                   FloatingPoint quantization_step,
+                   wavemap_msgs::HashedWaveletOctreeBlockBlob& msg) {
+  ZoneScoped;
+  if (0.f < quantization_step) {
+    io::blockToBytes(map, block_index, block, quantization_step, msg.data);
+  } else {
+    io::blockToBytes(map, block_index, block, msg.data);
+  }
+}
 
-    // Otherwise, evaluate which of its children should be serialized
-    const auto child_scales =
-        HashedWaveletOctreeBlock::Transform::backward({scale, node_data});
-    // NOTE: We iterate and add nodes to the stack in decreasing order s.t.
-    //       the nodes are popped from the stack in increasing order.
-    for (int relative_child_idx = OctreeIndex::kNumChildren - 1;
-         0 <= relative_child_idx; --relative_child_idx) {
-      // If the child is saturated, we don't need to store its descendants
-      const FloatingPoint child_scale = child_scales[relative_child_idx];
-      if (child_scale < min_log_odds || max_log_odds < child_scale) {
-        continue;
-      }
+void rosMsgToMap(const wavemap_msgs::HashedWaveletOctree& msg,
+                 HashedChunkedWaveletOctree::Ptr& map,
+                 std::shared_ptr<ThreadPool> thread_pool) {
+  ZoneScoped;
+  rosMsgToHashedMap(msg, map, thread_pool.get());
+}
 
-      // Check if the child is no longer in the current chunk
-      const OctreeIndex child_index =
-          index.computeChildIndex(relative_child_idx);
-      if (child_index.height % chunk_height == 0) {
-        // If so, check if the chunk exists
-        const MortonIndex child_morton =
-            convert::nodeIndexToMorton(child_index);
-        const LinearIndex linear_child_index =
-            OctreeIndex::computeLevelTraversalDistance(
-                child_morton, chunk_top_height, child_index.height);
-        if (chunk.hasChild(linear_child_index)) {
-          const auto& child_chunk = *chunk.getChild(linear_child_index);
-          // Indicate that the child will be serialized
-          // and add it to the stack
-          stack.emplace(StackElement{child_index, child_chunk, child_scale});
-          node_msg.allocated_children_bitset += (1 << relative_child_idx);
-        }
-      } else {
-        // Indicate that the child will be serialized and add it to the stack
-        stack.emplace(StackElement{child_index, chunk, child_scale});
-        node_msg.allocated_children_bitset += (1 << relative_child_idx);
-      }
+bool rosMsgToBlock(const wavemap_msgs::HashedWaveletOctreeBlock& msg,
+                   FloatingPoint quantization_step,
+                   HashedChunkedWaveletOctree::Block& block) {
+  ZoneScoped;
+  // Deserialize the wavelet scale coefficient of the block's root node
+  block.getRootScale() = msg.root_node_scale_coefficient;
+
+  // Decompress the block's nodes if needed
+  std::vector<wavemap_msgs::WaveletOctreeNode> decompressed_nodes;
+  const bool valid =
+      quantization_step <= 0.f ||
+      decompressBlockNodes(msg.compressed_nodes, quantization_step,
+                           decompressed_nodes);
+  const auto& node_msgs =
+      0.f < quantization_step ? decompressed_nodes : msg.nodes;
+
+  // Deserialize the block's remaining data directly into the chunks that
+  // hold its nodes
+  const OctreeIndex root_node_index{block.getTreeHeight(), Index3D::Zero()};
+  return nodeMsgsToChunkedTree(node_msgs, root_node_index,
+                               block.getRootChunk()) &&
+         valid;
+}
+
+bool rosMsgToSubtree(const wavemap_msgs::HashedWaveletOctreeSubtree& msg,
+                     FloatingPoint quantization_step,
+                     HashedChunkedWaveletOctree::Block& block) {
+  ZoneScoped;
+  // Check that the msg holds one of the subtrees tracked for the block
+  const auto& dirty_subtrees = block.getDirtySubtrees();
+  if (!dirty_subtrees.tracksSubtrees() ||
+      msg.root_node_height != dirty_subtrees.getSubtreeHeight()) {
+    return false;
+  }
+  const OctreeIndex subtree_index{
+      msg.root_node_height,
+      {msg.root_node_offset.x, msg.root_node_offset.y, msg.root_node_offset.z}};
+
+  // Decompress the subtree's nodes if needed
+  std::vector<wavemap_msgs::WaveletOctreeNode> decompressed_nodes;
+  const bool valid =
+      quantization_step <= 0.f ||
+      decompressBlockNodes(msg.compressed_nodes, quantization_step,
+                           decompressed_nodes);
+  const auto& node_msgs =
+      0.f < quantization_step ? decompressed_nodes : msg.nodes;
+
+  // Set the subtree's average value, which only updates the nodes on the path
+  // from the block's root node to the subtree and leaves the rest untouched
+  block.setCellValue(subtree_index, msg.root_node_scale_coefficient);
+
+  // Replace the chunk that holds the subtree's nodes
+  const LinearIndex subtree_idx = OctreeIndex::computeLevelTraversalDistance(
+      convert::nodeIndexToMorton(subtree_index), block.getTreeHeight(),
+      subtree_index.height);
+  auto& root_chunk = block.getRootChunk();
+  root_chunk.deleteChild(subtree_idx);
+  auto* subtree_chunk = root_chunk.allocateChild(subtree_idx);
+  return nodeMsgsToChunkedTree(node_msgs, subtree_index, *subtree_chunk) &&
+         valid;
+}
+
+bool rosMsgToBlock(const wavemap_msgs::HashedWaveletOctreeBlockBlob& msg,
+                   FloatingPoint quantization_step,
+                   HashedChunkedWaveletOctree::Block& block) {
+  ZoneScoped;
+  return blobMsgToBlock(msg, quantization_step, block);
+}
+
+void compressBlockNodes(
+    const std::vector<wavemap_msgs::WaveletOctreeNode>& nodes,
+    FloatingPoint quantization_step, std::vector<uint8_t>& compressed_nodes) {
+  ZoneScoped;
+  compressed_nodes.clear();
+  DetailCoefficientEncoder encoder(quantization_step, compressed_nodes);
+  DetailCoefficientEncoder::Details details;
+  for (const auto& node_msg : nodes) {
+    std::copy_n(node_msg.detail_coefficients.cbegin(), details.size(),
+                details.begin());
+    encoder.encodeNode(details, node_msg.allocated_children_bitset);
+  }
+  encoder.flush();
+}
+
+bool decompressBlockNodes(const std::vector<uint8_t>& compressed_nodes,
+                          FloatingPoint quantization_step,
+                          std::vector<wavemap_msgs::WaveletOctreeNode>& nodes) {
+  ZoneScoped;
+  nodes.clear();
+  DetailCoefficientDecoder decoder(
+      quantization_step, compressed_nodes.data(),
+      compressed_nodes.data() + compressed_nodes.size());
+  DetailCoefficientDecoder::Details details;
+  // The nodes are stored in depth-first order, starting from the block's root
+  // node, so all nodes have been read once no more children are pending
+  int num_pending_nodes = 1;
+  while (0 < num_pending_nodes) {
+    uint8_t allocated_children_bitset;
+    if (!decoder.decodeNode(details, allocated_children_bitset)) {
+      return false;
     }
+    auto& node_msg = nodes.emplace_back();
+    std::copy(details.cbegin(), details.cend(),
+              node_msg.detail_coefficients.begin());
+    node_msg.allocated_children_bitset = allocated_children_bitset;
+    num_pending_nodes +=
+        static_cast<int>(bit_ops::popcount(
+            static_cast<uint32_t>(allocated_children_bitset))) -
+        1;
   }
+  return true;
 }
 }  // namespace wavemap::convert
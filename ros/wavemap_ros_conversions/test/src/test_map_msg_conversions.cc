@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <type_traits>
+#include <unordered_set>
+
 #include <gtest/gtest.h>
 #include <wavemap/common.h>
 #include <wavemap/data_structure/volumetric/hashed_chunked_wavelet_octree.h>
@@ -7,6 +11,7 @@
 #include <wavemap/test/config_generator.h>
 #include <wavemap/test/fixture_base.h>
 #include <wavemap/test/geometry_generator.h>
+#include <wavemap/utils/thread_pool.h>
 #include <wavemap_msgs/Map.h>
 
 #include "wavemap_ros_conversions/map_msg_conversions.h"
@@ -144,4 +149,344 @@ TYPED_TEST(MapMsgConversionsTest, InsertionAndLeafVisitor) {
     }
   }
 }
+
+TYPED_TEST(MapMsgConversionsTest, Compression) {
+  constexpr FloatingPoint kQuantizationStep = 1e-4f;
+  constexpr int kNumRepetitions = 3;
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    // Create a random map
+    const auto config =
+        ConfigGenerator::getRandomConfig<typename TypeParam::Config>();
+    TypeParam map_original(config);
+    const std::vector<Index3D> random_indices =
+        GeometryGenerator::getRandomIndexVector<3>(
+            1000u, 2000u, Index3D::Constant(-5000), Index3D::Constant(5000));
+    for (const Index3D& index : random_indices) {
+      const FloatingPoint update = TestFixture::getRandomUpdate();
+      map_original.addToCellValue(index, update);
+    }
+    map_original.prune();
+
+    // Serialize with compression and deserialize
+    wavemap_msgs::Map map_msg;
+    ASSERT_TRUE(convert::mapToRosMsg(map_original, TestFixture::frame_id,
+                                     TestFixture::stamp, map_msg,
+                                     kQuantizationStep));
+    for (const auto& hashed_map_msg : map_msg.hashed_wavelet_octree) {
+      EXPECT_EQ(hashed_map_msg.quantization_step, kQuantizationStep);
+      for (const auto& block_msg : hashed_map_msg.blocks) {
+        EXPECT_TRUE(block_msg.nodes.empty());
+        EXPECT_FALSE(block_msg.compressed_nodes.empty());
+      }
+    }
+    VolumetricDataStructureBase::Ptr map_base_round_trip;
+    ASSERT_TRUE(convert::rosMsgToMap(map_msg, map_base_round_trip));
+    ASSERT_TRUE(map_base_round_trip);
+
+    // Check that the map was reconstructed up to the quantization error
+    map_base_round_trip->forEachLeaf(
+        [&map_original](const OctreeIndex& node_index,
+                        FloatingPoint round_trip_value) {
+          EXPECT_NEAR(round_trip_value, map_original.getCellValue(node_index),
+                      TestFixture::kAcceptableReconstructionError);
+        });
+  }
+}
+
+template <typename HashedMapType>
+class HashedMapMsgConversionsTest
+    : public MapMsgConversionsTest<HashedMapType> {};
+
+using HashedMapTypes =
+    ::testing::Types<HashedWaveletOctree, HashedChunkedWaveletOctree>;
+TYPED_TEST_SUITE(HashedMapMsgConversionsTest, HashedMapTypes, );
+
+TYPED_TEST(HashedMapMsgConversionsTest, ParallelDecoding) {
+  auto thread_pool = std::make_shared<ThreadPool>(4);
+  constexpr int kNumRepetitions = 3;
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    for (const FloatingPoint quantization_step : {0.f, 1e-4f}) {
+      // Create a random map
+      const auto config =
+          ConfigGenerator::getRandomConfig<typename TypeParam::Config>();
+      TypeParam map_original(config);
+      const std::vector<Index3D> random_indices =
+          GeometryGenerator::getRandomIndexVector<3>(
+              1000u, 2000u, Index3D::Constant(-5000), Index3D::Constant(5000));
+      for (const Index3D& index : random_indices) {
+        const FloatingPoint update = TestFixture::getRandomUpdate();
+        map_original.addToCellValue(index, update);
+      }
+      map_original.prune();
+
+      // Serialize the map
+      wavemap_msgs::HashedWaveletOctree map_msg;
+      convert::mapToRosMsg(map_original, map_msg, std::nullopt, thread_pool,
+                           quantization_step);
+
+      // Deserialize it serially and in parallel, natively into the original
+      // map type
+      typename TypeParam::Ptr serial_round_trip;
+      convert::rosMsgToMap(map_msg, serial_round_trip);
+      ASSERT_TRUE(serial_round_trip);
+      typename TypeParam::Ptr parallel_round_trip;
+      convert::rosMsgToMap(map_msg, parallel_round_trip, thread_pool);
+      ASSERT_TRUE(parallel_round_trip);
+
+      // Deserializing into an existing map should reset the transferred blocks
+      convert::rosMsgToMap(map_msg, parallel_round_trip, thread_pool);
+
+      // Check that all maps match
+      EXPECT_EQ(serial_round_trip->getBlocks().size(),
+                map_original.getBlocks().size());
+      EXPECT_EQ(parallel_round_trip->getBlocks().size(),
+                map_original.getBlocks().size());
+      EXPECT_EQ(parallel_round_trip->size(), serial_round_trip->size());
+      map_original.forEachLeaf(
+          [&serial_round_trip, &parallel_round_trip](
+              const OctreeIndex& node_index, FloatingPoint original_value) {
+            EXPECT_NEAR(serial_round_trip->getCellValue(node_index),
+                        original_value,
+                        TestFixture::kAcceptableReconstructionError);
+            EXPECT_NEAR(parallel_round_trip->getCellValue(node_index),
+                        original_value,
+                        TestFixture::kAcceptableReconstructionError);
+          });
+    }
+  }
+}
+
+TYPED_TEST(HashedMapMsgConversionsTest, BlockBlobs) {
+  auto thread_pool = std::make_shared<ThreadPool>(4);
+  constexpr int kNumRepetitions = 3;
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    for (const FloatingPoint quantization_step : {0.f, 1e-4f}) {
+      // Create a random map
+      const auto config =
+          ConfigGenerator::getRandomConfig<typename TypeParam::Config>();
+      TypeParam map_original(config);
+      const std::vector<Index3D> random_indices =
+          GeometryGenerator::getRandomIndexVector<3>(
+              1000u, 2000u, Index3D::Constant(-5000), Index3D::Constant(5000));
+      for (const Index3D& index : random_indices) {
+        const FloatingPoint update = TestFixture::getRandomUpdate();
+        map_original.addToCellValue(index, update);
+      }
+      map_original.prune();
+
+      // Serialize the map with each block as a single blob
+      wavemap_msgs::HashedWaveletOctree map_msg;
+      convert::mapToRosMsg(map_original, map_msg, std::nullopt, thread_pool,
+                           quantization_step, true);
+      EXPECT_TRUE(map_msg.blocks.empty());
+      EXPECT_EQ(map_msg.block_blobs.size(), map_original.getBlocks().size());
+
+      // Deserialize it and check that it matches the original
+      typename TypeParam::Ptr map_round_trip;
+      convert::rosMsgToMap(map_msg, map_round_trip, thread_pool);
+      ASSERT_TRUE(map_round_trip);
+      EXPECT_EQ(map_round_trip->getBlocks().size(),
+                map_original.getBlocks().size());
+      map_original.forEachLeaf([&map_round_trip](const OctreeIndex& node_index,
+                                                 FloatingPoint original_value) {
+        EXPECT_NEAR(map_round_trip->getCellValue(node_index), original_value,
+                    TestFixture::kAcceptableReconstructionError);
+      });
+
+      // Blobs whose header is truncated should be skipped, while the other
+      // blocks are still loaded
+      if (!map_msg.block_blobs.empty()) {
+        map_msg.block_blobs.front().data.resize(8u);
+        typename TypeParam::Ptr map_truncated;
+        convert::rosMsgToMap(map_msg, map_truncated, thread_pool);
+        ASSERT_TRUE(map_truncated);
+        EXPECT_EQ(map_truncated->getBlocks().size(),
+                  map_original.getBlocks().size() - 1u);
+      }
+    }
+  }
+}
+
+TYPED_TEST(HashedMapMsgConversionsTest, SubtreeDeltas) {
+  auto thread_pool = std::make_shared<ThreadPool>(4);
+  constexpr int kNumRepetitions = 3;
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    for (const FloatingPoint quantization_step : {0.f, 1e-4f}) {
+      // Create a random map and send it to the receiver as a whole
+      const auto config =
+          ConfigGenerator::getRandomConfig<typename TypeParam::Config>();
+      TypeParam map_original(config);
+      const std::vector<Index3D> random_indices =
+          GeometryGenerator::getRandomIndexVector<3>(
+              1000u, 2000u, Index3D::Constant(-5000), Index3D::Constant(5000));
+      for (const Index3D& index : random_indices) {
+        const FloatingPoint update = TestFixture::getRandomUpdate();
+        map_original.addToCellValue(index, update);
+      }
+      map_original.prune();
+      wavemap_msgs::HashedWaveletOctree full_map_msg;
+      convert::mapToRosMsg(map_original, full_map_msg, std::nullopt,
+                           thread_pool, quantization_step, false, true);
+      EXPECT_TRUE(full_map_msg.subtrees.empty());
+      typename TypeParam::Ptr map_received;
+      convert::rosMsgToMap(full_map_msg, map_received, thread_pool);
+      ASSERT_TRUE(map_received);
+
+      // Mark the map as published and update some of its cells
+      for (auto& [block_index, block] : map_original.getBlocks()) {
+        block.getDirtySubtrees().clear();
+      }
+      for (size_t update_idx = 0; update_idx < random_indices.size();
+           update_idx += 10u) {
+        const FloatingPoint update = TestFixture::getRandomUpdate();
+        map_original.addToCellValue(random_indices[update_idx], update);
+      }
+      map_original.prune();
+
+      // Send the changes and check that only the changed subtrees were sent
+      // for the blocks that track them
+      wavemap_msgs::HashedWaveletOctree delta_msg;
+      convert::mapToRosMsg(map_original, delta_msg, std::nullopt, thread_pool,
+                           quantization_step, false, true);
+      const bool tracks_subtrees =
+          DirtySubtreeMask(config.tree_height).tracksSubtrees();
+      if (tracks_subtrees) {
+        EXPECT_TRUE(delta_msg.blocks.empty());
+        EXPECT_FALSE(delta_msg.subtrees.empty());
+      } else {
+        EXPECT_TRUE(delta_msg.subtrees.empty());
+      }
+      EXPECT_LT(delta_msg.blocks.size(), full_map_msg.blocks.size());
+
+      // Apply them to the receiver's map and check that it matches the original
+      convert::rosMsgToMap(delta_msg, map_received, thread_pool);
+      EXPECT_EQ(map_received->getBlocks().size(),
+                map_original.getBlocks().size());
+      map_original.forEachLeaf([&map_received](const OctreeIndex& node_index,
+                                               FloatingPoint original_value) {
+        EXPECT_NEAR(map_received->getCellValue(node_index), original_value,
+                    TestFixture::kAcceptableReconstructionError);
+      });
+      map_received->forEachLeaf([&map_original](const OctreeIndex& node_index,
+                                                FloatingPoint received_value) {
+        EXPECT_NEAR(map_original.getCellValue(node_index), received_value,
+                    TestFixture::kAcceptableReconstructionError);
+      });
+    }
+  }
+}
+
+TYPED_TEST(HashedMapMsgConversionsTest, TerminationHeight) {
+  constexpr FloatingPoint kNumericalNoise = 1e-3f;
+  constexpr int kNumRepetitions = 3;
+  for (int i = 0; i < kNumRepetitions; ++i) {
+    // Create a random map
+    const auto config =
+        ConfigGenerator::getRandomConfig<typename TypeParam::Config>();
+    TypeParam map_original(config);
+    const std::vector<Index3D> random_indices =
+        GeometryGenerator::getRandomIndexVector<3>(
+            1000u, 2000u, Index3D::Constant(-5000), Index3D::Constant(5000));
+    for (const Index3D& index : random_indices) {
+      const FloatingPoint update = TestFixture::getRandomUpdate();
+      map_original.addToCellValue(index, update);
+    }
+    map_original.prune();
+
+    // Serialize its blocks down to a random termination height
+    const IndexElement termination_height =
+        TestFixture::getRandomInteger(1, config.tree_height - 1);
+    wavemap_msgs::HashedWaveletOctree map_msg;
+    convert::mapToRosMsg(map_original, map_msg,
+                         std::unordered_set<Index3D, Index3DHash>{});
+    for (const auto& [block_index, block] : map_original.getBlocks()) {
+      const FloatingPoint min_log_odds =
+          map_original.getMinLogOdds() + kNumericalNoise;
+      const FloatingPoint max_log_odds =
+          map_original.getMaxLogOdds() - kNumericalNoise;
+      if constexpr (std::is_same_v<TypeParam, HashedChunkedWaveletOctree>) {
+        convert::blockToRosMsg(block_index, block, min_log_odds, max_log_odds,
+                               config.tree_height,
+                               map_msg.blocks.emplace_back(),
+                               termination_height);
+      } else {
+        convert::blockToRosMsg(block_index, block, min_log_odds, max_log_odds,
+                               map_msg.blocks.emplace_back(),
+                               termination_height);
+      }
+    }
+
+    // Check that the received map matches the original at that resolution
+    typename TypeParam::Ptr map_received;
+    convert::rosMsgToMap(map_msg, map_received);
+    ASSERT_TRUE(map_received);
+    EXPECT_EQ(map_received->getBlocks().size(),
+              map_original.getBlocks().size());
+    map_received->forEachLeaf(
+        [termination_height](const OctreeIndex& node_index,
+                             FloatingPoint /*value*/) {
+          EXPECT_GE(node_index.height, termination_height);
+        });
+    map_original.forEachLeaf([&map_original, &map_received,
+                              termination_height](const OctreeIndex& node_index,
+                                                  FloatingPoint /*value*/) {
+      const OctreeIndex coarse_index = node_index.computeParentIndex(
+          std::max(node_index.height, termination_height));
+      EXPECT_NEAR(map_received->getCellValue(node_index),
+                  map_original.getCellValue(coarse_index),
+                  TestFixture::kAcceptableReconstructionError);
+    });
+  }
+}
+
+using HashedChunkedMapMsgConversionsTest =
+    MapMsgConversionsTest<HashedChunkedWaveletOctree>;
+
+TEST_F(HashedChunkedMapMsgConversionsTest, TreeHeightsNotMultipleOfChunkSize) {
+  // NOTE: The chunks are aligned with the blocks' root nodes, s.t. the chunks
+  //       at the bottom of the tree are only partially used if the tree height
+  //       is not a multiple of the chunk height.
+  for (IndexElement tree_height = 1; tree_height <= 8; ++tree_height) {
+    if (tree_height % HashedChunkedWaveletOctreeBlock::kChunkHeight == 0) {
+      continue;
+    }
+
+    // Create a random map
+    auto config = getRandomConfig<HashedChunkedWaveletOctreeConfig>();
+    config.tree_height = tree_height;
+    HashedChunkedWaveletOctree map_original(config);
+    const std::vector<Index3D> random_indices = getRandomIndexVector<3>(
+        1000u, 2000u, Index3D::Constant(-500), Index3D::Constant(500));
+    for (const Index3D& index : random_indices) {
+      map_original.addToCellValue(index, getRandomUpdate());
+    }
+    map_original.prune();
+
+    // Serialize and deserialize
+    wavemap_msgs::Map map_msg;
+    ASSERT_TRUE(convert::mapToRosMsg(map_original, frame_id, stamp, map_msg));
+    VolumetricDataStructureBase::Ptr map_base_round_trip;
+    ASSERT_TRUE(convert::rosMsgToMap(map_msg, map_base_round_trip));
+    HashedWaveletOctree::ConstPtr map_round_trip =
+        std::dynamic_pointer_cast<HashedWaveletOctree>(map_base_round_trip);
+    ASSERT_TRUE(map_round_trip);
+    EXPECT_EQ(map_round_trip->getTreeHeight(), tree_height);
+
+    // Check that both maps contain the same values
+    // NOTE: The original map is only accessed through getCellValue, since
+    //       HashedChunkedWaveletOctreeBlock::forEachLeaf also assumes that the
+    //       chunks are aligned with the leaves.
+    for (const Index3D& index : random_indices) {
+      EXPECT_NEAR(map_round_trip->getCellValue(index),
+                  map_original.getCellValue(index),
+                  kAcceptableReconstructionError);
+    }
+    map_round_trip->forEachLeaf(
+        [&map_original](const OctreeIndex& node_index,
+                        FloatingPoint round_trip_value) {
+          EXPECT_NEAR(round_trip_value, map_original.getCellValue(node_index),
+                      kAcceptableReconstructionError);
+        });
+  }
+}
 }  // namespace wavemap
@@ -8,6 +8,7 @@
 
 #include <rviz/message_filter_display.h>
 #include <rviz/properties/property.h>
+#include <wavemap/utils/thread_pool.h>
 #include <wavemap_msgs/Map.h>
 
 #include "wavemap_rviz_plugin/common.h"
@@ -66,6 +67,8 @@ class WavemapMapDisplay : public rviz::MessageFilterDisplay<wavemap_msgs::Map> {
   // Storage and message parsers for the map
   const std::shared_ptr<MapAndMutex> map_and_mutex_ =
       std::make_shared<MapAndMutex>();
+  const std::shared_ptr<ThreadPool> thread_pool_ =
+      std::make_shared<ThreadPool>();
   void updateMapFromRosMsg(const wavemap_msgs::Map& map_msg);
 
   // Submenus for each visual's properties
@@ -115,7 +115,7 @@ void WavemapMapDisplay::processMessage(
 void WavemapMapDisplay::updateMapFromRosMsg(const wavemap_msgs::Map& map_msg) {
   ZoneScoped;
   std::scoped_lock lock(map_and_mutex_->mutex);
-  if (!convert::rosMsgToMap(map_msg, map_and_mutex_->map)) {
+  if (!convert::rosMsgToMap(map_msg, map_and_mutex_->map, thread_pool_)) {
     ROS_WARN("Failed to parse map message.");
   }
 }